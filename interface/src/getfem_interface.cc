@@ -21,6 +21,7 @@
 // $Id$
 #include <getfem_interface.h>
 #include <getfemint.h>
+#include <mutex>
 
 using namespace getfemint;
 
@@ -76,12 +77,12 @@ void gf_util(getfemint::mexargs_in& in, getfemint::mexargs_out& out);
 void gf_exit(getfemint::mexargs_in&, getfemint::mexargs_out&) { exit(0); }
 
 namespace getfemint {
-  std::stringstream *global_pinfomsg = 0;
+  thread_local std::stringstream *global_pinfomsg = 0;
   std::ostream& infomsg() {
     return *global_pinfomsg;
   }
 
-  config *config::cfg = 0;
+  thread_local config *config::cfg = 0;
   config::config(gfi_interface_type t) : current_function_(0) {
     switch (t) {
     case MATLAB_INTERFACE:
@@ -90,6 +91,7 @@ namespace getfemint {
       prefer_native_sparse_ = true;
       can_return_integer_ = false;
       has_1D_arrays_ = false;
+      has_array_views_ = false;
       break;
     case PYTHON_INTERFACE:
       base_index_ = 0;
@@ -97,6 +99,7 @@ namespace getfemint {
       prefer_native_sparse_ = false;
       can_return_integer_ = true;
       has_1D_arrays_ = true;
+      has_array_views_ = true;
       break;
     case SCILAB_INTERFACE:
       base_index_ = 1;
@@ -104,6 +107,7 @@ namespace getfemint {
       prefer_native_sparse_ = true;
       can_return_integer_ = false;
       has_1D_arrays_ = false;
+      has_array_views_ = false;
       break;
     default:
       THROW_INTERNAL_ERROR;
@@ -112,6 +116,74 @@ namespace getfemint {
 }
 
 typedef void (* psub_command)(getfemint::mexargs_in& in, getfemint::mexargs_out& out);
+typedef std::map<std::string, psub_command > SUBC_TAB;
+
+/* Lock of the concurrent calls (from several Python threads, the
+   interpreter lock being released during the calls), which are executed
+   one at a time. Running the computations of two calls at the same time
+   is not possible: the library keeps its per thread data (stored objects,
+   static caches, partitions of the regions) by OpenMP thread number, which
+   is 0 for every Python thread, and the flag telling that a parallel
+   region is running is global to the process. */
+static std::mutex &call_lock() {
+  static std::mutex l;
+  return l;
+}
+
+static SUBC_TAB subcommand_table() {
+  SUBC_TAB subc_tab;
+  subc_tab["workspace"] = gf_workspace;
+  subc_tab["delete"] = gf_delete;
+  subc_tab["eltm"] = gf_eltm;
+  subc_tab["geotrans"] = gf_geotrans;
+  subc_tab["geotrans_get"] = gf_geotrans_get;
+  subc_tab["integ"] = gf_integ;
+  subc_tab["integ_get"] = gf_integ_get;
+  subc_tab["global_function"] = gf_global_function;
+  subc_tab["global_function_get"] = gf_global_function_get;
+  subc_tab["cont_struct"] = gf_cont_struct;
+  subc_tab["cont_struct_get"] = gf_cont_struct_get;
+  subc_tab["fem"] = gf_fem;
+  subc_tab["fem_get"] = gf_fem_get;
+  subc_tab["cvstruct_get"] = gf_cvstruct_get;
+  subc_tab["mesher_object"] = gf_mesher_object;
+  subc_tab["mesher_object_get"] = gf_mesher_object_get;
+  subc_tab["mesh"] = gf_mesh;
+  subc_tab["mesh_get"] = gf_mesh_get;
+  subc_tab["mesh_set"] = gf_mesh_set;
+  subc_tab["mesh_fem"] = gf_mesh_fem;
+  subc_tab["mesh_fem_get"] = gf_mesh_fem_get;
+  subc_tab["mesh_fem_set"] = gf_mesh_fem_set;
+  subc_tab["mesh_im"] = gf_mesh_im;
+  subc_tab["mesh_im_get"] = gf_mesh_im_get;
+  subc_tab["mesh_im_set"] = gf_mesh_im_set;
+  subc_tab["mesh_im_data"] = gf_mesh_im_data;
+  subc_tab["mesh_im_data_get"] = gf_mesh_im_data_get;
+  subc_tab["mesh_im_data_set"] = gf_mesh_im_data_set;
+  subc_tab["model"] = gf_model;
+  subc_tab["model_get"] = gf_model_get;
+  subc_tab["model_set"] = gf_model_set;
+  subc_tab["slice"] = gf_slice;
+  subc_tab["slice_get"] = gf_slice_get;
+  subc_tab["slice_set"] = gf_slice_set;
+  subc_tab["levelset"] = gf_levelset;
+  subc_tab["levelset_get"] = gf_levelset_get;
+  subc_tab["levelset_set"] = gf_levelset_set;
+  subc_tab["mesh_levelset"] = gf_mesh_levelset;
+  subc_tab["mesh_levelset_get"] = gf_mesh_levelset_get;
+  subc_tab["mesh_levelset_set"] = gf_mesh_levelset_set;
+  subc_tab["asm"] = gf_asm;
+  subc_tab["compute"] = gf_compute;
+  subc_tab["precond"] = gf_precond;
+  subc_tab["precond_get"] = gf_precond_get;
+  subc_tab["spmat"] = gf_spmat;
+  subc_tab["spmat_get"] = gf_spmat_get;
+  subc_tab["spmat_set"] = gf_spmat_set;
+  subc_tab["linsolve"] = gf_linsolve;
+  subc_tab["util"] = gf_util;
+  subc_tab["exit"] = gf_exit;
+  return subc_tab;
+}
 
 
 extern "C"
@@ -120,62 +192,9 @@ char* getfem_interface_main(int config_id, const char *function,
                             int *nb_out_args, gfi_array ***pout_args,
 			    char **pinfomsg, int scilab_flag) {
 
-  typedef std::map<std::string, psub_command > SUBC_TAB;
-  static SUBC_TAB subc_tab;
-
-  if (subc_tab.size() == 0) {
-    subc_tab["workspace"] = gf_workspace;
-    subc_tab["delete"] = gf_delete;
-    subc_tab["eltm"] = gf_eltm;
-    subc_tab["geotrans"] = gf_geotrans;
-    subc_tab["geotrans_get"] = gf_geotrans_get;
-    subc_tab["integ"] = gf_integ;
-    subc_tab["integ_get"] = gf_integ_get;
-    subc_tab["global_function"] = gf_global_function;
-    subc_tab["global_function_get"] = gf_global_function_get;
-    subc_tab["cont_struct"] = gf_cont_struct;
-    subc_tab["cont_struct_get"] = gf_cont_struct_get;
-    subc_tab["fem"] = gf_fem;
-    subc_tab["fem_get"] = gf_fem_get;
-    subc_tab["cvstruct_get"] = gf_cvstruct_get;
-    subc_tab["mesher_object"] = gf_mesher_object;
-    subc_tab["mesher_object_get"] = gf_mesher_object_get;
-    subc_tab["mesh"] = gf_mesh;
-    subc_tab["mesh_get"] = gf_mesh_get;
-    subc_tab["mesh_set"] = gf_mesh_set;
-    subc_tab["mesh_fem"] = gf_mesh_fem;
-    subc_tab["mesh_fem_get"] = gf_mesh_fem_get;
-    subc_tab["mesh_fem_set"] = gf_mesh_fem_set;
-    subc_tab["mesh_im"] = gf_mesh_im;
-    subc_tab["mesh_im_get"] = gf_mesh_im_get;
-    subc_tab["mesh_im_set"] = gf_mesh_im_set;
-    subc_tab["mesh_im_data"] = gf_mesh_im_data;
-    subc_tab["mesh_im_data_get"] = gf_mesh_im_data_get;
-    subc_tab["mesh_im_data_set"] = gf_mesh_im_data_set;
-    subc_tab["model"] = gf_model;
-    subc_tab["model_get"] = gf_model_get;
-    subc_tab["model_set"] = gf_model_set;
-    subc_tab["slice"] = gf_slice;
-    subc_tab["slice_get"] = gf_slice_get;
-    subc_tab["slice_set"] = gf_slice_set;
-    subc_tab["levelset"] = gf_levelset;
-    subc_tab["levelset_get"] = gf_levelset_get;
-    subc_tab["levelset_set"] = gf_levelset_set;
-    subc_tab["mesh_levelset"] = gf_mesh_levelset;
-    subc_tab["mesh_levelset_get"] = gf_mesh_levelset_get;
-    subc_tab["mesh_levelset_set"] = gf_mesh_levelset_set;
-    subc_tab["asm"] = gf_asm;
-    subc_tab["compute"] = gf_compute;
-    subc_tab["precond"] = gf_precond;
-    subc_tab["precond_get"] = gf_precond_get;
-    subc_tab["spmat"] = gf_spmat;
-    subc_tab["spmat_get"] = gf_spmat_get;
-    subc_tab["spmat_set"] = gf_spmat_set;
-    subc_tab["linsolve"] = gf_linsolve;
-    subc_tab["util"] = gf_util;
-    subc_tab["exit"] = gf_exit;
-  }
+  static const SUBC_TAB subc_tab(subcommand_table());
 
+  std::lock_guard<std::mutex> call_guard(call_lock());
 
   std::stringstream info;
   getfemint::global_pinfomsg = &info;
@@ -187,16 +206,16 @@ char* getfem_interface_main(int config_id, const char *function,
   //     gfi_array_print((gfi_array*)in_args[i]); cout << "\n";
   //  }
   try {
-    static getfemint::config *conf[3];
+    static thread_local std::unique_ptr<getfemint::config> conf[3];
     if (!conf[config_id])
-      conf[config_id] = new getfemint::config((gfi_interface_type)config_id);
+      conf[config_id].reset(new getfemint::config((gfi_interface_type)config_id));
     conf[config_id]->current_function_ = function;
-    config::set_current_config(conf[config_id]);
+    config::set_current_config(conf[config_id].get());
     mexargs_in in(nb_in_args, in_args, false);
     mexargs_out out(*nb_out_args);
     out.set_scilab(bool(scilab_flag));
 
-    SUBC_TAB::iterator it = subc_tab.find(function);
+    SUBC_TAB::const_iterator it = subc_tab.find(function);
     if (it != subc_tab.end()) {
       it->second(in, out);
     }
@@ -251,3 +270,16 @@ char* getfem_interface_main(int config_id, const char *function,
   //cout << "getfem_interface_main: exiting " << function << "\n";
   return 0;
 }
+
+extern "C"
+void *getfem_interface_take_view_owner(gfi_array *t) {
+  dal::pstatic_stored_object po = getfemint::take_array_view_owner(t);
+  return po ? new dal::pstatic_stored_object(po) : 0;
+}
+
+extern "C"
+void getfem_interface_release_view_owner(void *owner) {
+  /* The object may be deleted here. */
+  std::lock_guard<std::mutex> call_guard(call_lock());
+  delete (dal::pstatic_stored_object *)(owner);
+}
@@ -44,6 +44,15 @@ char* getfem_interface_main(int config_id, const char *function,
 			    int *nb_out_args,
 			    gfi_array ***pout_args, char **pinfomsg, int scilab_flag);
 
+/* An output array of getfem_interface_main may point to the data of an
+   object (if the interface accepts such array views). The first function
+   detaches it from this data, so that gfi_array_destroy does not free it,
+   and returns a reference on the object, or NULL if the array is not a
+   view. The second one releases this reference once the data is no longer
+   used. */
+void *getfem_interface_take_view_owner(gfi_array *t);
+void getfem_interface_release_view_owner(void *owner);
+
 #ifdef __cplusplus
 }
 #endif
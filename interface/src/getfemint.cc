@@ -724,6 +724,79 @@ namespace getfemint {
     std::copy(t.begin(), t.end(), q);
   }
 
+  /* References on the objects pointed to by the output array views, until
+     the interface takes them. */
+  typedef std::map<const gfi_array *, dal::pstatic_stored_object>
+  array_view_owner_tab;
+  static array_view_owner_tab &array_view_owners() {
+    static thread_local array_view_owner_tab tab;
+    return tab;
+  }
+
+  static gfi_array *create_array_view(const void *p, size_type n,
+                                      gfi_type_id type,
+                                      gfi_complex_flag is_complex,
+                                      const void *owner) {
+    if (!config::has_array_views() || n == 0
+        || n > size_type(std::numeric_limits<int>::max())) return 0;
+    id_type id = workspace().object(owner);
+    if (id == id_type(-1)) return 0;
+    dal::pstatic_stored_object po = workspace().shared_pointer(id);
+    gfi_array *t = checked_gfi_array_create_1(0, type, is_complex);
+    t->dim.dim_val[0] = int(n);
+    void *q = const_cast<void *>(p);
+    if (type == GFI_INT32) {
+      gfi_free(t->storage.gfi_storage_u.data_int32.data_int32_val);
+      t->storage.gfi_storage_u.data_int32.data_int32_val = (int *)q;
+      t->storage.gfi_storage_u.data_int32.data_int32_len = unsigned(n);
+    } else {
+      gfi_free(t->storage.gfi_storage_u.data_double.data_double_val);
+      t->storage.gfi_storage_u.data_double.data_double_val = (double *)q;
+      t->storage.gfi_storage_u.data_double.data_double_len
+        = unsigned(is_complex ? 2*n : n);
+    }
+    array_view_owners()[t] = po;
+    return t;
+  }
+
+  bool
+  mexarg_out::from_array_view(const double *p, size_type n,
+                              const void *owner) {
+    gfi_array *t = create_array_view(p, n, GFI_DOUBLE, GFI_REAL, owner);
+    if (t) arg = t;
+    return t != 0;
+  }
+
+  bool
+  mexarg_out::from_array_view(const complex_type *p, size_type n,
+                              const void *owner) {
+    gfi_array *t = create_array_view(p, n, GFI_DOUBLE, GFI_COMPLEX, owner);
+    if (t) arg = t;
+    return t != 0;
+  }
+
+  bool
+  mexarg_out::from_array_view(const unsigned *p, size_type n,
+                              const void *owner) {
+    if (config::base_index() != 0) return false;
+    gfi_array *t = create_array_view(p, n, GFI_INT32, GFI_REAL, owner);
+    if (t) arg = t;
+    return t != 0;
+  }
+
+  dal::pstatic_stored_object take_array_view_owner(gfi_array *t) {
+    array_view_owner_tab &tab = array_view_owners();
+    auto it = tab.find(t);
+    if (it == tab.end()) return dal::pstatic_stored_object();
+    dal::pstatic_stored_object po = it->second;
+    tab.erase(it);
+    if (gfi_array_get_class(t) == GFI_INT32)
+      t->storage.gfi_storage_u.data_int32.data_int32_val = 0;
+    else
+      t->storage.gfi_storage_u.data_double.data_double_val = 0;
+    return po;
+  }
+
   carray
   mexarg_out::create_carray_h(unsigned dim) {
     if (config::has_1D_arrays())
@@ -947,7 +1020,10 @@ namespace getfemint {
   mexargs_out::~mexargs_out() {
     if (!okay) {
       for (size_type i=0; i < out.size(); ++i) {
-        if (out[i]) { gfi_array_destroy(out[i]); free(out[i]); }
+        if (out[i]) {
+          take_array_view_owner(out[i]);
+          gfi_array_destroy(out[i]); free(out[i]);
+        }
       }
       out.clear();
       workspace().destroy_newly_created_objects();
@@ -583,6 +583,20 @@ namespace getfemint {
       std::copy(v.begin(), v.end(), gfi_int32_get_data(arg));
     }
     template<class VEC_CONT> void from_vector_container(const VEC_CONT& vv);
+
+    /* Output of the n values at p, stored in the object 'owner' of the
+       workspace, without copy. The array points to these values and keeps
+       a reference on the object (see take_array_view_owner). Only done
+       when config::has_array_views(); return false otherwise, or if
+       'owner' is not in the workspace, and the caller outputs a copy. */
+    bool from_array_view(const double *p, size_type n, const void *owner);
+    bool from_array_view(const complex_type *p, size_type n,
+                         const void *owner);
+    bool from_array_view(const unsigned *p, size_type n, const void *owner);
+    template<class T> void from_dcvector_view(const std::vector<T>& v,
+                                              const void *owner) {
+      if (!from_array_view(v.data(), v.size(), owner)) from_dcvector(v);
+    }
   };
 
   template<class STR_CONT> void
@@ -614,6 +628,12 @@ namespace getfemint {
     return create_object_id(1, &id, cid, true);
   }
 
+  /* If t is an output array view (see mexarg_out::from_array_view),
+     detach it from the data of the object, which it does not own, and
+     return the reference on the object it holds. Return a null pointer
+     otherwise. */
+  dal::pstatic_stored_object take_array_view_owner(gfi_array *t);
+
   /* handles the list of input arguments */
   class mexargs_in {
     const gfi_array **in;
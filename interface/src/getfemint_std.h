@@ -90,7 +90,7 @@ namespace getfemint
 
   /* see getfem_interface.C */
   struct config {
-    static config *cfg;
+    static thread_local config *cfg;
     gfi_interface_type interface_type_;
     int base_index_; /* base indexing of arrays (matlab starts at 1, python at 0 */
     bool can_return_integer_; /* matlab < 7 is brain-damaged with respect to int32 type */
@@ -98,12 +98,15 @@ namespace getfemint
     bool prefer_native_sparse_;
     bool has_1D_arrays_; /* true if 1D arrays do exist (for example python),
                            false if they do not existe (i.e. in matlab everything is at least a matrix) */
+    bool has_array_views_; /* true if the output arrays may point to the data
+                              of the objects (python, as read-only arrays) */
     const char *current_function_;
     static int base_index() { return cfg->base_index_; }
     static bool has_native_sparse() { return cfg->has_native_sparse_; }
     static bool prefer_native_sparse() { return cfg->prefer_native_sparse_; }
     static bool can_return_integer() { return cfg->can_return_integer_; }
     static bool has_1D_arrays() { return cfg->has_1D_arrays_; }
+    static bool has_array_views() { return cfg->has_array_views_; }
     static std::string current_function() { return std::string(cfg->current_function_); } 
     static void set_current_config(config *p) { cfg = p; }
     config(gfi_interface_type);
@@ -35,6 +35,8 @@
 #include <getfemint.h>
 #include <getfem/dal_bit_vector.h>
 #include <getfem/dal_static_stored_objects.h>
+#include <mutex>
+#include <thread>
 
 namespace getfemint {
 
@@ -50,6 +52,8 @@ namespace getfemint {
   // The object having a delayed deletion are called hidden objects. It is
   // also possible to directlycreate an hidden object. An hidden object
   // can eventually be retransformed in a normal object.
+  // The tables of the workspace_stack are protected by a lock of their
+  // own, so that it may be used by concurrent threads.
 
   class workspace_stack {
     
@@ -59,8 +63,10 @@ namespace getfemint {
       id_type workspace;
       getfemint_class_id class_id;
       std::vector<dal::pstatic_stored_object> dependent_on;
+      bool newly_created;
 
-      object_info() : raw_pointer(0), workspace(-1), class_id(GETFEMINT_NB_CLASS) {}
+      object_info() : raw_pointer(0), workspace(-1), class_id(GETFEMINT_NB_CLASS),
+                      newly_created(false) {}
     };
 
     typedef std::vector<object_info>  obj_ct;
@@ -72,12 +78,17 @@ namespace getfemint {
     wrk_ct wrk;                      // Stack of used workspaces.
 
     std::map<const void *, id_type> kmap;
-    std::vector<id_type> newly_created_objects;
+    // Objects created by the current call of each thread.
+    std::map<std::thread::id, std::vector<id_type> > newly_created_objects;
+
+    mutable std::recursive_mutex tables_lock;
+    typedef std::lock_guard<std::recursive_mutex> tables_guard;
 
   public:
 
     // Creates a new workspace on top of the stack
-    void push_workspace(const std::string &n = "Unnamed") { wrk.push_back(n); }
+    void push_workspace(const std::string &n = "Unnamed")
+    { tables_guard g(tables_lock); wrk.push_back(n); }
 
     // Deletes the current workspace and returns to the parent workspace
     void pop_workspace(bool keep_all = false);
@@ -113,7 +124,8 @@ namespace getfemint {
     void send_object_to_parent_workspace(id_type obj_id);
     void send_all_objects_to_parent_workspace();
 
-    id_type get_current_workspace() const { return id_type(wrk.size()-1); }
+    id_type get_current_workspace() const
+    { tables_guard g(tables_lock); return id_type(wrk.size()-1); }
     id_type get_base_workspace() const { return id_type(0); }
     /* Delete every object in the workspace, but *does not* delete the
        workspace itself */
@@ -126,7 +138,7 @@ namespace getfemint {
     const void *object(id_type id, const char *expected_type="") const;
 
     /* Throw an error if not found */
-    const dal::pstatic_stored_object &shared_pointer
+    dal::pstatic_stored_object shared_pointer
     (id_type id, const char *expected_class="") const;
 
     /* Return id_type(-1) if not found */
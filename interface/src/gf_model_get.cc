@@ -26,6 +26,7 @@
 #include <getfemint.h>
 #include <getfemint_workspace.h>
 #include <getfemint_misc.h>
+#include <getfemint_gsparse.h>
 #include <getfem/getfem_model_solvers.h>
 #include <getfem/getfem_generic_assembly.h>
 #include <getfem/getfem_nonlinear_elasticity.h>
@@ -36,17 +37,18 @@
 using namespace getfemint;
 
 
+// The matrix is directly converted in CSC format, with a single copy.
 #define RETURN_SPARSE(realmeth, cplxmeth)                            \
   if (!md->is_complex()) {                                           \
-    gf_real_sparse_by_col M(gmm::mat_nrows(md->realmeth),            \
-                            gmm::mat_ncols(md->realmeth));           \
-    gmm::copy(md->realmeth, M);                                      \
-    out.pop().from_sparse(M);                                        \
+    gsparse::t_cscmat_r M;                                           \
+    M.init_with(md->realmeth);                                       \
+    gsparse gsp;                                                     \
+    out.pop().from_sparse(gsp.destructive_assign(M));                \
   } else {                                                           \
-    gf_cplx_sparse_by_col M(gmm::mat_nrows(md->cplxmeth),            \
-                            gmm::mat_ncols(md->cplxmeth));           \
-    gmm::copy(md->cplxmeth, M);                                      \
-    out.pop().from_sparse(M);                                        \
+    gsparse::t_cscmat_c M;                                           \
+    M.init_with(md->cplxmeth);                                       \
+    gsparse gsp;                                                     \
+    out.pop().from_sparse(gsp.destructive_assign(M));                \
   }
 
 #define RETURN_VECTOR(realmeth, cplxmeth)                      \
@@ -56,6 +58,14 @@ using namespace getfemint;
     out.pop().from_dcvector(md->cplxmeth);                     \
   }
 
+// Read-only view on the vector of the model where the interface allows it.
+#define RETURN_VECTOR_VIEW(realmeth, cplxmeth)                 \
+  if (!md->is_complex()) {                                     \
+    out.pop().from_dcvector_view(md->realmeth, md);            \
+  } else {                                                     \
+    out.pop().from_dcvector_view(md->cplxmeth, md);            \
+  }
+
 /*@GFDOC
   Get information from a model object.
 @*/
@@ -138,10 +148,14 @@ void gf_model_get(getfemint::mexargs_in& m_in,
        );
 
     /*@GET ('rhs')
-      Return the right hand side of the tangent problem.@*/
+      Return the right hand side of the tangent problem.
+      In Python, the returned array is a read-only view on the right hand
+      side of the model, which it keeps alive. Its values are updated by
+      the next assemblies. It is no longer valid when the size of the model
+      changes.@*/
     sub_command
       ("rhs", 0, 0, 0, 1,
-       RETURN_VECTOR(real_rhs(), complex_rhs());
+       RETURN_VECTOR_VIEW(real_rhs(), complex_rhs());
        );
 
 
@@ -227,11 +241,15 @@ void gf_model_get(getfemint::mexargs_in& m_in,
 
 
     /*@GET V = ('variable', @str name)
-      Gives the value of a variable or data. @*/
+      Gives the value of a variable or data.
+      In Python, the returned array is a read-only view on the value stored
+      in the model, which it keeps alive. Its values follow the changes of
+      the variable (copy it to keep the current value). It is no longer
+      valid when the size of the variable changes.@*/
     sub_command
       ("variable", 1, 1, 0, 1,
        std::string name = in.pop().to_string();
-       RETURN_VECTOR(real_variable(name), complex_variable(name));
+       RETURN_VECTOR_VIEW(real_variable(name), complex_variable(name));
        );
 
 
@@ -131,22 +131,33 @@ gf_spmat_get_diag(gsparse &gsp,
   }
 }
 
+/* The CSC arrays of a matrix of the workspace are returned as read-only
+   views where the interface allows it (see mexarg_out::from_array_view). */
 template <typename T> static void
 gf_spmat_get_data(gmm::csc_matrix_ref<const T*, const unsigned int *, const unsigned int *> M,
-		  getfemint::mexargs_out& out, int which) {
+		  getfemint::mexargs_out& out, int which, const gsparse &gsp) {
   size_type nz = M.jc[M.nc];
   if (which == 0) {
-    iarray w = out.pop().create_iarray_h(unsigned(M.nc+1));
-    for (unsigned i=0; i < M.nc+1; ++i)
-      { w[i] = M.jc[i] + config::base_index(); }
+    mexarg_out ojc = out.pop();
+    if (!ojc.from_array_view(M.jc, M.nc+1, &gsp)) {
+      iarray w = ojc.create_iarray_h(unsigned(M.nc+1));
+      for (unsigned i=0; i < M.nc+1; ++i)
+        { w[i] = M.jc[i] + config::base_index(); }
+    }
     if (out.remaining()) {
-      w = out.pop().create_iarray_h(unsigned(nz));
-      for (unsigned i=0; i < nz; ++i)
-	{ w[i] = M.ir[i] + config::base_index(); }
+      mexarg_out oir = out.pop();
+      if (!oir.from_array_view(M.ir, nz, &gsp)) {
+        iarray w = oir.create_iarray_h(unsigned(nz));
+        for (unsigned i=0; i < nz; ++i)
+          { w[i] = M.ir[i] + config::base_index(); }
+      }
     }
   } else {
-    garray<T> w = out.pop().create_array_h(unsigned(nz), T());
-    for (unsigned i=0; i < unsigned(nz); ++i) { w[i] = M.pr[i]; }
+    mexarg_out o = out.pop();
+    if (!o.from_array_view(M.pr, nz, &gsp)) {
+      garray<T> w = o.create_array_h(unsigned(nz), T());
+      for (unsigned i=0; i < unsigned(nz); ++i) { w[i] = M.pr[i]; }
+    }
   }
 }
 
@@ -295,28 +306,33 @@ void gf_spmat_get(getfemint::mexargs_in& m_in,
     /*@GET @CELL{JC, IR} = ('csc_ind')
       Return the two usual index arrays of CSC storage.
       
-      If `M` is not stored as a CSC matrix, it is converted into CSC.@*/
+      If `M` is not stored as a CSC matrix, it is converted into CSC.
+      In Python, the arrays are read-only views on the storage of `M`,
+      which they keep alive. They are no longer valid when `M` is
+      modified.@*/
     sub_command
       ("csc_ind", 0, 0, 0, 2,
        gsp.to_csc();
        if (!gsp.is_complex())
-	 gf_spmat_get_data(gsp.csc(scalar_type()),  out, 0);
+	 gf_spmat_get_data(gsp.csc(scalar_type()),  out, 0, gsp);
        else
-	 gf_spmat_get_data(gsp.csc(complex_type()), out, 0);
+	 gf_spmat_get_data(gsp.csc(complex_type()), out, 0, gsp);
        );
 
     
     /*@GET V = ('csc_val')
       Return the array of values of all non-zero entries of `M`.
       
-      If `M` is not stored as a CSC matrix, it is converted into CSC.@*/
+      If `M` is not stored as a CSC matrix, it is converted into CSC.
+      In Python, the array is a read-only view on the storage of `M`,
+      which it keeps alive. It is no longer valid when `M` is modified.@*/
     sub_command
       ("csc_val", 0, 0, 0, 1,
        gsp.to_csc();
        if (!gsp.is_complex())
-	 gf_spmat_get_data(gsp.csc(scalar_type()),  out, 1);
+	 gf_spmat_get_data(gsp.csc(scalar_type()),  out, 1, gsp);
        else
-	 gf_spmat_get_data(gsp.csc(complex_type()), out, 1);
+	 gf_spmat_get_data(gsp.csc(complex_type()), out, 1, gsp);
        );
 
 
@@ -565,6 +565,52 @@ build_gfi_array_list(gcollect *gc, PyObject *tuple, char **pfunction_name,
   return l;
 }
 
+static void
+gfi_data_capsule_destructor(PyObject *capsule) {
+  gfi_free(PyCapsule_GetPointer(capsule, NULL));
+}
+
+static void
+gfi_view_capsule_destructor(PyObject *capsule) {
+  getfem_interface_release_view_owner(PyCapsule_GetPointer(capsule, NULL));
+}
+
+/* Numpy array (in Fortran order) on the data of a gfi_array. The data is
+   not copied: it is handed over to the numpy array, whose base object
+   frees it when the last view on it is released. *pdata is set to NULL
+   so that gfi_array_destroy does not free it.
+   When the gfi_array is a view on the data of a getfem object (see
+   getfem_interface_take_view_owner), the base object holds a reference
+   on the object instead, and the array is read-only. */
+static PyObject *
+gfi_array_data_to_PyArray(gfi_array *t, void **pdata, int typenum) {
+  PyObject *o, *capsule;
+  void *data = *pdata, *owner = getfem_interface_take_view_owner(t);
+  npy_intp *dim = PyDimMem_NEW(t->dim.dim_len);
+  int i;
+  for(i=0; i < t->dim.dim_len; i++)
+    dim[i] = (npy_intp)t->dim.dim_val[i];
+  o = PyArray_New(&PyArray_Type, t->dim.dim_len, dim, typenum, NULL, data,
+                  0, NPY_ARRAY_FARRAY, NULL);
+  PyDimMem_FREE(dim);
+  *pdata = NULL;
+  if (owner)
+    capsule = PyCapsule_New(owner, NULL, gfi_view_capsule_destructor);
+  else
+    capsule = PyCapsule_New(data, NULL, gfi_data_capsule_destructor);
+  if (!capsule) {
+    if (owner) getfem_interface_release_view_owner(owner);
+    else gfi_free(data);
+    Py_XDECREF(o); return NULL;
+  }
+  if (!o) { Py_DECREF(capsule); return NULL; }
+  if (owner) PyArray_CLEARFLAGS((PyArrayObject *)o, NPY_ARRAY_WRITEABLE);
+  /* the reference to capsule is stolen, even on failure */
+  if (PyArray_SetBaseObject((PyArrayObject *)o, capsule) < 0)
+    { Py_DECREF(o); return NULL; }
+  return o;
+}
+
 PyObject*
 gfi_array_to_PyObject(gfi_array *t, int in__init__) {
   PyObject *o = NULL;
@@ -574,52 +620,26 @@ gfi_array_to_PyObject(gfi_array *t, int in__init__) {
   case GFI_INT32: {
     //printf("GFI_INT32\n");
     if (t->dim.dim_len == 0) return PyInt_FromLong(TGFISTORE(int32,val)[0]);
-    else {
-      npy_intp *dim = PyDimMem_NEW(t->dim.dim_len);
-      int i;
-      for(i=0; i < t->dim.dim_len; i++)
-        dim[i] = (npy_intp)t->dim.dim_val[i];
-      if (!(o = PyArray_EMPTY(t->dim.dim_len, dim, NPY_INT, 1))) return NULL;
-      PyDimMem_FREE(dim);
-
-      npy_intp itemsize = PyArray_ITEMSIZE((PyArrayObject *)o);
-      npy_intp size = PyArray_Size(o); /* Number of elements. */
-      memcpy(PyArray_DATA((PyArrayObject *)o), TGFISTORE(int32,val),
-             size*itemsize); // new copy
-    }
+    else
+      o = gfi_array_data_to_PyArray(t, (void **)&TGFISTORE(int32,val),
+                                    NPY_INT); // no copy
   } break;
   case GFI_DOUBLE: {
     // printf("GFI_DOUBLE\n");
     if (!gfi_array_is_complex(t)) {
       if (t->dim.dim_len == 0)
         return PyFloat_FromDouble(TGFISTORE(double,val)[0]);
-      else {
-        npy_intp *dim = PyDimMem_NEW(t->dim.dim_len);
-        int i;
-        for(i=0; i< t->dim.dim_len; i++)
-          dim[i] = (npy_intp)t->dim.dim_val[i];
-        if (!(o = PyArray_EMPTY(t->dim.dim_len, dim, NPY_DOUBLE, 1)))
-          return NULL;
-        PyDimMem_FREE(dim);
-      }
+      else
+        o = gfi_array_data_to_PyArray(t, (void **)&TGFISTORE(double,val),
+                                      NPY_DOUBLE); // no copy
     } else {
       if (t->dim.dim_len == 0)
         return PyComplex_FromDoubles(TGFISTORE(double,val)[0],
                                      TGFISTORE(double,val)[1]);
-      else {
-        npy_intp *dim = PyDimMem_NEW(t->dim.dim_len);
-        int i;
-        for(i=0; i< t->dim.dim_len; i++)
-          dim[i] = (npy_intp)t->dim.dim_val[i];
-        if (!(o = PyArray_EMPTY(t->dim.dim_len, dim, NPY_CDOUBLE, 1)))
-          return NULL;
-        PyDimMem_FREE(dim);
-      }
+      else
+        o = gfi_array_data_to_PyArray(t, (void **)&TGFISTORE(double,val),
+                                      NPY_CDOUBLE); // no copy
     }
-    npy_intp itemsize = PyArray_ITEMSIZE((PyArrayObject *)o);
-    npy_intp size = PyArray_Size(o); /* Number of elements. */
-    memcpy(PyArray_DATA((PyArrayObject *)o), TGFISTORE(double,val),
-           size*itemsize); // new copy
   } break;
   case GFI_CHAR: {
     //printf("GFI_CHAR\n");
@@ -709,6 +729,9 @@ call_getfem_(PyObject *self, PyObject *args, int in__init__)
   in = build_gfi_array_list(&gc, args, &function_name, &in_cnt);
   if (in) {
     //fprintf(stdout,"  -> function = %s\n", function_name);
+    /* The interpreter lock is released during the call, so that the other
+       Python threads can run meanwhile. Their getfem calls wait for the
+       end of this one (see getfem_interface_main). */
     Py_BEGIN_ALLOW_THREADS;
     errmsg = getfem_interface_main(PYTHON_INTERFACE, function_name, in_cnt,
                                    in, &out_cnt, &out, &infomsg,0);
@@ -734,6 +757,10 @@ call_getfem_(PyObject *self, PyObject *args, int in__init__)
         for (i = 0; i < out_cnt; ++i) {
           if (!err && !(d[i] = gfi_array_to_PyObject(out[i], in__init__)))
             err = 1;
+          if (err) {
+            void *owner = getfem_interface_take_view_owner(out[i]);
+            if (owner) getfem_interface_release_view_owner(owner);
+          }
           gfi_array_destroy(out[i]);
         }
 
@@ -324,10 +324,15 @@ namespace bgeot {
     }
   };
 
+  /* As the structures, the convexes of reference are shared by all the
+     threads. */
   pconvex_ref simplex_of_reference(dim_type nc, short_type K) {
     dal::pstatic_stored_object_key
       pk = std::make_shared<convex_of_reference_key>(0, nc, K);
-    dal::pstatic_stored_object o = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
+    if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
+    getfem::omp_guard lock; // the convex is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pk);
     if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
     pconvex_ref p = std::make_shared<K_simplex_of_ref_>(nc, K);
     dal::add_stored_object(pk, p, p->structure(), p->pspt(),
@@ -413,7 +418,10 @@ namespace bgeot {
   pconvex_ref Q2_incomplete_of_reference(dim_type nc) {
      dal::pstatic_stored_object_key
       pk = std::make_shared<Q2_incomplete_of_reference_key_>(nc);
-    dal::pstatic_stored_object o = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
+    if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
+    getfem::omp_guard lock; // the convex is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pk);
     if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
     pconvex_ref p = std::make_shared<Q2_incomplete_of_ref_>(nc);
     dal::add_stored_object(pk, p, p->structure(), p->pspt(),
@@ -495,7 +503,10 @@ namespace bgeot {
   pconvex_ref pyramid_QK_of_reference(dim_type k) {
      dal::pstatic_stored_object_key
       pk = std::make_shared<pyramid_QK_reference_key_>(k);
-    dal::pstatic_stored_object o = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
+    if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
+    getfem::omp_guard lock; // the convex is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pk);
     if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
     pconvex_ref p = std::make_shared<pyramid_QK_of_ref_>(k);
     dal::add_stored_object(pk, p, p->structure(), p->pspt(),
@@ -549,10 +560,13 @@ namespace bgeot {
   pconvex_ref pyramid_Q2_incomplete_of_reference() {
     dal::pstatic_stored_object_key
       pk = std::make_shared<pyramid_Q2_incomplete_reference_key_>(0);
-    dal::pstatic_stored_object o = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
     if (o)
       return std::dynamic_pointer_cast<const convex_of_reference>(o);
     else {
+      getfem::omp_guard lock; // the convex is created by a single thread
+      o = dal::search_stored_object_on_all_threads(pk);
+      if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
       pconvex_ref p = std::make_shared<pyramid_Q2_incomplete_of_ref_>();
       dal::add_stored_object(pk, p, p->structure(), p->pspt(),
                              dal::PERMANENT_STATIC_OBJECT);
@@ -608,10 +622,13 @@ namespace bgeot {
   pconvex_ref prism_incomplete_P2_of_reference() {
     dal::pstatic_stored_object_key
       pk = std::make_shared<prism_incomplete_P2_reference_key_>(0);
-    dal::pstatic_stored_object o = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
     if (o)
       return std::dynamic_pointer_cast<const convex_of_reference>(o);
     else {
+      getfem::omp_guard lock; // the convex is created by a single thread
+      o = dal::search_stored_object_on_all_threads(pk);
+      if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
       pconvex_ref p = std::make_shared<prism_incomplete_P2_of_ref_>();
       dal::add_stored_object(pk, p, p->structure(), p->pspt(),
                              dal::PERMANENT_STATIC_OBJECT);
@@ -687,10 +704,13 @@ namespace bgeot {
   pconvex_ref convex_ref_product(pconvex_ref a, pconvex_ref b) {
     dal::pstatic_stored_object_key
       pk = std::make_shared<product_ref_key_>(a, b);
-    dal::pstatic_stored_object o = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
     if (o)
       return std::dynamic_pointer_cast<const convex_of_reference>(o);
     else {
+      getfem::omp_guard lock; // the convex is created by a single thread
+      o = dal::search_stored_object_on_all_threads(pk);
+      if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
       pconvex_ref p = std::make_shared<product_ref_>(a, b);
       dal::add_stored_object(pk, p, a, b,
                              convex_product_structure(a->structure(),
@@ -767,7 +787,11 @@ namespace bgeot {
     if (nc <= 1) return simplex_of_reference(nc);
      dal::pstatic_stored_object_key
       pk = std::make_shared<convex_of_reference_key>(1, nc);
-    dal::pstatic_stored_object o  = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o
+      = dal::search_stored_object_on_all_threads(pk);
+    if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
+    getfem::omp_guard lock; // the convex is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pk);
     if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
     pconvex_ref p = std::make_shared<equilateral_simplex_of_ref_>(nc);
     dal::add_stored_object(pk, p, p->structure(), p->pspt(),
@@ -801,7 +825,10 @@ namespace bgeot {
                                        short_type nf) {
     dal::pstatic_stored_object_key
       pk = std::make_shared<convex_of_reference_key>(2, nc, short_type(n), nf);
-    dal::pstatic_stored_object o = dal::search_stored_object(pk);
+    dal::pstatic_stored_object o = dal::search_stored_object_on_all_threads(pk);
+    if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
+    getfem::omp_guard lock; // the convex is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pk);
     if (o) return std::dynamic_pointer_cast<const convex_of_reference>(o);
     pconvex_ref p = std::make_shared<generic_dummy_>(nc, n, nf);
     dal::add_stored_object(pk, p, p->structure(), p->pspt(),
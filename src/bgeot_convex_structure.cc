@@ -119,6 +119,9 @@ namespace bgeot {
 #  include <qd/fpu.h>
 #endif
 
+  /* The structures are permanent and compared by their pointers : they are
+     searched in the storage of all the threads, not to be duplicated by a
+     thread of a parallel region. */
   pconvex_structure simplex_structure(dim_type nc) {
 #ifdef GETFEM_HAVE_QDLIB
     /* initialisation for QD on intel CPUs */
@@ -131,7 +134,11 @@ namespace bgeot {
 #endif
     dal::pstatic_stored_object_key
       pcsk = std::make_shared<convex_structure_key>(0, nc, 1);
-    dal::pstatic_stored_object o = dal::search_stored_object(pcsk);
+    dal::pstatic_stored_object o
+      = dal::search_stored_object_on_all_threads(pcsk);
+    if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
+    getfem::omp_guard lock; // the structure is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pcsk);
     if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
 
     auto p = std::make_shared<simplex_structure_>();
@@ -214,7 +221,11 @@ namespace bgeot {
     if (K == 1) return simplex_structure(nc);
     dal::pstatic_stored_object_key
       pcsk = std::make_shared<convex_structure_key>(0, nc, K);
-    dal::pstatic_stored_object o = dal::search_stored_object(pcsk);
+    dal::pstatic_stored_object o
+      = dal::search_stored_object_on_all_threads(pcsk);
+    if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
+    getfem::omp_guard lock; // the structure is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pcsk);
     if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
 
     pconvex_structure p = std::make_shared<K_simplex_structure_>(nc, K);
@@ -237,7 +248,11 @@ namespace bgeot {
 
     dal::pstatic_stored_object_key
       pcsk = std::make_shared<convex_structure_key>(1, dim_type(nbt));
-    dal::pstatic_stored_object o = dal::search_stored_object(pcsk);
+    dal::pstatic_stored_object o
+      = dal::search_stored_object_on_all_threads(pcsk);
+    if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
+    getfem::omp_guard lock; // the structure is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pcsk);
     if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
 
     auto p = std::make_shared<polygon_structure_>();
@@ -343,7 +358,11 @@ namespace bgeot {
                                              pconvex_structure b) {
 
     dal::pstatic_stored_object_key pcsk = std::make_shared<cv_pr_key_>(a, b);
-    dal::pstatic_stored_object o = dal::search_stored_object(pcsk);
+    dal::pstatic_stored_object o
+      = dal::search_stored_object_on_all_threads(pcsk);
+    if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
+    getfem::omp_guard lock; // the structure is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pcsk);
     if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
     pconvex_structure p = std::make_shared<cv_pr_structure_>(a, b);
     dal::add_stored_object(pcsk, p, a, b, dal::PERMANENT_STATIC_OBJECT);
@@ -375,10 +394,15 @@ namespace bgeot {
     dal::pstatic_stored_object_key
       pcsk = std::make_shared<parallelepiped_key_>(nc, k);
 
-    dal::pstatic_stored_object o = dal::search_stored_object(pcsk);
+    dal::pstatic_stored_object o
+
+      = dal::search_stored_object_on_all_threads(pcsk);
     if (o)
       return ((std::dynamic_pointer_cast<const parallelepiped_>(o))->p);
     else {
+      getfem::omp_guard lock; // the structure is created by a single thread
+      o = dal::search_stored_object_on_all_threads(pcsk);
+      if (o) return ((std::dynamic_pointer_cast<const parallelepiped_>(o))->p);
       auto p = std::make_shared<parallelepiped_>();
       p->p = convex_product_structure(parallelepiped_structure(dim_type(nc-1),k),
                                       simplex_structure(1,k));
@@ -403,7 +427,11 @@ namespace bgeot {
     GMM_ASSERT1(nc == 2 || nc == 3, "Bad parameter, expected value 2 or 3");
     dal::pstatic_stored_object_key
       pcsk = std::make_shared<Q2_incomplete_structure_key_>(nc);
-    dal::pstatic_stored_object o = dal::search_stored_object(pcsk);
+    dal::pstatic_stored_object o
+      = dal::search_stored_object_on_all_threads(pcsk);
+    if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
+    getfem::omp_guard lock; // the structure is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pcsk);
     if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
 
     auto p = std::make_shared<Q2_incomplete_structure_>();
@@ -484,9 +512,13 @@ namespace bgeot {
                 "only for degree one or two.");
     dal::pstatic_stored_object_key
       pcsk = std::make_shared<pyramid_QK_structure_key_>(k);
-    dal::pstatic_stored_object o = dal::search_stored_object(pcsk);
+    dal::pstatic_stored_object o
+      = dal::search_stored_object_on_all_threads(pcsk);
     if (o)
       return std::dynamic_pointer_cast<const convex_structure>(o);
+    getfem::omp_guard lock; // the structure is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pcsk);
+    if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
 
     auto p = std::make_shared<pyramid_QK_structure_>();
     pconvex_structure pcvs(p);
@@ -579,9 +611,13 @@ namespace bgeot {
   pconvex_structure pyramid_Q2_incomplete_structure() {
     dal::pstatic_stored_object_key
       pcsk = std::make_shared<pyramid_Q2_incomplete_structure_key_>(0);
-    dal::pstatic_stored_object o = dal::search_stored_object(pcsk);
+    dal::pstatic_stored_object o
+      = dal::search_stored_object_on_all_threads(pcsk);
     if (o)
       return std::dynamic_pointer_cast<const convex_structure>(o);
+    getfem::omp_guard lock; // the structure is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pcsk);
+    if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
 
     auto p = std::make_shared<pyramid_Q2_incomplete_structure_>();
     pconvex_structure pcvs(p);
@@ -639,9 +675,13 @@ namespace bgeot {
   pconvex_structure prism_incomplete_P2_structure() {
     dal::pstatic_stored_object_key
       pcsk = std::make_shared<prism_incomplete_P2_structure_key_>(0);
-    dal::pstatic_stored_object o = dal::search_stored_object(pcsk);
+    dal::pstatic_stored_object o
+      = dal::search_stored_object_on_all_threads(pcsk);
     if (o)
       return std::dynamic_pointer_cast<const convex_structure>(o);
+    getfem::omp_guard lock; // the structure is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pcsk);
+    if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
 
     auto p = std::make_shared<prism_incomplete_P2_structure_>();
     pconvex_structure pcvs(p);
@@ -700,7 +740,11 @@ namespace bgeot {
                                             short_type nf) {
     dal::pstatic_stored_object_key
       pcsk = std::make_shared<convex_structure_key>(2, nc, short_type(n), nf);
-    dal::pstatic_stored_object o = dal::search_stored_object(pcsk);
+    dal::pstatic_stored_object o
+      = dal::search_stored_object_on_all_threads(pcsk);
+    if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
+    getfem::omp_guard lock; // the structure is created by a single thread
+    o = dal::search_stored_object_on_all_threads(pcsk);
     if (o) return std::dynamic_pointer_cast<const convex_structure>(o);
     auto p = std::make_shared<dummy_structure_>();
     pconvex_structure pcvs(p);
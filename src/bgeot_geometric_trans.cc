@@ -500,11 +500,21 @@ namespace bgeot {
 
     std::vector<FUNC> trans;
     mutable std::vector<std::vector<FUNC>> grad_, hess_;
+    // packed forms, for polynomial transformations.
+    mutable packed_polynomials packed_val_, packed_grad_, packed_hess_;
+    mutable bool val_computed_ = false;
     mutable bool grad_computed_ = false;
     mutable bool hess_computed_ = false;
 
+    void compute_val_() const {
+      getfem::omp_guard guard;
+      if (val_computed_) return;
+      pack_functions(trans, packed_val_);
+      val_computed_ = true;
+    }
+
     void compute_grad_() const {
-      auto guard = getfem::omp_guard{};
+      getfem::omp_guard guard;
       if (grad_computed_) return;
       size_type R = trans.size();
       dim_type n = dim();
@@ -515,11 +525,15 @@ namespace bgeot {
           grad_[i][j] = trans[i]; grad_[i][j].derivative(j);
         }
       }
+      std::vector<FUNC> g; g.reserve(R*n);
+      for (dim_type j = 0; j < n; ++j)
+        for (size_type i = 0; i < R; ++i) g.push_back(grad_[i][j]);
+      pack_functions(g, packed_grad_);
       grad_computed_ = true;
     }
 
     void compute_hess_() const {
-      auto guard = getfem::omp_guard{};
+      getfem::omp_guard guard;
       if (hess_computed_) return;
       size_type R = trans.size();
       dim_type n = dim();
@@ -533,11 +547,18 @@ namespace bgeot {
           }
         }
       }
+      std::vector<FUNC> h; h.reserve(R*n*n);
+      for (dim_type k = 0; k < n*n; ++k)
+        for (size_type i = 0; i < R; ++i) h.push_back(hess_[i][k]);
+      pack_functions(h, packed_hess_);
       hess_computed_ = true;
     }
 
     virtual void poly_vector_val(const base_node &pt, base_vector &val) const {
+      if (!val_computed_) compute_val_();
       val.resize(nb_points());
+      if (packed_val_.nb_polynomials())
+        { packed_val_.eval(pt.begin(), val.begin()); return; }
       for (size_type k = 0; k < nb_points(); ++k)
         val[k] = to_scalar(trans[k].eval(pt.begin()));
     }
@@ -555,6 +576,8 @@ namespace bgeot {
       if (!grad_computed_) compute_grad_();
       FUNC PP;
       pc.base_resize(nb_points(),dim());
+      if (packed_grad_.nb_polynomials())
+        { packed_grad_.eval(pt.begin(), pc.begin()); return; }
       for (size_type i = 0; i < nb_points(); ++i)
         for (dim_type n = 0; n < dim(); ++n)
           pc(i, n) = to_scalar(grad_[i][n].eval(pt.begin()));
@@ -576,6 +599,8 @@ namespace bgeot {
       if (!hess_computed_) compute_hess_();
       FUNC PP, QP;
       pc.base_resize(nb_points(),dim()*dim());
+      if (packed_hess_.nb_polynomials())
+        { packed_hess_.eval(pt.begin(), pc.begin()); return; }
       for (size_type i = 0; i < nb_points(); ++i)
         for (dim_type n = 0; n < dim(); ++n) {
           for (dim_type m = 0; m <= n; ++m)
@@ -1173,9 +1198,9 @@ namespace bgeot {
   /* Fonctions pour la ref. directe.                                     */
 
   pgeometric_trans simplex_geotrans(size_type n, short_type k) {
-    static pgeometric_trans pgt = 0;
-    static size_type d = size_type(-2);
-    static short_type r = short_type(-2);
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(pgeometric_trans, pgt, 0);
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(size_type, d, size_type(-2));
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(short_type, r, short_type(-2));
     if (d != n || r != k) {
       std::stringstream name;
       name << "GT_PK(" << n << "," << k << ")";
@@ -1186,9 +1211,9 @@ namespace bgeot {
   }
 
   pgeometric_trans parallelepiped_geotrans(size_type n, short_type k) {
-    static pgeometric_trans pgt = 0;
-    static size_type d = size_type(-2);
-    static short_type r = short_type(-2);
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(pgeometric_trans, pgt, 0);
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(size_type, d, size_type(-2));
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(short_type, r, short_type(-2));
     if (d != n || r != k) {
       std::stringstream name;
       name << "GT_QK(" << n << "," << k << ")";
@@ -249,5 +249,19 @@ namespace bgeot {
     return read_base_poly(n, f);
   }
 
+  void packed_polynomials::init_monomials(short_type n_, size_type nb_mono_) {
+    n = n_; nb_mono = nb_mono_;
+    prev.assign(nb_mono, 0); var.assign(nb_mono, 0);
+    power_index mi(n);
+    for (size_type i = 1; i < nb_mono; ++i) {
+      ++mi;
+      const power_index &cmi = mi;
+      short_type k = 0;
+      while (cmi[k] == 0) ++k;
+      power_index mj(mi); mj[k]--;
+      prev[i] = mj.global_index(); var[i] = k;
+    }
+  }
+
 
 }  /* end of namespace bgeot.                                             */
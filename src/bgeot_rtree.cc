@@ -98,7 +98,7 @@ namespace bgeot {
 
   /* match boxes containing P */
   struct has_point_p {
-    const base_node P;
+    const base_node &P;
     has_point_p(const base_node& P_) : P(P_) {}
     bool operator()(const base_node& min2, const base_node& max2) {
       for (size_type i=0; i < P.size(); ++i)
@@ -170,14 +170,22 @@ namespace bgeot {
   };
 
 
-  template <typename Predicate>
-  static void find_matching_boxes_(rtree_elt_base *n, rtree::pbox_set& boxlst,
-                                   Predicate p) {
+  inline static void add_matching_box_(rtree::pbox_set& boxlst,
+                                       const box_index *pbi)
+  { boxlst.insert(pbi); }
+
+  inline static void add_matching_box_(rtree::pbox_cont& boxlst,
+                                       const box_index *pbi)
+  { boxlst.push_back(pbi); }
+
+  template <typename Predicate, typename CONT>
+  static void find_matching_boxes_(rtree_elt_base *n, CONT& boxlst,
+                                   Predicate &p) {
     if (n->isleaf()) {
       const rtree_leaf *rl = static_cast<rtree_leaf*>(n);
       for (rtree::pbox_cont::const_iterator it = rl->lst.begin();
            it != rl->lst.end(); ++it) {
-        if (p((*it)->min, (*it)->max)) { boxlst.insert(*it); }
+        if (p((*it)->min, (*it)->max)) add_matching_box_(boxlst, *it);
       }
     } else {
       const rtree_node *rn = static_cast<rtree_node*>(n);
@@ -191,32 +199,60 @@ namespace bgeot {
   void rtree::find_intersecting_boxes(const base_node& bmin,
                                       const base_node& bmax,
                                       pbox_set& boxlst) {
-    boxlst.clear(); if (!root) build_tree();
-    if (root) find_matching_boxes_(root.get(),boxlst,intersection_p(bmin,bmax));
+    boxlst.clear(); build_tree();
+    intersection_p p(bmin, bmax);
+    if (root) find_matching_boxes_(root.get(), boxlst, p);
+  }
+
+  void rtree::find_intersecting_boxes(const base_node& bmin,
+                                      const base_node& bmax,
+                                      pbox_cont& boxlst) {
+    boxlst.resize(0); build_tree();
+    intersection_p p(bmin, bmax);
+    if (root) {
+      find_matching_boxes_(root.get(), boxlst, p);
+      std::sort(boxlst.begin(), boxlst.end());
+      boxlst.erase(std::unique(boxlst.begin(), boxlst.end()), boxlst.end());
+    }
   }
 
   void rtree::find_containing_boxes(const base_node& bmin,
                                     const base_node& bmax, pbox_set& boxlst) {
-    boxlst.clear(); if (!root) build_tree();
-    if (root) find_matching_boxes_(root.get(), boxlst, contains_p(bmin,bmax));
+    boxlst.clear(); build_tree();
+    contains_p p(bmin, bmax);
+    if (root) find_matching_boxes_(root.get(), boxlst, p);
   }
 
   void rtree::find_contained_boxes(const base_node& bmin,
                                    const base_node& bmax, pbox_set& boxlst) {
-    boxlst.clear(); if (!root) build_tree();
-    if (root) find_matching_boxes_(root.get(), boxlst, contained_p(bmin,bmax));
+    boxlst.clear(); build_tree();
+    contained_p p(bmin, bmax);
+    if (root) find_matching_boxes_(root.get(), boxlst, p);
   }
 
   void rtree::find_boxes_at_point(const base_node& P, pbox_set& boxlst) {
-    boxlst.clear(); if (!root) build_tree();
-    if (root) find_matching_boxes_(root.get(), boxlst, has_point_p(P));
+    boxlst.clear(); build_tree();
+    has_point_p p(P);
+    if (root) find_matching_boxes_(root.get(), boxlst, p);
+  }
+
+  void rtree::find_boxes_at_point(const base_node& P, pbox_cont& boxlst) {
+    boxlst.resize(0); build_tree();
+    has_point_p p(P);
+    if (root) {
+      find_matching_boxes_(root.get(), boxlst, p);
+      // A box may be stored in several leaves
+      std::sort(boxlst.begin(), boxlst.end());
+      boxlst.erase(std::unique(boxlst.begin(), boxlst.end()), boxlst.end());
+    }
   }
 
   void rtree::find_line_intersecting_boxes(const base_node& org,
                                            const base_small_vector& dirv,
                                            pbox_set& boxlst) {
-    boxlst.clear(); if (!root) build_tree();
-    if (root) find_matching_boxes_(root.get(),boxlst,intersect_line(org, dirv));
+    boxlst.clear(); build_tree();
+    intersect_line p(org, dirv);
+    if (root) find_matching_boxes_(root.get(), boxlst, p);
   }
 
   void rtree::find_line_intersecting_boxes(const base_node& org,
@@ -224,10 +260,9 @@ namespace bgeot {
                                            const base_node& bmin,
                                            const base_node& bmax,
                                            pbox_set& boxlst) {
-    boxlst.clear(); if (!root) build_tree();
-    if (root)
-      find_matching_boxes_(root.get(), boxlst,
-                           intersect_line_and_box(org, dirv, bmin, bmax));
+    boxlst.clear(); build_tree();
+    intersect_line_and_box p(org, dirv, bmin, bmax);
+    if (root) find_matching_boxes_(root.get(), boxlst, p);
   }
 
   /*
@@ -313,9 +348,10 @@ namespace bgeot {
   }
 
   void rtree::build_tree() {
-    if (boxes.size() == 0) return;
+    if (tree_built.load(std::memory_order_acquire) || boxes.size() == 0)
+      return;
     getfem::local_guard lock = locks_.get_lock();
-    assert(root == 0);
+    if (root) return; // Already built by another thread
     pbox_cont b(boxes.size());
     pbox_cont::iterator b_it = b.begin();
     base_node bmin(boxes.front().min), bmax(boxes.front().max);
@@ -324,6 +360,7 @@ namespace bgeot {
       *b_it++ = &(*it);
     }
     root = build_tree_(b, bmin, bmax, 0);
+    tree_built.store(true, std::memory_order_release);
   }
 
   static void dump_tree_(rtree_elt_base *p, int level, size_type& count) {
@@ -347,7 +384,7 @@ namespace bgeot {
 
   void rtree::dump() {
     cout << "tree dump follows\n";
-    if (!root) build_tree();
+    build_tree();
     size_type count = 0;
     dump_tree_(root.get(), 0, count);
     cout << " --- end of tree dump, nb of rectangles: " << boxes.size()
@@ -27,6 +27,7 @@
 #include <set>
 #include <algorithm>
 #include <deque>
+#include <unordered_map>
 
 
 namespace dal {
@@ -138,12 +139,25 @@ static bool dal_static_stored_tab_valid__ = true;
 
 
 
+  /* Table of the stored objects of a thread. The tables of all the threads
+     are created together at the first use, so that a thread looking into
+     the table of another thread does not race with its lazy creation. */
+  static stored_object_tab &stored_object_tab_of_thread(size_t thread) {
+    static bool tabs_created = []() {
+      for (size_t i = 0; i < getfem::num_threads(); ++i)
+        dal::singleton<stored_object_tab>::instance(i);
+      return true;
+    }();
+    (void)tabs_created;
+    return dal::singleton<stored_object_tab>::instance(thread);
+  }
+
   // Gives a pointer to a key of an object from its pointer, while looking in the storage of
   // a specific thread
   pstatic_stored_object_key key_of_stored_object(pstatic_stored_object o, size_t thread) 
   {
     stored_object_tab::stored_key_tab& stored_keys 
-      = dal::singleton<stored_object_tab>::instance(thread).stored_keys_;
+      = stored_object_tab_of_thread(thread).stored_keys_;
     GMM_ASSERT1(dal_static_stored_tab_valid__, "Too late to do that");
     stored_object_tab::stored_key_tab::iterator it = stored_keys.find(o);
     if (it != stored_keys.end()) return it->second;
@@ -155,7 +169,7 @@ static bool dal_static_stored_tab_valid__ = true;
   {
     for(size_t thread = 0; thread<getfem::num_threads();thread++)
     {
-      if (thread == this_thread()) continue;
+      if (thread == getfem::this_thread()) continue;
       pstatic_stored_object_key key = key_of_stored_object(o,thread);
       if (key) return key;
     }
@@ -164,12 +178,75 @@ static bool dal_static_stored_tab_valid__ = true;
 
   pstatic_stored_object_key key_of_stored_object(pstatic_stored_object o) 
   {
-    pstatic_stored_object_key key = key_of_stored_object(o,this_thread());
+    pstatic_stored_object_key key = key_of_stored_object(o,getfem::this_thread());
     if (key) return key;
-    else return (num_threads() > 1) ? key_of_stored_object_other_threads(o) : 0;
+    else return (getfem::num_threads() > 1) ? key_of_stored_object_other_threads(o) : 0;
     return 0;
   }
 
+  /* Generation of the stored objects, incremented after any deletion
+     of stored objects. */
+  static atomic_int stored_objects_generation__(0);
+
+  /* Cache of the objects found by search_stored_object in the current
+     thread, hashed on the value of their key. It is read without lock and
+     emptied each time the generation of the stored objects changes, so
+     that a deleted object is never given again. The objects are not kept
+     alive by the cache. The key stored with the object is kept, since
+     some keys given for the search point to temporary data. */
+  struct stored_object_search_cache {
+    struct key_hash {
+      size_t operator()(const pstatic_stored_object_key &k) const
+      { return typeid(*k).hash_code() ^ k->hash(); }
+    };
+    struct key_equal {
+      bool operator()(const pstatic_stored_object_key &k1,
+                      const pstatic_stored_object_key &k2) const
+      { return *k1 == *k2; }
+    };
+    typedef std::unordered_map<pstatic_stored_object_key,
+                               std::weak_ptr<const static_stored_object>,
+                               key_hash, key_equal> object_map;
+    object_map objects;
+    size_t hits, misses;
+    int generation;
+
+    pstatic_stored_object search(pstatic_stored_object_key k, int g) {
+      if (g != generation) { objects.clear(); generation = g; }
+      else {
+        object_map::const_iterator it = objects.find(k);
+        if (it != objects.end()) {
+          pstatic_stored_object p = it->second.lock();
+          if (p) { ++hits; return p; }
+        }
+      }
+      ++misses;
+      return nullptr;
+    }
+
+    /* g is the generation read before the search of o in the tables,
+       k is the key of o in the table. */
+    void add(pstatic_stored_object o, pstatic_stored_object_key k, int g) {
+      if (g != generation || g != stored_objects_generation__) return;
+      objects[k] = o;
+    }
+
+    stored_object_search_cache() : hits(0), misses(0), generation(0) {}
+  };
+
+  /* The cache of the current thread. The threads which are not OpenMP
+     threads, such as the threads of the Python interface, have their own
+     cache, while they share the OpenMP thread number 0. */
+  static stored_object_search_cache &search_cache() {
+    DEFINE_STATIC_THREAD_LOCAL(stored_object_search_cache, cache);
+    return cache;
+  }
+
+  void stored_object_cache_statistics(size_t &hits, size_t &misses) {
+    stored_object_search_cache &cache = search_cache();
+    hits = cache.hits; misses = cache.misses;
+  }
+
   bool exists_stored_object(pstatic_stored_object o) 
   {
     stored_object_tab::stored_key_tab& stored_keys 
@@ -185,8 +262,13 @@ static bool dal_static_stored_tab_valid__ = true;
     stored_object_tab& stored_objects
         = dal::singleton<stored_object_tab>::instance();
     if (dal_static_stored_tab_valid__) {
-      pstatic_stored_object p = stored_objects.search_stored_object(k);
+      stored_object_search_cache &cache = search_cache();
+      int g = stored_objects_generation__;
+      pstatic_stored_object p = cache.search(k, g);
       if (p) return p;
+      pstatic_stored_object_key ks;
+      p = stored_objects.search_stored_object(k, &ks);
+      if (p) { cache.add(p, ks, g); return p; }
     }
     return 0;
   }
@@ -195,13 +277,18 @@ static bool dal_static_stored_tab_valid__ = true;
   {
     auto& stored_objects = singleton<stored_object_tab>::instance();
     if (!dal_static_stored_tab_valid__) return nullptr;
-    auto p = stored_objects.search_stored_object(k);
+    stored_object_search_cache &cache = search_cache();
+    int g = stored_objects_generation__;
+    auto p = cache.search(k, g);
     if (p) return p;
-    if (num_threads()  == 1) return nullptr;
+    pstatic_stored_object_key ks;
+    p = stored_objects.search_stored_object(k, &ks);
+    if (p) { cache.add(p, ks, g); return p; }
+    if (getfem::num_threads()  == 1) return nullptr;
     for(size_t thread = 0; thread < getfem::num_threads(); thread++)
     {
-      if (thread == this_thread()) continue;
-      auto& other_objects = singleton<stored_object_tab>::instance(thread);
+      if (thread == getfem::this_thread()) continue;
+      auto& other_objects = stored_object_tab_of_thread(thread);
       p = other_objects.search_stored_object(k);
       if (p) return p;
     }
@@ -211,10 +298,10 @@ static bool dal_static_stored_tab_valid__ = true;
   std::pair<stored_object_tab::iterator, stored_object_tab::iterator> iterators_of_object(
     pstatic_stored_object o)
   {
-    for(size_t thread=0; thread < num_threads(); ++thread)
+    for(size_t thread=0; thread < getfem::num_threads(); ++thread)
     {
       stored_object_tab& stored_objects
-        = dal::singleton<stored_object_tab>::instance(thread);
+        = stored_object_tab_of_thread(thread);
       if (!dal_static_stored_tab_valid__) continue;
       stored_object_tab::iterator it = stored_objects.iterator_of_object_(o);
       if (it != stored_objects.end()) return {it, stored_objects.end()};
@@ -226,10 +313,10 @@ static bool dal_static_stored_tab_valid__ = true;
 
   void test_stored_objects(void) 
   {
-    for(size_t thread = 0; thread < num_threads(); ++thread)
+    for(size_t thread = 0; thread < getfem::num_threads(); ++thread)
     {
       stored_object_tab& stored_objects 
-        = dal::singleton<stored_object_tab>::instance(thread);
+        = stored_object_tab_of_thread(thread);
       if (!dal_static_stored_tab_valid__) continue;
       stored_object_tab::stored_key_tab& stored_keys = stored_objects.stored_keys_;
 
@@ -253,10 +340,10 @@ static bool dal_static_stored_tab_valid__ = true;
   void add_dependency(pstatic_stored_object o1,
                       pstatic_stored_object o2) {
     bool dep_added = false;
-    for(size_t thread=0; thread < num_threads(); ++thread)
+    for(size_t thread=0; thread < getfem::num_threads(); ++thread)
     {
       stored_object_tab& stored_objects
-          = dal::singleton<stored_object_tab>::instance(thread);
+          = stored_object_tab_of_thread(thread);
       if (!dal_static_stored_tab_valid__) return;
       if ((dep_added = stored_objects.add_dependency_(o1,o2))) break;
     }
@@ -265,10 +352,10 @@ static bool dal_static_stored_tab_valid__ = true;
 		<< " of type "  << typeid(*o2).name() << ". ");
 
     bool dependent_added = false;
-    for(size_t thread=0; thread < num_threads(); ++thread)
+    for(size_t thread=0; thread < getfem::num_threads(); ++thread)
     {
       stored_object_tab& stored_objects
-          = dal::singleton<stored_object_tab>::instance(thread);
+          = stored_object_tab_of_thread(thread);
       if ((dependent_added = stored_objects.add_dependent_(o1,o2))) break;
     }
     GMM_ASSERT1(dependent_added, "Failed to add dependent between " << o1
@@ -284,10 +371,10 @@ static bool dal_static_stored_tab_valid__ = true;
     pstatic_stored_object o2) 
   {
     bool dep_deleted = false;
-    for(size_t thread=0; thread < num_threads(); ++thread)
+    for(size_t thread=0; thread < getfem::num_threads(); ++thread)
     {
       stored_object_tab& stored_objects
-          = dal::singleton<stored_object_tab>::instance(thread);
+          = stored_object_tab_of_thread(thread);
       if (!dal_static_stored_tab_valid__) return false;
       if ((dep_deleted = stored_objects.del_dependency_(o1,o2))) break;
     }
@@ -296,10 +383,10 @@ static bool dal_static_stored_tab_valid__ = true;
 
     bool dependent_deleted = false;
     bool dependent_empty = false;
-    for(size_t thread=0; thread < num_threads(); ++thread)
+    for(size_t thread=0; thread < getfem::num_threads(); ++thread)
     {
       stored_object_tab& stored_objects
-          = dal::singleton<stored_object_tab>::instance(thread);
+          = stored_object_tab_of_thread(thread);
       dependent_deleted = stored_objects.del_dependent_(o1,o2);
       if (dependent_deleted)
       {
@@ -333,16 +420,16 @@ static bool dal_static_stored_tab_valid__ = true;
     
     if (!to_delete.empty()) //need to delete from other threads
       {
-        for(size_t thread=0; thread < num_threads(); ++thread)
+        for(size_t thread=0; thread < getfem::num_threads(); ++thread)
 	  { 
-	    if (thread == this_thread()) continue;
+	    if (thread == getfem::this_thread()) continue;
 	    stored_object_tab& stored_objects
-              = dal::singleton<stored_object_tab>::instance(thread);
+              = stored_object_tab_of_thread(thread);
 	    stored_objects.basic_delete_(to_delete);
 	    if (to_delete.empty()) break;
 	  }
       }
-    if (me_is_multithreaded_now())
+    if (getfem::me_is_multithreaded_now())
       {
         if (!to_delete.empty()) GMM_WARNING1("Not all objects were deleted");
       }
@@ -372,7 +459,7 @@ static bool dal_static_stored_tab_valid__ = true;
           if (ignore_unstored)
             to_delete.erase(it);
           else
-            if (me_is_multithreaded_now()) {
+            if (getfem::me_is_multithreaded_now()) {
               GMM_WARNING1("This object is (already?) not stored : "<< it->get()
               << " typename: " << typeid(*it->get()).name() 
               << "(which could happen in multithreaded code and is OK)");
@@ -434,7 +521,7 @@ static bool dal_static_stored_tab_valid__ = true;
     for(size_t thread=0; thread<getfem::num_threads();thread++)
     {
       stored_object_tab& stored_objects
-        = dal::singleton<stored_object_tab>::instance(thread);
+        = stored_object_tab_of_thread(thread);
       if (!dal_static_stored_tab_valid__) continue;
       if (perm == PERMANENT_STATIC_OBJECT) perm = STRONG_STATIC_OBJECT;
       stored_object_tab::iterator it;
@@ -450,7 +537,7 @@ static bool dal_static_stored_tab_valid__ = true;
     for(size_t thread=0; thread<getfem::num_threads();thread++)
     {
       stored_object_tab::stored_key_tab& stored_keys 
-        = dal::singleton<stored_object_tab>::instance(thread).stored_keys_;
+        = stored_object_tab_of_thread(thread).stored_keys_;
       if (!dal_static_stored_tab_valid__) continue;
       if (stored_keys.begin() == stored_keys.end())
         ost << "No static stored objects" << endl;
@@ -467,7 +554,7 @@ static bool dal_static_stored_tab_valid__ = true;
     for(size_t thread=0;thread<getfem::num_threads(); ++thread)
     {
       stored_object_tab::stored_key_tab& stored_keys 
-      = dal::singleton<stored_object_tab>::instance(thread).stored_keys_;
+      = stored_object_tab_of_thread(thread).stored_keys_;
       if (!dal_static_stored_tab_valid__) continue;
       num_objects+=stored_keys.size();
     }
@@ -489,11 +576,14 @@ static bool dal_static_stored_tab_valid__ = true;
   { dal_static_stored_tab_valid__ = false; }
 
   pstatic_stored_object
-  stored_object_tab::search_stored_object(pstatic_stored_object_key k) const
+  stored_object_tab::search_stored_object(pstatic_stored_object_key k,
+                                          pstatic_stored_object_key *ks) const
   {
    getfem::local_guard guard = locks_.get_lock();
    stored_object_tab::const_iterator it=find(enr_static_stored_object_key(k));
-   return (it != end()) ? it->second.p : 0;
+   if (it == end()) return 0;
+   if (ks) *ks = it->first.p;
+   return it->second.p;
   }
 
   bool stored_object_tab::add_dependency_(pstatic_stored_object o1,
@@ -518,7 +608,7 @@ static bool dal_static_stored_tab_valid__ = true;
     stored_keys_[o] = k;
     insert(std::make_pair(enr_static_stored_object_key(k),
                           enr_static_stored_object(o, perm)));
-    size_t t = this_thread();
+    size_t t = getfem::this_thread();
     GMM_ASSERT2(stored_keys_.size() == size() && t != size_t(-1), 
       "stored_keys are not consistent with stored_object tab");
   }
@@ -590,6 +680,7 @@ static bool dal_static_stored_tab_valid__ = true;
   (std::list<pstatic_stored_object> &to_delete)
   {
     getfem::local_guard guard = locks_.get_lock();
+    size_t nb_to_delete = to_delete.size();
     std::list<pstatic_stored_object>::iterator it;
     for (it = to_delete.begin(); it != to_delete.end(); ) 
     {
@@ -609,6 +700,8 @@ static bool dal_static_stored_tab_valid__ = true;
         ++it;
       }
     }
+    // Invalidates the search caches, after the objects are removed.
+    if (to_delete.size() != nb_to_delete) ++stored_objects_generation__;
   }
 
 
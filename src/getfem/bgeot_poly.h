@@ -627,6 +627,80 @@ namespace bgeot
   /** read a base_poly on the string s. */
   base_poly read_base_poly(short_type n, const std::string &s);
 
+  /**********************************************************************/
+  /* Packed evaluation of a set of polynomials.                         */
+  /**********************************************************************/
+
+  /** A set of polynomials of the same dimension stored as a dense matrix
+      of coefficients, in order to evaluate all of them at once: at a given
+      point, the monomials are computed only once and the values of the
+      polynomials are obtained with a single matrix-vector product.
+  */
+  class packed_polynomials {
+    short_type n;
+    size_type nb_poly, nb_mono;
+    // coeffs[j + i*nb_poly] is the coefficient of monomial i in polynomial j
+    std::vector<scalar_type> coeffs;
+    // monomial i is the product of monomial prev[i] and of variable var[i]
+    std::vector<size_type> prev;
+    std::vector<short_type> var;
+
+    void init_monomials(short_type n_, size_type nb_mono_);
+
+  public :
+    size_type nb_polynomials() const { return nb_poly; }
+
+    template<typename T> void init(const std::vector<polynomial<T> > &P) {
+      short_type d = P.size() ? P[0].dim() : 0;
+      size_type nb = 1;
+      for (size_type j = 0; j < P.size(); ++j) {
+        GMM_ASSERT1(P[j].dim() == d, "dimensions mismatch");
+        nb = std::max(nb, P[j].size());
+      }
+      init_monomials(d, nb);
+      nb_poly = P.size();
+      coeffs.assign(nb_poly * nb_mono, scalar_type(0));
+      for (size_type j = 0; j < nb_poly; ++j)
+        for (size_type i = 0; i < P[j].size(); ++i)
+          coeffs[j + i*nb_poly] = to_scalar(P[j][i]);
+    }
+
+    /** Evaluates the polynomials at point x and writes the values at
+        it[0], ..., it[nb_polynomials()-1]. */
+    template<typename ITER, typename OITER>
+    void eval(const ITER &x, const OITER &it) const {
+      if (!nb_poly) return;
+      scalar_type buf[128], *m = buf;
+      std::vector<scalar_type> vbuf;
+      if (nb_mono > 128) { vbuf.resize(nb_mono); m = &vbuf[0]; }
+      m[0] = scalar_type(1);
+      for (size_type i = 1; i < nb_mono; ++i) m[i] = m[prev[i]] * x[var[i]];
+      const scalar_type *c = &coeffs[0];
+      for (size_type j = 0; j < nb_poly; ++j) it[j] = c[j];
+      for (size_type i = 1; i < nb_mono; ++i) {
+        c += nb_poly;
+        scalar_type a = m[i];
+        if (a != scalar_type(0))
+          for (size_type j = 0; j < nb_poly; ++j) it[j] += a * c[j];
+      }
+    }
+
+    packed_polynomials() : n(0), nb_poly(0), nb_mono(0) {}
+  };
+
+  /** Stores the functions of P in pp if they are polynomials with
+      coefficients of type scalar_type. Returns false for other functions,
+      in particular for the polynomials of higher precision (base_poly
+      when opt_long_scalar_type is a QD type), since the packed evaluation
+      is done in scalar_type. */
+  template <typename FUNC>
+  inline bool pack_functions(const std::vector<FUNC> &, packed_polynomials &)
+  { return false; }
+
+  inline bool pack_functions(const std::vector<polynomial<scalar_type> > &P,
+                             packed_polynomials &pp)
+  { pp.init(P); return true; }
+
 
   /**********************************************************************/
   /* A class for rational fractions                                     */
@@ -39,6 +39,7 @@
 */
 
 #include <set>
+#include <atomic>
 #include "bgeot_small_vector.h"
 
 namespace bgeot {
@@ -69,21 +70,33 @@ namespace bgeot {
     typedef std::vector<const box_index*> pbox_cont;
     typedef std::set<const box_index*> pbox_set;
 
+    rtree() : tree_built(false) {}
+
     void add_box(base_node min, base_node max, size_type id=size_type(-1)) {
       box_index bi; bi.min = min; bi.max = max;
       bi.id = (id + 1) ? id : boxes.size();
       boxes.push_back(bi);
     }
     size_type nb_boxes() const { return boxes.size(); }
-    void clear() { root = std::unique_ptr<rtree_elt_base>(); boxes.clear(); }
+    void clear() {
+      root = std::unique_ptr<rtree_elt_base>(); boxes.clear();
+      tree_built = false;
+    }
 
     void find_intersecting_boxes(const base_node& bmin, const base_node& bmax,
                                  pbox_set& boxlst);
+    /** Same as above but fills a reusable vector (see below). */
+    void find_intersecting_boxes(const base_node& bmin, const base_node& bmax,
+                                 pbox_cont& boxlst);
     void find_containing_boxes(const base_node& bmin, const base_node& bmax,
                                pbox_set& boxlst);
     void find_contained_boxes(const base_node& bmin, const base_node& bmax,
                               pbox_set& boxlst);
     void find_boxes_at_point(const base_node& P, pbox_set& boxlst);
+    /** Same as above but fills a vector (sorted by address, without
+        duplicates) which can be reused from one query to another in
+        order to avoid any allocation. */
+    void find_boxes_at_point(const base_node& P, pbox_cont& boxlst);
     void find_line_intersecting_boxes(const base_node& org,
                                       const base_small_vector& dirv,
                                       pbox_set& boxlst);
@@ -132,6 +145,9 @@ namespace bgeot {
     }
 
     void dump();
+    /** Build the tree if it is not already built. All the searches call it
+        first, so that concurrent searches on a tree shared between threads
+        are safe (the tree is built once, by the first of them). */
     void build_tree();
   private:
     static void pbox_set_to_idvec(pbox_set bs, std::vector<size_type>& idvec) {
@@ -142,6 +158,7 @@ namespace bgeot {
 
     box_cont boxes;
     std::unique_ptr<rtree_elt_base> root;
+    std::atomic<bool> tree_built;
     getfem::lock_factory locks_;
   };
 
@@ -73,6 +73,8 @@ std::shared_ptr are used.
 #include "dal_singleton.h"
 #include <set>
 #include <list>
+#include <functional>
+#include <type_traits>
 
 
 #include "getfem/getfem_arch_config.h"
@@ -131,6 +133,11 @@ namespace dal {
     virtual bool equal(const static_stored_object_key &) const = 0;
 
   public :
+    /* Hash of the value of the key, consistent with equal. It is only
+       used with the type of the key, so keys of a type without hash may
+       all return 0. */
+    virtual size_t hash() const { return 0; }
+
     bool operator < (const static_stored_object_key &o) const {
       // comparaison des noms d'objet
       if (typeid(*this).before(typeid(o))) return true;
@@ -150,10 +157,55 @@ namespace dal {
     virtual ~static_stored_object_key() {}
   };
 
+  /* Hash of the values of the simple keys : numbers, pointers, shared
+     pointers, strings, and pairs and vectors of them. The values of the
+     other types all have the hash 0. */
+  template <typename T, typename = void> struct key_value_hash
+  { size_t operator()(const T &) const { return 0; } };
+
+  template <typename T> struct key_value_hash
+  <T, typename std::enable_if<std::is_arithmetic<T>::value
+                              || std::is_pointer<T>::value>::type>
+  { size_t operator()(const T &a) const { return std::hash<T>()(a); } };
+
+  template <typename T> struct key_value_hash
+  <T, typename std::enable_if<std::is_enum<T>::value>::type>
+  { size_t operator()(const T &a) const { return size_t(a); } };
+
+  template <typename T> struct key_value_hash<std::shared_ptr<T> > {
+    size_t operator()(const std::shared_ptr<T> &a) const
+    { return std::hash<const void *>()(a.get()); }
+  };
+
+  template <> struct key_value_hash<std::string> {
+    size_t operator()(const std::string &a) const
+    { return std::hash<std::string>()(a); }
+  };
+
+  inline size_t combine_key_hash(size_t h1, size_t h2)
+  { return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2)); }
+
+  template <typename T1, typename T2>
+  struct key_value_hash<std::pair<T1, T2> > {
+    size_t operator()(const std::pair<T1, T2> &a) const {
+      return combine_key_hash(key_value_hash<T1>()(a.first),
+                              key_value_hash<T2>()(a.second));
+    }
+  };
+
+  template <typename T> struct key_value_hash<std::vector<T> > {
+    size_t operator()(const std::vector<T> &a) const {
+      size_t h = a.size();
+      for (const T &x : a) h = combine_key_hash(h, key_value_hash<T>()(x));
+      return h;
+    }
+  };
+
   template <typename var_type>
   class simple_key : virtual public static_stored_object_key {
     var_type a;
   public :
+    size_t hash() const override { return key_value_hash<var_type>()(a); }
      bool compare(const static_stored_object_key &oo) const override {
       auto &o = dynamic_cast<const simple_key &>(oo);
       return a < o.a;
@@ -287,6 +339,10 @@ namespace dal {
   /** Return the number of stored objects (for debugging purpose). */
   size_t nb_stored_objects(void);
 
+  /** Numbers of searches of the current thread answered by its cache of
+      the last objects found and by the tables (for debugging purpose). */
+  void stored_object_cache_statistics(size_t &hits, size_t &misses);
+
   /** Delete a list of objects and their dependencies*/
   void del_stored_objects(std::list<pstatic_stored_object> &to_delete,
     bool ignore_unstored);
@@ -332,8 +388,10 @@ namespace dal {
 
     stored_object_tab();
     ~stored_object_tab();
+    /* If ks is given, it receives the key stored with the object. */
     pstatic_stored_object
-      search_stored_object(pstatic_stored_object_key k) const;
+      search_stored_object(pstatic_stored_object_key k,
+                           pstatic_stored_object_key *ks = 0) const;
     bool has_dependent_objects(pstatic_stored_object o) const;
     bool exists_stored_object(pstatic_stored_object o) const;
     //adding the object to the storage on the current thread
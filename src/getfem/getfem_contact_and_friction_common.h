@@ -125,7 +125,8 @@ namespace getfem {
         gmm::copy(gmm::identity_matrix(), g);
         gmm::rank_one_update(g, gmm::scaled(n, -scalar_type(1)), n);
       } else if (xn < scalar_type(0)) {
-        static base_small_vector t; gmm::resize(t, N);
+        DEFINE_STATIC_THREAD_LOCAL(base_small_vector, t);
+        gmm::resize(t, N);
         gmm::add(x, gmm::scaled(n, -xn), t);
         gmm::scale(t, scalar_type(1)/xtn);
         if (N > 2) {
@@ -150,7 +151,8 @@ namespace getfem {
 
   template<typename VEC>
   void De_Saxce_projection(const VEC &x, const VEC &n_, scalar_type f) {
-    static base_small_vector n; // For more robustness, n_ is not supposed unitary
+    DEFINE_STATIC_THREAD_LOCAL(base_small_vector, n);
+    // For more robustness, n_ is not supposed unitary
     size_type N = gmm::vect_size(x);
     gmm::resize(n, N);
     gmm::copy(gmm::scaled(n_, scalar_type(1)/gmm::vect_norm2(n_)), n);
@@ -169,7 +171,7 @@ namespace getfem {
   template<typename VEC, typename MAT>
   void De_Saxce_projection_grad(const VEC &x, const VEC &n_,
                                 scalar_type f, MAT &g) {
-    static base_small_vector n;
+    DEFINE_STATIC_THREAD_LOCAL(base_small_vector, n);
     size_type N = gmm::vect_size(x);
     gmm::resize(n, N);
     gmm::copy(gmm::scaled(n_, scalar_type(1)/gmm::vect_norm2(n_)), n);
@@ -180,7 +182,7 @@ namespace getfem {
     if (xn > scalar_type(0) && f * nxt <= xn) {
       gmm::clear(g);
     } else if (xn > scalar_type(0) || nxt > -f*xn) {
-      static base_small_vector xt;
+      DEFINE_STATIC_THREAD_LOCAL(base_small_vector, xt);
       gmm::resize(xt, N);
       gmm::add(x, gmm::scaled(n, -xn), xt);
       gmm::scale(xt, scalar_type(1)/nxt);
@@ -206,7 +208,7 @@ namespace getfem {
   template<typename VEC, typename MAT>
   static void De_Saxce_projection_gradn(const VEC &x, const VEC &n_,
                                         scalar_type f, MAT &g) {
-    static base_small_vector n;
+    DEFINE_STATIC_THREAD_LOCAL(base_small_vector, n);
     size_type N = gmm::vect_size(x);
     scalar_type nn = gmm::vect_norm2(n_);
     gmm::resize(n, N);
@@ -217,7 +219,8 @@ namespace getfem {
 
     if (!(xn > scalar_type(0) && f * nxt <= xn)
         && (xn > scalar_type(0) || nxt > -f*xn)) {
-      static base_small_vector xt, aux;
+      DEFINE_STATIC_THREAD_LOCAL(base_small_vector, xt);
+      DEFINE_STATIC_THREAD_LOCAL(base_small_vector, aux);
       gmm::resize(xt, N); gmm::resize(aux, N);
       gmm::add(x, gmm::scaled(n, -xn), xt);
       gmm::scale(xt, scalar_type(1)/nxt);
@@ -426,8 +429,15 @@ namespace getfem {
     bool self_contact;    // Self-contact is searched or not.
     bool ref_conf;        // Contact in reference configuration
                           // for linear elasticity small sliding contact.
-    bool use_delaunay;    // Use delaunay to detect the contact pairs instead
-                          // of influence boxes.
+    int use_delaunay;     // 0 = Use influence boxes to detect the contact
+                          //     pairs.
+                          // 1 = Use the Delaunay triangulation of the
+                          //     boundary points computed by qhull (the
+                          //     bucket grid below if qhull is not
+                          //     available).
+                          // 2 = Connect the boundary points closer than
+                          //     the release distance (plus the master faces
+                          //     diameter) with a bucket grid.
     int nodes_mode;       // 0 = Use Gauss points for both slave and master
                           // 1 = Use finite element nodes for slave and
                           //     Gauss points for master.
@@ -438,7 +448,20 @@ namespace getfem {
     scalar_type release_distance;  // Limit distance beyond which the contact
     // will not be considered. CAUTION: should be comparable to the element
     // size (if it is too large, a too large set of influence boxes will be
-    // detected and the computation will be slow, except for delaunay option)
+    // detected and the computation will be slow, except for delaunay option
+    // with qhull. The cost of the bucket grid is proportional to the number
+    // of slave-master point pairs closer than the release distance)
+
+    scalar_type search_margin; // If positive, the potential contact pairs
+    // are kept from a call of compute_contact_pairs to the next one while
+    // the displacements do not move more than this margin (in maximum norm)
+    // since the last full search. Influence boxes are enlarged accordingly
+    // and the normal cones are not used to filter the potential pairs.
+    // Not compatible with the qhull Delaunay detection.
+    size_type nb_full_search; // Number of full searches of potential pairs
+
+    struct bucket_grid;   // Bucket grid of the master boundary points, kept
+    std::shared_ptr<bucket_grid> pgrid; // from a detection to the next one.
 
     scalar_type cut_angle; // Cut angle (in radian) for normal cones
     scalar_type EPS;       // Should be typically hmin/1000 (for computing
@@ -455,6 +478,8 @@ namespace getfem {
     std::vector<const VECTOR *> lambdas;  // Displacement vectors
     std::vector<std::string> lambdanames; // Displacement vectors names.
     std::vector<VECTOR> ext_lambdas;      // Unreduced displacement vectors
+    std::vector<VECTOR> ref_Us;      // Unreduced displacement vectors at the
+                                     // last full search of contact pairs
 
     std::vector<contact_boundary> contact_boundaries;
 
@@ -464,6 +489,8 @@ namespace getfem {
     std::vector<ga_function> obstacles_f;
     std::vector<std::string> obstacles;
     std::vector<std::string> obstacles_velocities;
+    std::vector<pmesher_signed_distance> obstacles_sd; // Analytic obstacles
+                                                      // (0 for expressions)
 
 
     struct normal_cone : public std::vector<base_small_vector> {
@@ -533,6 +560,10 @@ namespace getfem {
     dal::bit_vector aux_dof_cv; // An auxiliary variable for are_dof_linked
     // function (in order to be of constant complexity).
 
+    // Test if the displacements moved less than search_margin since the
+    // last full search of contact pairs.
+    bool displacements_within_margin(void) const;
+
     bool are_dof_linked(size_type ib1, size_type idof1,
                         size_type ib2, size_type idof2);
 
@@ -551,10 +582,31 @@ namespace getfem {
 
   protected:
 
-    std::vector<std::vector<face_info> > potential_pairs;
+    // Potential contact faces of the boundary points in a compressed
+    // storage : the faces of the boundary point ip are
+    // potential_faces[potential_pairs_ptr[ip] .. potential_pairs_ptr[ip+1]-1]
+    std::vector<face_info> potential_faces;
+    std::vector<size_type> potential_pairs_ptr;
+
+    // Unsorted list of (boundary point, face) candidates, as produced
+    // (possibly by several threads) by the detection algorithms.
+    typedef std::vector<std::pair<size_type, face_info> > potential_pair_list;
+
+    void add_potential_contact_face(potential_pair_list &ppl, size_type ip,
+                                    size_type ib, size_type ie,
+                                    short_type iff) const
+    { ppl.push_back(std::make_pair(ip, face_info(ib, ie, iff))); }
+
+    // Build the compressed storage from a list of candidates. Duplicate
+    // faces of a same point are eliminated, the order of first appearance
+    // being kept.
+    void set_potential_pairs(const potential_pair_list &ppl);
+
+    size_type nb_potential_faces(size_type ip) const
+    { return potential_pairs_ptr[ip+1] - potential_pairs_ptr[ip]; }
+    const face_info &potential_face(size_type ip, size_type k) const
+    { return potential_faces[potential_pairs_ptr[ip] + k]; }
 
-    void add_potential_contact_face(size_type ip, size_type ib, size_type ie,
-                                    short_type iff);
   public:
 
     // stored information for contact pair
@@ -620,8 +672,27 @@ namespace getfem {
     // number, element number, face number, unit normal vector ...
     void compute_boundary_points(bool slave_only = false);
     void compute_potential_contact_pairs_delaunay(void);
+    // Add the potential contact pairs between two boundary points which are
+    // neighbours (in the Delaunay triangulation or in the bucket grid).
+    void add_potential_pairs_of_points(potential_pair_list &ppl,
+                                       size_type ipt1, size_type ipt2);
+    // Maximal diameter of the master faces in reference configuration.
+    scalar_type master_faces_diameter(void) const;
     void compute_potential_contact_pairs_influence_boxes(void);
 
+    // Value and gradient of the level-set function of a rigid obstacle.
+    // Only the analytic obstacles can be evaluated concurrently.
+    scalar_type obstacle_value(size_type i, const base_node &P);
+    void obstacle_gradient(size_type i, const base_node &P, scalar_type d,
+                           base_small_vector &G);
+    bool analytic_obstacles(void) const;
+    // Search of the nearest rigid obstacle for boundary point ip, `d` being
+    // the values of the obstacle level-set functions at this point, and
+    // projection (or raytrace) on it. Returns 0 if no obstacle is found, 1
+    // if a contact pair is found and 2 if the point has to be discarded.
+    int rigid_obstacle_pair(size_type ip, const base_small_vector &nx,
+                            const scalar_type *d, contact_pair &ct);
+
   protected:
 
     std::vector<contact_pair> contact_pairs;
@@ -669,20 +740,37 @@ namespace getfem {
     bool is_slave_boundary(size_type n) const { return contact_boundaries[n].slave; }
     void set_raytrace(bool b) { raytrace = b; }
     void set_nodes_mode(int m) { nodes_mode = m; }
+    /** Select the detection of the potential contact pairs (see
+        use_delaunay above). */
+    void set_delaunay_mode(int m) { use_delaunay = m; }
+    /** Set the margin for the reuse of the potential contact pairs between
+        successive calls of compute_contact_pairs (0 to disable). */
+    void set_search_margin(scalar_type m)
+    { search_margin = m; ref_Us = std::vector<VECTOR>(); }
+    /** Number of full searches of potential contact pairs done, the other
+        calls of compute_contact_pairs reusing the stored pairs. */
+    size_type nb_full_searches(void) const { return nb_full_search; }
     size_type nb_contact_pairs(void) const { return contact_pairs.size(); }
     const contact_pair &get_contact_pair(size_type i)
     { return contact_pairs[i]; }
 
     multi_contact_frame(size_type NN, scalar_type r_dist,
-                        bool dela = true, bool selfc = true,
+                        int dela = 1, bool selfc = true,
                         scalar_type cut_a = 0.3, bool rayt = false,
                         int fem_nodes = 0, bool refc = false);
     multi_contact_frame(const model &md, size_type NN, scalar_type r_dist,
-                        bool dela = true, bool selfc = true,
+                        int dela = 1, bool selfc = true,
                         scalar_type cut_a = 0.3, bool rayt = false,
                         int fem_nodes = 0, bool refc = false);
 
     size_type add_obstacle(const std::string &obs);
+    /** Add a rigid obstacle described by an analytic signed distance
+        (negative inside the obstacle), for instance
+        new_mesher_half_space, new_mesher_ball, new_mesher_tube,
+        new_mesher_grid_distance or new_mesher_triangulated_surface.
+        The evaluation is much cheaper than the one of an expression and
+        can be done in parallel. */
+    size_type add_obstacle(const pmesher_signed_distance &obs);
 
     size_type add_slave_boundary(const getfem::mesh_im &mim,
                                  const getfem::mesh_fem *mfu,
@@ -739,16 +827,21 @@ namespace getfem {
 
   /** Add a raytracing interpolate transformation called 'transname' to a model
       to be used by the generic assembly bricks.
+      If `search_margin` is positive, the bounding boxes of the master faces
+      are enlarged by this margin and kept from an assembly to the next one
+      while the master displacements do not move more than the margin.
   */
   void add_raytracing_transformation
-  (model &md, const std::string &transname, scalar_type release_distance);
+  (model &md, const std::string &transname, scalar_type release_distance,
+   scalar_type search_margin = scalar_type(0));
 
   /** Add a raytracing interpolate transformation called 'transname' to a
       workspace to be used by the generic assembly bricks.
+      See above for the meaning of `search_margin`.
   */
   void add_raytracing_transformation
   (ga_workspace &workspace, const std::string &transname,
-   scalar_type release_distance);
+   scalar_type release_distance, scalar_type search_margin = scalar_type(0));
 
   /** Add a master boundary with corresponding displacement variable
       'dispname' on a specific boundary 'region' to an existing raytracing
@@ -801,6 +894,22 @@ namespace getfem {
   (ga_workspace &workspace, const std::string &transname,
    const std::string &expr, size_type N);
 
+  /** Add a rigid obstacle described by an analytic signed distance
+      (negative inside the obstacle, see getfem_mesher.h) to an existing
+      raytracing interpolate transformation called 'transname'.
+  */
+  void add_rigid_obstacle_to_raytracing_transformation
+  (model &md, const std::string &transname,
+   const pmesher_signed_distance &obs, size_type N);
+
+  /** Add a rigid obstacle described by an analytic signed distance
+      to an existing raytracing interpolate transformation called
+      'transname'.
+  */
+  void add_rigid_obstacle_to_raytracing_transformation
+  (ga_workspace &workspace, const std::string &transname,
+   const pmesher_signed_distance &obs, size_type N);
+
   //=========================================================================
   //
   //  Projection Interpolate transformation
@@ -809,16 +918,21 @@ namespace getfem {
 
   /** Add a projection interpolate transformation called 'transname' to a model
       to be used by the generic assembly bricks.
+      If `search_margin` is positive, the bounding boxes of the master faces
+      are enlarged by this margin and kept from an assembly to the next one
+      while the master displacements do not move more than the margin.
   */
   void add_projection_transformation
-  (model &md, const std::string &transname, scalar_type release_distance);
+  (model &md, const std::string &transname, scalar_type release_distance,
+   scalar_type search_margin = scalar_type(0));
 
   /** Add a projection interpolate transformation called 'transname' to a
       workspace to be used by the generic assembly bricks.
+      See above for the meaning of `search_margin`.
   */
   void add_projection_transformation
   (ga_workspace &workspace, const std::string &transname,
-   scalar_type release_distance);
+   scalar_type release_distance, scalar_type search_margin = scalar_type(0));
 
   /** Add a master boundary with corresponding displacement variable
       'dispname' on a specific boundary 'region' to an existing projection
@@ -869,6 +983,22 @@ namespace getfem {
   void add_rigid_obstacle_to_projection_transformation
   (ga_workspace &workspace, const std::string &transname,
    const std::string &expr, size_type N);
+
+  /** Add a rigid obstacle described by an analytic signed distance
+      (negative inside the obstacle, see getfem_mesher.h) to an existing
+      projection interpolate transformation called 'transname'.
+  */
+  void add_rigid_obstacle_to_projection_transformation
+  (model &md, const std::string &transname,
+   const pmesher_signed_distance &obs, size_type N);
+
+  /** Add a rigid obstacle described by an analytic signed distance
+      to an existing projection interpolate transformation called
+      'transname'.
+  */
+  void add_rigid_obstacle_to_projection_transformation
+  (ga_workspace &workspace, const std::string &transname,
+   const pmesher_signed_distance &obs, size_type N);
 }  /* end of namespace getfem.                                             */
 
 
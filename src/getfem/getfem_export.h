@@ -84,6 +84,23 @@ namespace getfem {
     template<class IT> void write_3x3tensor(IT p);
     void write_separ();
 
+    /* U interpolated on the exported slice or on the used dofs of the
+       exported mesh_fem. */
+    template<class VECT>
+    void interpolate_on_exported_points(const mesh_fem &mf, const VECT& U,
+                                        std::vector<scalar_type> &V) const;
+    /* Values of a dataset of nb_val scalars, vectors or tensors, with 1, 3
+       or 9 components as in VTK files. Returns the number of components. */
+    template<class VECT>
+    size_type float_dataset(const VECT& U, size_type nb_val, size_type qdim,
+                            std::vector<float> &v) const;
+    /* Whole arrays describing the exported slice or mesh_fem: points
+       (3 coordinates), connectivity, end of each cell in the connectivity
+       and VTK cell types. */
+    void mesh_structure_arrays(std::vector<float> &pts, std::vector<int> &conn,
+                               std::vector<int> &offsets,
+                               std::vector<unsigned char> &types) const;
+
   public:
     typedef enum { VTK_VERTEX = 1,
                    VTK_LINE = 3,
@@ -206,16 +223,14 @@ namespace getfem {
   }
 
   template<class VECT>
-  void vtk_export::write_point_data(const getfem::mesh_fem &mf, const VECT& U,
-                                    const std::string& name) {
+  void vtk_export::interpolate_on_exported_points
+  (const mesh_fem &mf, const VECT& U, std::vector<scalar_type> &V) const {
     size_type Q = (gmm::vect_size(U) / mf.nb_dof()) * mf.get_qdim();
-    size_type qdim = mf.get_qdim();
     if (psl) {
-      std::vector<scalar_type> Uslice(Q*psl->nb_points());
-      psl->interpolate(mf, U, Uslice);
-      write_dataset_(Uslice, name, qdim);
+      V.resize(Q*psl->nb_points());
+      psl->interpolate(mf, U, V);
     } else {
-      std::vector<scalar_type> V(pmf->nb_dof() * Q);
+      V.resize(pmf->nb_dof() * Q);
       if (&mf != &(*pmf)) {
         interpolation(mf, *pmf, U, V);
       } else gmm::copy(U,V);
@@ -227,10 +242,49 @@ namespace getfem {
           }
       }
       V.resize(Q*pmf_dof_used.card());
-      write_dataset_(V, name, qdim);
     }
   }
 
+  template<class VECT>
+  size_type vtk_export::float_dataset(const VECT& U, size_type nb_val,
+                                      size_type qdim,
+                                      std::vector<float> &v) const {
+    size_type Q = qdim;
+    if (Q == 1) Q = gmm::vect_size(U) / nb_val;
+    GMM_ASSERT1(gmm::vect_size(U) == nb_val*Q,
+                "inconsistency in the size of the dataset: "
+                << gmm::vect_size(U) << " != " << nb_val << "*" << Q);
+    if (Q == 1) {
+      v.resize(nb_val);
+      for (size_type i=0; i < nb_val; ++i) v[i] = float(U[i]);
+      return 1;
+    } else if (Q <= 3) {
+      v.assign(3*nb_val, 0.f);
+      for (size_type i=0; i < nb_val; ++i)
+        for (size_type j=0; j < Q; ++j) v[3*i+j] = float(U[i*Q+j]);
+      return 3;
+    } else if (Q == gmm::sqr(dim_)) {
+      /* tensors : coef are supposed to be stored in FORTRAN order
+         in the VTK file, they are written with C (row major) order
+       */
+      v.assign(9*nb_val, 0.f);
+      for (size_type i=0; i < nb_val; ++i)
+        for (size_type j=0; j < dim_; ++j)
+          for (size_type k=0; k < dim_; ++k)
+            v[9*i+3*j+k] = float(U[i*Q + j + k*dim_]);
+      return 9;
+    } else GMM_ASSERT1(false, "vtk does not accept vectors of dimension > 3");
+    return 0;
+  }
+
+  template<class VECT>
+  void vtk_export::write_point_data(const getfem::mesh_fem &mf, const VECT& U,
+                                    const std::string& name) {
+    std::vector<scalar_type> V;
+    interpolate_on_exported_points(mf, U, V);
+    write_dataset_(V, name, mf.get_qdim());
+  }
+
   template<class VECT>
   void vtk_export::write_cell_data(const VECT& U, const std::string& name,
                                    size_type qdim) {
@@ -287,6 +341,242 @@ namespace getfem {
   }
 
 
+  /** @brief VTK XML export.
+
+      Export to the XML unstructured grid format of VTK (.vtu files). It
+      is used as vtk_export, but each array is written at once, in binary
+      form and in the byte order of the machine, in the appended data
+      section of the file. With compression enabled (zlib is required),
+      the arrays are compressed by blocks of 32 kB, in parallel.
+
+      The arrays are kept in memory and the file is written by close()
+      or by the destructor. Several vtu_export on different parts of a
+      mesh (for instance mesh_fem defined on a partition of the
+      elements) are independent, they can be written concurrently and
+      gathered in a .pvtu file with write_pvtu().
+  */
+  class vtu_export : protected vtk_export {
+    struct data_array {
+      std::string name, type;
+      size_type nb_comp;
+      std::vector<char> data; /* size of the data followed by the data,
+                                 or compression header and blocks */
+    };
+    std::vector<data_array> point_arrays, cell_arrays, structure_arrays;
+    typedef std::vector<data_array>::const_iterator array_iterator;
+    size_type nb_points, nb_cells;
+    bool compressed, closed;
+
+    void encode(const char *p, size_type nb, std::vector<char> &data) const;
+    void add_array(std::vector<data_array> &arrays, const std::string& name,
+                   const char *type, const void *p, size_type nb,
+                   size_type nb_comp);
+    void write_array_headers(array_iterator it, array_iterator ite,
+                             size_type &offset);
+    void init();
+
+  public:
+    vtu_export(const std::string& fname, bool compressed_ = false);
+    vtu_export(std::ostream &os_, bool compressed_ = false);
+    ~vtu_export();
+
+    using vtk_export::exporting;
+    using vtk_export::get_exported_slice;
+    using vtk_export::get_exported_mesh_fem;
+
+    void write_mesh();
+
+    /** Add a scalar, vector or tensor field defined on mf. It is
+        interpolated on the exported slice or mesh_fem if necessary. */
+    template<class VECT> void write_point_data(const getfem::mesh_fem &mf,
+                                               const VECT& U,
+                                               const std::string& name);
+    /** Add a field already interpolated on the exported slice. */
+    template<class VECT> void write_sliced_point_data(const VECT& Uslice,
+                                                      const std::string& name,
+                                                      size_type qdim=1);
+    /** Add a field constant on each cell (convex of the exported
+        mesh_fem or simplex of the exported slice). */
+    template<class VECT> void write_cell_data(const VECT& U,
+                                              const std::string& name,
+                                              size_type qdim = 1);
+    void write_mesh_quality(const mesh &m);
+
+    /** Write the .vtu file. Nothing can be added afterwards. */
+    void close();
+
+    /** Write a .pvtu file gathering the pieces whose file names are given
+        (relatively to the .pvtu file). The pieces should have the same
+        arrays as this one, which is usually one of them. */
+    void write_pvtu(const std::string& fname,
+                    const std::vector<std::string> &pieces) const;
+  private:
+    template<class VECT> void write_dataset_(const VECT& U,
+                                             const std::string& name,
+                                             size_type qdim,
+                                             bool cell_data=false);
+  };
+
+  template<class VECT>
+  void vtu_export::write_point_data(const getfem::mesh_fem &mf, const VECT& U,
+                                    const std::string& name) {
+    std::vector<scalar_type> V;
+    interpolate_on_exported_points(mf, U, V);
+    write_dataset_(V, name, mf.get_qdim());
+  }
+
+  template<class VECT>
+  void vtu_export::write_cell_data(const VECT& U, const std::string& name,
+                                   size_type qdim) {
+    write_dataset_(U, name, qdim, true);
+  }
+
+  template<class VECT>
+  void vtu_export::write_sliced_point_data(const VECT& U,
+                                           const std::string& name,
+                                           size_type qdim) {
+    write_dataset_(U, name, qdim, false);
+  }
+
+  template<class VECT>
+  void vtu_export::write_dataset_(const VECT& U, const std::string& name,
+                                  size_type qdim, bool cell_data) {
+    write_mesh();
+    std::vector<float> v;
+    size_type nc = float_dataset(U, cell_data ? nb_cells : nb_points, qdim, v);
+    add_array(cell_data ? cell_arrays : point_arrays, remove_spaces(name),
+              "Float32", v.data(), v.size()*sizeof(float), nc);
+  }
+
+  /** @brief Collection of VTK files (.pvd), typically a time series.
+
+      The .pvd file is rewritten at each call of add_dataset, it is
+      always complete and can be opened during the computation.
+  */
+  class pvd_export {
+    std::string fname;
+    struct dataset { scalar_type time; size_type part; std::string file; };
+    std::vector<dataset> datasets;
+    void write() const;
+
+  public:
+    pvd_export(const std::string& fname_);
+    /** Add a .vtu or .pvtu file (name relative to the .pvd file) for the
+        time step "time". Files with the same time and different parts are
+        displayed together. */
+    void add_dataset(scalar_type time, const std::string& file,
+                     size_type part = 0);
+    size_type nb_datasets() const { return datasets.size(); }
+  };
+
+  class xdmf_async_writer;
+
+  /** @brief Time series export in the XDMF format.
+
+      The geometry and the topology of the exported mesh_fem or slice are
+      written once in a raw binary file (basename.bin), then only the
+      fields of each time step are appended to it. The XML description of
+      the time series (basename.xmf, which can be read by ParaView or
+      VisIt) refers to the arrays of the binary file by their offset and is
+      rewritten at each new time step. The mesh is written again only if
+      exporting() is called again (after a remeshing for instance).
+
+      The binary data is written by a background thread: the write_*_data
+      functions only convert the field and queue it, the computation goes
+      on during the writing. flush() waits for the end of the writing.
+  */
+  class xdmf_export : protected vtk_export {
+    struct xdmf_array {
+      std::string name;
+      size_type nb, nb_comp, offset;
+      bool cell_data;
+    };
+    struct xdmf_grid {
+      size_type nb_points, nb_cells, geometry, topology, topology_size;
+    };
+    struct xdmf_step {
+      scalar_type time;
+      size_type grid;
+      std::vector<xdmf_array> fields;
+    };
+    std::string basename, binname;
+    std::vector<xdmf_grid> grids;
+    std::vector<xdmf_step> steps;
+    bool mesh_written;
+    size_type offset; // end of the data queued for the binary file
+    std::unique_ptr<xdmf_async_writer> pwriter;
+
+    size_type queue_data(const void *p, size_type nb);
+    std::string xml_description() const;
+    template<class VECT> void write_dataset_(const VECT& U,
+                                             const std::string& name,
+                                             size_type qdim,
+                                             bool cell_data=false);
+  public:
+    xdmf_export(const std::string& basename_);
+    ~xdmf_export();
+
+    void exporting(const mesh& m);
+    void exporting(const mesh_fem& mf);
+    void exporting(const stored_mesh_slice& sl);
+    using vtk_export::get_exported_slice;
+    using vtk_export::get_exported_mesh_fem;
+
+    /** Begin a new time step, the following fields are associated to it. */
+    void new_time_step(scalar_type t);
+    size_type nb_time_steps() const { return steps.size(); }
+
+    void write_mesh();
+    /** Add a field defined on mf at the current time step. It is
+        interpolated on the exported slice or mesh_fem if necessary. */
+    template<class VECT> void write_point_data(const getfem::mesh_fem &mf,
+                                               const VECT& U,
+                                               const std::string& name);
+    /** Add a field already interpolated on the exported slice. */
+    template<class VECT> void write_sliced_point_data(const VECT& Uslice,
+                                                      const std::string& name,
+                                                      size_type qdim=1)
+    { write_dataset_(Uslice, name, qdim, false); }
+    /** Add a field constant on each cell (convex of the exported
+        mesh_fem or simplex of the exported slice). */
+    template<class VECT> void write_cell_data(const VECT& U,
+                                              const std::string& name,
+                                              size_type qdim = 1)
+    { write_dataset_(U, name, qdim, true); }
+
+    /** Wait for the end of the writing of the queued data and write the
+        XML description. */
+    void flush();
+  };
+
+  template<class VECT>
+  void xdmf_export::write_point_data(const getfem::mesh_fem &mf, const VECT& U,
+                                     const std::string& name) {
+    std::vector<scalar_type> V;
+    interpolate_on_exported_points(mf, U, V);
+    write_dataset_(V, name, mf.get_qdim());
+  }
+
+  template<class VECT>
+  void xdmf_export::write_dataset_(const VECT& U, const std::string& name,
+                                   size_type qdim, bool cell_data) {
+    write_mesh();
+    if (steps.empty()) new_time_step(scalar_type(0));
+    xdmf_step &step = steps.back();
+    GMM_ASSERT1(step.fields.empty() || step.grid == grids.size()-1,
+                "xdmf export: the exported mesh has changed during a "
+                "time step");
+    step.grid = grids.size()-1;
+    const xdmf_grid &grid = grids.back();
+    xdmf_array a;
+    a.name = remove_spaces(name); a.cell_data = cell_data;
+    a.nb = cell_data ? grid.nb_cells : grid.nb_points;
+    std::vector<float> v;
+    a.nb_comp = float_dataset(U, a.nb, qdim, v);
+    a.offset = queue_data(v.data(), v.size()*sizeof(float));
+    step.fields.push_back(a);
+  }
+
   /** @brief A (quite large) class for exportation of data to IBM OpenDX.
 
                      http://www.opendx.org/
@@ -496,16 +496,30 @@ namespace getfem {
      virtual_fem implementation as a vector of generic functions. The
      class FUNC should provide "derivative" and "eval" member
      functions (this is the case for bgeot::polynomial<T>).
+     Polynomial base functions and their derivatives are evaluated in a
+     packed form (see bgeot::packed_polynomials).
   */
   template <class FUNC> class fem : public virtual_fem {
   protected :
     std::vector<FUNC> base_;
     mutable std::vector<std::vector<FUNC>> grad_, hess_;
+    mutable bgeot::packed_polynomials packed_base_, packed_grad_,
+      packed_hess_;
+    mutable bool base_computed_;
     mutable bool grad_computed_;
     mutable bool hess_computed_;
 
+    void compute_base_() const {
+      getfem::omp_guard guard;
+      if (base_computed_) return;
+      size_type R = nb_base_components(0);
+      std::vector<FUNC> b(base_.begin(), base_.begin() + R);
+      bgeot::pack_functions(b, packed_base_);
+      base_computed_ = true;
+    }
+
     void compute_grad_() const {
-      auto guard = getfem::omp_guard{};
+      getfem::omp_guard guard;
       if (grad_computed_) return;
       size_type R = nb_base_components(0);
       dim_type n = dim();
@@ -516,11 +530,15 @@ namespace getfem {
 	  grad_[i][j] = base_[i]; grad_[i][j].derivative(j);
 	}
       }
+      std::vector<FUNC> g; g.reserve(R*n);
+      for (dim_type j = 0; j < n; ++j)
+        for (size_type i = 0; i < R; ++i) g.push_back(grad_[i][j]);
+      bgeot::pack_functions(g, packed_grad_);
       grad_computed_ = true;
     }
 
     void compute_hess_() const {
-      auto guard = getfem::omp_guard{};
+      getfem::omp_guard guard;
       if (hess_computed_) return;
       size_type R = nb_base_components(0);
       dim_type n = dim();
@@ -534,6 +552,11 @@ namespace getfem {
 	  }
 	}
       }
+      std::vector<FUNC> h; h.reserve(R*n*n);
+      for (dim_type k = 0; k < n; ++k)
+        for (dim_type j = 0; j < n; ++j)
+          for (size_type i = 0; i < R; ++i) h.push_back(hess_[i][j+k*n]);
+      bgeot::pack_functions(h, packed_hess_);
       hess_computed_ = true;
     }
     
@@ -545,11 +568,14 @@ namespace getfem {
     /** Evaluates at point x, all base functions and returns the result in
         t(nb_base,target_dim) */
     void base_value(const base_node &x, base_tensor &t) const {
+      if (!base_computed_) compute_base_();
       bgeot::multi_index mi(2);
       mi[1] = target_dim(); mi[0] = short_type(nb_base(0));
       t.adjust_sizes(mi);
       size_type R = nb_base_components(0);
       base_tensor::iterator it = t.begin();
+      if (packed_base_.nb_polynomials())
+        { packed_base_.eval(x.begin(), it); return; }
       for (size_type  i = 0; i < R; ++i, ++it)
         *it = bgeot::to_scalar(base_[i].eval(x.begin()));
     }
@@ -564,6 +590,8 @@ namespace getfem {
       t.adjust_sizes(mi);
       size_type R = nb_base_components(0);
       base_tensor::iterator it = t.begin();
+      if (packed_grad_.nb_polynomials())
+        { packed_grad_.eval(x.begin(), it); return; }
       for (dim_type j = 0; j < n; ++j)
         for (size_type i = 0; i < R; ++i, ++it)
 	  *it = bgeot::to_scalar(grad_[i][j].eval(x.begin()));
@@ -580,13 +608,16 @@ namespace getfem {
       t.adjust_sizes(mi);
       size_type R = nb_base_components(0);
       base_tensor::iterator it = t.begin();
+      if (packed_hess_.nb_polynomials())
+        { packed_hess_.eval(x.begin(), it); return; }
       for (dim_type k = 0; k < n; ++k)
         for (dim_type j = 0; j < n; ++j)
           for (size_type i = 0; i < R; ++i, ++it)
 	    *it = bgeot::to_scalar(hess_[i][j+k*n].eval(x.begin()));
     }
 
-    fem() : grad_computed_(false), hess_computed_(false){}
+    fem() : base_computed_(false), grad_computed_(false),
+            hess_computed_(false) {}
 
   };
 
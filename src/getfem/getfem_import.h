@@ -56,6 +56,9 @@ namespace getfem {
 
 
       - "gmsh" for meshes generated by Gmsh http://www.geuz.org/gmsh/
+       Versions 1, 2 and 4 (4.0 and 4.1) of the MSH format are read,
+       in ASCII or binary form for versions 2 and 4.
+
        IMPORTANT NOTE: if you do not assign a physical surface/volume
        to your 3D mesh, the file will also contain the mesh of the
        boundary (2D elements) and the boundary of the boundary (line
@@ -138,6 +141,11 @@ namespace getfem {
       are not face of another convex. Thus, a 3D model can have a mixture of
       3D solid, 2D plates and 1D rod elements. This feature is still yet to
       be tested.
+
+      remove_duplicated_nodes can be set to false for files whose nodes
+      are known to be distinct (meshes generated by Gmsh). The points
+      are then added to the mesh without searching for an existing one,
+      which is faster for large meshes.
   */
   void import_mesh_gmsh(const std::string& filename, mesh& m,
                         std::map<std::string, size_type> &region_map,
@@ -66,13 +66,49 @@ namespace getfem {
 				   ignored (for instance because
 				   INTEGRATE_INSIDE and the convex
 				   is outside etc.) */
-    std::vector<pintegration_method> build_methods;
+    /* The integration methods built are shared by the convexes having
+       the same cut pattern, i.e. the same sub-elements kept (with their
+       singular vertices) in the reference element. The coordinates of
+       the vertices are quantized in the key. On the boundary, the
+       method depends on the real element, so it is not shared. */
+    struct cut_pattern {
+      bgeot::pconvex_ref cvr;
+      bgeot::pgeometric_trans pgt2;
+      size_type cv; // size_type(-1) if the method can be shared.
+      std::vector<scalar_type> data;
+      bool operator <(const cut_pattern &p) const {
+        if (cvr != p.cvr) return cvr < p.cvr;
+        if (pgt2 != p.pgt2) return pgt2 < p.pgt2;
+        if (cv != p.cv) return cv < p.cv;
+        return data < p.data;
+      }
+    };
+    struct cut_rule {
+      pintegration_method pim;
+      size_type nb_uses; // number of convexes using the method.
+    };
+    typedef std::map<cut_pattern, cut_rule> cut_rule_map;
+    cut_rule_map cut_rules;
+    std::map<size_type, cut_rule_map::iterator> build_methods;
+    /* For each convex, the version of its cut in the mesh_level_set when
+       its integration method was built, and the parameters used, to
+       rebuild only the methods of the convexes cut again. */
+    std::vector<gmm::uint64_type> built_versions;
+    const mesh_level_set *built_mls;
+    int built_where;
+    pintegration_method built_regular_pim, built_singular_pim;
+    std::string built_csg_description;
 
     mutable bool is_adapted;
     int integrate_where; // INTEGRATE_INSIDE or INTEGRATE_OUTSIDE
 
     void clear_build_methods();
+    void clear_method_of_convex(size_type cv);
     void build_method_of_convex(size_type cv);
+    pintegration_method build_method_of_cut
+    (size_type cv, const std::vector<pmesher_signed_distance> &mesherls0,
+     const std::vector<pmesher_signed_distance> &mesherls1,
+     const std::vector<papprox_integration> &pais);
 
     /* CSG (constructive solid geometry) description for the
        definition of the domain with respect to one or more levelsets.
@@ -100,7 +136,9 @@ namespace getfem {
            INTEGRATE_BOUNDARY = 4};
     void update_from_context(void) const;
     
-    /** Apply the adequate integration methods. */
+    /** Apply the adequate integration methods. The methods are only
+	rebuilt on the convexes adapted again by the mesh_level_set since
+	the last call. */
     void adapt(void);
     void clear(void); // to be modified
 
@@ -113,6 +151,10 @@ namespace getfem {
     }
 
     int location() const { return integrate_where; }
+
+    /** Number of distinct integration methods built for the convexes
+        cut by the level sets. */
+    size_type nb_distinct_cut_methods() const { return cut_rules.size(); }
     
     size_type memsize() const {
       return mesh_im::memsize(); // + ... ;
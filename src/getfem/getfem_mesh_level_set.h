@@ -60,6 +60,7 @@ namespace getfem {
 
     mutable std::set<subzone> allsubzones;
     mutable std::set<zone> allzones;
+    lock_factory zones_lock; // the zones are interned concurrently by adapt
 
     dal::dynamic_array<const std::string *> zones_of_convexes;
     mesh *linked_mesh_;
@@ -81,6 +82,23 @@ namespace getfem {
 
     mutable dal::bit_vector crack_tip_convexes_;
 
+    /* For each fem of the level sets, a bound of the undershoot of its
+       interpolation on the reference element (or -1 if none is known),
+       used to skip the uncut elements cheaply. */
+    std::map<pfem, scalar_type> undershoot_bounds;
+
+    /* Values of the level sets on each convex at the last adapt. Only the
+       convexes whose values or mesh version have changed are re-adapted,
+       the version is renewed each time the cut of a convex is recomputed. */
+    struct convex_state {
+      gmm::uint64_type mesh_version, version;
+      std::vector<scalar_type> values;
+      convex_state() : mesh_version(0), version(0) {}
+    };
+    std::vector<convex_state> convex_states;
+    std::vector<plevel_set> adapted_level_sets;
+    std::vector<gmm::uint64_type> adapted_mf_versions;
+
   public :
     /// Get number of level-sets referenced in this object.
     size_type nb_level_sets(void) const { return level_sets.size(); }
@@ -94,6 +112,12 @@ namespace getfem {
     }
     
     const dal::bit_vector &crack_tip_convexes() const;
+    /** Version of the cut of the convex cv, renewed each time adapt
+        recomputes it (0 if cv has not been adapted yet). */
+    gmm::uint64_type convex_version_number(size_type cv) const {
+      return (cv < convex_states.size()) ? convex_states[cv].version
+                                         : gmm::uint64_type(0);
+    }
 
     /// Gives a reference to the linked mesh of type mesh.
     mesh &linked_mesh(void) const { return *linked_mesh_; }
@@ -109,6 +133,9 @@ namespace getfem {
 	  + it->second.zones.size()
 	  * (level_sets.size() + sizeof(std::string *) + sizeof(std::string));
       }
+      for (const zone &z : allzones)
+	res += sizeof(zone) + z.size() * sizeof(const subzone *);
+      res += allsubzones.size() * (sizeof(subzone) + level_sets.size());
       return res;
     }
     /** add a new level set. Only a reference is kept, no copy done. */
@@ -131,7 +158,10 @@ namespace getfem {
 
     /** fill m with the (non-conformal) "cut" mesh. */
     void global_cut_mesh(mesh &m) const;
-    /** do all the work (cut the convexes wrt the levelsets) */
+    /** do all the work (cut the convexes wrt the levelsets). Once
+        adapted, only the convexes on which the values of the level sets
+        have changed are cut again, unless the level sets or their
+        mesh_fem have been changed. */
     void adapt(void);
     void merge_zoneset(zoneset &zones1, const zoneset &zones2) const;
     void merge_zoneset(zoneset &zones1, const std::string &subz) const;
@@ -171,6 +201,12 @@ namespace getfem {
 				      size_type sub_cv, scalar_type radius);
     void find_zones_of_element(size_type cv, std::string &prezone,
 			       scalar_type radius);
+    const subzone *intern_subzone(const subzone &s) const;
+    const zone *intern_zone(const zone &z) const;
+    void add_sub_zones_no_zero(std::string &s, zone &z) const;
+    void prune_zones(void);
+    void update_undershoot_bounds(void);
+    void values_of_convex(size_type cv, std::vector<scalar_type> &v) const;
 
     /** For each levelset, if the convex cv is crossed, add the levelset number
 	into 'prim' (and 'sec' is the levelset has a secondary part).
@@ -184,7 +220,7 @@ namespace getfem {
 		      gmm::dense_matrix<size_type> &simplexes,
 		      std::vector<dal::bit_vector> &fixed_points_constraints);
     
-    void update_crack_tip_convexes();
+    void update_crack_tip_convexes(const std::vector<size_type> &cvs);
   };
 
   void getfem_mesh_level_set_noisy(void);
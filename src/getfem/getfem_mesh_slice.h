@@ -82,6 +82,34 @@ namespace getfem {
     cvlst_ct cvlst;
     size_type dim_;
     std::vector<size_type> cv2pos; // convex id -> pos in cvlst
+
+  public:
+    typedef gmm::row_matrix<gmm::rsvector<scalar_type> >
+    interpolation_matrix_type;
+  protected:
+    /* interpolation matrices of the mesh_fems already interpolated on the
+       slice, rebuilt when the mesh_fem changes. */
+    struct interpolation_matrix_cache : public context_dependencies {
+      const mesh_fem *pmf;
+      mutable bool up_to_date;
+      interpolation_matrix_type M;
+      void update_from_context() const { up_to_date = false; }
+      interpolation_matrix_cache() : pmf(0), up_to_date(false) {}
+    };
+    struct interpolation_matrix_list
+      : public std::list<interpolation_matrix_cache> {
+      /* interpolation_matrix() may be called by several threads */
+      getfem::lock_factory locks;
+      interpolation_matrix_list() {}
+      /* the matrices are not copied with the slice: they would not be
+         registered as dependent objects of their mesh_fem */
+      interpolation_matrix_list(const interpolation_matrix_list &)
+        : std::list<interpolation_matrix_cache>() {}
+      interpolation_matrix_list &operator=(const interpolation_matrix_list &)
+      { clear(); return *this; }
+    };
+    mutable interpolation_matrix_list interpolation_matrices;
+
     friend class slicer_build_stored_mesh_slice;
     friend class mesh_slicer;
   public:
@@ -131,6 +159,7 @@ namespace getfem {
       gmm::fill(cv2pos, size_type(-1));
       simplex_cnt.clear();
       clear_merged_nodes();
+      interpolation_matrices.clear();
     }
     /** @brief merge with another mesh slice. */
     void merge(const stored_mesh_slice& sl);
@@ -229,6 +258,21 @@ namespace getfem {
     void read_from_file(const std::string &fname, const getfem::mesh &m);
 
 
+    /** @brief Interpolation matrix of a mesh_fem on the slice.
+
+        Matrix of size (nb_points()*mf.get_qdim()) x mf.nb_basic_dof()
+        giving the values of a field on the nodes of the slice from its
+        basic dofs. The matrix is computed on the first call and kept
+        with the slice until the mesh_fem or the slice are modified, so
+        that the interpolation of several fields (or of the same field at
+        different time steps) does not evaluate the base functions again.
+        The rows of the nodes of convexes on which mf is not defined are
+        empty. The cache is protected by a lock, so that several threads
+        can interpolate on the same slice.
+    */
+    const interpolation_matrix_type &
+    interpolation_matrix(const getfem::mesh_fem &mf) const;
+
     /** @brief Interpolation of a mesh_fem on a slice.
 
         The mesh_fem and the slice must share the same mesh, of course.
@@ -244,56 +288,25 @@ namespace getfem {
     template<typename V1, typename V2> void 
     interpolate(const getfem::mesh_fem &mf, const V1& UU, V2& V) const {
       typedef typename gmm::linalg_traits<V2>::value_type T;
-      std::vector<base_node> refpts;
-      std::vector<std::vector<T> > coeff;
-      base_matrix G;
+      typedef gmm::rsvector<scalar_type> ROW;
+      typedef gmm::linalg_traits<ROW>::const_iterator ROW_IT;
+      const interpolation_matrix_type &M = interpolation_matrix(mf);
       size_type qdim = mf.get_qdim();
       size_type qqdim = gmm::vect_size(UU) / mf.nb_dof();
-      size_type pos = 0;
-      coeff.resize(qqdim);
-      std::vector<T> U(mf.nb_basic_dof()*qqdim);
+      GMM_ASSERT1(gmm::vect_size(V) == nb_points() * qdim * qqdim,
+                  "bad dimensions");
+      std::vector<T> U(mf.nb_basic_dof()*qqdim), W(gmm::vect_size(V));
       mf.extend_vector(UU, U);
 
-      gmm::clear(V);
-      for (size_type i=0; i < nb_convex(); ++i) {
-        size_type cv = convex_num(i);
-        refpts.resize(nodes(i).size());
-        for (size_type j=0; j < refpts.size(); ++j)
-          refpts[j] = nodes(i)[j].pt_ref;
-        if (!mf.convex_index().is_in(cv)) {
-          pos += refpts.size() * qdim * qqdim;
-          continue;
-        }
-        
-        pfem pf = mf.fem_of_element(cv);
-        if (pf->need_G()) 
-          bgeot::vectors_to_base_matrix(G,
-                                        mf.linked_mesh().points_of_convex(cv));
-        fem_precomp_pool fppool;
-        pfem_precomp pfp = fppool(pf, store_point_tab(refpts));
-        
-        mesh_fem::ind_dof_ct dof = mf.ind_basic_dof_of_element(cv);
-        for (size_type qq=0; qq < qqdim; ++qq) {
-          coeff[qq].resize(mf.nb_basic_dof_of_element(cv));
-          typename std::vector<T>::iterator cit = coeff[qq].begin();
-          for (mesh_fem::ind_dof_ct::const_iterator it=dof.begin();
-               it != dof.end(); ++it, ++cit)
-            *cit = U[(*it)*qqdim+qq];
-        }
-        fem_interpolation_context ctx(mf.linked_mesh().trans_of_convex(cv),
-                                      pfp, 0, G, cv, short_type(-1));
-        for (size_type j=0; j < refpts.size(); ++j) {
-          ctx.set_ii(j);
-          for (size_type qq = 0; qq < qqdim; ++qq) {
-            typename gmm::sub_vector_type<V2*,
-              gmm::sub_interval>::vector_type dest = 
-              gmm::sub_vector(V,gmm::sub_interval(pos,qdim));
-            pf->interpolation(ctx,coeff[qq],dest,dim_type(qdim));
-            pos += qdim;
-          }
+      for (size_type i = 0; i < nb_points(); ++i)
+        for (size_type k = 0; k < qdim; ++k) {
+          const ROW &row = M.row(i*qdim+k);
+          for (ROW_IT it = gmm::vect_const_begin(row),
+                 ite = gmm::vect_const_end(row); it != ite; ++it)
+            for (size_type qq = 0; qq < qqdim; ++qq)
+              W[(i*qqdim+qq)*qdim+k] += (*it) * U[it.index()*qqdim+qq];
         }
-      }
-      GMM_ASSERT1(pos == V.size(), "bad dimensions");
+      gmm::copy(W, V);
     }
   };
 
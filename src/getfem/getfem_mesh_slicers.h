@@ -238,6 +238,12 @@ namespace getfem {
   public:
     static const float EPS;
     virtual void exec(mesh_slicer &ms) = 0;
+    /** Called before the slicing of several convexes in parallel. Returns
+        true if exec can be called concurrently by several threads (the
+        data depending on the current convex is then stored per thread).
+        The lazily computed data shared by the threads should be updated
+        here. */
+    virtual bool prepare_parallel_exec() { return false; }
     virtual ~slicer_action() {}
   };
 
@@ -246,6 +252,7 @@ namespace getfem {
   public:
     slicer_none() {}
     void exec(mesh_slicer &/*ms*/) {}
+    bool prepare_parallel_exec() { return true; }
     static slicer_none& static_instance();
   };
 
@@ -262,17 +269,22 @@ namespace getfem {
     slicer_boundary(const mesh& m,
                     slicer_action &sA = slicer_none::static_instance());
     void exec(mesh_slicer &ms);
+    bool prepare_parallel_exec() { return !A || A->prepare_parallel_exec(); }
   };
 
   /* Apply a precomputed deformation to the slice nodes */
   class slicer_apply_deformation : public slicer_action {
     mesh_slice_cv_dof_data_base *defdata;
-    pfem pf;
-    fem_precomp_pool fprecomp;
-    std::vector<base_node> ref_pts;
+    struct deformation_cache { /* data kept from a convex to the next one */
+      pfem pf;
+      fem_precomp_pool fprecomp;
+      std::vector<base_node> ref_pts;
+      deformation_cache() : pf(0) {}
+    };
+    omp_distribute<deformation_cache> cache;
  public:
     slicer_apply_deformation(mesh_slice_cv_dof_data_base &defdata_) 
-      : defdata(&defdata_), pf(0) {
+      : defdata(&defdata_) {
       if (defdata &&
           defdata->pmf->get_qdim() != defdata->pmf->linked_mesh().dim()) 
         GMM_ASSERT1(false, "wrong Q(=" << int(defdata->pmf->get_qdim()) 
@@ -281,6 +293,8 @@ namespace getfem {
                     << int(defdata->pmf->linked_mesh().dim()));
     }
     void exec(mesh_slicer &ms);
+    bool prepare_parallel_exec()
+    { defdata->pmf->nb_basic_dof(); return true; }
   };
 
   /**
@@ -300,18 +314,19 @@ namespace getfem {
         untils no simplex crosses the boundary
     */
     int orient;
-    dal::bit_vector pt_in, pt_bin;    
-    
+    omp_distribute<dal::bit_vector> pt_in, pt_bin; /* for the current convex */
+
     /** Overload either 'prepare' or 'test_point'.
      */
     virtual void prepare(size_type /*cv*/,
                          const mesh_slicer::cs_nodes_ct& nodes,
                          const dal::bit_vector& nodes_index) {
-      pt_in.clear(); pt_bin.clear();
+      dal::bit_vector &in_ = pt_in, &bin_ = pt_bin;
+      in_.clear(); bin_.clear();
       for (dal::bv_visitor i(nodes_index); !i.finished(); ++i) {
         bool in, bin; test_point(nodes[i].pt, in, bin);        
-        if (bin || ((orient > 0) ? !in : in)) pt_in.add(i);
-        if (bin) pt_bin.add(i);
+        if (bin || ((orient > 0) ? !in : in)) in_.add(i);
+        if (bin) bin_.add(i);
       }
     }
     virtual void test_point(const base_node&, bool& in, bool& bound) const
@@ -336,9 +351,10 @@ namespace getfem {
                        slice_simplex s, /* s is NOT a reference, it is on
                                          * purpose(push_back in the function)*/
                        size_type sstart, std::bitset<32> spin,
-                       std::bitset<32> spbin);
+                       std::bitset<32> spbin, int level = 0);
   public:
     void exec(mesh_slicer &ms);
+    bool prepare_parallel_exec() { return true; }
   };
 
   /**
@@ -386,7 +402,7 @@ namespace getfem {
       const base_node& B=nodes[iB].pt;
       scalar_type a,b,c; // a*x^2 + b*x + c = 0
       a = gmm::vect_norm2_sqr(B-A);
-      if (a < EPS) return pt_bin.is_in(iA) ? 0. : 1./EPS;
+      if (a < EPS) return pt_bin.thrd_cast().is_in(iA) ? 0. : 1./EPS;
       b = 2*gmm::vect_sp(A-x0,B-A);
       c = gmm::vect_norm2_sqr(A-x0)-R*R;
       return slicer_volume::trinom(a,b,c);
@@ -429,7 +445,8 @@ namespace getfem {
       scalar_type Fd = gmm::vect_sp(F,d);
       scalar_type Dd = gmm::vect_sp(D,d);
       scalar_type a = gmm::vect_norm2_sqr(D) - gmm::sqr(Dd);
-      if (a < EPS) return pt_bin.is_in(iA) ? 0. : 1./EPS; assert(a> -EPS);
+      if (a < EPS) return pt_bin.thrd_cast().is_in(iA) ? 0. : 1./EPS;
+      assert(a> -EPS);
       scalar_type b = 2*(gmm::vect_sp(F,D) - Fd*Dd);
       scalar_type c = gmm::vect_norm2_sqr(F) - gmm::sqr(Fd) - gmm::sqr(R);
       return slicer_volume::trinom(a,b,c);
@@ -449,12 +466,12 @@ namespace getfem {
     std::unique_ptr<const mesh_slice_cv_dof_data_base> mfU;
     scalar_type val;
     scalar_type val_scaling; /* = max(abs(U)) */
-    std::vector<scalar_type> Uval;
+    omp_distribute<std::vector<scalar_type> > Uval; /* on the current convex */
     void prepare(size_type cv, const mesh_slicer::cs_nodes_ct& nodes,
                  const dal::bit_vector& nodes_index);
     scalar_type edge_intersect(size_type iA, size_type iB,
                                const mesh_slicer::cs_nodes_ct&) const {
-      assert(iA < Uval.size() && iB < Uval.size());
+      assert(iA < Uval.thrd_cast().size() && iB < Uval.thrd_cast().size());
       if (((Uval[iA] < val) && (Uval[iB] > val)) ||
           ((Uval[iA] > val) && (Uval[iB] < val)))
         return (val-Uval[iA])/(Uval[iB]-Uval[iA]);
@@ -469,6 +486,8 @@ namespace getfem {
                   "can't compute isovalues of a vector field !");
         val_scaling = mfU->maxval();
     }
+    bool prepare_parallel_exec()
+    { mfU->pmf->nb_basic_dof(); return true; }
   };
   
   /** 
@@ -497,6 +516,8 @@ namespace getfem {
     slicer_union(const slicer_action &sA, const slicer_action &sB) : 
       A(&const_cast<slicer_action&>(sA)), B(&const_cast<slicer_action&>(sB)) {}
     void exec(mesh_slicer &ms);
+    bool prepare_parallel_exec()
+    { return A->prepare_parallel_exec() && B->prepare_parallel_exec(); }
   };
 
   /**
@@ -507,6 +528,8 @@ namespace getfem {
   public:
     slicer_intersect(slicer_action &sA, slicer_action &sB) : A(&sA), B(&sB) {}
     void exec(mesh_slicer &ms);
+    bool prepare_parallel_exec()
+    { return A->prepare_parallel_exec() && B->prepare_parallel_exec(); }
   };
 
   /**
@@ -517,6 +540,7 @@ namespace getfem {
   public:
     slicer_complementary(slicer_action &sA) : A(&sA) {}
     void exec(mesh_slicer &ms);
+    bool prepare_parallel_exec() { return A->prepare_parallel_exec(); }
   };
   
   /**
@@ -525,11 +549,16 @@ namespace getfem {
      dimensions, the resulting area is nonsense.
   */
   class slicer_compute_area : public slicer_action {
-    scalar_type a;
+    omp_distribute<scalar_type> a; /* area computed by each thread */
   public:
-    slicer_compute_area() : a(0) {}
+    slicer_compute_area() : a(scalar_type(0)) {}
     void exec(mesh_slicer &ms);
-    scalar_type area() const { return a; }
+    bool prepare_parallel_exec() { return true; }
+    scalar_type area() const {
+      scalar_type r(0);
+      for (size_type th = 0; th < num_threads(); ++th) r += a(th);
+      return r;
+    }
   };
 
   /**
@@ -581,6 +610,7 @@ namespace getfem {
     */
     slicer_explode(scalar_type c) : coef(c) {}
     void exec(mesh_slicer &ms);
+    bool prepare_parallel_exec() { return true; }
   };
 
 }
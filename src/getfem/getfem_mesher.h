@@ -45,7 +45,9 @@
 #include "gmm/gmm_solver_bfgs.h"
 #include "getfem_export.h"
 #include "bgeot_kdtree.h"
+#include "bgeot_rtree.h"
 #include <typeinfo>
+#include <atomic>
 
 namespace getfem {
 
@@ -83,6 +85,11 @@ namespace getfem {
     virtual void register_constraints(std::vector<const
 				      mesher_signed_distance*>& list) const=0;
     virtual scalar_type operator()(const base_node &P) const  = 0;
+    // Evaluation on a set of points (to be redefined for efficiency).
+    virtual void eval(const std::vector<base_node> &P, base_vector &d) const {
+      gmm::resize(d, P.size());
+      for (size_type i = 0; i < P.size(); ++i) d[i] = (*this)(P[i]);
+    }
   };
 
   typedef std::shared_ptr<const mesher_signed_distance> pmesher_signed_distance;
@@ -98,6 +105,11 @@ namespace getfem {
     { return false; }
     virtual scalar_type operator()(const base_node &P) const
     { return xon - gmm::vect_sp(P,n); }
+    virtual void eval(const std::vector<base_node> &P, base_vector &d) const {
+      gmm::resize(d, P.size());
+      for (size_type i = 0; i < P.size(); ++i)
+        d[i] = xon - gmm::vect_sp(P[i], n);
+    }
     virtual scalar_type operator()(const base_node &P,
 				   dal::bit_vector &bv) const {
       scalar_type d = xon - gmm::vect_sp(P,n);
@@ -127,7 +139,7 @@ namespace getfem {
     mutable std::vector<base_poly> gradient;
     mutable std::vector<base_poly> hessian;
     const fem<base_poly> *pf;
-    mutable int initialized;
+    mutable std::atomic<int> initialized; // 1: gradient, 2: hessian built
     scalar_type shift_ls;     // for the computation of a gap on a level_set.
   public:
     bool is_initialized(void) const { return initialized; }
@@ -202,6 +214,11 @@ namespace getfem {
     }
     virtual scalar_type operator()(const base_node &P) const
     { return gmm::vect_dist2(P,x0)-R; }
+    virtual void eval(const std::vector<base_node> &P, base_vector &d) const {
+      gmm::resize(d, P.size());
+      for (size_type i = 0; i < P.size(); ++i)
+        d[i] = gmm::vect_dist2(P[i], x0) - R;
+    }
     virtual void register_constraints(std::vector<const
 				      mesher_signed_distance*>& list) const {
       id = list.size(); list.push_back(this);
@@ -407,13 +424,17 @@ namespace getfem {
 
   class mesher_union : public mesher_signed_distance {
     std::vector<pmesher_signed_distance> dists;
-    mutable std::vector<scalar_type> vd;
-    mutable bool isin;
+    mutable omp_distribute<std::vector<scalar_type> > vd; // one per thread
+    mutable omp_distribute<bool> isin;
     bool with_min;
+    void init_vd(void) {
+      for (size_type i = 0; i < num_threads(); ++i)
+	vd(i).resize(dists.size());
+    }
   public:
     mesher_union(const std::vector<pmesher_signed_distance>
 			&dists_) : dists(dists_) 
-    { vd.resize(dists.size()); with_min = true; }
+    { init_vd(); with_min = true; }
 
     mesher_union
     (const pmesher_signed_distance &a,
@@ -456,7 +477,7 @@ namespace getfem {
       if (r) dists.push_back(r);
       if (s) dists.push_back(s);
       if (t) dists.push_back(t);
-      vd.resize(dists.size());
+      init_vd();
     }
     
     bool bounding_box(base_node &bmin, base_node &bmax) const {
@@ -493,6 +514,15 @@ namespace getfem {
       }
       return d;
     }
+    virtual void eval(const std::vector<base_node> &P, base_vector &d) const {
+      if (!with_min) { mesher_signed_distance::eval(P, d); return; }
+      base_vector d2;
+      dists[0]->eval(P, d);
+      for (size_type k = 1; k < dists.size(); ++k) {
+	dists[k]->eval(P, d2);
+	for (size_type i = 0; i < P.size(); ++i) d[i] = std::min(d[i], d2[i]);
+      }
+    }
     scalar_type operator()(const base_node &P, dal::bit_vector &bv) const {
       if (with_min) {
 	scalar_type d = vd[0] = (*(dists[0]))(P);
@@ -601,14 +631,18 @@ namespace getfem {
 
   class mesher_intersection : public mesher_signed_distance {
     std::vector<pmesher_signed_distance> dists;
-    mutable std::vector<scalar_type> vd;
+    mutable omp_distribute<std::vector<scalar_type> > vd; // one per thread
+    void init_vd(void) {
+      for (size_type i = 0; i < num_threads(); ++i)
+	vd(i).resize(dists.size());
+    }
 
     // const mesher_signed_distance &a, &b;
   public:
     
     mesher_intersection(const std::vector<pmesher_signed_distance>
 			&dists_) : dists(dists_) 
-    { vd.resize(dists.size()); }
+    { init_vd(); }
     
     mesher_intersection
     (const pmesher_signed_distance &a,
@@ -650,7 +684,7 @@ namespace getfem {
       if (r) dists.push_back(r);
       if (s) dists.push_back(s);
       if (t) dists.push_back(t);
-      vd.resize(dists.size());
+      init_vd();
     }
     bool bounding_box(base_node &bmin, base_node &bmax) const {
       base_node bmin2, bmax2;
@@ -674,6 +708,14 @@ namespace getfem {
       return d;
 
     }
+    virtual void eval(const std::vector<base_node> &P, base_vector &d) const {
+      base_vector d2;
+      dists[0]->eval(P, d);
+      for (size_type k = 1; k < dists.size(); ++k) {
+	dists[k]->eval(P, d2);
+	for (size_type i = 0; i < P.size(); ++i) d[i] = std::max(d[i], d2[i]);
+      }
+    }
     scalar_type operator()(const base_node &P, dal::bit_vector &bv) const {
       scalar_type d = vd[0] = (*(dists[0]))(P);
       bool ok = (d < SEPS);
@@ -760,6 +802,11 @@ namespace getfem {
     }
     scalar_type operator()(const base_node &P) const
     { return std::max((*a)(P),-(*b)(P)); }
+    virtual void eval(const std::vector<base_node> &P, base_vector &d) const {
+      base_vector d2;
+      a->eval(P, d); b->eval(P, d2);
+      for (size_type i = 0; i < P.size(); ++i) d[i] = std::max(d[i], -d2[i]);
+    }
     virtual void register_constraints(std::vector<const
 				      mesher_signed_distance*>& list) const {
       a->register_constraints(list); b->register_constraints(list);
@@ -1067,8 +1114,98 @@ namespace getfem {
 
   inline pmesher_signed_distance new_mesher_torus(scalar_type R, scalar_type r)
   { return std::make_shared<mesher_torus>(R,r); }
+
+  // Signed distance sampled on a structured grid of origin x0, of steps h
+  // and of nb[i] points in direction i. The values are given with the
+  // first direction varying fastest and are multilinearly interpolated.
+  // Outside the grid, the distance to the grid is added to the value at
+  // the nearest point of the grid.
+  class mesher_grid_distance : public mesher_signed_distance {
+    base_node x0; base_small_vector h;
+    std::vector<size_type> nb;
+    base_vector values;
+    scalar_type interpolate(const base_node &P, base_small_vector *G) const;
+  public:
+    mesher_grid_distance(const base_node &x0_, const base_small_vector &h_,
+                         const std::vector<size_type> &nb_,
+                         const base_vector &values_);
+    bool bounding_box(base_node &, base_node &) const
+    { return false; }
+    virtual scalar_type operator()(const base_node &P) const
+    { return interpolate(P, 0); }
+    virtual scalar_type operator()(const base_node &P,
+                                   dal::bit_vector &bv) const {
+      scalar_type d = interpolate(P, 0);
+      bv[id] = (gmm::abs(d) < SEPS);
+      return d;
+    }
+    virtual void register_constraints(std::vector<const
+                                      mesher_signed_distance*>& list) const {
+      id = list.size(); list.push_back(this);
+    }
+    scalar_type grad(const base_node &P, base_small_vector &G) const
+    { return interpolate(P, &G); }
+    void hess(const base_node &, base_matrix &) const {
+      GMM_ASSERT1(false, "Sorry, to be done");
+    }
+  };
+
+  inline pmesher_signed_distance new_mesher_grid_distance
+  (const base_node &x0, const base_small_vector &h,
+   const std::vector<size_type> &nb, const base_vector &values)
+  { return std::make_shared<mesher_grid_distance>(x0, h, nb, values); }
+
+  // Signed distance to a closed triangulated surface (to a closed polygonal
+  // line in 2D). Each face is given by the indices of its N vertices. The
+  // faces are oriented such that the normal (b-a)x(c-a) (resp. the normal
+  // (b[1]-a[1], a[0]-b[0]) in 2D) is the outward one. The nearest face is
+  // searched in a tree of the face bounding boxes and the sign is given by
+  // angle weighted pseudo-normals.
+  class mesher_triangulated_surface : public mesher_signed_distance {
+    size_type N;
+    std::vector<base_node> pts;
+    std::vector<size_type> faces;              // N vertices per face
+    std::vector<base_small_vector> fnormals;   // Unit face normals
+    std::vector<base_small_vector> vnormals;   // Vertex pseudo-normals
+    std::map<std::pair<size_type, size_type>, base_small_vector> enormals;
+                                               // Edge pseudo-normals (3D)
+    base_node bmin, bmax;
+    scalar_type hmean;                         // Mean size of the faces
+    mutable bgeot::rtree face_tree;
+    scalar_type distance(const base_node &P, base_small_vector *G) const;
+  public:
+    mesher_triangulated_surface(const std::vector<base_node> &pts_,
+                                const std::vector<size_type> &faces_);
+    bool bounding_box(base_node &bmin_, base_node &bmax_) const
+    { bmin_ = bmin; bmax_ = bmax; return true; }
+    virtual scalar_type operator()(const base_node &P) const
+    { return distance(P, 0); }
+    virtual scalar_type operator()(const base_node &P,
+                                   dal::bit_vector &bv) const {
+      scalar_type d = distance(P, 0);
+      bv[id] = (gmm::abs(d) < SEPS);
+      return d;
+    }
+    virtual void register_constraints(std::vector<const
+                                      mesher_signed_distance*>& list) const {
+      id = list.size(); list.push_back(this);
+    }
+    scalar_type grad(const base_node &P, base_small_vector &G) const
+    { return distance(P, &G); }
+    void hess(const base_node &, base_matrix &) const {
+      GMM_ASSERT1(false, "Sorry, to be done");
+    }
+  };
+
+  inline pmesher_signed_distance new_mesher_triangulated_surface
+  (const std::vector<base_node> &pts, const std::vector<size_type> &faces)
+  { return std::make_shared<mesher_triangulated_surface>(pts, faces); }
   
-  // mesher
+  /* mesher. The points are moved in parallel. In 2D, when the points have
+     only moved since the last triangulation, it is repaired by edge flips
+     (see delaunay_by_flips below). In 3D, and when points are added or
+     removed, the Delaunay triangulation is rebuilt by qhull at each
+     retriangulation, which dominates the cost for large meshes. */
   void build_mesh(mesh &m, const pmesher_signed_distance& dist_,
 		  scalar_type h0, const std::vector<base_node> &fixed_points
 		  = std::vector<base_node>(), size_type K = 1, int noise = -1,
@@ -1077,6 +1214,24 @@ namespace getfem {
 		  scalar_type boundary_threshold_flatness = 0.11);
 
   // exported functions
+
+  /* Evaluation of a signed distance on a set of points, shared between the
+     threads (the distance is evaluated by blocks of points with
+     mesher_signed_distance::eval). */
+  void eval_signed_distance(const mesher_signed_distance &dist,
+			    const std::vector<base_node> &P, base_vector &d);
+  /* Restores the Delaunay property of the 2D triangulation t (one column
+     per triangle) of the points pts by edge flips, after the points have
+     been moved. orient gives the sign of the orientation of each triangle
+     before the motion. Returns false if the triangles are not a
+     triangulation anymore (a triangle has been flattened, or inverted
+     relatively to orient). On success, the triangles are counterclockwise
+     and orient is updated accordingly. h is the typical size of the
+     triangles. */
+  bool delaunay_by_flips(const std::vector<base_node> &pts,
+			 gmm::dense_matrix<size_type> &t,
+			 std::vector<int> &orient, scalar_type h,
+			 size_type *nbflips = 0);
   bool try_projection(const mesher_signed_distance& dist, base_node &X,
 		      bool on_surface = false);
   bool pure_multi_constraint_projection
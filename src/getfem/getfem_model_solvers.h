@@ -880,6 +880,149 @@ namespace getfem {
 
   void standard_solve(model &md, gmm::iteration &iter);
 
+
+  //---------------------------------------------------------------------
+  // Explicit central difference scheme.
+  //---------------------------------------------------------------------
+
+  /** Explicit central difference (leapfrog) time integration of
+      M d^2u/dt^2 = F(u, t) for the variable `varname` of a real model,
+      F(u, t) being the right hand side of the model (i.e. the opposite of
+      its residual). M is the row-sum lumped mass matrix for the density
+      `dataexpr_rho`, assembled once on `mim`. A step only needs the
+      assembly of the right hand side of the model: no tangent matrix is
+      built and no linear system is solved. The scheme is conditionally
+      stable (see explicit_stable_time_step).
+
+      The model should have no other unknown than `varname`. Dirichlet
+      conditions can be prescribed by penalization, which reduces the
+      stable time step.
+
+      @ingroup bricks
+  */
+  class APIDECL explicit_central_difference {
+    model &md;
+    std::string varname;
+    model_real_plain_vector M, V, A;
+    bool acceleration_computed;
+
+    void compute_acceleration();
+
+  public:
+
+    /** Performs a step of size md.get_time_step(): updates the variable,
+        its velocity and the time of the model. */
+    void next_step();
+
+    /** Lumped mass. */
+    const model_real_plain_vector &lumped_mass() const { return M; }
+    /** Velocity at the current time (zero at the start). */
+    const model_real_plain_vector &velocity() const { return V; }
+    /** Gives a write access to the velocity, to set an initial velocity. */
+    model_real_plain_vector &set_velocity() { return V; }
+    /** Acceleration at the current time, once a step has been done. */
+    const model_real_plain_vector &acceleration() const { return A; }
+
+    explicit_central_difference(model &md, const std::string &varname,
+                                const mesh_im &mim,
+                                const std::string &dataexpr_rho
+                                = std::string("1"),
+                                size_type region = size_type(-1));
+  };
+
+  /** Rough estimate of the critical time step of the explicit central
+      difference scheme for the fem `mf`, `c` being the speed of the
+      fastest wave (for instance sqrt((lambda+2mu)/rho) for linearized
+      elasticity). It is the minimum on the elements of h/(c k), where h is
+      a lower estimate of the height of the element and k the degree of the
+      fem. A safety factor has to be applied.
+  */
+  scalar_type APIDECL explicit_stable_time_step
+  (const mesh_fem &mf, scalar_type c,
+   const mesh_region &rg = mesh_region::all_convexes());
+
+  //---------------------------------------------------------------------
+  // Adaptive time stepping.
+  //---------------------------------------------------------------------
+
+  /** Adaptive control of the time step of a real model using one of the
+      implicit time integration schemes (theta-method, Newmark ...).
+
+      Each step starts from a predictor for the unknowns of the model, which
+      is the linear extrapolation of the last two accepted states (the last
+      state for the first step), also used as initial guess for the Newton
+      method. The difference between the predictor and the solution on the
+      variable `varname` gives the error estimate
+        err = sqrt(1/n sum_i ((U_i - Up_i)/(atol + rtol |U_i|))^2).
+      A step is rejected if err > 1 or if the solver does not converge. The
+      unknowns and the time of the model are then restored and the step is
+      done again with a smaller time step. When a step is accepted,
+      shift_variables_for_time_integration() is called and the next time
+      step is set to dt*safety*err^(-1/(q+1)) (q = 1 with the linear
+      predictor, 0 for the first step), bounded by the growth and
+      reduction factors, and reduced if the Newton method needed more than
+      a target number of iterations.
+
+      Only the unknowns of the model are restored after a rejected step:
+      data updated by the user or by some bricks during the step (internal
+      variables for instance) are not.
+
+      @ingroup bricks
+  */
+  class APIDECL adaptive_time_stepping {
+    model &md;
+    std::string varname;
+    scalar_type rtol, atol, dt_min, dt_max, safety, fac_min, fac_max;
+    size_type newton_target;
+    model_real_plain_vector U0, U1; // States at the last two accepted steps
+    scalar_type dt_prev;
+    bool has_history;
+
+    size_type nb_accepted, nb_rejected, nb_failures, nb_iter;
+    scalar_type dt_min_used, dt_max_used;
+
+    scalar_type error_estimate(const model_real_plain_vector &U,
+                               const model_real_plain_vector &Up) const;
+
+  public:
+
+    /** Performs an accepted step, starting with the time step
+        md.get_time_step() and redoing it with a smaller time step as long
+        as it is rejected. Returns the size of the accepted step and sets
+        the time step of the model to the proposal for the next one.
+    */
+    scalar_type next_step(gmm::iteration &iter, rmodel_plsolver_type lsolver,
+                          abstract_newton_line_search &ls);
+    scalar_type next_step(gmm::iteration &iter);
+
+    /** Bounds of the time step. The default ones are 0 and infinity. */
+    void set_time_step_bounds(scalar_type dtmin, scalar_type dtmax)
+    { dt_min = dtmin; dt_max = dtmax; }
+    /** Bounds of the ratio between two consecutive time steps (default
+        0.2 and 5) and safety factor applied to the optimal ratio
+        (default 0.9). */
+    void set_step_factors(scalar_type fmin, scalar_type fmax,
+                          scalar_type saf = scalar_type(0.9))
+    { fac_min = fmin; fac_max = fmax; safety = saf; }
+    /** Number of Newton iterations above which the time step is reduced
+        (default 8). */
+    void set_newton_target(size_type n) { newton_target = n; }
+
+    size_type nb_accepted_steps() const { return nb_accepted; }
+    size_type nb_rejected_steps() const { return nb_rejected; }
+    /** Number of rejected steps due to a non convergence of the solver. */
+    size_type nb_solver_failures() const { return nb_failures; }
+    /** Total number of solver iterations, rejected steps included. */
+    size_type nb_solver_iterations() const { return nb_iter; }
+    scalar_type min_accepted_time_step() const { return dt_min_used; }
+    scalar_type max_accepted_time_step() const { return dt_max_used; }
+    void print_statistics(std::ostream &ost = cout) const;
+
+    adaptive_time_stepping(model &md, const std::string &varname,
+                           scalar_type rtol = scalar_type(1E-3),
+                           scalar_type atol = scalar_type(1E-6));
+  };
+
 }  /* end of namespace getfem.                                             */
 
 
@@ -126,6 +126,16 @@ namespace getfem {
     mutable model_real_plain_vector rrhs;
     mutable model_complex_plain_vector crhs;
     mutable bool act_size_to_be_done;
+    // Sparsity pattern of the tangent matrix kept from one assembly to the
+    // next one while the sizes and the set of active bricks are unchanged.
+    mutable bool tangent_pattern_valid;
+    mutable dal::bit_vector tangent_pattern_bricks;
+    // For a linear model, the tangent matrix is not rebuilt as long as the
+    // matrices of the bricks and the factors applied to them are unchanged.
+    mutable bool tangent_matrix_reusable;
+    mutable gmm::uint64_type tangent_matrix_v_num;
+    mutable std::vector<scalar_type> tangent_matrix_coeffs;
+    mutable size_type nb_tangent_matrix_builds_;
     dim_type leading_dim;
     getfem::lock_factory locks_;
 
@@ -283,6 +293,7 @@ namespace getfem {
     struct brick_description {
       mutable bool terms_to_be_computed;
       mutable gmm::uint64_type v_num;
+      mutable gmm::uint64_type matrix_v_num; // Last change of the matrices
       pbrick pbr;                // brick pointer
       pdispatcher pdispatch;     // Optional dispatcher
       size_type nbrhs;           // Additional rhs for dispatcher.
@@ -310,12 +321,13 @@ namespace getfem {
       mutable std::vector<complex_veclist> cveclist_sym;  // additional rhs
       // for symmetric terms (real version).
 
-      brick_description() : v_num(0) {}
+      brick_description() : v_num(0), matrix_v_num(0) {}
 
       brick_description(pbrick p, const varnamelist &vl,
                         const varnamelist &dl, const termlist &tl,
                         const mimlist &mms, size_type reg)
-        : terms_to_be_computed(true), v_num(0), pbr(p), pdispatch(0), nbrhs(1),
+        : terms_to_be_computed(true), v_num(0), matrix_v_num(0), pbr(p),
+          pdispatch(0), nbrhs(1),
           vlist(vl), dlist(dl), tlist(tl), mims(mms), region(reg),
           is_update_brick(false), external_load(0),
           rveclist(1), rveclist_sym(1), cveclist(1),
@@ -384,7 +396,11 @@ namespace getfem {
     void brick_init(size_type ib, build_version version,
                     size_type rhs_ind = 0) const;
 
-    void init() { complex_version = false; act_size_to_be_done = false; }
+    void init() {
+      complex_version = false; act_size_to_be_done = false;
+      tangent_pattern_valid = tangent_matrix_reusable = false;
+      nb_tangent_matrix_builds_ = 0;
+    }
 
     void resize_global_system() const;
 
@@ -559,6 +575,12 @@ namespace getfem {
     /** Total number of degrees of freedom in the model. */
     size_type nb_dof() const;
 
+    /** Number of times the tangent matrix has been assembled. For a linear
+        model, it is not assembled again while the matrices of the bricks
+        are unchanged. */
+    size_type nb_tangent_matrix_builds() const
+    { return nb_tangent_matrix_builds_; }
+
     /** Leading dimension of the meshes used in the model. */
     dim_type leading_dimension() const { return leading_dim; }
 
@@ -949,6 +971,7 @@ namespace getfem {
     void touch_brick(size_type ib) {
       GMM_ASSERT1(valid_bricks[ib], "Inexistent brick");
       bricks[ib].terms_to_be_computed = true;
+      tangent_pattern_valid = false;
     }
 
     /** Add a brick to the model. varname is the list of variable used
@@ -134,6 +134,16 @@ namespace getfem
   inline bool me_is_multithreaded_now(){return false;}
 #endif
 
+  /**contiguous range [ibegin, iend) of the nb items statically attributed
+     to the current thread of a parallel region. The ranges follow the
+     thread numbers, which allows a deterministic merge of thread results.*/
+  inline void thread_range(size_type nb, size_type &ibegin, size_type &iend) {
+    size_type nbth = num_threads(), th = this_thread();
+    size_type chunk = nb / nbth, rem = nb % nbth;
+    ibegin = th * chunk + std::min(th, rem);
+    iend = ibegin + chunk + ((th < rem) ? 1 : 0);
+  }
+
 
 
   /**use this template class for any object you want to
@@ -384,6 +394,31 @@ namespace getfem
     std::vector<std::exception_ptr> exceptions_;
   };
 
+  /** Parallel loop for (i = 0; i < nb; ++i) f(i), each thread doing the
+      contiguous range of indices given by thread_range. The loop is done
+      by the calling thread alone when it is already in a parallel section.
+      The exceptions thrown by f are re-thrown in the calling thread. */
+  template <typename FUNC>
+  void open_mp_range_for(size_type nb, const FUNC &f) {
+    if (me_is_multithreaded_now() || nb < 2) {
+      for (size_type i = 0; i < nb; ++i) f(i);
+      return;
+    }
+    gmm::standard_locale locale;
+    open_mp_is_running_properly check;
+    thread_exception exception;
+#pragma omp parallel default(shared)
+    {
+      exception.run([&]
+      {
+        size_type ib, ie;
+        thread_range(nb, ib, ie);
+        for (size_type i = ib; i < ie; ++i) f(i);
+      });
+    }
+    exception.rethrow();
+  }
+
 
 }
 
@@ -23,6 +23,7 @@
 #include "getfem/getfem_generic_assembly.h"
 #ifndef _WIN32
 #include <unistd.h>
+#include <random>
 #endif
 
 namespace getfem {
@@ -56,6 +57,33 @@ namespace getfem {
       }
   }
 
+  // Pseudo-random values in [-1,1] for the perturbations of the projection
+  // and raytrace algorithms of the pair scan. The generator is seeded for
+  // each boundary point so that the result depends neither on the number
+  // of threads nor on the global rand() state.
+  static scalar_type point_random(std::minstd_rand &gen) {
+    return scalar_type(gen() - gen.min()) * scalar_type(2)
+      / scalar_type(gen.max() - gen.min()) - scalar_type(1);
+  }
+
+  static void fill_point_random(base_small_vector &v, std::minstd_rand &gen)
+  { for (size_type i = 0; i < v.size(); ++i) v[i] = point_random(gen); }
+
+  // Normal vector of a boundary point used for raytracing : the mean of
+  // its normal cone.
+  static base_small_vector
+  raytrace_normal(const std::vector<base_small_vector> &normals) {
+    base_small_vector nx = normals[0];
+    if (normals.size() > 1) {
+      for (size_type i = 1; i < normals.size(); ++i)
+        gmm::add(normals[i], nx);
+      scalar_type nnx = gmm::vect_norm2(nx);
+      GMM_ASSERT1(nnx != scalar_type(0), "Invalid normal cone");
+      gmm::scale(nx, scalar_type(1)/nnx);
+    }
+    return nx;
+  }
+
   //=========================================================================
   //
   //  Structure which store the contact boundaries, rigid obstacles and
@@ -155,6 +183,18 @@ namespace getfem {
     return false;
   }
 
+  bool multi_contact_frame::displacements_within_margin() const {
+    if (ref_Us.size() != Us.size()) return false;
+    if (ref_conf) return true;
+    for (size_type i = 0; i < Us.size(); ++i) {
+      const VECTOR &U = ext_Us[i], &U0 = ref_Us[i];
+      if (gmm::vect_size(U) != gmm::vect_size(U0)) return false;
+      for (size_type j = 0; j < gmm::vect_size(U); ++j)
+        if (gmm::abs(U[j] - U0[j]) > search_margin) return false;
+    }
+    return true;
+  }
+
   bool multi_contact_frame::are_dof_linked(size_type ib1, size_type idof1,
                                            size_type ib2, size_type idof2) {
     const mesh_fem &mf1 = mfdisp_of_boundary(ib1);
@@ -185,16 +225,39 @@ namespace getfem {
     return false;
   }
 
-  void multi_contact_frame::add_potential_contact_face
-  (size_type ip, size_type ib, size_type ie, short_type iff) {
-    bool found = false;
-    std::vector<face_info> &sfi = potential_pairs[ip];
-    for (size_type k = 0; k < sfi.size(); ++k)
-      if (sfi[k].ind_boundary == ib &&
-          sfi[k].ind_element == ie &&
-          sfi[k].ind_face == iff) found = true;
-
-    if (!found) sfi.push_back(face_info(ib, ie, iff));
+  void multi_contact_frame::set_potential_pairs
+  (const potential_pair_list &ppl) {
+    size_type nbpt = boundary_points.size();
+    potential_pairs_ptr.assign(nbpt+1, 0);
+    for (const auto &pp : ppl) ++(potential_pairs_ptr[pp.first+1]);
+    for (size_type ip = 0; ip < nbpt; ++ip)
+      potential_pairs_ptr[ip+1] += potential_pairs_ptr[ip];
+
+    // Stable counting sort with respect to the boundary point index
+    potential_faces.resize(ppl.size());
+    std::vector<size_type> pos(potential_pairs_ptr.begin(),
+                               potential_pairs_ptr.end()-1);
+    for (const auto &pp : ppl) potential_faces[pos[pp.first]++] = pp.second;
+
+    // Elimination of the duplicated faces of each point
+    size_type k = 0;
+    for (size_type ip = 0; ip < nbpt; ++ip) {
+      size_type kb = k;
+      for (size_type j = potential_pairs_ptr[ip];
+           j < potential_pairs_ptr[ip+1]; ++j) {
+        const face_info &fi = potential_faces[j];
+        bool found = false;
+        for (size_type l = kb; l < k; ++l)
+          if (potential_faces[l].ind_boundary == fi.ind_boundary &&
+              potential_faces[l].ind_element == fi.ind_element &&
+              potential_faces[l].ind_face == fi.ind_face)
+            { found = true; break; }
+        if (!found) potential_faces[k++] = fi;
+      }
+      potential_pairs_ptr[ip] = kb;
+    }
+    potential_pairs_ptr[nbpt] = k;
+    potential_faces.resize(k);
   }
 
   void multi_contact_frame::clear_aux_info() {
@@ -202,15 +265,27 @@ namespace getfem {
     boundary_points_info = std::vector<boundary_point>();
     element_boxes.clear();
     element_boxes_info = std::vector<influence_box>();
-    potential_pairs = std::vector<std::vector<face_info> >();
+    if (search_margin <= scalar_type(0)) {
+      potential_faces = std::vector<face_info>();
+      potential_pairs_ptr = std::vector<size_type>();
+    }
   }
 
+  // The Delaunay triangulation of qhull is used for the delaunay option 1
+  // when it is available, the bucket grid otherwise.
+#ifdef GETFEM_HAVE_LIBQHULL_QHULL_A_H
+  static const bool qhull_available = true;
+#else
+  static const bool qhull_available = false;
+#endif
+
   multi_contact_frame::multi_contact_frame(size_type NN, scalar_type r_dist,
-                                           bool dela, bool selfc,
+                                           int dela, bool selfc,
                                            scalar_type cut_a,
                                            bool rayt, int nmode, bool refc)
     : N(NN), self_contact(selfc), ref_conf(refc), use_delaunay(dela),
-      nodes_mode(nmode), raytrace(rayt), release_distance(r_dist),
+      nodes_mode(nmode), raytrace(rayt),
+      release_distance(r_dist), search_margin(0), nb_full_search(0),
       cut_angle(cut_a), EPS(1E-8), md(0), coordinates(N), pt(N) {
     if (N > 0) coordinates[0] = "x";
     if (N > 1) coordinates[1] = "y";
@@ -222,13 +297,13 @@ namespace getfem {
 
   multi_contact_frame::multi_contact_frame(const model &mdd, size_type NN,
                                            scalar_type r_dist,
-                                           bool dela, bool selfc,
+                                           int dela, bool selfc,
                                            scalar_type cut_a,
                                            bool rayt, int nmode, bool refc)
     : N(NN), self_contact(selfc), ref_conf(refc),
       use_delaunay(dela), nodes_mode(nmode), raytrace(rayt),
-      release_distance(r_dist), cut_angle(cut_a), EPS(1E-8), md(&mdd),
-      coordinates(N), pt(N) {
+      release_distance(r_dist), search_margin(0), nb_full_search(0),
+      cut_angle(cut_a), EPS(1E-8), md(&mdd), coordinates(N), pt(N) {
     if (N > 0) coordinates[0] = "x";
     if (N > 1) coordinates[1] = "y";
     if (N > 2) coordinates[2] = "z";
@@ -253,9 +328,122 @@ namespace getfem {
     }
     obstacles_f.push_back(ga_function(obstacles_gw.back(), obs));
     obstacles_f.back().compile();
+    obstacles_sd.push_back(pmesher_signed_distance());
     return ind;
   }
 
+  size_type multi_contact_frame::add_obstacle
+  (const pmesher_signed_distance &obs) {
+    GMM_ASSERT1(obs, "Invalid obstacle");
+    size_type ind = obstacles.size();
+    obstacles.push_back("");
+    obstacles_velocities.push_back("");
+    obstacles_f.push_back(ga_function());
+    obstacles_sd.push_back(obs);
+    return ind;
+  }
+
+  scalar_type multi_contact_frame::obstacle_value(size_type i,
+                                                  const base_node &P) {
+    if (obstacles_sd[i]) return (*(obstacles_sd[i]))(P);
+    gmm::copy(P, pt);
+    switch(N) {
+    default:
+    case 4: ptw[0] = pt[3];
+    case 3: ptz[0] = pt[2];
+    case 2: pty[0] = pt[1];
+    case 1: ptx[0] = pt[0];
+    }
+    return (obstacles_f[i].eval())[0];
+  }
+
+  void multi_contact_frame::obstacle_gradient(size_type i, const base_node &P,
+                                              scalar_type d,
+                                              base_small_vector &G) {
+    if (obstacles_sd[i]) { obstacles_sd[i]->grad(P, G); return; }
+    // Finite difference approximation for an expression
+    base_node P2(P);
+    for (size_type k = 0; k < N; ++k) {
+      P2[k] += EPS;
+      G[k] = (obstacle_value(i, P2) - d) / EPS;
+      P2[k] -= EPS;
+    }
+  }
+
+  bool multi_contact_frame::analytic_obstacles() const {
+    for (size_type i = 0; i < obstacles_sd.size(); ++i)
+      if (!(obstacles_sd[i])) return false;
+    return true;
+  }
+
+  int multi_contact_frame::rigid_obstacle_pair(size_type ip,
+                                               const base_small_vector &nx,
+                                               const scalar_type *d,
+                                               contact_pair &ct) {
+    const base_node &x = boundary_points[ip];
+    const boundary_point &bpinfo = boundary_points_info[ip];
+    scalar_type d0 = 1E300, d1, d2(0);
+    size_type irigid_obstacle(-1);
+    base_node P(N), y(N);
+    base_small_vector ny(N);
+
+    // Detect here the nearest rigid obstacle (taking into account
+    // the release distance)
+    for (size_type i = 0; i < obstacles.size(); ++i) {
+      d1 = d[i];
+      if (gmm::abs(d1) < release_distance && d1 < d0) {
+        for (size_type j=0; j < bpinfo.normals.size(); ++j) {
+          gmm::add(x, gmm::scaled(bpinfo.normals[j], EPS), P);
+          d2 = obstacle_value(i, P);
+          if (d2 < d1) { d0 = d1; irigid_obstacle = i; break; }
+        }
+      }
+    }
+    if (irigid_obstacle == size_type(-1)) return 0;
+
+    gmm::copy(x, P);
+    gmm::copy(x, y);
+    size_type nit = 0, nb_fail = 0;
+    scalar_type alpha(0), beta(0);
+    d1 = d0;
+
+    while (++nit < 50 && nb_fail < 3) {
+      obstacle_gradient(irigid_obstacle, P, d1, ny);
+
+      if (gmm::abs(d1) < 1E-13)
+        break; // point already lies on the rigid obstacle surface
+
+      // ajouter un test de divergence ...
+      for (scalar_type lambda(1); lambda >= 1E-3; lambda /= scalar_type(2)) {
+        if (raytrace) {
+          alpha = beta - lambda * d1 / gmm::vect_sp(ny, nx);
+          gmm::add(x, gmm::scaled(nx, alpha), P);
+        } else {
+          gmm::add(gmm::scaled(ny, -d1/gmm::vect_norm2_sqr(ny)), y, P);
+        }
+        d2 = obstacle_value(irigid_obstacle, P);
+        if (gmm::abs(d2) < gmm::abs(d1)) break;
+      }
+      if (raytrace &&
+          gmm::abs(beta - d1 / gmm::vect_sp(ny, nx)) > scalar_type(500))
+        nb_fail++;
+      gmm::copy(P, y); beta = alpha; d1 = d2;
+    }
+
+    if (gmm::abs(d1) > 1E-8) {
+      GMM_WARNING1("Projection/raytrace on rigid obstacle failed");
+      return 2;
+    }
+
+    // CRITERION 4 for rigid bodies : Apply the release distance
+    if (gmm::vect_dist2(y, x) > release_distance) return 2;
+
+    ny /= gmm::vect_norm2(ny);
+    d0 = gmm::vect_dist2(y, x) * gmm::sgn(d0);
+    ct = contact_pair(x, nx, bpinfo, y, ny, irigid_obstacle, d0);
+    return 1;
+  }
+
 
 
   size_type multi_contact_frame::add_master_boundary
@@ -276,6 +464,7 @@ namespace getfem {
     contact_boundary cb(reg, mfu, mim, add_U(U, vvarname, w, wname),
                         mflambda, add_lambda(lambda, mmultname));
     contact_boundaries.push_back(cb);
+    ref_Us = std::vector<VECTOR>();
     return size_type(contact_boundaries.size() - 1);
   }
 
@@ -446,111 +635,281 @@ namespace getfem {
       }
   }
 
-  void multi_contact_frame::compute_potential_contact_pairs_delaunay() {
+  void multi_contact_frame::add_potential_pairs_of_points
+  (potential_pair_list &ppl, size_type ipt1, size_type ipt2) {
+    boundary_point *pt_info1 = &(boundary_points_info[ipt1]);
+    boundary_point *pt_info2 = &(boundary_points_info[ipt2]);
+    size_type ib1 = pt_info1->ind_boundary;
+    size_type ib2 = pt_info2->ind_boundary;
+    bool sl1 = is_slave_boundary(ib1);
+    bool sl2 = is_slave_boundary(ib2);
+    if (!sl1 && sl2) { // The slave in first if any
+      std::swap(ipt1, ipt2);
+      std::swap(pt_info1, pt_info2);
+      std::swap(ib1, ib2);
+      std::swap(sl1, sl2);
+    }
+    size_type ir1 = region_of_boundary(ib1);
+    size_type ir2 = region_of_boundary(ib2);
+    const mesh_fem &mf1 = mfdisp_of_boundary(ib1);
+    const mesh_fem &mf2 = mfdisp_of_boundary(ib2);
 
-    compute_boundary_points();
-    normal_cone_simplification();
-    potential_pairs = std::vector<std::vector<face_info> >();
-    potential_pairs.resize(boundary_points.size());
-
-    gmm::dense_matrix<size_type> simplexes;
-    base_small_vector rr(N);
-    // Necessary ?
-    // for (size_type i = 0; i < boundary_points.size(); ++i) {
-    //   gmm::fill_random(rr);
-    //   boundary_points[i] += 1E-9*rr;
-    // }
-    bgeot::qhull_delaunay(boundary_points, simplexes);
-
-    // connectivity analysis
-    for (size_type is = 0; is < gmm::mat_ncols(simplexes); ++is) {
-
-      for (size_type i = 1; i <= N; ++i)
-        for (size_type j = 0; j < i; ++j) {
-          size_type ipt1 = simplexes(i, is), ipt2 = simplexes(j, is);
-          boundary_point *pt_info1 = &(boundary_points_info[ipt1]);
-          boundary_point *pt_info2 = &(boundary_points_info[ipt2]);
-          size_type ib1 = pt_info1->ind_boundary;
-          size_type ib2 = pt_info2->ind_boundary;
-          bool sl1 = is_slave_boundary(ib1);
-          bool sl2 = is_slave_boundary(ib2);
-          if (!sl1 && sl2) { // The slave in first if any
-            std::swap(ipt1, ipt2);
-            std::swap(pt_info1, pt_info2);
-            std::swap(ib1, ib2);
-            std::swap(sl1, sl2);
+    // CRITERION 1 : The unit normal cone / vector are compatible
+    //               and the two points are not in the same element.
+    if (
+        // slave-master case
+        ((sl1 && !sl2)
+         // master-master self-contact case
+         || (self_contact && !sl1 && !sl2))
+        // test of unit normal vectors or cones (not done when the pairs
+        // are kept for the next searches, see search_margin)
+        && (search_margin > scalar_type(0)
+            || test_normal_cones_compatibility(pt_info1->normals,
+                                               pt_info2->normals))
+        // In case of self-contact, test if the two points share the
+        // same element.
+        && (sl1
+            || ((nodes_mode < 2)
+                && (( &(mf1.linked_mesh()) != &(mf2.linked_mesh()))
+                    || (pt_info1->ind_element != pt_info2->ind_element)))
+            || ((nodes_mode == 2)
+                && !(are_dof_linked(ib1, pt_info1->ind_pt,
+                                    ib2, pt_info2->ind_pt)))
+            )
+        ) {
+
+      // Store the potential contact pairs
+
+      if (boundary_has_fem_nodes(sl2, nodes_mode)) {
+        const mesh::ind_cv_ct &ic2
+          = mf2.convex_to_basic_dof(pt_info2->ind_pt);
+        for (size_type k = 0; k < ic2.size(); ++k) {
+          mesh_region::face_bitset fbs
+            = mf2.linked_mesh().region(ir2).faces_of_convex(ic2[k]);
+          short_type nbf = mf2.linked_mesh().nb_faces_of_convex(ic2[k]);
+          for (short_type f = 0; f < nbf; ++f)
+            if (fbs.test(f))
+              add_potential_contact_face(ppl, ipt1,
+                                         pt_info2->ind_boundary,
+                                         ic2[k], f);
+        }
+      } else
+        add_potential_contact_face(ppl, ipt1, pt_info2->ind_boundary,
+                                   pt_info2->ind_element,
+                                   pt_info2->ind_face);
+
+      if (self_contact && !sl1 && !sl2) {
+        if (boundary_has_fem_nodes(sl2, nodes_mode)) {
+          const mesh::ind_cv_ct &ic1
+            = mf1.convex_to_basic_dof(pt_info1->ind_pt);
+          for (size_type k = 0; k < ic1.size(); ++k) {
+            mesh_region::face_bitset fbs
+              = mf1.linked_mesh().region(ir1).faces_of_convex(ic1[k]);
+            short_type nbf = mf1.linked_mesh().nb_faces_of_convex(ic1[k]);
+            for (short_type f = 0; f < nbf; ++f)
+              if (fbs.test(f))
+                add_potential_contact_face(ppl, ipt2,
+                                           pt_info1->ind_boundary,
+                                           ic1[k], f);
           }
-          size_type ir1 = region_of_boundary(ib1);
-          size_type ir2 = region_of_boundary(ib2);
-          const mesh_fem &mf1 = mfdisp_of_boundary(ib1);
-          const mesh_fem &mf2 = mfdisp_of_boundary(ib2);
-
-          // CRITERION 1 : The unit normal cone / vector are compatible
-          //               and the two points are not in the same element.
-          if (
-              // slave-master case
-              ((sl1 && !sl2)
-               // master-master self-contact case
-               || (self_contact && !sl1 && !sl2))
-              // test of unit normal vectors or cones
-              && test_normal_cones_compatibility(pt_info1->normals,
-                                                 pt_info2->normals)
-              // In case of self-contact, test if the two points share the
-              // same element.
-              && (sl1
-                  || ((nodes_mode < 2)
-                      && (( &(mf1.linked_mesh()) != &(mf2.linked_mesh()))
-                          || (pt_info1->ind_element != pt_info2->ind_element)))
-                  || ((nodes_mode == 2)
-                      && !(are_dof_linked(ib1, pt_info1->ind_pt,
-                                          ib2, pt_info2->ind_pt)))
-                  )
-              ) {
-
-            // Store the potential contact pairs
-
-            if (boundary_has_fem_nodes(sl2, nodes_mode)) {
-              const mesh::ind_cv_ct &ic2
-                = mf2.convex_to_basic_dof(pt_info2->ind_pt);
-              for (size_type k = 0; k < ic2.size(); ++k) {
-                mesh_region::face_bitset fbs
-                  = mf2.linked_mesh().region(ir2).faces_of_convex(ic2[k]);
-                short_type nbf = mf2.linked_mesh().nb_faces_of_convex(ic2[k]);
-                for (short_type f = 0; f < nbf; ++f)
-                  if (fbs.test(f))
-                    add_potential_contact_face(ipt1,
-                                               pt_info2->ind_boundary,
-                                               ic2[k], f);
-              }
-            } else
-              add_potential_contact_face(ipt1, pt_info2->ind_boundary,
-                                         pt_info2->ind_element,
-                                         pt_info2->ind_face);
-
-            if (self_contact && !sl1 && !sl2) {
-              if (boundary_has_fem_nodes(sl2, nodes_mode)) {
-                const mesh::ind_cv_ct &ic1
-                  = mf1.convex_to_basic_dof(pt_info1->ind_pt);
-                for (size_type k = 0; k < ic1.size(); ++k) {
-                  mesh_region::face_bitset fbs
-                    = mf1.linked_mesh().region(ir1).faces_of_convex(ic1[k]);
-                  short_type nbf = mf1.linked_mesh().nb_faces_of_convex(ic1[k]);
-                  for (short_type f = 0; f < nbf; ++f)
-                    if (fbs.test(f))
-                      add_potential_contact_face(ipt2,
-                                                 pt_info1->ind_boundary,
-                                                 ic1[k], f);
-                }
-              } else
-                add_potential_contact_face(ipt2, pt_info1->ind_boundary,
-                                           pt_info1->ind_element,
-                                           pt_info1->ind_face);
-            }
+        } else
+          add_potential_contact_face(ppl, ipt2, pt_info1->ind_boundary,
+                                     pt_info1->ind_element,
+                                     pt_info1->ind_face);
+      }
 
-          }
+    }
+  }
+
+  namespace {
+
+  // Bucket grid on a set of points for the search of the points lying at a
+  // given distance of a point. The points are sorted with respect to the
+  // index of the cell containing them. When the grid is updated with the
+  // same points which stayed in the grid bounds (the bounding box of the
+  // points enlarged by one cell), the cells are kept and the storage is
+  // only sorted again if some points changed of cell.
+  class point_bucket_grid {
+    size_type N;
+    base_node pmin;
+    scalar_type h0, h;    // Asked and actual size of the cells
+    size_type nc[4];
+    std::vector<size_type> ind_pts;
+    std::vector<std::pair<size_type, size_type> > sorted; // (cell, point)
+
+    size_type cell_coord(const base_node &P, size_type k) const {
+      scalar_type c = (P[k] - pmin[k]) / h;
+      if (c <= scalar_type(0)) return 0;
+      return std::min(size_type(c), nc[k]-1);
+    }
+
+    size_type cell_of(const base_node &P) const {
+      size_type c = 0;
+      for (size_type k = N; k > 0; --k) c = c * nc[k-1] + cell_coord(P, k-1);
+      return c;
+    }
+
+    bool in_bounds(const base_node &P) const {
+      for (size_type k = 0; k < N; ++k)
+        if (P[k] < pmin[k] || P[k] > pmin[k] + scalar_type(nc[k]) * h)
+          return false;
+      return true;
+    }
+
+    void set_cells(const std::vector<base_node> &pts) {
+      base_node pmax = pmin = pts[ind_pts[0]];
+      for (size_type i : ind_pts)
+        for (size_type k = 0; k < N; ++k) {
+          pmin[k] = std::min(pmin[k], pts[i][k]);
+          pmax[k] = std::max(pmax[k], pts[i][k]);
+        }
+      // Enlarge the cells if the number of cells overflows
+      for (h = h0;; h *= scalar_type(2)) {
+        scalar_type nbc(1);
+        for (size_type k = 0; k < N; ++k) {
+          nc[k] = size_type((pmax[k] - pmin[k]) / h) + 3;
+          nbc *= scalar_type(nc[k]);
+        }
+        if (nbc < 1E15) break;
+      }
+      for (size_type k = 0; k < N; ++k) pmin[k] -= h;
+      sorted.resize(ind_pts.size());
+      for (size_type i = 0; i < ind_pts.size(); ++i)
+        sorted[i] = std::make_pair(size_type(-1), ind_pts[i]);
+    }
+
+  public:
+    // Set the grid on the points pts[ind[i]] with cells of size h_.
+    void update(const std::vector<base_node> &pts,
+                const std::vector<size_type> &ind, scalar_type h_) {
+      if (!ind.size()) { ind_pts.resize(0); sorted.resize(0); return; }
+      bool keep = (h_ == h0 && N == pts[ind[0]].size() && ind == ind_pts);
+      for (size_type i = 0; keep && i < ind.size(); ++i)
+        keep = in_bounds(pts[ind[i]]);
+      if (!keep) {
+        GMM_ASSERT1(pts[ind[0]].size() <= 4 && h_ > scalar_type(0),
+                    "Invalid bucket grid");
+        N = pts[ind[0]].size(); h0 = h_; ind_pts = ind;
+        set_cells(pts);
+      }
+      bool moved = false;
+      for (auto &c : sorted) {
+        size_type cell = cell_of(pts[c.second]);
+        if (cell != c.first) { c.first = cell; moved = true; }
+      }
+      if (moved) std::sort(sorted.begin(), sorted.end());
+    }
+
+    // Indices of the points at a distance less than or equal to d of P.
+    void points_around(const std::vector<base_node> &pts, const base_node &P,
+                       scalar_type d, std::vector<size_type> &ind) const {
+      ind.resize(0);
+      if (!sorted.size()) return;
+      size_type r = size_type(std::ceil(d / h)), cmin[4], cmax[4], c[4];
+      for (size_type k = 0; k < N; ++k) {
+        if (P[k] < pmin[k] - d || P[k] > pmin[k] + scalar_type(nc[k])*h + d)
+          return;
+        size_type ck = cell_coord(P, k);
+        cmin[k] = (ck > r) ? ck-r : 0;
+        cmax[k] = std::min(ck+r, nc[k]-1);
+        c[k] = cmin[k];
+      }
+      scalar_type d2 = d * d;
+      for (;;) {
+        size_type cell = 0;
+        for (size_type k = N; k > 0; --k) cell = cell * nc[k-1] + c[k-1];
+        auto it = std::lower_bound(sorted.begin(), sorted.end(),
+                                   std::make_pair(cell, size_type(0)));
+        for (; it != sorted.end() && it->first == cell; ++it)
+          if (gmm::vect_dist2_sqr(pts[it->second], P) <= d2)
+            ind.push_back(it->second);
+        size_type k = 0;
+        for (; k < N; ++k) {
+          if (c[k] < cmax[k]) { ++(c[k]); break; }
+          c[k] = cmin[k];
+        }
+        if (k == N) break;
+      }
+    }
+
+    point_bucket_grid() : N(0), h0(0), h(0) {}
+  };
 
+  }
+
+  struct multi_contact_frame::bucket_grid : public point_bucket_grid {};
+
+  scalar_type multi_contact_frame::master_faces_diameter() const {
+    scalar_type h(0);
+    for (size_type i = 0; i < contact_boundaries.size(); ++i)
+      if (self_contact || !is_slave_boundary(i)) {
+        const mesh &m = mfdisp_of_boundary(i).linked_mesh();
+        base_node bmin(N), bmax(N);
+        for (mr_visitor v(m.region(region_of_boundary(i)), m);
+             !v.finished(); ++v) {
+          mesh::ref_mesh_face_pt_ct pts
+            = m.points_of_face_of_convex(v.cv(), v.f());
+          bmin = bmax = pts[0];
+          for (size_type j = 1; j < pts.size(); ++j)
+            for (size_type k = 0; k < N; ++k) {
+              bmin[k] = std::min(bmin[k], pts[j][k]);
+              bmax[k] = std::max(bmax[k], pts[j][k]);
+            }
+          h = std::max(h, gmm::vect_dist2(bmin, bmax));
         }
+      }
+    return h;
+  }
+
+  void multi_contact_frame::compute_potential_contact_pairs_delaunay() {
+
+    compute_boundary_points();
+    normal_cone_simplification();
+    potential_pair_list ppl;
+
+    if (use_delaunay == 1 && qhull_available) {
+      gmm::dense_matrix<size_type> simplexes;
+      base_small_vector rr(N);
+      // Necessary ?
+      // for (size_type i = 0; i < boundary_points.size(); ++i) {
+      //   gmm::fill_random(rr);
+      //   boundary_points[i] += 1E-9*rr;
+      // }
+      bgeot::qhull_delaunay(boundary_points, simplexes);
+
+      // connectivity analysis
+      for (size_type is = 0; is < gmm::mat_ncols(simplexes); ++is)
+        for (size_type i = 1; i <= N; ++i)
+          for (size_type j = 0; j < i; ++j)
+            add_potential_pairs_of_points(ppl, simplexes(i, is),
+                                          simplexes(j, is));
+    } else {
+      // Connection of the points closer than the release distance plus the
+      // diameter of the master faces (with a security coefficient of 1.3
+      // for the deformation and the search margin).
+      // The grid contains the master points only and the cells are not
+      // larger than the release distance (nor smaller than the half of the
+      // search distance, which bounds the number of cells to be scanned).
+      scalar_type d = release_distance + scalar_type(2) * search_margin
+        + scalar_type(1.3) * master_faces_diameter();
+      std::vector<size_type> ind;
+      for (size_type ip = 0; ip < boundary_points.size(); ++ip)
+        if (!is_slave_boundary(boundary_points_info[ip].ind_boundary))
+          ind.push_back(ip);
+      if (!pgrid) pgrid = std::make_shared<bucket_grid>();
+      pgrid->update(boundary_points, ind,
+                    std::max(release_distance, d / scalar_type(2)));
+      for (size_type ip = 0; ip < boundary_points.size(); ++ip) {
+        bool slave = is_slave_boundary(boundary_points_info[ip].ind_boundary);
+        if (!slave && !self_contact) continue;
+        pgrid->points_around(boundary_points, boundary_points[ip], d, ind);
+        for (size_type j = 0; j < ind.size(); ++j)
+          if (slave || ind[j] > ip)
+            add_potential_pairs_of_points(ppl, ip, ind[j]);
+      }
     }
+
+    set_potential_pairs(ppl);
   }
 
 
@@ -643,8 +1002,11 @@ namespace getfem {
                          "adapt the release distance.");
             avert = true;
           }
+          // The box is also enlarged by twice the search margin (the face
+          // and the boundary point may both move of the margin).
+          scalar_type dist = release_distance + scalar_type(2)*search_margin;
           for (size_type k = 0; k < N; ++k)
-            { bmin[k] -= release_distance; bmax[k] += release_distance; }
+            { bmin[k] -= dist; bmax[k] += dist; }
 
           // Store the influence box and additional information.
           element_boxes.add_box(bmin, bmax, element_boxes_info.size());
@@ -658,45 +1020,72 @@ namespace getfem {
     compute_influence_boxes();
     compute_boundary_points(!self_contact); // vraiment necessaire ?
     normal_cone_simplification();
-    potential_pairs = std::vector<std::vector<face_info> >();
-    potential_pairs.resize(boundary_points.size());
-
-    for (size_type ip = 0; ip < boundary_points.size(); ++ip) {
 
-      bgeot::rtree::pbox_set bset;
-      element_boxes.find_boxes_at_point(boundary_points[ip], bset);
-      boundary_point *pt_info = &(boundary_points_info[ip]);
-      const mesh_fem &mf1 = mfdisp_of_boundary(pt_info->ind_boundary);
-      size_type ib1 = pt_info->ind_boundary;
-
-      bgeot::rtree::pbox_set::iterator it = bset.begin();
-      for (; it != bset.end(); ++it) {
-        influence_box &ibx = element_boxes_info[(*it)->id];
-        size_type ib2 = ibx.ind_boundary;
-        const mesh_fem &mf2 = mfdisp_of_boundary(ib2);
-
-        // CRITERION 1 : The unit normal cone / vector are compatible
-        //               and the two points are not in the same element.
-        if (
-            test_normal_cones_compatibility(ibx.mean_normal,
-                                            pt_info->normals)
-            // In case of self-contact, test if the points and the face
-            // share the same element.
-            && (((nodes_mode < 2)
-                 && (( &(mf1.linked_mesh()) != &(mf2.linked_mesh()))
-                     || (pt_info->ind_element != ibx.ind_element)))
-                || ((nodes_mode == 2)
-                    && !(is_dof_linked(ib1, pt_info->ind_pt,
-                                       ibx.ind_boundary, ibx.ind_element)))
-                )
-            ) {
-
-          add_potential_contact_face(ip, ibx.ind_boundary, ibx.ind_element,
-                                     ibx.ind_face);
+    // Lazily built structures are built before the parallel section
+    element_boxes.build_tree();
+    for (size_type i = 0; i < contact_boundaries.size(); ++i)
+      mfdisp_of_boundary(i).nb_basic_dof();
+
+    omp_distribute<potential_pair_list> ppls;
+    gmm::standard_locale locale;
+    open_mp_is_running_properly check;
+    thread_exception exception;
+    #pragma omp parallel default(shared)
+    {
+      exception.run([&]
+      {
+        potential_pair_list &ppl = ppls.thrd_cast();
+        bgeot::rtree::pbox_cont bset;
+        size_type ipb, ipe;
+        thread_range(boundary_points.size(), ipb, ipe);
+
+        for (size_type ip = ipb; ip < ipe; ++ip) {
+
+          element_boxes.find_boxes_at_point(boundary_points[ip], bset);
+          const boundary_point *pt_info = &(boundary_points_info[ip]);
+          const mesh_fem &mf1 = mfdisp_of_boundary(pt_info->ind_boundary);
+          size_type ib1 = pt_info->ind_boundary;
+
+          for (const bgeot::box_index *pbox : bset) {
+            const influence_box &ibx = element_boxes_info[pbox->id];
+            size_type ib2 = ibx.ind_boundary;
+            const mesh_fem &mf2 = mfdisp_of_boundary(ib2);
+
+            // CRITERION 1 : The unit normal cone / vector are compatible
+            //               and the two points are not in the same element.
+            //               The normals are not tested when the pairs are
+            //               kept for the next searches since they will
+            //               change (they are tested again on the current
+            //               configuration in compute_contact_pairs).
+            if (
+                (search_margin > scalar_type(0)
+                 || test_normal_cones_compatibility(ibx.mean_normal,
+                                                    pt_info->normals))
+                // In case of self-contact, test if the points and the face
+                // share the same element.
+                && (((nodes_mode < 2)
+                     && (( &(mf1.linked_mesh()) != &(mf2.linked_mesh()))
+                         || (pt_info->ind_element != ibx.ind_element)))
+                    || ((nodes_mode == 2)
+                        && !(is_dof_linked(ib1, pt_info->ind_pt,
+                                           ibx.ind_boundary, ibx.ind_element)))
+                    )
+                ) {
+
+              add_potential_contact_face(ppl, ip, ibx.ind_boundary,
+                                         ibx.ind_element, ibx.ind_face);
+            }
+          }
         }
-      }
-
+      });
     }
+    exception.rethrow();
+
+    // The buffers of the threads are merged once.
+    potential_pair_list &ppl = ppls(0);
+    for (size_type th = 1; th < num_threads(); ++th)
+      ppl.insert(ppl.end(), ppls(th).begin(), ppls(th).end());
+    set_potential_pairs(ppl);
   }
 
   struct proj_pt_surf_cost_function_object {
@@ -833,12 +1222,6 @@ namespace getfem {
   //   account. How to take it into account in a cheap way ?
 
   void multi_contact_frame::compute_contact_pairs() {
-    base_matrix G, grad(N,N);
-    model_real_plain_vector coeff;
-    base_small_vector a(N-1), ny(N);
-    base_node y(N);
-    std::vector<base_small_vector> ti(N-1), Ti(N-1);
-    size_type nbwarn(0);
 
     // double time = dal::uclock_sec();
 
@@ -859,420 +1242,387 @@ namespace getfem {
 
     if (only_slave) {
       compute_boundary_points();
-      potential_pairs.resize(boundary_points.size());
+      set_potential_pairs(potential_pair_list());
+    }
+    else if (search_margin > scalar_type(0)
+             && !(use_delaunay == 1 && qhull_available)
+             && displacements_within_margin()) {
+      // The potential pairs of the last full search are still valid,
+      // only the boundary points are updated.
+      compute_boundary_points(!use_delaunay && !self_contact);
+      normal_cone_simplification();
+      GMM_ASSERT1(potential_pairs_ptr.size() == boundary_points.size() + 1,
+                  "The contact boundaries have changed, call "
+                  "set_search_margin to reset the stored contact pairs");
+    } else {
+      if (use_delaunay)
+        compute_potential_contact_pairs_delaunay();
+      else
+        compute_potential_contact_pairs_influence_boxes();
+      if (search_margin > scalar_type(0)) ref_Us = ext_Us;
+      ++nb_full_search;
     }
-    else if (use_delaunay)
-      compute_potential_contact_pairs_delaunay();
-    else
-      compute_potential_contact_pairs_influence_boxes();
 
     // cout << "Time for computing potential pairs: " << dal::uclock_sec() - time << endl; time = dal::uclock_sec();
 
-
-    // Scan of potential pairs
-    for (size_type ip = 0; ip < potential_pairs.size(); ++ip) {
-      bool first_pair_found = false;
-      const base_node &x = boundary_points[ip];
-      boundary_point &bpinfo = boundary_points_info[ip];
-      size_type ibx = bpinfo.ind_boundary;
-      bool slx = is_slave_boundary(ibx);
-      scalar_type d0 = 1E300, d1, d2;
-
-      base_small_vector nx = bpinfo.normals[0];
-      if (raytrace) {
-        if (bpinfo.normals.size() > 1) { // take the mean normal vector
-          for (size_type i = 1; i < bpinfo.normals.size(); ++i)
-            gmm::add(bpinfo.normals[i], nx);
-          scalar_type nnx = gmm::vect_norm2(nx);
-          GMM_ASSERT1(nnx != scalar_type(0), "Invalid normal cone");
-          gmm::scale(nx, scalar_type(1)/nnx);
-        }
+    size_type nbpt = boundary_points.size();
+
+    // Contact pairs with rigid obstacles. The obstacles given by an
+    // expression are evaluated on a shared workspace, so that they are
+    // treated serially here. The analytic ones are evaluated once for all
+    // the points and treated in the parallel scan below.
+    bool parallel_obstacles = obstacles.size() && analytic_obstacles();
+    std::vector<contact_pair> obstacle_pairs;
+    std::vector<size_type> obstacle_pair_of_point(nbpt, size_type(-1));
+    dal::bit_vector discarded_points;
+    base_vector obstacle_dist;
+    if (parallel_obstacles) {
+      size_type nbo = obstacles.size();
+      base_vector di;
+      gmm::resize(obstacle_dist, nbpt * nbo);
+      for (size_type i = 0; i < nbo; ++i) {
+        obstacles_sd[i]->eval(boundary_points, di);
+        for (size_type ip = 0; ip < nbpt; ++ip)
+          obstacle_dist[ip*nbo+i] = di[ip];
       }
-
-      if (self_contact || slx) {
-        // Detect here the nearest rigid obstacle (taking into account
-        // the release distance)
-        size_type irigid_obstacle(-1);
-        gmm::copy(x, pt);
-        switch(N) {
-        default:
-        case 4: ptw[0] = pt[3]; 
-        case 3: ptz[0] = pt[2]; 
-        case 2: pty[0] = pt[1]; 
-        case 1: ptx[0] = pt[0];
-        }
-        for (size_type i = 0; i < obstacles.size(); ++i) {
-          d1 = (obstacles_f[i].eval())[0];
-          if (gmm::abs(d1) < release_distance && d1 < d0) {
-
-            for (size_type j=0; j < bpinfo.normals.size(); ++j) {
-              gmm::add(gmm::scaled(bpinfo.normals[j], EPS), pt);
-              switch(N) {
-              default:
-              case 4: ptw[0] = pt[3]; 
-              case 3: ptz[0] = pt[2]; 
-              case 2: pty[0] = pt[1]; 
-              case 1: ptx[0] = pt[0];
-              }
-              d2 =  (obstacles_f[i].eval())[0];
-              if (d2 < d1) { d0 = d1; irigid_obstacle = i; break; }
-              gmm::copy(x, pt);
-              switch(N) {
-              default:
-              case 4: ptw[0] = pt[3]; 
-              case 3: ptz[0] = pt[2]; 
-              case 2: pty[0] = pt[1]; 
-              case 1: ptx[0] = pt[0];
-              }
-            }
+    } else if (obstacles.size()) {
+      base_vector d(obstacles.size());
+      contact_pair ct;
+      for (size_type ip = 0; ip < nbpt; ++ip) {
+        const base_node &x = boundary_points[ip];
+        const boundary_point &bpinfo = boundary_points_info[ip];
+        if (self_contact || is_slave_boundary(bpinfo.ind_boundary)) {
+          base_small_vector nx = raytrace ? raytrace_normal(bpinfo.normals)
+                                          : bpinfo.normals[0];
+          for (size_type i = 0; i < obstacles.size(); ++i)
+            d[i] = obstacle_value(i, x);
+          switch (rigid_obstacle_pair(ip, nx, &(d[0]), ct)) {
+          case 1:
+            obstacle_pair_of_point[ip] = obstacle_pairs.size();
+            obstacle_pairs.push_back(ct);
+            break;
+          case 2: discarded_points.add(ip); break;
           }
         }
+      }
+    }
 
-        if (irigid_obstacle != size_type(-1)) {
-
-          gmm::copy(x, pt);
-          switch(N) {
-          default:
-          case 4: ptw[0] = pt[3]; 
-          case 3: ptz[0] = pt[2]; 
-          case 2: pty[0] = pt[1]; 
-          case 1: ptx[0] = pt[0];
-          }
-          gmm::copy(x, y);
-          size_type nit = 0, nb_fail = 0;
-          scalar_type alpha(0), beta(0);
-          d1 = d0;
-
-          while (++nit < 50 && nb_fail < 3) {
-            for (size_type k = 0; k < N; ++k) {
-              pt[k] += EPS;
-              switch(N) {
-              case 4: ptw[0] += EPS; break;
-              case 3: ptz[0] += EPS; break;
-              case 2: pty[0] += EPS; break;
-              case 1: ptx[0] += EPS; break;
-              }
-              d2 = (obstacles_f[irigid_obstacle].eval())[0];
-              ny[k] = (d2 - d1) / EPS;
-              pt[k] -= EPS;
-              switch(N) {
-              case 4: ptw[0] -= EPS; break;
-              case 3: ptz[0] -= EPS; break;
-              case 2: pty[0] -= EPS; break;
-              case 1: ptx[0] -= EPS; break;
-              }
+    // Scan of potential pairs, the points being distributed on the threads.
+    // The pairs found by each thread are stored in a local buffer and the
+    // buffers are concatenated in the order of the points.
+    for (size_type i = 0; i < contact_boundaries.size(); ++i)
+      mfdisp_of_boundary(i).nb_basic_dof();
+    const dal::bit_vector &discarded = discarded_points;
+    omp_distribute<std::vector<contact_pair> > cpss;
+    gmm::standard_locale locale;
+    open_mp_is_running_properly check;
+    thread_exception exception;
+    #pragma omp parallel default(shared)
+    {
+      exception.run([&]
+      {
+        std::vector<contact_pair> &cps = cpss.thrd_cast();
+        base_matrix G, grad(N,N);
+        model_real_plain_vector coeff;
+        base_small_vector a(N-1), ny(N);
+        base_node y(N);
+        std::vector<base_small_vector> ti(N-1), Ti(N-1);
+        size_type nbwarn(0), ipb, ipe;
+        thread_range(nbpt, ipb, ipe);
+
+        for (size_type ip = ipb; ip < ipe; ++ip) {
+          if (discarded.is_in(ip)) continue;
+          std::minstd_rand gen(std::minstd_rand::result_type(ip + 1));
+          bool first_pair_found = false;
+          const base_node &x = boundary_points[ip];
+          const boundary_point &bpinfo = boundary_points_info[ip];
+          size_type ibx = bpinfo.ind_boundary;
+
+          base_small_vector nx = raytrace ? raytrace_normal(bpinfo.normals)
+                                          : bpinfo.normals[0];
+
+          if (parallel_obstacles) {
+            if (self_contact || is_slave_boundary(ibx)) {
+              contact_pair ct;
+              int res = rigid_obstacle_pair
+                (ip, nx, &(obstacle_dist[ip*obstacles.size()]), ct);
+              if (res == 2) continue;
+              if (res == 1) { cps.push_back(ct); first_pair_found = true; }
             }
+          } else if (obstacle_pair_of_point[ip] != size_type(-1)) {
+            cps.push_back(obstacle_pairs[obstacle_pair_of_point[ip]]);
+            first_pair_found = true;
+          }
 
-            if (gmm::abs(d1) < 1E-13)
-              break; // point already lies on the rigid obstacle surface
+          for (size_type ipf = 0; ipf < nb_potential_faces(ip); ++ipf) {
+            // Point to surface projection. Principle :
+            //  - One parametrizes first the face on the reference element by
+            //    obtaining a point x_0 on that face and t_i, i=1..d-1 some
+            //    orthonormals tangent vectors to the face.
+            //  - Let y_0 be the point to be projected and y the searched
+            //    projected point. Then one searches for the minimum of
+            //    J = (1/2)|| y - x ||
+            //    with
+            //    y = \phi(x0 + a_i t_i)
+            //    (with a summation on i), where \phi = I+u(\tau(x)), and \tau
+            //    the geometric transformation between reference and real
+            //    elements.
+            //  - The gradient of J with respect to a_i is
+            //    \partial_{a_j} J = (\phi(x0 + a_i t_i) - x)
+            //                       . (\nabla \phi(x0 + a_i t_i) t_j
+            //  - A Newton algorithm is applied.
+            //  - If it fails, a BFGS is called.
+
+            const face_info &fi = potential_face(ip, ipf);
+            size_type ib = fi.ind_boundary;
+            size_type cv = fi.ind_element;
+            short_type iff = fi.ind_face;
+
+            const mesh_fem &mfu = mfdisp_of_boundary(ib);
+            const mesh &m = mfu.linked_mesh();
+            pfem pf_s = mfu.fem_of_element(cv);
+            bgeot::pgeometric_trans pgt = m.trans_of_convex(cv);
 
-            // ajouter un test de divergence ...
-            for (scalar_type lambda(1); lambda >= 1E-3; lambda /= scalar_type(2)) {
-              if (raytrace) {
-                alpha = beta - lambda * d1 / gmm::vect_sp(ny, nx);
-                gmm::add(x, gmm::scaled(nx, alpha), pt);
-              } else {
-                gmm::add(gmm::scaled(ny, -d1/gmm::vect_norm2_sqr(ny)), y, pt);
-              }
-              switch(N) {
-              default:
-              case 4: ptw[0] = pt[3]; 
-              case 3: ptz[0] = pt[2]; 
-              case 2: pty[0] = pt[1]; 
-              case 1: ptx[0] = pt[0];
+            if (!ref_conf)
+              slice_vector_on_basic_dof_of_element(mfu, disp_of_boundary(ib),
+                                                   cv, coeff);
+
+            m.points_of_convex(cv, G);
+
+            const base_node &x0 = pf_s->ref_convex(cv)->points_of_face(iff)[0];
+            fem_interpolation_context ctx(pgt, pf_s, x0, G, cv, iff);
+
+            const base_small_vector &n0 = pf_s->ref_convex(cv)->normals()[iff];
+            for (size_type k = 0; k < N-1; ++k) { // A basis for the face
+              gmm::resize(ti[k], N);
+              scalar_type norm(0);
+              while(norm < 1E-5) {
+                fill_point_random(ti[k], gen);
+                ti[k] -= gmm::vect_sp(ti[k], n0) * n0;
+                for (size_type l = 0; l < k; ++l)
+                  ti[k] -= gmm::vect_sp(ti[k], ti[l]) * ti[l];
+                norm = gmm::vect_norm2(ti[k]);
               }
-              d2 = (obstacles_f[irigid_obstacle].eval())[0];
-//               if (nit > 10)
-//                 cout << "nit = " << nit << " lambda = " << lambda
-//                      << " alpha = " << alpha << " d2 = " << d2
-//                      << " d1  = " << d1 << endl;
-              if (gmm::abs(d2) < gmm::abs(d1)) break;
+              ti[k] /= norm;
             }
-            if (raytrace &&
-                gmm::abs(beta - d1 / gmm::vect_sp(ny, nx)) > scalar_type(500))
-              nb_fail++;
-            gmm::copy(pt, y); beta = alpha; d1 = d2;
-          }
-
-          if (gmm::abs(d1) > 1E-8) {
-            GMM_WARNING1("Projection/raytrace on rigid obstacle failed");
-            continue;
-          }
-
-          // CRITERION 4 for rigid bodies : Apply the release distance
-          if (gmm::vect_dist2(y, x) > release_distance)
-            continue;
-
-          gmm::copy(pt, y);
-          ny /= gmm::vect_norm2(ny);
-
-          d0 = gmm::vect_dist2(y, x) * gmm::sgn(d0);
-          contact_pair ct(x, nx, bpinfo, y, ny, irigid_obstacle, d0);
 
-          contact_pairs.push_back(ct);
-          first_pair_found = true;
-        }
-      }
+            bool converged = false;
+            scalar_type residual(0);
 
-      // if (potential_pairs[ip].size())
-      // cout << "number of potential pairs for point " << ip << " : " << potential_pairs[ip].size() << endl;
-      for (size_type ipf = 0; ipf < potential_pairs[ip].size(); ++ipf) {
-        // Point to surface projection. Principle :
-        //  - One parametrizes first the face on the reference element by
-        //    obtaining a point x_0 on that face and t_i, i=1..d-1 some
-        //    orthonormals tangent vectors to the face.
-        //  - Let y_0 be the point to be projected and y the searched
-        //    projected point. Then one searches for the minimum of
-        //    J = (1/2)|| y - x ||
-        //    with
-        //    y = \phi(x0 + a_i t_i)
-        //    (with a summation on i), where \phi = I+u(\tau(x)), and \tau
-        //    the geometric transformation between reference and real
-        //    elements.
-        //  - The gradient of J with respect to a_i is
-        //    \partial_{a_j} J = (\phi(x0 + a_i t_i) - x)
-        //                       . (\nabla \phi(x0 + a_i t_i) t_j
-        //  - A Newton algorithm is applied.
-        //  - If it fails, a BFGS is called.
-
-        const face_info &fi = potential_pairs[ip][ipf];
-        size_type ib = fi.ind_boundary;
-        size_type cv = fi.ind_element;
-        short_type iff = fi.ind_face;
-
-        const mesh_fem &mfu = mfdisp_of_boundary(ib);
-        const mesh &m = mfu.linked_mesh();
-        pfem pf_s = mfu.fem_of_element(cv);
-        bgeot::pgeometric_trans pgt = m.trans_of_convex(cv);
 
-        if (!ref_conf)
-          slice_vector_on_basic_dof_of_element(mfu, disp_of_boundary(ib),
-                                               cv, coeff);
+            if (raytrace) { // Raytrace search for y by a Newton algorithm
 
-        m.points_of_convex(cv, G);
+              base_small_vector res(N-1), res2(N-1), dir(N-1), b(N-1);
 
-        const base_node &x0 = pf_s->ref_convex(cv)->points_of_face(iff)[0];
-        fem_interpolation_context ctx(pgt, pf_s, x0, G, cv, iff);
-
-        const base_small_vector &n0 = pf_s->ref_convex(cv)->normals()[iff];
-        for (size_type k = 0; k < N-1; ++k) { // A basis for the face
-          gmm::resize(ti[k], N);
-          scalar_type norm(0);
-          while(norm < 1E-5) {
-            gmm::fill_random(ti[k]);
-            ti[k] -= gmm::vect_sp(ti[k], n0) * n0;
-            for (size_type l = 0; l < k; ++l)
-              ti[k] -= gmm::vect_sp(ti[k], ti[l]) * ti[l];
-            norm = gmm::vect_norm2(ti[k]);
-          }
-          ti[k] /= norm;
-        }
-
-        bool converged = false;
-        scalar_type residual(0);
+              base_matrix hessa(N-1, N-1);
+              gmm::clear(a);
 
+              for (size_type k = 0; k < N-1; ++k) {
+                gmm::resize(Ti[k], N);
+                scalar_type norm(0);
+                while (norm < 1E-5) {
+                  fill_point_random(Ti[k], gen);
+                  Ti[k] -= gmm::vect_sp(Ti[k], nx) * nx;
+                  for (size_type l = 0; l < k; ++l)
+                    Ti[k] -= gmm::vect_sp(Ti[k], Ti[l]) * Ti[l];
+                  norm = gmm::vect_norm2(Ti[k]);
+                }
+                Ti[k] /= norm;
+              }
 
-        if (raytrace) { // Raytrace search for y by a Newton algorithm
+              raytrace_pt_surf_cost_function_object pps(x0, x, ctx, coeff, ti, Ti,
+                                                        ref_conf);
+
+              pps(a, res);
+              residual = gmm::vect_norm2(res);
+              scalar_type residual2(0), det(0);
+              bool exited = false;
+              size_type nbfail = 0, niter = 0;
+              for (;residual > 2E-12 && niter <= 30; ++niter) {
+
+                for (size_type subiter(0);;) {
+                  pps(a, hessa);
+                  det = gmm::abs(bgeot::lu_inverse(&(*(hessa.begin())),
+                                                   N-1, false));
+                  if (det > 1E-15) break;
+                  for (size_type i = 0; i < N-1; ++i)
+                    a[i] += point_random(gen) * 1E-7;
+                  if (++subiter > 4) break;
+                }
+                if (det <= 1E-15) break;
+                // Computation of the descent direction
+                gmm::mult(hessa, gmm::scaled(res, scalar_type(-1)), dir);
+
+                if (gmm::vect_norm2(dir) > scalar_type(10)) nbfail++;
+                if (nbfail >= 4) break;
+
+                // Line search
+                scalar_type lambda(1);
+                for (size_type j = 0; j < 5; ++j) {
+                  gmm::add(a, gmm::scaled(dir, lambda), b);
+                  pps(b, res2);
+                  residual2 = gmm::vect_norm2(res2);
+                  if (residual2 < residual) break;
+                  lambda /= ((j < 3) ? scalar_type(2) : scalar_type(5));
+                }
 
-          base_small_vector res(N-1), res2(N-1), dir(N-1), b(N-1);
+                residual = residual2;
+                gmm::copy(res2, res);
+                gmm::copy(b, a);
+                scalar_type dist_ref = gmm::vect_norm2(a);
+    //             if (niter == 15)
+    //               cout << "more than 15 iterations " << a
+    //                    << " dir " << dir << " nbfail : " << nbfail << endl;
+                if (niter > 1 && dist_ref > 15) break;
+                if (niter > 5 && dist_ref > 8) break;
+                if ((niter > 1 && dist_ref > 7) || nbfail == 3) exited = true;
+              }
+              converged = (gmm::vect_norm2(res) < 2E-6);
+              GMM_ASSERT1(!((exited && converged &&
+                             pf_s->ref_convex(cv)->is_in(ctx.xref()) < 1E-6)),
+                          "A non conformal case !! " << gmm::vect_norm2(res)
+                          << " : " << nbfail << " : " << niter);
+
+            } else { // Classical projection for y
+
+              proj_pt_surf_cost_function_object pps(x0, x, ctx, coeff, ti,
+                                                    EPS, ref_conf);
+
+              // Projection could be ameliorated by finding a starting point near
+              // x (with respect to the integration method, for instance).
+
+              // A specific (Quasi) Newton algorithm for computing the projection
+              base_small_vector grada(N-1), dir(N-1), b(N-1);
+              gmm::clear(a);
+              base_matrix hessa(N-1, N-1);
+              scalar_type det(0);
+
+              scalar_type dist = pps(a, grada);
+              for (size_type niter = 0;
+                   gmm::vect_norm2(grada) > 1E-12 && niter <= 50; ++niter) {
+
+                for (size_type subiter(0);;) {
+                  pps(a, hessa);
+                  det = gmm::abs(bgeot::lu_inverse(&(*(hessa.begin())),
+                                                   N-1, false));
+                  if (det > 1E-15) break;
+                  for (size_type i = 0; i < N-1; ++i)
+                    a[i] += point_random(gen) * 1E-7;
+                  if (++subiter > 4) break;
+                }
+                if (det <= 1E-15) break;
+                // Computation of the descent direction
+                gmm::mult(hessa, gmm::scaled(grada, scalar_type(-1)), dir);
+
+                // Line search
+                for (scalar_type lambda(1);
+                     lambda >= 1E-3; lambda /= scalar_type(2)) {
+                  gmm::add(a, gmm::scaled(dir, lambda), b);
+                  if (pps(b) < dist) break;
+                  gmm::add(a, gmm::scaled(dir, -lambda), b);
+                  if (pps(b) < dist) break;
+                }
+                gmm::copy(b, a);
+                dist = pps(a, grada);
+              }
 
-          base_matrix hessa(N-1, N-1);
-          gmm::clear(a);
+              converged = (gmm::vect_norm2(grada) < 2E-6);
 
-          for (size_type k = 0; k < N-1; ++k) {
-            gmm::resize(Ti[k], N);
-            scalar_type norm(0);
-            while (norm < 1E-5) {
-              gmm::fill_random(Ti[k]);
-              Ti[k] -= gmm::vect_sp(Ti[k], nx) * nx;
-              for (size_type l = 0; l < k; ++l)
-                Ti[k] -= gmm::vect_sp(Ti[k], Ti[l]) * Ti[l];
-              norm = gmm::vect_norm2(Ti[k]);
+              if (!converged) { // Try with BFGS
+                gmm::iteration iter(1E-12, 0 /* noisy*/, 100 /*maxiter*/);
+                gmm::clear(a);
+                gmm::bfgs(pps, pps, a, 10, iter, 0, 0.5);
+                residual = gmm::abs(iter.get_res());
+                converged = (residual < 2E-5);
+              }
             }
-            Ti[k] /= norm;
-          }
 
-          raytrace_pt_surf_cost_function_object pps(x0, x, ctx, coeff, ti, Ti,
-                                                    ref_conf);
+            bool is_in = (pf_s->ref_convex(cv)->is_in(ctx.xref()) < 1E-6);
 
-          pps(a, res);
-          residual = gmm::vect_norm2(res);
-          scalar_type residual2(0), det(0);
-          bool exited = false;
-          size_type nbfail = 0, niter = 0;
-          for (;residual > 2E-12 && niter <= 30; ++niter) {
-
-            for (size_type subiter(0);;) {
-              pps(a, hessa);
-              det = gmm::abs(bgeot::lu_inverse(&(*(hessa.begin())),N-1, false));
-              if (det > 1E-15) break;
-              for (size_type i = 0; i < N-1; ++i)
-                a[i] += gmm::random() * 1E-7;
-              if (++subiter > 4) break;
+            if (is_in || (!converged && !raytrace)) {
+              if (!ref_conf) {
+                ctx.pf()->interpolation(ctx, coeff, y, dim_type(N));
+                y += ctx.xreal();
+              } else {
+                y = ctx.xreal();
+              }
             }
-            if (det <= 1E-15) break;
-            // Computation of the descent direction
-            gmm::mult(hessa, gmm::scaled(res, scalar_type(-1)), dir);
-
-            if (gmm::vect_norm2(dir) > scalar_type(10)) nbfail++;
-            if (nbfail >= 4) break;
 
-            // Line search
-            scalar_type lambda(1);
-            for (size_type j = 0; j < 5; ++j) {
-              gmm::add(a, gmm::scaled(dir, lambda), b);
-              pps(b, res2);
-              residual2 = gmm::vect_norm2(res2);
-              if (residual2 < residual) break;
-              lambda /= ((j < 3) ? scalar_type(2) : scalar_type(5));
+            // CRITERION 2 : The contact pair is eliminated when
+            //               projection/raytrace do not converge.
+            if (!converged) {
+              if (!raytrace && nbwarn < 4) {
+                GMM_WARNING3("Projection or raytrace algorithm did not converge "
+                             "for point " << x << " residual " << residual
+                             << " projection computed " << y);
+                ++nbwarn;
+              }
+              continue;
             }
 
-            residual = residual2;
-            gmm::copy(res2, res);
-            gmm::copy(b, a);
-            scalar_type dist_ref = gmm::vect_norm2(a);
-//             if (niter == 15)
-//               cout << "more than 15 iterations " << a
-//                    << " dir " << dir << " nbfail : " << nbfail << endl;
-            if (niter > 1 && dist_ref > 15) break;
-            if (niter > 5 && dist_ref > 8) break;
-            if ((niter > 1 && dist_ref > 7) || nbfail == 3) exited = true;
-          }
-          converged = (gmm::vect_norm2(res) < 2E-6);
-          GMM_ASSERT1(!((exited && converged &&
-                         pf_s->ref_convex(cv)->is_in(ctx.xref()) < 1E-6)),
-                      "A non conformal case !! " << gmm::vect_norm2(res)
-                      << " : " << nbfail << " : " << niter);
-
-        } else { // Classical projection for y
-
-          proj_pt_surf_cost_function_object pps(x0, x, ctx, coeff, ti,
-                                                EPS, ref_conf);
-
-          // Projection could be ameliorated by finding a starting point near
-          // x (with respect to the integration method, for instance).
-
-          // A specific (Quasi) Newton algorithm for computing the projection
-          base_small_vector grada(N-1), dir(N-1), b(N-1);
-          gmm::clear(a);
-          base_matrix hessa(N-1, N-1);
-          scalar_type det(0);
-
-          scalar_type dist = pps(a, grada);
-          for (size_type niter = 0;
-               gmm::vect_norm2(grada) > 1E-12 && niter <= 50; ++niter) {
-
-            for (size_type subiter(0);;) {
-              pps(a, hessa);
-              det = gmm::abs(bgeot::lu_inverse(&(*(hessa.begin())),N-1, false));
-              if (det > 1E-15) break;
-              for (size_type i = 0; i < N-1; ++i)
-                a[i] += gmm::random() * 1E-7;
-              if (++subiter > 4) break;
+            // CRITERION 3 : The projected point is inside the element
+            //               The test should be completed: If the point is
+            //               outside the element, a rapid reprojection on the face
+            //               (on the reference element, with a linear algorithm)
+            //               can be applied and a test with a neigbhour element
+            //               to decide if the point is in fact ok ...
+            //               (to be done only if there is no projection on other
+            //               element which coincides and with a test on the
+            //               distance ... ?) To be specified (in this case,
+            //               change xref).
+            if (!is_in) continue;
+
+            // CRITERION 4 : Apply the release distance
+            scalar_type signed_dist = gmm::vect_dist2(y, x);
+            if (signed_dist > release_distance) continue;
+
+            // compute the unit normal vector at y and the signed distance.
+            base_small_vector ny0(N);
+            compute_normal(ctx, iff, ref_conf, coeff, ny0, ny, grad);
+            // ny /= gmm::vect_norm2(ny); // Useful only if the unit normal is kept
+            signed_dist *= gmm::sgn(gmm::vect_sp(x - y, ny));
+
+            // CRITERION 5 : comparison with rigid obstacles
+            // CRITERION 7 : smallest signed distance on contact pairs
+            if (first_pair_found && cps.back().signed_dist < signed_dist)
+                continue;
+
+            // CRITERION 1 : again on found unit normal vector
+            if (!(test_normal_cones_compatibility(ny, bpinfo.normals)))
+                continue;
+
+            // CRITERION 6 : for self-contact only : apply a test on
+            //               unit normals in reference configuration.
+            if (&m == &(mfdisp_of_boundary(ibx).linked_mesh())) {
+
+              base_small_vector diff = bpinfo.ref_point - ctx.xreal();
+              scalar_type ref_dist = gmm::vect_norm2(diff);
+
+              if ( (ref_dist < scalar_type(4) * release_distance)
+                   && (gmm::vect_sp(diff, ny0) < - 0.01 * ref_dist) )
+                continue;
             }
-            if (det <= 1E-15) break;
-            // Computation of the descent direction
-            gmm::mult(hessa, gmm::scaled(grada, scalar_type(-1)), dir);
 
-            // Line search
-            for (scalar_type lambda(1);
-                 lambda >= 1E-3; lambda /= scalar_type(2)) {
-              gmm::add(a, gmm::scaled(dir, lambda), b);
-              if (pps(b) < dist) break;
-              gmm::add(a, gmm::scaled(dir, -lambda), b);
-              if (pps(b) < dist) break;
+            contact_pair ct(x, nx, bpinfo, ctx.xref(), y, ny, fi, signed_dist);
+            if (first_pair_found) {
+              cps.back() = ct;
+            } else {
+              cps.push_back(ct);
+              first_pair_found = true;
             }
-            gmm::copy(b, a);
-            dist = pps(a, grada);
-          }
-
-          converged = (gmm::vect_norm2(grada) < 2E-6);
-
-          if (!converged) { // Try with BFGS
-            gmm::iteration iter(1E-12, 0 /* noisy*/, 100 /*maxiter*/);
-            gmm::clear(a);
-            gmm::bfgs(pps, pps, a, 10, iter, 0, 0.5);
-            residual = gmm::abs(iter.get_res());
-            converged = (residual < 2E-5);
-          }
-        }
-
-        bool is_in = (pf_s->ref_convex(cv)->is_in(ctx.xref()) < 1E-6);
 
-        if (is_in || (!converged && !raytrace)) {
-          if (!ref_conf) {
-            ctx.pf()->interpolation(ctx, coeff, y, dim_type(N));
-            y += ctx.xreal();
-          } else {
-            y = ctx.xreal();
           }
         }
-
-        // CRITERION 2 : The contact pair is eliminated when
-        //               projection/raytrace do not converge.
-        if (!converged) {
-          if (!raytrace && nbwarn < 4) {
-            GMM_WARNING3("Projection or raytrace algorithm did not converge "
-                         "for point " << x << " residual " << residual
-                         << " projection computed " << y);
-            ++nbwarn;
-          }
-          continue;
-        }
-
-        // CRITERION 3 : The projected point is inside the element
-        //               The test should be completed: If the point is outside
-        //               the element, a rapid reprojection on the face
-        //               (on the reference element, with a linear algorithm)
-        //               can be applied and a test with a neigbhour element
-        //               to decide if the point is in fact ok ...
-        //               (to be done only if there is no projection on other
-        //               element which coincides and with a test on the
-        //               distance ... ?) To be specified (in this case,
-        //               change xref).
-        if (!is_in) continue;
-
-        // CRITERION 4 : Apply the release distance
-        scalar_type signed_dist = gmm::vect_dist2(y, x);
-        if (signed_dist > release_distance) continue;
-
-        // compute the unit normal vector at y and the signed distance.
-        base_small_vector ny0(N);
-        compute_normal(ctx, iff, ref_conf, coeff, ny0, ny, grad);
-        // ny /= gmm::vect_norm2(ny); // Useful only if the unit normal is kept
-        signed_dist *= gmm::sgn(gmm::vect_sp(x - y, ny));
-
-        // CRITERION 5 : comparison with rigid obstacles
-        // CRITERION 7 : smallest signed distance on contact pairs
-        if (first_pair_found && contact_pairs.back().signed_dist < signed_dist)
-            continue;
-
-        // CRITERION 1 : again on found unit normal vector
-        if (!(test_normal_cones_compatibility(ny, bpinfo.normals)))
-            continue;
-
-        // CRITERION 6 : for self-contact only : apply a test on
-        //               unit normals in reference configuration.
-        if (&m == &(mfdisp_of_boundary(ibx).linked_mesh())) {
-
-          base_small_vector diff = bpinfo.ref_point - ctx.xreal();
-          scalar_type ref_dist = gmm::vect_norm2(diff);
-
-          if ( (ref_dist < scalar_type(4) * release_distance)
-               && (gmm::vect_sp(diff, ny0) < - 0.01 * ref_dist) )
-            continue;
-        }
-
-        contact_pair ct(x, nx, bpinfo, ctx.xref(), y, ny, fi, signed_dist);
-        if (first_pair_found) {
-          contact_pairs.back() = ct;
-        } else {
-          contact_pairs.push_back(ct);
-          first_pair_found = true;
-        }
-
-      }
+      });
     }
+    exception.rethrow();
+
+    size_type nbcp = 0;
+    for (size_type th = 0; th < num_threads(); ++th) nbcp += cpss(th).size();
+    contact_pairs.reserve(nbcp);
+    for (size_type th = 0; th < num_threads(); ++th)
+      contact_pairs.insert(contact_pairs.end(),
+                           cpss(th).begin(), cpss(th).end());
 
     // cout << "Time for computing pairs: " << dal::uclock_sec() - time << endl; time = dal::uclock_sec();
 
@@ -1295,6 +1645,8 @@ namespace getfem {
       std::string dispname;        // Variable name for the displacement
       mutable const model_real_plain_vector *U;      // Displacement
       mutable model_real_plain_vector U_unred; // Unreduced displacement
+      mutable model_real_plain_vector U_ref; // Displacement used for the
+                                             // last computation of face boxes
       bool slave;
  
       contact_boundary()
@@ -1318,6 +1670,10 @@ namespace getfem {
 
     scalar_type release_distance;  // Limit distance beyond which the contact
                                    // will not be considered.
+    scalar_type search_margin;     // If positive, the face boxes are kept
+                                   // between assemblies while the master
+                                   // displacements do not move more than
+                                   // this margin (in maximum norm).
     
     std::vector<contact_boundary> contact_boundaries;
     typedef std::map<const mesh *, std::vector<size_type> > mesh_boundary_cor;
@@ -1327,10 +1683,14 @@ namespace getfem {
       const model *md;
       const ga_workspace *parent_workspace;
       std::string expr;
+      pmesher_signed_distance sd; // Analytic obstacle (replaces expr)
 
       mutable base_vector X;
       mutable ga_function f, der_f;
       mutable bool compiled;
+      mutable base_tensor sd_val, sd_der;
+      mutable base_node sd_X;
+      mutable base_small_vector sd_G;
 
       void compile() const {
         if (md)
@@ -1356,10 +1716,23 @@ namespace getfem {
       base_vector &point() const { return X; }
 
       const base_tensor &eval() const {
+        if (sd) {
+          sd_val.adjust_sizes(1);
+          gmm::copy(X, sd_X);
+          sd_val[0] = (*sd)(sd_X);
+          return sd_val;
+        }
         if (!compiled) compile();
         return f.eval();
       }
       const base_tensor &eval_derivative() const {
+        if (sd) {
+          sd_der.adjust_sizes(gmm::vect_size(X));
+          gmm::copy(X, sd_X);
+          sd->grad(sd_X, sd_G);
+          gmm::copy(sd_G, sd_der.as_vector());
+          return sd_der;
+        }
         if (!compiled) compile();
         return der_f.eval();
       }
@@ -1373,13 +1746,19 @@ namespace getfem {
                const std::string &expr_, size_type N)
         : md(0), parent_workspace(&parent_workspace_), expr(expr_), X(N),
           f(), der_f(), compiled(false) {}
+      obstacle(const pmesher_signed_distance &sd_, size_type N)
+        : md(0), parent_workspace(0), expr(""), sd(sd_), X(N),
+          f(), der_f(), compiled(false), sd_X(N), sd_G(N) {}
       obstacle(const obstacle &obs)
         : md(obs.md), parent_workspace(obs.parent_workspace), expr(obs.expr),
-          X(obs.X), f(), der_f(), compiled(false) {}
+          sd(obs.sd), X(obs.X), f(), der_f(), compiled(false),
+          sd_X(obs.sd_X), sd_G(obs.sd_G) {}
       obstacle &operator =(const obstacle& obs) {
         md = obs.md;
         parent_workspace = obs.parent_workspace;
         expr = obs.expr;
+        sd = obs.sd;
+        sd_X = obs.sd_X; sd_G = obs.sd_G;
         X = obs.X;
         f = ga_function();
         der_f = ga_function();
@@ -1393,14 +1772,34 @@ namespace getfem {
         
     mutable bgeot::rtree face_boxes;
     mutable std::vector<face_box_info> face_boxes_info;
+    mutable bool face_boxes_valid;
 
+    // Test if the face boxes computed with the stored displacements are
+    // still valid for the current ones.
+    bool face_boxes_reusable() const {
+      if (search_margin <= scalar_type(0) || !face_boxes_valid) return false;
+      for (const contact_boundary &cb : contact_boundaries)
+        if (!(cb.slave)) {
+          const model_real_plain_vector &U = *(cb.U);
+          if (gmm::vect_size(U) != gmm::vect_size(cb.U_ref)) return false;
+          for (size_type j = 0; j < gmm::vect_size(U); ++j)
+            if (gmm::abs(U[j] - cb.U_ref[j]) > search_margin) return false;
+        }
+      return true;
+    }
 
-    void compute_face_boxes() const { // called by init
+    // Computes the face boxes and their mean normals. If only_normals is
+    // true, the boxes kept from a previous call (see search_margin) are
+    // unchanged and only their mean normals are updated.
+    void compute_face_boxes(bool only_normals = false) const {
       fem_precomp_pool fppool;
       base_matrix G;
       model_real_plain_vector coeff;
-      face_boxes.clear();
-      face_boxes_info.resize(0);
+      size_type ibox = 0;
+      if (!only_normals) {
+        face_boxes.clear();
+        face_boxes_info.resize(0);
+      }
 
       for (size_type i = 0; i < contact_boundaries.size(); ++i) {
         const contact_boundary &cb = contact_boundaries[i];
@@ -1408,6 +1807,8 @@ namespace getfem {
           size_type bnum = cb.region;
           const mesh_fem &mfu = *(cb.mfu);
           const model_real_plain_vector &U = *(cb.U);
+          if (search_margin > scalar_type(0) && !only_normals)
+            gmm::copy(U, cb.U_ref);
           const mesh &m = mfu.linked_mesh();
           size_type N = m.dim();
           
@@ -1464,19 +1865,29 @@ namespace getfem {
             }
             
             // Security coefficient of 1.3 (for nonlinear transformations)
+            // plus the search margin.
             scalar_type h = bmax[0] - bmin[0];
             for (size_type k = 1; k < N; ++k) h = std::max(h, bmax[k]-bmin[k]);
-            for (size_type k = 0; k < N; ++k)
-              { bmin[k] -= h * 0.15; bmax[k] += h * 0.15; }
+            for (size_type k = 0; k < N; ++k) {
+              bmin[k] -= h * 0.15 + search_margin;
+              bmax[k] += h * 0.15 + search_margin;
+            }
             
             // Store the bounding box and additional information.
-            face_boxes.add_box(bmin, bmax, face_boxes_info.size());
             n_mean /= gmm::vect_norm2(n_mean);
-            face_boxes_info.push_back(face_box_info(i, cv, v.f(), n_mean));
+            if (only_normals) {
+              GMM_ASSERT1(ibox < face_boxes_info.size() &&
+                          face_boxes_info[ibox].ind_element == cv,
+                          "The contact boundaries have changed");
+              face_boxes_info[ibox++].mean_normal = n_mean;
+            } else {
+              face_boxes.add_box(bmin, bmax, face_boxes_info.size());
+              face_boxes_info.push_back(face_box_info(i, cv, v.f(), n_mean));
+            }
           }
         }
       }
-      
+      face_boxes_valid = true;
     }
 
   public:
@@ -1491,6 +1902,11 @@ namespace getfem {
      obstacles.push_back(obstacle(parent_workspace, expr, N));
     }
 
+    void add_rigid_obstacle(const pmesher_signed_distance &sd, size_type N) {
+      GMM_ASSERT1(sd, "Invalid obstacle");
+      obstacles.push_back(obstacle(sd, N));
+    }
+
     void add_contact_boundary(const model &md, const mesh &m,
                               const std::string dispname,
                               size_type region, bool slave) {
@@ -1509,6 +1925,7 @@ namespace getfem {
       boundary_for_mesh[&(mf->linked_mesh())]
         .push_back(contact_boundaries.size());
       contact_boundaries.push_back(cb);
+      face_boxes_valid = false;
     }
     
     void add_contact_boundary(const ga_workspace &workspace, const mesh &m,
@@ -1529,6 +1946,7 @@ namespace getfem {
       boundary_for_mesh[&(mf->linked_mesh())]
         .push_back(contact_boundaries.size());
       contact_boundaries.push_back(cb);
+      face_boxes_valid = false;
     }
 
     void extract_variables(const ga_workspace &workspace,
@@ -1580,12 +1998,17 @@ namespace getfem {
           cb.U = &(workspace.value(dispname_x));
         }
       }
-      compute_face_boxes();
+      // The mean normals of reused boxes are updated since they are used
+      // to filter the faces.
+      compute_face_boxes(face_boxes_reusable());
     };
 
     void finalize() const {
-      face_boxes.clear();
-      face_boxes_info = std::vector<face_box_info>();
+      if (search_margin <= scalar_type(0)) {
+        face_boxes.clear();
+        face_boxes_info = std::vector<face_box_info>();
+        face_boxes_valid = false;
+      }
       for (const contact_boundary &cb : contact_boundaries)
         cb.U_unred = model_real_plain_vector();
     }
@@ -2006,8 +2429,8 @@ namespace getfem {
       return ret_type;
     }
     
-    raytracing_interpolate_transformation(scalar_type d)
-      : release_distance(d) {}
+    raytracing_interpolate_transformation(scalar_type d, scalar_type m = 0)
+      : release_distance(d), search_margin(m), face_boxes_valid(false) {}
   };
 
 
@@ -2436,20 +2859,25 @@ namespace getfem {
       }
       return ret_type;
     }
-    projection_interpolate_transformation(const scalar_type &d)
-      :raytracing_interpolate_transformation(d), release_distance(d) {}
+    projection_interpolate_transformation(const scalar_type &d,
+                                          const scalar_type &m = 0)
+      :raytracing_interpolate_transformation(d, m), release_distance(d) {}
   };
   void add_raytracing_transformation
-  (model &md, const std::string &transname, scalar_type d) {
+  (model &md, const std::string &transname, scalar_type d,
+   scalar_type search_margin) {
     pinterpolate_transformation
-      p = std::make_shared<raytracing_interpolate_transformation>(d);
+      p = std::make_shared<raytracing_interpolate_transformation>
+        (d, search_margin);
     md.add_interpolate_transformation(transname, p);
   }
 
   void add_raytracing_transformation
-  (ga_workspace &workspace, const std::string &transname, scalar_type d) {
+  (ga_workspace &workspace, const std::string &transname, scalar_type d,
+   scalar_type search_margin) {
     pinterpolate_transformation
-      p = std::make_shared<raytracing_interpolate_transformation>(d);
+      p = std::make_shared<raytracing_interpolate_transformation>
+        (d, search_margin);
     workspace.add_interpolate_transformation(transname, p);
   }
 
@@ -2503,6 +2931,16 @@ namespace getfem {
     p->add_rigid_obstacle(md, expr, N);
   }
 
+  void add_rigid_obstacle_to_raytracing_transformation
+  (model &md, const std::string &transname,
+   const pmesher_signed_distance &obs, size_type N) {
+    raytracing_interpolate_transformation *p
+      = dynamic_cast<raytracing_interpolate_transformation *>
+      (const_cast<virtual_interpolate_transformation *>
+       (&(*(md.interpolate_transformation(transname)))));
+    p->add_rigid_obstacle(obs, N);
+  }
+
   void add_rigid_obstacle_to_raytracing_transformation
   (ga_workspace &workspace, const std::string &transname,
    const std::string &expr, size_type N) {
@@ -2513,17 +2951,31 @@ namespace getfem {
     p->add_rigid_obstacle(workspace, expr, N);
   }
 
+  void add_rigid_obstacle_to_raytracing_transformation
+  (ga_workspace &workspace, const std::string &transname,
+   const pmesher_signed_distance &obs, size_type N) {
+    raytracing_interpolate_transformation *p
+      = dynamic_cast<raytracing_interpolate_transformation *>
+      (const_cast<virtual_interpolate_transformation *>
+       (&(*(workspace.interpolate_transformation(transname)))));
+    p->add_rigid_obstacle(obs, N);
+  }
+
  void add_projection_transformation
-  (model &md, const std::string &transname, scalar_type d) {
+  (model &md, const std::string &transname, scalar_type d,
+   scalar_type search_margin) {
     pinterpolate_transformation
-      p = std::make_shared<projection_interpolate_transformation>(d);
+      p = std::make_shared<projection_interpolate_transformation>
+        (d, search_margin);
     md.add_interpolate_transformation(transname, p);
   }
 
   void add_projection_transformation
-  (ga_workspace &workspace, const std::string &transname, scalar_type d) {
+  (ga_workspace &workspace, const std::string &transname, scalar_type d,
+   scalar_type search_margin) {
     pinterpolate_transformation
-      p = std::make_shared<projection_interpolate_transformation>(d);
+      p = std::make_shared<projection_interpolate_transformation>
+        (d, search_margin);
     workspace.add_interpolate_transformation(transname, p);
   }
 
@@ -2577,6 +3029,16 @@ namespace getfem {
     p->add_rigid_obstacle(md, expr, N);
   }
 
+  void add_rigid_obstacle_to_projection_transformation
+  (model &md, const std::string &transname,
+   const pmesher_signed_distance &obs, size_type N) {
+    projection_interpolate_transformation *p
+      = dynamic_cast<projection_interpolate_transformation *>
+      (const_cast<virtual_interpolate_transformation *>
+       (&(*(md.interpolate_transformation(transname)))));
+    p->add_rigid_obstacle(obs, N);
+  }
+
   void add_rigid_obstacle_to_projection_transformation
   (ga_workspace &workspace, const std::string &transname,
    const std::string &expr, size_type N) {
@@ -2587,6 +3049,16 @@ namespace getfem {
     p->add_rigid_obstacle(workspace, expr, N);
   }
 
+  void add_rigid_obstacle_to_projection_transformation
+  (ga_workspace &workspace, const std::string &transname,
+   const pmesher_signed_distance &obs, size_type N) {
+    projection_interpolate_transformation *p
+      = dynamic_cast<projection_interpolate_transformation *>
+      (const_cast<virtual_interpolate_transformation *>
+       (&(*(workspace.interpolate_transformation(transname)))));
+    p->add_rigid_obstacle(obs, N);
+  }
+
 
 
   //=========================================================================
@@ -383,6 +383,15 @@ namespace getfem {
     }
   }
 
+  // Term of one of the matrices BN1, BN2, BT1, BT2 (numbered 0 to 3)
+  // computed by a thread and added to the matrix after the parallel loop.
+  struct contact_B_entry {
+    size_type im, i, j;
+    scalar_type val;
+    contact_B_entry(size_type im_, size_type i_, size_type j_, scalar_type v)
+      : im(im_), i(i_), j(j_), val(v) {}
+  };
+
   void compute_contact_matrices
          (const mesh_fem &mf_disp1, const mesh_fem &mf_disp2,
           contact_node_pair_list &cnpl, model_real_plain_vector &gap,
@@ -408,103 +417,144 @@ namespace getfem {
       GMM_ASSERT1( gmm::mat_nrows(*BT2) == cnpl.size() * d, "Wrong size of BT2");
     }
     gmm::fill(gap, scalar_type(10));  //FIXME: Needs a threshold value
-    for (size_type row = 0; row < cnpl.size(); ++row) {
-      contact_node_pair *cnp = &cnpl[row];
-      if (cnp->is_active) {
-        contact_node *cn_s = &cnp->cn_s;  //slave contact node
-        contact_node *cn_m = &cnp->cn_m;  //master contact node
-        const mesh &mesh_m = cn_m->mf->linked_mesh();
-        base_node slave_node = cn_s->mf->point_of_basic_dof(cn_s->dof);
-        base_node master_node = cn_m->mf->point_of_basic_dof(cn_m->dof);
-        GMM_ASSERT1(slave_node.size() == qdim && master_node.size() == qdim,
-                    "Internal error");
-        base_node un_sel(qdim), proj_node_sel(qdim), proj_node_ref_sel(qdim);
-        scalar_type is_in_min = 1e5;  //FIXME
-        size_type cv_sel = 0;
-        short_type fc_sel = 0;
-        std::vector<size_type>::iterator cv;
-        std::vector<short_type>::iterator fc;
-        for (cv = cn_m->cvs.begin(), fc = cn_m->fcs.begin();
-             cv != cn_m->cvs.end() && fc != cn_m->fcs.end(); cv++, fc++) {
-          base_node un(qdim), proj_node(qdim), proj_node_ref(qdim);
-          scalar_type is_in = projection_on_convex_face
-            (mesh_m, *cv, *fc, master_node, slave_node, un, proj_node, proj_node_ref);
-          if (is_in < is_in_min) {
-            is_in_min = is_in;
-            cv_sel = *cv;
-            fc_sel = *fc;
-            un_sel = un;
-            proj_node_sel = proj_node;
-            proj_node_ref_sel = proj_node_ref;
-          }
-        }
-        if (is_in_min < 0.05) {  //FIXME
-          gap[row] = gmm::vect_sp(slave_node-proj_node_sel, un_sel);
-
-	  std::vector<base_node> ut(d);
-          if (BT1) orthonormal_basis_to_unit_vec(d, un_sel, &(ut[0]));
-
-          CONTACT_B_MATRIX *BN = 0;
-          CONTACT_B_MATRIX *BT = 0;
-          if (cn_s->mf == &mf_disp1) {
-            BN = BN1;
-            BT = BT1;
-          } else if (cn_s->mf == &mf_disp2) {
-            BN = BN2;
-            BT = BT2;
-          }
-          if (BN)
-            for (size_type k = 0; k <= d; ++k)
-              (*BN)(row, cn_s->dof + k) -= un_sel[k];
-          if (BT)
-            for (size_type k = 0; k <= d; ++k)
-              for (size_type n = 0; n < d; ++n)
-                (*BT)(row * d + n, cn_s->dof + k) -= ut[n][k];
-
-          BN = 0;
-          const mesh_fem *mf_disp = 0;
-          if (cn_m->mf == &mf_disp1) {
-            BN = BN1;
-            BT = BT1;
-            mf_disp = &mf_disp1;
-          } else if (cn_m->mf == &mf_disp2) {
-            BN = BN2;
-            BT = BT2;
-            mf_disp = &mf_disp2;
-          }
-          if (BN) {
-            base_matrix G;
-            base_matrix M(qdim, mf_disp->nb_basic_dof_of_element(cv_sel));
-            mesh_m.points_of_convex(cv_sel, G);
-            pfem pf = mf_disp->fem_of_element(cv_sel);
-            bgeot::pgeometric_trans pgt = mesh_m.trans_of_convex(cv_sel);
-            fem_interpolation_context
-              ctx(pgt, pf, proj_node_ref_sel, G, cv_sel, fc_sel);
-            pf->interpolation (ctx, M, int(qdim));
-
-            mesh_fem::ind_dof_ct
-              master_dofs = mf_disp->ind_basic_dof_of_element(cv_sel);
-
-            model_real_plain_vector MT_u(mf_disp->nb_basic_dof_of_element(cv_sel));
-            gmm::mult(gmm::transposed(M), un_sel, MT_u);
-            for (size_type j = 0; j < master_dofs.size(); ++j)
-              (*BN)(row, master_dofs[j]) += MT_u[j];
-
-            if (BT) {
-              for (size_type n = 0; n < d; ++n) {
-                gmm::mult(gmm::transposed(M), ut[n], MT_u);
-                for (size_type j = 0; j < master_dofs.size(); ++j)
-                  (*BT)(row * d + n, master_dofs[j]) += MT_u[j];
+
+    // Each contact node pair gives its own rows of BN and BT. The pairs are
+    // distributed by contiguous chunks over the threads which store their
+    // terms in local buffers. The buffers are merged in the thread order
+    // so that the result does not depend on the number of threads.
+    CONTACT_B_MATRIX *Bs[4] = { BN1, BN2, BT1, BT2 };
+    mf_disp1.nb_basic_dof(); mf_disp2.nb_basic_dof();
+    omp_distribute<std::vector<contact_B_entry> > B_entries;
+    gmm::standard_locale locale;
+    open_mp_is_running_properly check;
+    thread_exception exception;
+    #pragma omp parallel default(shared)
+    {
+      exception.run([&]
+      {
+        std::vector<contact_B_entry> &entries = B_entries.thrd_cast();
+        size_type rowb, rowe;
+        thread_range(cnpl.size(), rowb, rowe);
+        for (size_type row = rowb; row < rowe; ++row) {
+          contact_node_pair *cnp = &cnpl[row];
+          if (cnp->is_active) {
+            contact_node *cn_s = &cnp->cn_s;  //slave contact node
+            contact_node *cn_m = &cnp->cn_m;  //master contact node
+            const mesh &mesh_m = cn_m->mf->linked_mesh();
+            base_node slave_node = cn_s->mf->point_of_basic_dof(cn_s->dof);
+            base_node master_node = cn_m->mf->point_of_basic_dof(cn_m->dof);
+            GMM_ASSERT1(slave_node.size() == qdim
+                        && master_node.size() == qdim, "Internal error");
+            base_node un_sel(qdim), proj_node_sel(qdim);
+            base_node proj_node_ref_sel(qdim);
+            scalar_type is_in_min = 1e5;  //FIXME
+            size_type cv_sel = 0;
+            short_type fc_sel = 0;
+            std::vector<size_type>::iterator cv;
+            std::vector<short_type>::iterator fc;
+            for (cv = cn_m->cvs.begin(), fc = cn_m->fcs.begin();
+                 cv != cn_m->cvs.end() && fc != cn_m->fcs.end(); cv++, fc++) {
+              base_node un(qdim), proj_node(qdim), proj_node_ref(qdim);
+              scalar_type is_in = projection_on_convex_face
+                (mesh_m, *cv, *fc, master_node, slave_node, un, proj_node,
+                 proj_node_ref);
+              if (is_in < is_in_min) {
+                is_in_min = is_in;
+                cv_sel = *cv;
+                fc_sel = *fc;
+                un_sel = un;
+                proj_node_sel = proj_node;
+                proj_node_ref_sel = proj_node_ref;
               }
             }
-          } // BN
+            if (is_in_min < 0.05) {  //FIXME
+              gap[row] = gmm::vect_sp(slave_node-proj_node_sel, un_sel);
+
+              std::vector<base_node> ut(d);
+              if (BT1) orthonormal_basis_to_unit_vec(d, un_sel, &(ut[0]));
+
+              size_type iBN = size_type(-1);
+              if (cn_s->mf == &mf_disp1) iBN = 0;
+              else if (cn_s->mf == &mf_disp2) iBN = 1;
+              if (iBN != size_type(-1) && Bs[iBN])
+                for (size_type k = 0; k <= d; ++k)
+                  entries.push_back(contact_B_entry(iBN, row, cn_s->dof + k,
+                                                    -un_sel[k]));
+              if (iBN != size_type(-1) && Bs[iBN+2])
+                for (size_type k = 0; k <= d; ++k)
+                  for (size_type n = 0; n < d; ++n)
+                    entries.push_back(contact_B_entry
+                                      (iBN+2, row * d + n, cn_s->dof + k,
+                                       -ut[n][k]));
+
+              iBN = size_type(-1);
+              const mesh_fem *mf_disp = 0;
+              if (cn_m->mf == &mf_disp1) {
+                iBN = 0;
+                mf_disp = &mf_disp1;
+              } else if (cn_m->mf == &mf_disp2) {
+                iBN = 1;
+                mf_disp = &mf_disp2;
+              }
+              if (iBN != size_type(-1) && Bs[iBN]) {
+                base_matrix G;
+                base_matrix M(qdim, mf_disp->nb_basic_dof_of_element(cv_sel));
+                mesh_m.points_of_convex(cv_sel, G);
+                pfem pf = mf_disp->fem_of_element(cv_sel);
+                bgeot::pgeometric_trans pgt = mesh_m.trans_of_convex(cv_sel);
+                fem_interpolation_context
+                  ctx(pgt, pf, proj_node_ref_sel, G, cv_sel, fc_sel);
+                pf->interpolation (ctx, M, int(qdim));
+
+                mesh_fem::ind_dof_ct
+                  master_dofs = mf_disp->ind_basic_dof_of_element(cv_sel);
+
+                model_real_plain_vector
+                  MT_u(mf_disp->nb_basic_dof_of_element(cv_sel));
+                gmm::mult(gmm::transposed(M), un_sel, MT_u);
+                for (size_type j = 0; j < master_dofs.size(); ++j)
+                  entries.push_back(contact_B_entry(iBN, row, master_dofs[j],
+                                                    MT_u[j]));
+
+                if (Bs[iBN+2]) {
+                  for (size_type n = 0; n < d; ++n) {
+                    gmm::mult(gmm::transposed(M), ut[n], MT_u);
+                    for (size_type j = 0; j < master_dofs.size(); ++j)
+                      entries.push_back(contact_B_entry(iBN+2, row * d + n,
+                                                        master_dofs[j], MT_u[j]));
+                  }
+                }
+              } // BN
 
-        }
-      } // if:cnp->cn_s
-    } // cnp
+            }
+          } // if:cnp->cn_s
+        } // cnp
+      });
+    }
+    exception.rethrow();
+
+    for (size_type th = 0; th < num_threads(); ++th)
+      for (const contact_B_entry &e : B_entries(th))
+        (*(Bs[e.im]))(e.i, e.j) += e.val;
 
   } // compute_contact_matrices
 
+  // The loops below call open_mp_range_for. Each loop body should only
+  // write the rows or the columns of the results which belong to its index,
+  // so that the result does not depend on the number of threads.
+
+  // y += B x, the rows of B being distributed over the threads.
+  template <typename VEC>
+  static void contact_parallel_mult_add(const CONTACT_B_MATRIX &B,
+                                        const VEC &x,
+                                        model_real_plain_vector &y) {
+    GMM_ASSERT2(gmm::mat_ncols(B) == gmm::vect_size(x)
+                && gmm::mat_nrows(B) == gmm::vect_size(y),
+                "dimensions mismatch");
+    open_mp_range_for(gmm::mat_nrows(B), [&](size_type i)
+      { y[i] += gmm::vect_sp(gmm::mat_const_row(B, i), x); });
+  }
+
 
 
   //=========================================================================
@@ -583,23 +633,25 @@ namespace getfem {
       gmm::copy(gmm::scaled(gap, r), RLN);
       for (size_type i = 0; i < gmm::mat_nrows(BN1); ++i) RLN[i] *= alpha[i];
       gmm::add(lambda_n, RLN);
-      gmm::mult_add(BBN1, gmm::scaled(u1, -r), RLN);
+      contact_parallel_mult_add(BBN1, gmm::scaled(u1, -r), RLN);
       if (Hughes_stabilized)
-        gmm::mult_add(DDN, gmm::scaled(lambda_n, -r), RLN);
-      if (two_variables) gmm::mult_add(BBN2, gmm::scaled(u2, -r), RLN);
+        contact_parallel_mult_add(DDN, gmm::scaled(lambda_n, -r), RLN);
+      if (two_variables)
+        contact_parallel_mult_add(BBN2, gmm::scaled(u2, -r), RLN);
       if (!contact_only) {
         gmm::copy(lambda_t, RLT);
         if (friction_dynamic_term) {
-          gmm::mult_add(BBT1, gmm::scaled(wt1, -r*gamma), RLT);
+          contact_parallel_mult_add(BBT1, gmm::scaled(wt1, -r*gamma), RLT);
           if (two_variables)
-            gmm::mult_add(BBT2, gmm::scaled(wt2, -r*gamma), RLT);
+            contact_parallel_mult_add(BBT2, gmm::scaled(wt2, -r*gamma), RLT);
         }
         if (!really_stationary) {
-          gmm::mult_add(BBT1, gmm::scaled(u1, -r), RLT);
-          if (two_variables) gmm::mult_add(BBT2, gmm::scaled(u2, -r), RLT);
+          contact_parallel_mult_add(BBT1, gmm::scaled(u1, -r), RLT);
+          if (two_variables)
+            contact_parallel_mult_add(BBT2, gmm::scaled(u2, -r), RLT);
         }
         if (Hughes_stabilized)
-          gmm::mult_add(DDT, gmm::scaled(lambda_t, -r), RLT);
+          contact_parallel_mult_add(DDT, gmm::scaled(lambda_t, -r), RLT);
       }
     }
 
@@ -652,10 +704,10 @@ namespace getfem {
       if (augmentation_version <= 2)
         precomp(u1, u2, lambda_n, lambda_t, wt1, wt2);
 
+      // The loops on the contact nodes are done in parallel, each contact
+      // node only writing its own columns of the tangent terms. The
+      // products by the transposed matrices are kept serial.
       if (version & model::BUILD_MATRIX) {
-        base_matrix pg(d, d);
-        base_vector vg(d);
-
         gmm::clear(T_n_n); gmm::clear(T_n_u1);
         gmm::clear(T_u1_n); gmm::clear(T_u1_u1);
         if (two_variables)
@@ -670,7 +722,7 @@ namespace getfem {
           gmm::copy(gmm::scaled(gmm::transposed(BN1), -vt1), T_u1_n);
           if (two_variables)
             gmm::copy(gmm::scaled(gmm::transposed(BN2), -vt1), T_u2_n);
-          for (size_type i=0; i < nbc; ++i) {
+          open_mp_range_for(nbc, [&](size_type i) {
             if (RLN[i] > vt0) {
               gmm::clear(gmm::mat_col(T_u1_n, i));
               if (two_variables) gmm::clear(gmm::mat_col(T_u2_n, i));
@@ -679,7 +731,7 @@ namespace getfem {
             if (Hughes_stabilized && RLN[i] <= vt0)
               gmm::copy(gmm::scaled(gmm::mat_row(DN, i), -vt1),
                         gmm::mat_col(T_n_n, i));
-          }
+          });
           if (Hughes_stabilized) {
             model_real_sparse_matrix aux(nbc, nbc);
             gmm::copy(gmm::transposed(T_n_n), aux);
@@ -688,7 +740,9 @@ namespace getfem {
           gmm::copy(gmm::transposed(T_u1_n), T_n_u1);
           if (two_variables) gmm::copy(gmm::transposed(T_u2_n), T_n_u2);
           if (!contact_only) {
-            for (size_type i=0; i < nbc; ++i) {
+            open_mp_range_for(nbc, [&](size_type i) {
+              base_matrix pg(d, d);
+              base_vector vg(d);
               gmm::sub_interval SUBI(i*d, d);
               scalar_type th = Tresca_version ? threshold[i]
                 : - (std::min(vt0, RLN[i])) * friction_coeff[i];
@@ -722,7 +776,7 @@ namespace getfem {
                   }
               }
 
-            }
+            });
             if (Hughes_stabilized) {
               model_real_sparse_matrix aux(gmm::mat_nrows(T_t_t),
 					   gmm::mat_nrows(T_t_t));
@@ -777,7 +831,8 @@ namespace getfem {
 	    model_real_sparse_matrix tmp4(gmm::mat_ncols(T_t_u2),
 					  gmm::mat_nrows(T_t_u2));
 
-	    for (size_type i=0; i < nbc; ++i) {
+	    open_mp_range_for(nbc, [&](size_type i) {
+	      base_vector vg(d);
 	      gmm::sub_interval SUBI(i*d, d);
 	      scalar_type th = - (std::min(vt0, RLN[i])) * friction_coeff[i];
 	      if (RLN[i] <= vt0) {
@@ -812,7 +867,7 @@ namespace getfem {
 		  }
 		}
 	      }
-	    }
+	    });
 
 	    gmm::add(gmm::transposed(tmp3), T_t_u1);
 	    if (two_variables)
@@ -835,17 +890,19 @@ namespace getfem {
           gmm::copy(gmm::scaled(gmm::transposed(BN1), -vt1), T_u1_n);
           if (two_variables)
             gmm::copy(gmm::scaled(gmm::transposed(BN2), -vt1), T_u2_n);
-          for (size_type i=0; i < nbc; ++i) {
+          open_mp_range_for(nbc, [&](size_type i) {
             if (lambda_n[i] > vt0) {
               gmm::clear(gmm::mat_col(T_u1_n, i));
               if (two_variables) gmm::clear(gmm::mat_col(T_u2_n, i));
               T_n_n(i, i) = -vt1/r;
             }
-          }
+          });
           gmm::copy(gmm::scaled(BN1, -vt1), T_n_u1);
           if (two_variables) gmm::copy(gmm::scaled(BN2, -r), T_n_u2);
           if (!contact_only) {
-            for (size_type i=0; i < nbc; ++i) {
+            open_mp_range_for(nbc, [&](size_type i) {
+              base_matrix pg(d, d);
+              base_vector vg(d);
               gmm::sub_interval SUBI(i*d, d);
               scalar_type th = Tresca_version ? threshold[i]
                 : gmm::neg(lambda_n[i]) * friction_coeff[i];
@@ -878,22 +935,23 @@ namespace getfem {
               gmm::copy(gmm::scaled(pg, vt1/(r*alpha[i])),
 			gmm::sub_matrix(T_t_t, SUBI));
 
-            }
+            });
             gmm::copy(gmm::scaled(BT1, -vt1), T_t_u1);
             if (two_variables) gmm::copy(gmm::scaled(BT2, -r), T_t_u2);
           }
           break;
 
         case 4: // Desaxce projection
-          base_small_vector x(d+1), n(d+1), u(d); n[0] = vt1;
-          base_matrix g(d+1, d+1);
           model_real_sparse_matrix T_n_u1_transp(gmm::mat_ncols(T_n_u1), nbc);
           model_real_sparse_matrix T_n_u2_transp(gmm::mat_ncols(T_n_u2), nbc);
 
-          gmm::mult(BT1, u1, RLT);
-          if (two_variables) gmm::mult_add(BT2, u2, RLT);
+          gmm::clear(RLT);
+          contact_parallel_mult_add(BT1, u1, RLT);
+          if (two_variables) contact_parallel_mult_add(BT2, u2, RLT);
 
-          for (size_type i=0; i < nbc; ++i) {
+          open_mp_range_for(nbc, [&](size_type i) {
+            base_small_vector x(d+1), n(d+1), u(d); n[0] = vt1;
+            base_matrix g(d+1, d+1);
             x[0] = lambda_n[i];
             for (size_type j=0; j < d; ++j) x[1+j] = lambda_t[i*d+j];
             De_Saxce_projection_grad(x, n, friction_coeff[i], g);
@@ -943,7 +1001,7 @@ namespace getfem {
               T_t_n(i*d+j, i) = g(1+j,0)/(r*alpha[i]);
               // T_n_t(i, i*d+j) = g(0,1+j)/(r*alpha[i]);
             }
-          }
+          });
           gmm::copy(gmm::scaled(BN1, -vt1), T_n_u1);
           if (two_variables) gmm::copy(gmm::scaled(BN2, -vt1), T_n_u2);
           gmm::add(gmm::transposed(T_n_u1_transp), T_n_u1);
@@ -958,7 +1016,7 @@ namespace getfem {
 
         switch (augmentation_version) {
         case 1: // unsymmetric Alart-Curnier
-          for (size_type i=0; i < nbc; ++i) {
+          open_mp_range_for(nbc, [&](size_type i) {
             RLN[i] = std::min(scalar_type(0), RLN[i]);
             if (!contact_only) {
               scalar_type radius = Tresca_version ? threshold[i]
@@ -966,7 +1024,7 @@ namespace getfem {
               ball_projection
                 (gmm::sub_vector(RLT, gmm::sub_interval(i*d,d)), radius);
             }
-          }
+          });
           gmm::mult_add(gmm::transposed(BN1), lambda_n, ru1);
           if (two_variables)
             gmm::mult_add(gmm::transposed(BN2), lambda_n, ru2);
@@ -984,7 +1042,7 @@ namespace getfem {
 	  }
           break;
         case 2: // symmetric Alart-Curnier
-          for (size_type i=0; i < nbc; ++i) {
+          open_mp_range_for(nbc, [&](size_type i) {
             RLN[i] = std::min(vt0, RLN[i]);
             if (!contact_only) {
               scalar_type radius = Tresca_version ? threshold[i]
@@ -992,7 +1050,7 @@ namespace getfem {
               ball_projection
                 (gmm::sub_vector(RLT, gmm::sub_interval(i*d,d)), radius);
             }
-          }
+          });
           gmm::mult_add(gmm::transposed(BN1), RLN, ru1);
           if (two_variables) gmm::mult_add(gmm::transposed(BN2), RLN, ru2);
           if (!contact_only) {
@@ -1009,7 +1067,7 @@ namespace getfem {
           break;
         case 3: // New unsymmetric method
           if (!contact_only) gmm::copy(lambda_t, RLT);
-          for (size_type i=0; i < nbc; ++i) {
+          open_mp_range_for(nbc, [&](size_type i) {
             RLN[i] = -gmm::neg(lambda_n[i]);
             rlambda_n[i] = gmm::pos(lambda_n[i])/r - alpha[i]*gap[i];
 
@@ -1019,18 +1077,18 @@ namespace getfem {
               ball_projection
                 (gmm::sub_vector(RLT, gmm::sub_interval(i*d,d)), radius);
             }
-          }
+          });
           gmm::mult(gmm::transposed(BN1), RLN, ru1);
           if (two_variables) gmm::mult(gmm::transposed(BN2), RLN, ru2);
-          gmm::mult_add(BBN1, u1, rlambda_n);
-          if (two_variables) gmm::mult_add(BBN2, u2, rlambda_n);
+          contact_parallel_mult_add(BBN1, u1, rlambda_n);
+          if (two_variables) contact_parallel_mult_add(BBN2, u2, rlambda_n);
           if (!contact_only) {
             gmm::mult_add(gmm::transposed(BT1), RLT, ru1);
             if (two_variables) gmm::mult_add(gmm::transposed(BT2), RLT, ru2);
             gmm::add(gmm::scaled(lambda_t, vt1/r), gmm::scaled(RLT,-vt1/r),
                       rlambda_t);
-            gmm::mult_add(BBT1, u1, rlambda_t);
-            if (two_variables) gmm::mult_add(BBT2, u2, rlambda_t);
+            contact_parallel_mult_add(BBT1, u1, rlambda_t);
+            if (two_variables) contact_parallel_mult_add(BBT2, u2, rlambda_t);
           }
 	  for (size_type i = 0; i < nbc; ++i) {
 	    rlambda_n[i] /= alpha[i];
@@ -1039,14 +1097,15 @@ namespace getfem {
 	  }
           break;
         case 4:  // New unsymmetric method with De Saxce projection
-          base_small_vector x(d+1), n(d+1);
-          n[0] = vt1;
           GMM_ASSERT1(!Tresca_version,
                "Augmentation version incompatible with Tresca friction law");
-          gmm::mult(BBT1, u1, rlambda_t);
+          gmm::clear(rlambda_t);
+          contact_parallel_mult_add(BBT1, u1, rlambda_t);
           if (two_variables)
-              gmm::mult_add(BBT2, u2, rlambda_t);
-          for (size_type i=0; i < nbc; ++i) {
+              contact_parallel_mult_add(BBT2, u2, rlambda_t);
+          open_mp_range_for(nbc, [&](size_type i) {
+            base_small_vector x(d+1), n(d+1);
+            n[0] = vt1;
             x[0] = lambda_n[i];
             gmm::copy(gmm::sub_vector(lambda_t, gmm::sub_interval(i*d,d)),
                       gmm::sub_vector(x, gmm::sub_interval(1, d)));
@@ -1057,15 +1116,15 @@ namespace getfem {
             rlambda_n[i] = lambda_n[i]/r - x[0]/r - alpha[i]*gap[i]
               - friction_coeff[i] * gmm::vect_norm2(gmm::sub_vector(rlambda_t,
                                                     gmm::sub_interval(i*d,d)));
-          }
+          });
           gmm::mult_add(gmm::transposed(BT1), RLT, ru1);
           if (two_variables) gmm::mult_add(gmm::transposed(BT2), RLT, ru2);
           gmm::mult_add(gmm::transposed(BN1), RLN, ru1);
           if (two_variables) gmm::mult_add(gmm::transposed(BN2), RLN, ru2);
           gmm::add(gmm::scaled(lambda_t, vt1/r), rlambda_t);
           gmm::add(gmm::scaled(RLT, -vt1/r), rlambda_t);
-          gmm::mult_add(BBN1, u1, rlambda_n);
-          if (two_variables) gmm::mult_add(BBN2, u2, rlambda_n);
+          contact_parallel_mult_add(BBN1, u1, rlambda_n);
+          if (two_variables) contact_parallel_mult_add(BBN2, u2, rlambda_n);
 	  for (size_type i = 0; i < nbc; ++i) {
 	    rlambda_n[i] /= alpha[i];
 	    if (!contact_only)
@@ -1077,15 +1136,17 @@ namespace getfem {
     }
 
     // specific part for the basic bricks : BN, BT, gap, r, alpha are given.
-    virtual void asm_real_tangent_terms(const model &md, size_type ib,
-                                        const model::varnamelist &vl,
-                                        const model::varnamelist &dl,
-                                        const model::mimlist &mims,
-                                        model::real_matlist &matl,
-                                        model::real_veclist &vecl,
-                                        model::real_veclist &,
-                                        size_type /* region */,
-                                        build_version version) const {
+    // The terms are computed out of the parallel assembly of the bricks of
+    // the model, the loops on the contact nodes being threaded.
+    virtual void real_pre_assembly_in_serial(const model &md, size_type ib,
+                                             const model::varnamelist &vl,
+                                             const model::varnamelist &dl,
+                                             const model::mimlist &mims,
+                                             model::real_matlist &matl,
+                                             model::real_veclist &vecl,
+                                             model::real_veclist &,
+                                             size_type /* region */,
+                                             build_version version) const {
       if (MPI_IS_MASTER()) {
       GMM_ASSERT1(mims.size() == 0, "Contact brick need no mesh_im");
       size_type nbvar = 2 + (contact_only ? 0 : 1) + (two_variables ? 1 : 0);
@@ -1459,15 +1520,15 @@ namespace getfem {
 
   public :
 
-    virtual void asm_real_tangent_terms(const model &md, size_type ib,
-                                        const model::varnamelist &vl,
-                                        const model::varnamelist &dl,
-                                        const model::mimlist &mims,
-                                        model::real_matlist &matl,
-                                        model::real_veclist &vecl,
-                                        model::real_veclist &,
-                                        size_type region,
-                                        build_version version) const {
+    virtual void real_pre_assembly_in_serial(const model &md, size_type ib,
+                                             const model::varnamelist &vl,
+                                             const model::varnamelist &dl,
+                                             const model::mimlist &mims,
+                                             model::real_matlist &matl,
+                                             model::real_veclist &vecl,
+                                             model::real_veclist &,
+                                             size_type region,
+                                             build_version version) const {
       if (MPI_IS_MASTER()) {
       GMM_ASSERT1(mims.size() == 1, "This contact brick needs one mesh_im");
       size_type nbvar = 2 + (contact_only ? 0 : 1);
@@ -1722,15 +1783,15 @@ namespace getfem {
                          // as slave surfaces (the contact multipliers are
                          // defined on these surfaces)
 
-    virtual void asm_real_tangent_terms(const model &md, size_type ib,
-                                        const model::varnamelist &vl,
-                                        const model::varnamelist &dl,
-                                        const model::mimlist &mims,
-                                        model::real_matlist &matl,
-                                        model::real_veclist &vecl,
-                                        model::real_veclist &,
-                                        size_type region,
-                                        build_version version) const {
+    virtual void real_pre_assembly_in_serial(const model &md, size_type ib,
+                                             const model::varnamelist &vl,
+                                             const model::varnamelist &dl,
+                                             const model::mimlist &mims,
+                                             model::real_matlist &matl,
+                                             model::real_veclist &vecl,
+                                             model::real_veclist &,
+                                             size_type region,
+                                             build_version version) const {
       if (MPI_IS_MASTER()) {
       GMM_ASSERT1(mims.size() == 2, "This contact brick needs two mesh_im");
       const mesh_im &mim1 = *mims[0];
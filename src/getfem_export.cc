@@ -20,9 +20,18 @@
 ===========================================================================*/
 
 #include <iomanip>
+#include <cstring>
+#include <cstdint>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "getfem/dal_singleton.h"
 #include "getfem/bgeot_comma_init.h"
 #include "getfem/getfem_export.h"
+#if defined(GETFEM_HAVE_ZLIB_H)
+# include <zlib.h>
+#endif
 
 namespace getfem
 {
@@ -431,6 +440,56 @@ namespace getfem
     state = STRUCTURE_WRITTEN;
   }
 
+  void vtk_export::mesh_structure_arrays(std::vector<float> &pts,
+                                         std::vector<int> &conn,
+                                         std::vector<int> &offsets,
+                                         std::vector<unsigned char> &types)
+    const {
+    conn.resize(0); offsets.resize(0); types.resize(0);
+    if (psl) {
+      static unsigned char vtk_simplex_code[4]
+        = { VTK_VERTEX, VTK_LINE, VTK_TRIANGLE, VTK_TETRA };
+      pts.assign(3*psl->nb_points(), 0.f);
+      size_type nodes_cnt = 0;
+      for (size_type ic=0; ic < psl->nb_convex(); ++ic) {
+        for (size_type i=0; i < psl->nodes(ic).size(); ++i) {
+          const base_node &P = psl->nodes(ic)[i].pt;
+          for (size_type k=0; k < P.size(); ++k)
+            pts[3*(nodes_cnt+i)+k] = float(P[k]);
+        }
+        const getfem::mesh_slicer::cs_simplexes_ct& s = psl->simplexes(ic);
+        for (size_type i=0; i < s.size(); ++i) {
+          for (size_type j=0; j < s[i].dim()+1; ++j)
+            conn.push_back(int(s[i].inodes[j] + nodes_cnt));
+          offsets.push_back(int(conn.size()));
+          types.push_back(vtk_simplex_code[s[i].dim()]);
+        }
+        nodes_cnt += psl->nodes(ic).size();
+      }
+    } else {
+      pts.assign(3*pmf_dof_used.card(), 0.f);
+      std::vector<int> dofmap(pmf->nb_dof());
+      int cnt = 0;
+      for (dal::bv_visitor d(pmf_dof_used); !d.finished(); ++d, ++cnt) {
+        dofmap[d] = cnt;
+        base_node P = pmf->point_of_basic_dof(d);
+        for (size_type k=0; k < P.size(); ++k) pts[3*cnt+k] = float(P[k]);
+      }
+      size_type nbcv = pmf->convex_index().card();
+      offsets.resize(nbcv); types.resize(nbcv);
+      size_type i = 0;
+      for (dal::bv_visitor cv(pmf->convex_index()); !cv.finished();
+           ++cv, ++i) {
+        const std::vector<unsigned> &dmap
+          = select_vtk_dof_mapping(pmf_mapping_type[cv]);
+        for (size_type j=0; j < dmap.size(); ++j)
+          conn.push_back(dofmap[pmf->ind_basic_dof_of_element(cv)[dmap[j]]]);
+        offsets[i] = int(conn.size());
+        types[i] = (unsigned char)(select_vtk_type(pmf_mapping_type[cv]));
+      }
+    }
+  }
+
   void vtk_export::write_mesh_quality(const mesh &m) {
     if (psl) {
       mesh_fem mf(const_cast<mesh&>(m),1);
@@ -450,6 +509,463 @@ namespace getfem
   }
 
 
+  /* -------------------------------------------------------------
+   * VTK XML export
+   * ------------------------------------------------------------- */
+
+  // Byte order of the binary data of the vtu and xdmf exports.
+  static bool little_endian() {
+    static int test_endian = 0x01234567;
+    return *((char*)&test_endian) == 0x67;
+  }
+
+  static const char *vtu_byte_order()
+  { return little_endian() ? "LittleEndian" : "BigEndian"; }
+
+  vtu_export::vtu_export(std::ostream &os_, bool compressed_)
+    : vtk_export(os_, false), compressed(compressed_) { init(); }
+
+  vtu_export::vtu_export(const std::string& fname, bool compressed_)
+    : vtk_export(fname, false), compressed(compressed_) { init(); }
+
+  vtu_export::~vtu_export() {
+    // No exception should be thrown by a destructor
+    if (!closed) {
+      try { close(); }
+      catch (const std::exception &e) {
+        GMM_WARNING1("vtu export: the file could not be written: "
+                     << e.what());
+      }
+    }
+  }
+
+  void vtu_export::init() {
+    nb_points = nb_cells = 0; closed = false;
+#if !defined(GETFEM_HAVE_ZLIB_H)
+    if (compressed) {
+      GMM_WARNING1("getfem++ is compiled without zlib, the vtu "
+                   "export will not be compressed");
+      compressed = false;
+    }
+#endif
+  }
+
+  /* Appended data, with a 64 bits header (header_type="UInt64"). Without
+     compression, it is the number of bytes followed by the data. With
+     compression, the data is cut into blocks of 32 kB compressed
+     independently, the header is the number of blocks, the size of the
+     blocks, the size of the last block and the compressed size of each
+     block. */
+  void vtu_export::encode(const char *p, size_type nb,
+                          std::vector<char> &data) const {
+    typedef uint64_t header_type;
+    if (!compressed) {
+      header_type h = nb;
+      data.resize(sizeof(header_type) + nb);
+      memcpy(&data[0], &h, sizeof(header_type));
+      if (nb) memcpy(&data[sizeof(header_type)], p, nb);
+      return;
+    }
+#if defined(GETFEM_HAVE_ZLIB_H)
+    const size_type bs = 32768;
+    size_type nbb = (nb + bs - 1) / bs;
+    std::vector<std::vector<char>> blocks(nbb);
+
+    open_mp_range_for(nbb, [&](size_type i) {
+        uLong l = uLong(std::min(bs, nb - i*bs));
+        uLongf lc = compressBound(l);
+        blocks[i].resize(lc);
+        int res = compress2((Bytef *)(&blocks[i][0]), &lc,
+                            (const Bytef *)(p + i*bs), l, Z_BEST_SPEED);
+        GMM_ASSERT1(res == Z_OK, "vtu export: zlib compression error");
+        blocks[i].resize(lc);
+      });
+
+    std::vector<header_type> h(3 + nbb);
+    h[0] = nbb; h[1] = bs; h[2] = nb % bs;
+    size_type size = 0;
+    for (size_type i = 0; i < nbb; ++i) {
+      h[3+i] = blocks[i].size(); size += blocks[i].size();
+    }
+    data.resize(h.size()*sizeof(header_type) + size);
+    memcpy(&data[0], &h[0], h.size()*sizeof(header_type));
+    size = h.size()*sizeof(header_type);
+    for (size_type i = 0; i < nbb; ++i) {
+      memcpy(&data[size], &blocks[i][0], blocks[i].size());
+      size += blocks[i].size();
+    }
+#endif
+  }
+
+  void vtu_export::add_array(std::vector<data_array> &arrays,
+                             const std::string& name, const char *type,
+                             const void *p, size_type nb,
+                             size_type nb_comp) {
+    GMM_ASSERT1(!closed, "vtu export: the file is already written");
+    for (const data_array &a : arrays)
+      GMM_ASSERT1(a.name != name || name.empty(),
+                  "vtu export: two fields named '" << name << "'");
+    arrays.push_back(data_array());
+    arrays.back().name = name; arrays.back().type = type;
+    arrays.back().nb_comp = nb_comp;
+    encode((const char *)(p), nb, arrays.back().data);
+  }
+
+  void vtu_export::write_mesh() {
+    if (state >= STRUCTURE_WRITTEN) return;
+    std::vector<float> pts;
+    std::vector<int> conn, offsets;
+    std::vector<unsigned char> types;
+    mesh_structure_arrays(pts, conn, offsets, types);
+    nb_points = pts.size() / 3; nb_cells = types.size();
+    add_array(structure_arrays, "", "Float32", pts.data(),
+              pts.size()*sizeof(float), 3);
+    add_array(structure_arrays, "connectivity", "Int32", conn.data(),
+              conn.size()*sizeof(int), 1);
+    add_array(structure_arrays, "offsets", "Int32", offsets.data(),
+              offsets.size()*sizeof(int), 1);
+    add_array(structure_arrays, "types", "UInt8", types.data(),
+              types.size(), 1);
+    state = STRUCTURE_WRITTEN;
+  }
+
+  void vtu_export::write_mesh_quality(const mesh &m) {
+    if (psl) {
+      mesh_fem mf(const_cast<mesh&>(m),1);
+      mf.set_classical_finite_element(0);
+      std::vector<scalar_type> q(mf.nb_dof());
+      for (size_type d=0; d < mf.nb_dof(); ++d) {
+        q[d] = m.convex_quality_estimate(mf.first_convex_of_basic_dof(d));
+      }
+      write_point_data(mf, q, "convex_quality");
+    } else {
+      std::vector<scalar_type> q(pmf->convex_index().card());
+      size_type i = 0;
+      for (dal::bv_visitor cv(pmf->convex_index()); !cv.finished(); ++cv)
+        q[i++] = m.convex_quality_estimate(cv);
+      write_cell_data(q, "convex_quality");
+    }
+  }
+
+  void vtu_export::write_array_headers(array_iterator it, array_iterator ite,
+                                       size_type &offset) {
+    for (; it != ite; ++it) {
+      const data_array &a = *it;
+      os << "<DataArray type=\"" << a.type << "\"";
+      if (!a.name.empty()) os << " Name=\"" << a.name << "\"";
+      if (a.nb_comp != 1)
+        os << " NumberOfComponents=\"" << a.nb_comp << "\"";
+      os << " format=\"appended\" offset=\"" << offset << "\"/>\n";
+      offset += a.data.size();
+    }
+  }
+
+  void vtu_export::close() {
+    if (closed) return;
+    write_mesh();
+    os << "<?xml version=\"1.0\"?>\n"
+       << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+       << vtu_byte_order() << "\" header_type=\"UInt64\"";
+    if (compressed) os << " compressor=\"vtkZLibDataCompressor\"";
+    os << ">\n<UnstructuredGrid>\n<Piece NumberOfPoints=\"" << nb_points
+       << "\" NumberOfCells=\"" << nb_cells << "\">\n";
+    size_type offset = 0;
+    os << "<PointData>\n";
+    write_array_headers(point_arrays.begin(), point_arrays.end(), offset);
+    os << "</PointData>\n<CellData>\n";
+    write_array_headers(cell_arrays.begin(), cell_arrays.end(), offset);
+    os << "</CellData>\n<Points>\n";
+    write_array_headers(structure_arrays.begin(),
+                        structure_arrays.begin() + 1, offset);
+    os << "</Points>\n<Cells>\n";
+    write_array_headers(structure_arrays.begin() + 1,
+                        structure_arrays.end(), offset);
+    os << "</Cells>\n</Piece>\n</UnstructuredGrid>\n"
+       << "<AppendedData encoding=\"raw\">\n_";
+    for (std::vector<data_array> *arrays
+           : { &point_arrays, &cell_arrays, &structure_arrays })
+      for (data_array &a : *arrays) {
+        os.write(&a.data[0], std::streamsize(a.data.size()));
+        std::vector<char>().swap(a.data); // the names are kept for write_pvtu
+      }
+    os << "\n</AppendedData>\n</VTKFile>\n";
+    os.flush();
+    GMM_ASSERT1(os.good(), "vtu export: error while writing the file");
+    closed = true;
+  }
+
+  void vtu_export::write_pvtu(const std::string& fname,
+                              const std::vector<std::string> &pieces) const {
+    std::ofstream f(fname.c_str());
+    GMM_ASSERT1(f, "impossible to write to pvtu file '" << fname << "'");
+    f << "<?xml version=\"1.0\"?>\n"
+      << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\""
+      << vtu_byte_order() << "\" header_type=\"UInt64\">\n"
+      << "<PUnstructuredGrid GhostLevel=\"0\">\n<PPointData>\n";
+    for (const std::vector<data_array> *arrays : { &point_arrays,
+                                                   &cell_arrays }) {
+      for (const data_array &a : *arrays) {
+        f << "<PDataArray type=\"" << a.type << "\" Name=\"" << a.name << "\"";
+        if (a.nb_comp != 1)
+          f << " NumberOfComponents=\"" << a.nb_comp << "\"";
+        f << "/>\n";
+      }
+      if (arrays == &point_arrays) f << "</PPointData>\n<PCellData>\n";
+    }
+    f << "</PCellData>\n<PPoints>\n"
+      << "<PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n"
+      << "</PPoints>\n";
+    for (const std::string &s : pieces)
+      f << "<Piece Source=\"" << s << "\"/>\n";
+    f << "</PUnstructuredGrid>\n</VTKFile>\n";
+    GMM_ASSERT1(f.good(), "error while writing the pvtu file '"
+                << fname << "'");
+  }
+
+  pvd_export::pvd_export(const std::string& fname_) : fname(fname_)
+  { write(); }
+
+  void pvd_export::add_dataset(scalar_type time, const std::string& file,
+                               size_type part) {
+    dataset d; d.time = time; d.part = part; d.file = file;
+    datasets.push_back(d);
+    write();
+  }
+
+  void pvd_export::write() const {
+    std::ofstream f(fname.c_str());
+    GMM_ASSERT1(f, "impossible to write to pvd file '" << fname << "'");
+    f << std::setprecision(16);
+    f << "<?xml version=\"1.0\"?>\n"
+      << "<VTKFile type=\"Collection\" version=\"0.1\">\n<Collection>\n";
+    for (const dataset &d : datasets)
+      f << "<DataSet timestep=\"" << d.time << "\" part=\"" << d.part
+        << "\" file=\"" << d.file << "\"/>\n";
+    f << "</Collection>\n</VTKFile>\n";
+    GMM_ASSERT1(f.good(), "error while writing the pvd file '"
+                << fname << "'");
+  }
+
+  /* -------------------------------------------------------------
+   * XDMF time series export
+   * ------------------------------------------------------------- */
+
+  /* Writes the queued data blocks to the binary file, and the XML
+     descriptions to their file, in a background thread and in the order
+     of the queue. The size of the queue is limited, push_data waits when
+     the writing is too late. */
+  class xdmf_async_writer {
+    std::ostream &os;
+    std::string xml_fname;
+    struct job { std::vector<char> data; std::string xml; };
+    std::deque<job> jobs;
+    size_type queued;
+    bool busy, stop, error;
+    std::mutex mtx;
+    std::condition_variable cond_jobs, cond_done;
+    std::thread th;
+    static const size_type max_queued = size_type(1) << 28;
+
+    void run() {
+      for (;;) {
+        job j;
+        {
+          std::unique_lock<std::mutex> lock(mtx);
+          cond_jobs.wait(lock, [this]{ return stop || !jobs.empty(); });
+          if (jobs.empty()) return;
+          j.data.swap(jobs.front().data); j.xml.swap(jobs.front().xml);
+          jobs.pop_front(); busy = true;
+        }
+        bool ok = true;
+        if (j.data.size()) {
+          os.write(&j.data[0], std::streamsize(j.data.size()));
+          ok = os.good();
+        } else {
+          os.flush();
+          std::ofstream f(xml_fname.c_str());
+          f << j.xml;
+          ok = os.good() && f.good();
+        }
+        {
+          std::unique_lock<std::mutex> lock(mtx);
+          queued -= j.data.size(); busy = false;
+          if (!ok) error = true;
+        }
+        cond_done.notify_all();
+      }
+    }
+
+    void push(job &j) {
+      std::unique_lock<std::mutex> lock(mtx);
+      cond_done.wait(lock, [this]{ return queued < max_queued; });
+      queued += j.data.size();
+      jobs.push_back(job());
+      jobs.back().data.swap(j.data); jobs.back().xml.swap(j.xml);
+      lock.unlock();
+      cond_jobs.notify_one();
+    }
+
+  public:
+    void push_data(std::vector<char> &data)
+    { job j; j.data.swap(data); push(j); }
+    void push_xml(const std::string &xml) { job j; j.xml = xml; push(j); }
+
+    void flush() {
+      std::unique_lock<std::mutex> lock(mtx);
+      cond_done.wait(lock, [this]{ return jobs.empty() && !busy; });
+      GMM_ASSERT1(!error, "xdmf export: error while writing the files");
+    }
+
+    xdmf_async_writer(std::ostream &os_, const std::string &xml_fname_)
+      : os(os_), xml_fname(xml_fname_), queued(0), busy(false), stop(false),
+        error(false) { th = std::thread([this]{ run(); }); }
+
+    ~xdmf_async_writer() {
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        stop = true;
+      }
+      cond_jobs.notify_one();
+      th.join();
+    }
+  };
+
+  /* XDMF cell type, and number of nodes for polyvertices and polylines,
+     of a VTK cell type. The node order of VTK and XDMF cells is the same,
+     except for pixels and voxels which are converted to quadrangles and
+     hexahedra. */
+  static int xdmf_cell_type(unsigned char vtk_type, bool &with_nb_nodes) {
+    with_nb_nodes = false;
+    switch (vtk_type) {
+    case vtk_export::VTK_VERTEX: with_nb_nodes = true; return 1;
+    case vtk_export::VTK_LINE: with_nb_nodes = true; return 2;
+    case vtk_export::VTK_TRIANGLE: return 4;
+    case vtk_export::VTK_PIXEL: case vtk_export::VTK_QUAD: return 5;
+    case vtk_export::VTK_TETRA: return 6;
+    case vtk_export::VTK_PYRAMID: return 7;
+    case vtk_export::VTK_WEDGE: return 8;
+    case vtk_export::VTK_VOXEL: case vtk_export::VTK_HEXAHEDRON: return 9;
+    case vtk_export::VTK_QUADRATIC_EDGE: return 34;
+    case vtk_export::VTK_BIQUADRATIC_QUAD: return 35;
+    case vtk_export::VTK_QUADRATIC_TRIANGLE: return 36;
+    case vtk_export::VTK_QUADRATIC_QUAD: return 37;
+    case vtk_export::VTK_QUADRATIC_TETRA: return 38;
+    case vtk_export::VTK_QUADRATIC_PYRAMID: return 39;
+    case vtk_export::VTK_QUADRATIC_WEDGE: return 40;
+    case vtk_export::VTK_BIQUADRATIC_QUADRATIC_WEDGE: return 41;
+    case vtk_export::VTK_QUADRATIC_HEXAHEDRON: return 48;
+    case vtk_export::VTK_TRIQUADRATIC_HEXAHEDRON: return 50;
+    }
+    GMM_ASSERT1(false, "xdmf export: unsupported cell type " << int(vtk_type));
+    return 0;
+  }
+
+  xdmf_export::xdmf_export(const std::string& basename_)
+    : vtk_export(basename_ + ".bin", false), basename(basename_),
+      mesh_written(false), offset(0) {
+    size_type i = basename.find_last_of("/\\");
+    binname = ((i == std::string::npos) ? basename : basename.substr(i+1))
+      + ".bin";
+    pwriter = std::make_unique<xdmf_async_writer>(os, basename + ".xmf");
+  }
+
+  xdmf_export::~xdmf_export() { pwriter->push_xml(xml_description()); }
+
+  void xdmf_export::exporting(const mesh& m)
+  { vtk_export::exporting(m); mesh_written = false; }
+  void xdmf_export::exporting(const mesh_fem& mf)
+  { vtk_export::exporting(mf); mesh_written = false; }
+  void xdmf_export::exporting(const stored_mesh_slice& sl)
+  { vtk_export::exporting(sl); mesh_written = false; }
+
+  size_type xdmf_export::queue_data(const void *p, size_type nb) {
+    std::vector<char> data(nb);
+    if (nb) memcpy(&data[0], p, nb);
+    size_type o = offset;
+    offset += nb;
+    pwriter->push_data(data);
+    return o;
+  }
+
+  void xdmf_export::new_time_step(scalar_type t) {
+    if (steps.size()) pwriter->push_xml(xml_description());
+    steps.push_back(xdmf_step());
+    steps.back().time = t;
+    steps.back().grid = size_type(-1);
+  }
+
+  void xdmf_export::write_mesh() {
+    if (mesh_written) return;
+    std::vector<float> pts;
+    std::vector<int> conn, offsets, topo;
+    std::vector<unsigned char> types;
+    mesh_structure_arrays(pts, conn, offsets, types);
+    topo.reserve(conn.size() + 2*types.size());
+    for (size_type i = 0, j = 0; i < types.size(); ++i) {
+      bool with_nb_nodes;
+      size_type nb = size_type(offsets[i]) - j;
+      topo.push_back(xdmf_cell_type(types[i], with_nb_nodes));
+      if (with_nb_nodes) topo.push_back(int(nb));
+      size_type k = topo.size();
+      topo.insert(topo.end(), conn.begin() + j, conn.begin() + offsets[i]);
+      if (types[i] == VTK_PIXEL || types[i] == VTK_VOXEL)
+        for (size_type l = 2; l < nb; l += 4) std::swap(topo[k+l], topo[k+l+1]);
+      j = size_type(offsets[i]);
+    }
+    xdmf_grid g;
+    g.nb_points = pts.size() / 3; g.nb_cells = types.size();
+    g.topology_size = topo.size();
+    g.geometry = queue_data(pts.data(), pts.size()*sizeof(float));
+    g.topology = queue_data(topo.data(), topo.size()*sizeof(int));
+    grids.push_back(g);
+    mesh_written = true;
+  }
+
+  std::string xdmf_export::xml_description() const {
+    const char *endian = little_endian() ? "Little" : "Big";
+    std::stringstream s;
+    s << std::setprecision(16);
+    s << "<?xml version=\"1.0\" ?>\n<Xdmf Version=\"2.0\">\n<Domain>\n"
+      << "<Grid Name=\"TimeSeries\" GridType=\"Collection\" "
+      << "CollectionType=\"Temporal\">\n";
+    for (const xdmf_step &st : steps) {
+      if (st.grid == size_type(-1)) continue;
+      const xdmf_grid &g = grids[st.grid];
+      s << "<Grid Name=\"mesh\" GridType=\"Uniform\">\n"
+        << "<Time Value=\"" << st.time << "\"/>\n"
+        << "<Topology TopologyType=\"Mixed\" NumberOfElements=\""
+        << g.nb_cells << "\">\n"
+        << "<DataItem Format=\"Binary\" NumberType=\"Int\" Precision=\"4\" "
+        << "Endian=\"" << endian << "\" Seek=\"" << g.topology
+        << "\" Dimensions=\"" << g.topology_size << "\">" << binname
+        << "</DataItem>\n</Topology>\n"
+        << "<Geometry GeometryType=\"XYZ\">\n"
+        << "<DataItem Format=\"Binary\" NumberType=\"Float\" Precision=\"4\" "
+        << "Endian=\"" << endian << "\" Seek=\"" << g.geometry
+        << "\" Dimensions=\"" << g.nb_points << " 3\">" << binname
+        << "</DataItem>\n</Geometry>\n";
+      for (const xdmf_array &a : st.fields) {
+        s << "<Attribute Name=\"" << a.name << "\" AttributeType=\""
+          << (a.nb_comp == 1 ? "Scalar" : (a.nb_comp == 3 ? "Vector"
+                                                          : "Tensor"))
+          << "\" Center=\"" << (a.cell_data ? "Cell" : "Node") << "\">\n"
+          << "<DataItem Format=\"Binary\" NumberType=\"Float\" "
+          << "Precision=\"4\" Endian=\"" << endian << "\" Seek=\""
+          << a.offset << "\" Dimensions=\"" << a.nb;
+        if (a.nb_comp != 1) s << " " << a.nb_comp;
+        s << "\">" << binname << "</DataItem>\n</Attribute>\n";
+      }
+      s << "</Grid>\n";
+    }
+    s << "</Grid>\n</Domain>\n</Xdmf>\n";
+    return s.str();
+  }
+
+  void xdmf_export::flush() {
+    pwriter->push_xml(xml_description());
+    pwriter->flush();
+  }
+
   /* -------------------------------------------------------------
    * OPENDX export
    * ------------------------------------------------------------- */
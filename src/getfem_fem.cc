@@ -831,6 +831,7 @@ namespace getfem {
 
   thierach_femi::thierach_femi(ppolyfem fi1, ppolyfem fi2)
     : fem<base_poly>(*fi1) {
+    base_computed_ = false;
     grad_computed_ = false;
     hess_computed_ = false;
     GMM_ASSERT1(fi2->target_dim()==fi1->target_dim(), "dimensions mismatch.");
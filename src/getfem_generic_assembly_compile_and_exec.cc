@@ -7024,6 +7024,131 @@ namespace getfem {
     }
   }
 
+  /* Elements (or faces of elements) of a region on which the integration
+     is done, grouped by geometric transformation, integration method and
+     finite element methods, in order to avoid repeated changes of the
+     precomputations on mixed meshes. Within a group, the order of the
+     region is kept, and no grouping is done if all the elements have the
+     same signature. Since the instructions are compiled again at each
+     assembly, the schedules are kept in a table of each thread, indexed
+     by the integration method, the finite element methods and the region,
+     and recomputed when the version number of one of the methods or the
+     part of the region visited by the thread changes. A modification of
+     the mesh or of one of its regions touches the integration method and
+     the version numbers are never reused, so that a destroyed and
+     reallocated object cannot match an old schedule. The regions which do
+     not belong to the mesh are not followed by the version numbers and
+     their schedule is recomputed at each call. The table keeps at most
+     64 schedules, the least recently used one is removed first, which
+     also forgets the schedules of destroyed objects. */
+  typedef std::vector<std::pair<size_type, short_type>> ga_elements_list;
+  struct ga_element_schedule {
+    std::vector<gmm::uint64_type> versions;
+    std::shared_ptr<const ga_elements_list> elts;
+    size_type last_use;
+  };
+  typedef std::pair<std::vector<const void *>, size_type> ga_schedule_key;
+  struct ga_element_schedule_table
+    : public std::map<ga_schedule_key, ga_element_schedule> {
+    enum { MAX_SIZE = 64 };
+    size_type nb_uses;
+    ga_element_schedule_table() : nb_uses(0) {}
+  };
+
+  static std::shared_ptr<const ga_elements_list>
+  ga_exec_element_schedule(const mesh_region &region, const mesh &m,
+                           const mesh_im &mim,
+                           const ga_instruction_set::region_mim_instructions
+                           &rmi) {
+    DEFINE_STATIC_THREAD_LOCAL(ga_element_schedule_table, schedules);
+
+    std::vector<gmm::uint64_type> versions(1, mim.version_number());
+    ga_schedule_key key;
+    key.first.push_back(&mim);
+    for (const auto &pfp : rmi.pfps) {
+      key.first.push_back(pfp.first);
+      versions.push_back(pfp.first->version_number());
+    }
+    // In a parallel section, only the partition of the thread is visited.
+    versions.push_back((me_is_multithreaded_now()
+                        && region.is_partitioning_allowed())
+                       ? num_threads() : 0);
+    key.second = region.id();
+
+    bool followed = (region.id() == size_type(-1)
+                     || region.get_parent_mesh() == &m);
+    if (followed) {
+      auto it = schedules.find(key);
+      if (it != schedules.end() && it->second.versions == versions) {
+        it->second.last_use = ++(schedules.nb_uses);
+        return it->second.elts;
+      }
+    }
+
+    auto pelts = std::make_shared<ga_elements_list>();
+    ga_elements_list &elts = *pelts;
+    std::vector<size_type> groups;
+    std::map<std::vector<const void *>, size_type> signatures;
+    std::vector<const void *> sig, sig0;
+    size_type old_cv = size_type(-1), group = 0;
+    bool single_signature = true;
+    for (getfem::mr_visitor v(region, m, true); !v.finished(); ++v) {
+      if (!mim.convex_index().is_in(v.cv())) continue;
+      if (v.cv() != old_cv) {
+        sig.resize(0);
+        sig.push_back(m.trans_of_convex(v.cv()).get());
+        sig.push_back(mim.int_method_of_element(v.cv()).get());
+        for (const auto &pfp : rmi.pfps) {
+          const mesh_fem *mf = pfp.first;
+          sig.push_back((&(mf->linked_mesh()) == &m
+                         && mf->convex_index().is_in(v.cv()))
+                        ? mf->fem_of_element(v.cv()).get() : nullptr);
+        }
+        if (old_cv == size_type(-1)) sig0 = sig;
+        else if (single_signature && sig != sig0) {
+          // first change of signature: the previous elements form group 0
+          single_signature = false;
+          signatures[sig0] = 0;
+          groups.assign(elts.size(), 0);
+        }
+        if (!single_signature) {
+          auto it = signatures.find(sig);
+          if (it == signatures.end())
+            it = signatures.insert(std::make_pair(sig,
+                                                  signatures.size())).first;
+          group = it->second;
+        }
+        old_cv = v.cv();
+      }
+      elts.push_back(std::make_pair(v.cv(), v.f()));
+      if (!single_signature) groups.push_back(group);
+    }
+
+    if (!single_signature) {
+      std::vector<size_type> first(signatures.size()+1, 0);
+      for (size_type i = 0; i < groups.size(); ++i) ++(first[groups[i]+1]);
+      for (size_type i = 1; i < first.size(); ++i) first[i] += first[i-1];
+      ga_elements_list sorted_elts(elts.size());
+      for (size_type i = 0; i < groups.size(); ++i)
+        sorted_elts[(first[groups[i]])++] = elts[i];
+      elts.swap(sorted_elts);
+    }
+    if (followed) {
+      if (schedules.size() >= size_type(schedules.MAX_SIZE)
+          && schedules.find(key) == schedules.end()) {
+        auto itlru = schedules.begin();
+        for (auto it = schedules.begin(); it != schedules.end(); ++it)
+          if (it->second.last_use < itlru->second.last_use) itlru = it;
+        schedules.erase(itlru);
+      }
+      ga_element_schedule &sch = schedules[key];
+      sch.versions.swap(versions);
+      sch.elts = pelts;
+      sch.last_use = ++(schedules.nb_uses);
+    }
+    return pelts;
+  }
+
   void ga_exec(ga_instruction_set &gis, ga_workspace &workspace) {
     base_matrix G1, G2;
     base_small_vector un;
@@ -7063,84 +7188,84 @@ namespace getfem {
 	bgeot::pstored_point_tab pspt = 0, old_pspt = 0;
 	bgeot::pgeotrans_precomp pgp = 0;
 	bool first_gp = true;
-	for (getfem::mr_visitor v(region, m, true); !v.finished(); ++v) {
-	  if (mim.convex_index().is_in(v.cv())) {
-	    // cout << "proceed with elt " << v.cv() << " face " << v.f()<<endl;
-	    if (v.cv() != old_cv) {
-	      pgt = m.trans_of_convex(v.cv());
-	      pim = mim.int_method_of_element(v.cv());
-	      m.points_of_convex(v.cv(), G1);
+	auto pelts = ga_exec_element_schedule(region, m, mim, instr.second);
+	for (const auto &elt : *pelts) {
+	  size_type cv = elt.first;
+	  short_type f = elt.second;
+	  if (cv != old_cv) {
+	    pgt = m.trans_of_convex(cv);
+	    pim = mim.int_method_of_element(cv);
+	    m.points_of_convex(cv, G1);
 	      
-	      if (pim->type() == IM_NONE) continue;
-	      GMM_ASSERT1(pim->type() == IM_APPROX, "Sorry, exact methods "
-			  "cannot be used in high level generic assembly");
-	      pai = pim->approx_method();
-	      pspt = pai->pintegration_points();
-	      if (pspt->size()) {
-		if (pgp && gis.pai == pai && pgt_old == pgt) {
-		  gis.ctx.change(pgp, 0, 0, G1, v.cv(), v.f());
+	    if (pim->type() == IM_NONE) continue;
+	    GMM_ASSERT1(pim->type() == IM_APPROX, "Sorry, exact methods "
+			"cannot be used in high level generic assembly");
+	    pai = pim->approx_method();
+	    pspt = pai->pintegration_points();
+	    if (pspt->size()) {
+	      if (pgp && gis.pai == pai && pgt_old == pgt) {
+		gis.ctx.change(pgp, 0, 0, G1, cv, f);
+	      } else {
+		if (pai->is_built_on_the_fly()) {
+		  gis.ctx.change(pgt, 0, (*pspt)[0], G1, cv, f);
+		  pgp = 0;
 		} else {
-		  if (pai->is_built_on_the_fly()) {
-		    gis.ctx.change(pgt, 0, (*pspt)[0], G1, v.cv(), v.f());
-		    pgp = 0;
-		  } else {
-		    pgp = gis.gp_pool(pgt, pspt);
-		    gis.ctx.change(pgp, 0, 0, G1, v.cv(), v.f());
-		  }
-		  pgt_old = pgt; gis.pai = pai;
+		  pgp = gis.gp_pool(pgt, pspt);
+		  gis.ctx.change(pgp, 0, 0, G1, cv, f);
 		}
-		if (gis.need_elt_size)
-		  gis.elt_size = convex_radius_estimate(pgt, G1)*scalar_type(2);
+		pgt_old = pgt; gis.pai = pai;
 	      }
-	      old_cv = v.cv();
+	      if (gis.need_elt_size)
+		gis.elt_size = convex_radius_estimate(pgt, G1)*scalar_type(2);
+	    }
+	    old_cv = cv;
+	  } else {
+	    if (pim->type() == IM_NONE) continue;
+	    gis.ctx.set_face_num(f);
+	  }
+	  if (pspt != old_pspt) { first_gp = true; old_pspt = pspt; }
+	  if (pspt->size()) {
+	    // iterations on Gauss points
+	    size_type first_ind = 0;
+	    if (f != short_type(-1)) {
+	      gis.nbpt = pai->nb_points_on_face(f);
+	      first_ind = pai->ind_first_point_on_face(f);
 	    } else {
-	      if (pim->type() == IM_NONE) continue;
-	      gis.ctx.set_face_num(v.f());
+	      gis.nbpt = pai->nb_points_on_convex();
 	    }
-	    if (pspt != old_pspt) { first_gp = true; old_pspt = pspt; }
-	    if (pspt->size()) {
-	      // iterations on Gauss points
-	      size_type first_ind = 0;
-	      if (v.f() != short_type(-1)) {
-		gis.nbpt = pai->nb_points_on_face(v.f());
-		first_ind = pai->ind_first_point_on_face(v.f());
-	      } else {
-		gis.nbpt = pai->nb_points_on_convex();
+	    for (gis.ipt = 0; gis.ipt < gis.nbpt; ++(gis.ipt)) {
+	      if (pgp) gis.ctx.set_ii(first_ind+gis.ipt);
+	      else gis.ctx.set_xref((*pspt)[first_ind+gis.ipt]);
+	      if (gis.ipt == 0 || !(pgt->is_linear())) {
+		J1 = gis.ctx.J();
+		// Computation of unit normal vector in case of a boundary
+		if (f != short_type(-1)) {
+		  gis.Normal.resize(G1.nrows());
+		  un.resize(pgt->dim());
+		  gmm::copy(pgt->normals()[f], un);
+		  gmm::mult(gis.ctx.B(), un, gis.Normal);
+		  scalar_type nup = gmm::vect_norm2(gis.Normal);
+		  J1 *= nup;
+		  gmm::scale(gis.Normal, 1.0/nup);
+		  gmm::clean(gis.Normal, 1e-13);
+		} else gis.Normal.resize(0);
 	      }
-	      for (gis.ipt = 0; gis.ipt < gis.nbpt; ++(gis.ipt)) {
-		if (pgp) gis.ctx.set_ii(first_ind+gis.ipt);
-		else gis.ctx.set_xref((*pspt)[first_ind+gis.ipt]);
-		if (gis.ipt == 0 || !(pgt->is_linear())) {
-		  J1 = gis.ctx.J();
-		  // Computation of unit normal vector in case of a boundary
-		  if (v.f() != short_type(-1)) {
-		    gis.Normal.resize(G1.nrows());
-		    un.resize(pgt->dim());
-		    gmm::copy(pgt->normals()[v.f()], un);
-		    gmm::mult(gis.ctx.B(), un, gis.Normal);
-		    scalar_type nup = gmm::vect_norm2(gis.Normal);
-		    J1 *= nup;
-		    gmm::scale(gis.Normal, 1.0/nup);
-		    gmm::clean(gis.Normal, 1e-13);
-		  } else gis.Normal.resize(0);
-		}
-		auto ipt_coeff = pai->coeff(first_ind+gis.ipt);
-		gis.coeff = J1 * ipt_coeff;
-		bool enable_ipt = (gmm::abs(ipt_coeff) > 0.0 ||
-				   workspace.include_empty_int_points());
-		if (!enable_ipt) gis.coeff = scalar_type(0);
-		if (first_gp) {
-		  for (size_type j=0; j < gilb.size(); ++j) j+=gilb[j]->exec();
-		  first_gp = false;
-		}
-		if (gis.ipt == 0) {
-		  for (size_type j=0; j < gile.size(); ++j) j+=gile[j]->exec();
-		}
-		if (enable_ipt || gis.ipt == 0 || gis.ipt == gis.nbpt-1) {
-		  for (size_type j=0; j < gil.size(); ++j) j+=gil[j]->exec();
-		}
-		GA_DEBUG_INFO("");
+	      auto ipt_coeff = pai->coeff(first_ind+gis.ipt);
+	      gis.coeff = J1 * ipt_coeff;
+	      bool enable_ipt = (gmm::abs(ipt_coeff) > 0.0 ||
+				 workspace.include_empty_int_points());
+	      if (!enable_ipt) gis.coeff = scalar_type(0);
+	      if (first_gp) {
+		for (size_type j=0; j < gilb.size(); ++j) j+=gilb[j]->exec();
+		first_gp = false;
+	      }
+	      if (gis.ipt == 0) {
+		for (size_type j=0; j < gile.size(); ++j) j+=gile[j]->exec();
+	      }
+	      if (enable_ipt || gis.ipt == 0 || gis.ipt == gis.nbpt-1) {
+		for (size_type j=0; j < gil.size(); ++j) j+=gil[j]->exec();
 	      }
+	      GA_DEBUG_INFO("");
 	    }
 	  }
 	}
@@ -22,13 +22,174 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <limits>
 
 #include "getfem/getfem_mesh.h"
 #include "getfem/getfem_import.h"
 #include "getfem/getfem_regular_meshes.h"
+#include "getfem/getfem_omp.h"
 
 namespace getfem {
 
+  /* Conversion of the number at p, p is moved after the number. */
+  static scalar_type parse_scalar(const char *&p) {
+    char *q;
+    scalar_type v = strtod(p, &q);
+    GMM_ASSERT1(q != p, "mesh import: a number is expected at \""
+                << std::string(p, strcspn(p, "\n")) << "\"");
+    p = q; return v;
+  }
+
+  static long parse_int(const char *&p) {
+    char *q;
+    long v = strtol(p, &q, 10);
+    GMM_ASSERT1(q != p, "mesh import: an integer is expected at \""
+                << std::string(p, strcspn(p, "\n")) << "\"");
+    p = q; return v;
+  }
+
+  /* Buffered reading of the words and numbers of a mesh file, common to
+     the importers of text formats. The stream buffer is read by large
+     blocks and the numbers are converted in place, without the
+     extraction operators of the stream. The characters read ahead are
+     given back to the stream when the tokenizer is destroyed, so that the
+     stream is positioned just after the last token read. This needs a
+     stream which can seek (files, string streams) or put back the
+     characters, the stream is left after the read data otherwise. */
+  class mesh_file_tokenizer {
+    gmm::standard_locale locale;
+    std::streambuf *sb;
+    std::vector<char> buf;
+    size_type pos, last; // current position and end of the data in buf
+    bool eof;
+
+    // At least n characters after pos, or the end of the file.
+    void fill(size_type n) {
+      if (last - pos >= n || eof) return;
+      std::copy(buf.begin() + pos, buf.begin() + last, buf.begin());
+      last -= pos; pos = 0;
+      if (buf.size() < 2 * n + 1) buf.resize(2 * n + 1);
+      while (last < n && !eof) {
+        std::streamsize nb
+          = sb->sgetn(&buf[last], std::streamsize(buf.size() - 1 - last));
+        if (nb <= 0) eof = true; else last += size_type(nb);
+      }
+      buf[last] = '\0';
+    }
+
+    // The current token is entirely in the buffer.
+    void fill_token() {
+      for (size_type i = 0; ; fill(i + 1)) {
+        for (; pos + i < last; ++i) if (is_space(buf[pos + i])) return;
+        if (eof) return;
+      }
+    }
+
+    static bool is_space(char c) { return isspace((unsigned char)(c)); }
+
+    // Case insensitive comparison of the l first characters.
+    static bool same_word(const char *a, const char *b, size_type l) {
+      for (size_type i = 0; i < l; ++i)
+        if (toupper((unsigned char)(a[i])) != toupper((unsigned char)(b[i])))
+          return false;
+      return true;
+    }
+
+    const char *current() {
+      GMM_ASSERT1(skip_spaces(), "mesh import: unexpected end of file");
+      fill_token();
+      return &buf[pos];
+    }
+
+  public :
+
+    /* Returns false at the end of the file. */
+    bool skip_spaces() {
+      for (;; ++pos) {
+        if (pos == last) { fill(1); if (pos == last) return false; }
+        if (!is_space(buf[pos])) return true;
+      }
+    }
+
+    long get_int() {
+      const char *p = current();
+      long v = parse_int(p); pos = size_type(p - &buf[0]); return v;
+    }
+
+    scalar_type get_scalar() {
+      const char *p = current();
+      scalar_type v = parse_scalar(p); pos = size_type(p - &buf[0]); return v;
+    }
+
+    std::string get_word() {
+      const char *p = current(), *q = p;
+      while (*q && !is_space(*q)) ++q;
+      pos += size_type(q - p);
+      return std::string(p, q);
+    }
+
+    /* Rest of the current line. */
+    std::string get_line() {
+      std::string s;
+      for (;; ++pos) {
+        if (pos == last) { fill(1); if (pos == last) break; }
+        if (buf[pos] == '\n') { ++pos; break; }
+        s.push_back(buf[pos]);
+      }
+      return s;
+    }
+
+    void skip_line() {
+      for (;; ++pos) {
+        if (pos == last) { fill(1); if (pos == last) return; }
+        if (buf[pos] == '\n') { ++pos; return; }
+      }
+    }
+
+    /* Case insensitive comparison of the next word with s, the word is
+       not read. */
+    bool next_is(const char *s) {
+      size_type l = strlen(s);
+      if (!skip_spaces()) return false;
+      fill(l);
+      return (last - pos >= l && same_word(&buf[pos], s, l));
+    }
+
+    /* Reads the word s (case insensitive) which has to be the next one. */
+    void expect(const char *s) {
+      GMM_ASSERT1(next_is(s), "mesh import: expected token '" << s
+                  << "' not found");
+      pos += strlen(s);
+    }
+
+    /* Moves after the next occurrence of s (case insensitive). Returns
+       false if s is not found. */
+    bool find(const char *s) {
+      size_type l = strlen(s);
+      for (;; ++pos) {
+        fill(l);
+        if (last - pos < l) { pos = last; return false; }
+        if (same_word(&buf[pos], s, l)) { pos += l; return true; }
+      }
+    }
+
+    mesh_file_tokenizer(std::istream &f)
+      : sb(f.rdbuf()), buf(size_type(1) << 16), pos(0), last(0), eof(false)
+    { buf[0] = '\0'; }
+
+    ~mesh_file_tokenizer() {
+      std::streamoff n = std::streamoff(last - pos);
+      if (n == 0) return;
+      if (sb->pubseekoff(-n, std::ios_base::cur, std::ios_base::in)
+          != std::streampos(std::streamoff(-1))) return;
+      for (size_type i = last; i > pos; --i)
+        if (sb->sputbackc(buf[i-1]) == std::streambuf::traits_type::eof())
+          return;
+    }
+  };
+
   /* mesh file from gmsh [http://www.geuz.org/gmsh/]*/
 
   struct gmsh_cv_info {
@@ -168,6 +329,174 @@ namespace getfem {
       }
     }
 
+    // Reordering nodes for certain elements (should be completed ?)
+    // http://www.geuz.org/gmsh/doc/texinfo/gmsh.html#Node-ordering
+    void reorder_nodes() {
+      std::vector<size_type> tmp_nodes(nodes);
+      switch(type) {
+      case 3 : {
+        nodes[2] = tmp_nodes[3];
+        nodes[3] = tmp_nodes[2];
+      } break;
+      case 5 : { /* First order hexaedron */
+        //nodes[0] = tmp_nodes[0];
+        //nodes[1] = tmp_nodes[1];
+        nodes[2] = tmp_nodes[3];
+        nodes[3] = tmp_nodes[2];
+        //nodes[4] = tmp_nodes[4];
+        //nodes[5] = tmp_nodes[5];
+        nodes[6] = tmp_nodes[7];
+        nodes[7] = tmp_nodes[6];
+      } break;
+      case 7 : { /* first order pyramid */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[2];
+        nodes[2] = tmp_nodes[1];
+        // nodes[3] = tmp_nodes[3];
+        // nodes[4] = tmp_nodes[4];
+      } break;
+      case 8 : { /* Second order line */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[2];
+        nodes[2] = tmp_nodes[1];
+      } break;
+      case 9 : { /* Second order triangle */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[3];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[5];
+        //nodes[4] = tmp_nodes[4];
+        nodes[5] = tmp_nodes[2];
+      } break;
+      case 10 : { /* Second order quadrangle */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[4];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[7];
+        nodes[4] = tmp_nodes[8];
+        //nodes[5] = tmp_nodes[5];
+        nodes[6] = tmp_nodes[3];
+        nodes[7] = tmp_nodes[6];
+        nodes[8] = tmp_nodes[2];
+      } break;
+      case 11: { /* Second order tetrahedron */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[4];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[6];
+        nodes[4] = tmp_nodes[5];
+        nodes[5] = tmp_nodes[2];
+        nodes[6] = tmp_nodes[7];
+        nodes[7] = tmp_nodes[9];
+        //nodes[8] = tmp_nodes[8];
+        nodes[9] = tmp_nodes[3];
+      } break;
+      case 12: { /* Second order hexahedron */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[8];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[9];
+        nodes[4] = tmp_nodes[20];
+        nodes[5] = tmp_nodes[11];
+        nodes[6] = tmp_nodes[3];
+        nodes[7] = tmp_nodes[13];
+        nodes[8] = tmp_nodes[2];
+        nodes[9] = tmp_nodes[10];
+        nodes[10] = tmp_nodes[21];
+        nodes[11] = tmp_nodes[12];
+        nodes[12] = tmp_nodes[22];
+        nodes[13] = tmp_nodes[26];
+        nodes[14] = tmp_nodes[23];
+        //nodes[15] = tmp_nodes[15];
+        nodes[16] = tmp_nodes[24];
+        nodes[17] = tmp_nodes[14];
+        nodes[18] = tmp_nodes[4];
+        nodes[19] = tmp_nodes[16];
+        nodes[20] = tmp_nodes[5];
+        nodes[21] = tmp_nodes[17];
+        nodes[22] = tmp_nodes[25];
+        nodes[23] = tmp_nodes[18];
+        nodes[24] = tmp_nodes[7];
+        nodes[25] = tmp_nodes[19];
+        nodes[26] = tmp_nodes[6];
+      } break;
+      case 16 : { /* Incomplete second order quadrangle */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[4];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[7];
+        nodes[4] = tmp_nodes[5];
+        nodes[5] = tmp_nodes[3];
+        nodes[6] = tmp_nodes[6];
+        nodes[7] = tmp_nodes[2];
+      } break;
+      case 17: { /* Incomplete second order hexahedron */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[8];
+        nodes[2] = tmp_nodes[1];
+        nodes[3] = tmp_nodes[9];
+        nodes[4] = tmp_nodes[11];
+        nodes[5] = tmp_nodes[3];
+        nodes[6] = tmp_nodes[13];
+        nodes[7] = tmp_nodes[2];
+        nodes[8] = tmp_nodes[10];
+        nodes[9] = tmp_nodes[12];
+        nodes[10] = tmp_nodes[15];
+        nodes[11] = tmp_nodes[14];
+        nodes[12] = tmp_nodes[4];
+        nodes[13] = tmp_nodes[16];
+        nodes[14] = tmp_nodes[5];
+        nodes[15] = tmp_nodes[17];
+        nodes[16] = tmp_nodes[18];
+        nodes[17] = tmp_nodes[7];
+        nodes[18] = tmp_nodes[19];
+        nodes[19] = tmp_nodes[6];
+      } break;
+      case 26 : { /* Third order line */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[2];
+        nodes[2] = tmp_nodes[3];
+        nodes[3] = tmp_nodes[1];
+      } break;
+      case 21 : { /* Third order triangle */
+        //nodes[0] = tmp_nodes[0];
+        nodes[1] = tmp_nodes[3];
+        nodes[2] = tmp_nodes[4];
+        nodes[3] = tmp_nodes[1];
+        nodes[4] = tmp_nodes[8];
+        nodes[5] = tmp_nodes[9];
+        nodes[6] = tmp_nodes[5];
+        //nodes[7] = tmp_nodes[7];
+        nodes[8] = tmp_nodes[6];
+        nodes[9] = tmp_nodes[2];
+      } break;
+      case 23: { /* Fourth order triangle */
+      //nodes[0]  = tmp_nodes[0];
+        nodes[1]  = tmp_nodes[3];
+        nodes[2]  = tmp_nodes[4];
+        nodes[3]  = tmp_nodes[5];
+        nodes[4]  = tmp_nodes[1];
+        nodes[5]  = tmp_nodes[11];
+        nodes[6]  = tmp_nodes[12];
+        nodes[7]  = tmp_nodes[13];
+        nodes[8]  = tmp_nodes[6];
+        nodes[9]  = tmp_nodes[10];
+        nodes[10] = tmp_nodes[14];
+        nodes[11] = tmp_nodes[7];
+        nodes[12] = tmp_nodes[9];
+        nodes[13] = tmp_nodes[8];
+        nodes[14] = tmp_nodes[2];
+      } break;
+      case 27: { /* Fourth order line */
+      //nodes[0]  = tmp_nodes[0];
+        nodes[1]  = tmp_nodes[2];
+        nodes[2]  = tmp_nodes[3];
+        nodes[3]  = tmp_nodes[4];
+        nodes[4]  = tmp_nodes[1];
+      } break;
+      }
+    }
+
     bool operator<(const gmsh_cv_info& other) const {
       unsigned this_dim = (type == 15) ? 0 : pgt->dim();
       unsigned other_dim = (other.type == 15) ? 0 : other.pgt->dim();
@@ -200,6 +529,374 @@ namespace getfem {
     return region_map;
   }
 
+  /* Lines of a section of an ASCII gmsh file. They are read at once, up
+     to the keyword ending the section, so that they can be parsed by
+     several threads. Empty lines are skipped. */
+  struct gmsh_ascii_lines {
+    std::string buf;
+    std::vector<size_type> start;
+
+    size_type size() const { return start.size(); }
+    const char *operator[](size_type i) const {
+      GMM_ASSERT1(i < start.size(), "gmsh import: unexpected end of section");
+      return buf.c_str() + start[i];
+    }
+
+    void read(std::istream &f, const char *end_keyword) {
+      buf.clear(); start.clear();
+      unsigned l = unsigned(strlen(end_keyword));
+      std::string line;
+      for (;;) {
+        GMM_ASSERT1(std::getline(f, line), "gmsh import: " << end_keyword
+                    << " not found");
+        size_type i = line.find_first_not_of(" \t\r");
+        if (i == std::string::npos) continue;
+        if (bgeot::casecmp(line.c_str() + i, end_keyword, l) == 0) break;
+        start.push_back(buf.size());
+        buf.append(line, i, std::string::npos);
+        buf.push_back('\n');
+      }
+    }
+  };
+
+  /* Binary data of a gmsh file, in the byte order of the file. Integers
+     are 4 bytes long and size_t 8 bytes long (data-size 8). */
+  struct gmsh_binary_stream {
+    std::istream &f;
+    bool swap;
+
+    template <typename T> void read(T *p, size_type n) {
+      f.read(reinterpret_cast<char *>(p), std::streamsize(n * sizeof(T)));
+      GMM_ASSERT1(f.good(), "gmsh import: unexpected end of binary data");
+      if (swap)
+        for (size_type i = 0; i < n; ++i) {
+          char *c = reinterpret_cast<char *>(p + i);
+          std::reverse(c, c + sizeof(T));
+        }
+    }
+    long get_int() { int32_t i; read(&i, 1); return long(i); }
+    size_type get_size() { uint64_t i; read(&i, 1); return size_type(i); }
+    void skip_doubles(size_type n) { f.ignore(std::streamsize(8 * n)); }
+    // The binary data starts after the end of the line of the section
+    // keyword (or of the number of items), which may be "\r\n".
+    void skip_line_end()
+    { f.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); }
+
+    gmsh_binary_stream(std::istream &f_, bool swap_) : f(f_), swap(swap_) {}
+  };
+
+  struct gmsh_format {
+    int version;  // 1, 2 or 4
+    bool v41;     // version 4.1 (version 4.0 otherwise for version 4)
+    bool binary;
+    bool swap;    // binary data in a byte order different from the machine
+  };
+
+  /* Correspondence between gmsh node tags and mesh points: an array
+     indexed by the tags when they are dense enough, a sorted array of
+     pairs (tag, point) otherwise. */
+  struct gmsh_node_remap {
+    std::vector<size_type> direct;
+    std::vector<std::pair<size_type, size_type> > sorted;
+
+    size_type operator()(size_type tag) const {
+      if (direct.size())
+        return (tag < direct.size()) ? direct[tag] : size_type(-1);
+      auto it = std::lower_bound(sorted.begin(), sorted.end(),
+                                 std::make_pair(tag, size_type(0)));
+      return (it != sorted.end() && it->first == tag)
+        ? it->second : size_type(-1);
+    }
+
+    void build(const std::vector<size_type> &tags,
+               const std::vector<size_type> &ipts) {
+      size_type max_tag = 0;
+      for (size_type tag : tags) max_tag = std::max(max_tag, tag);
+      if (max_tag <= 4 * tags.size() + 1024) {
+        direct.assign(max_tag + 1, size_type(-1));
+        for (size_type i = 0; i < tags.size(); ++i) direct[tags[i]] = ipts[i];
+      } else {
+        sorted.resize(tags.size());
+        for (size_type i = 0; i < tags.size(); ++i)
+          sorted[i] = std::make_pair(tags[i], ipts[i]);
+        std::sort(sorted.begin(), sorted.end());
+      }
+    }
+  };
+
+  typedef std::map<std::pair<int, long>, std::vector<long> > gmsh_entities;
+
+  /* Physical tags of the entities of a version 4 file. */
+  static void read_gmsh_entities(std::istream &f, const gmsh_format &fmt,
+                                 gmsh_entities &entities) {
+    GMM_ASSERT1(bgeot::read_until(f, "$Entities"),
+                "gmsh import: $Entities not found");
+    size_type nb[4];
+    if (fmt.binary) {
+      gmsh_binary_stream bf(f, fmt.swap);
+      bf.skip_line_end();
+      for (int d = 0; d < 4; ++d) nb[d] = bf.get_size();
+      for (int d = 0; d < 4; ++d)
+        for (size_type i = 0; i < nb[d]; ++i) {
+          long tag = bf.get_int();
+          bf.skip_doubles((d == 0 && fmt.v41) ? 3 : 6);
+          std::vector<long> &phys = entities[std::make_pair(d, tag)];
+          phys.resize(bf.get_size());
+          for (long &ph : phys) ph = bf.get_int();
+          if (d > 0) {
+            size_type nbb = bf.get_size();
+            f.ignore(std::streamsize(4 * nbb));
+          }
+        }
+    } else {
+      for (int d = 0; d < 4; ++d) f >> nb[d];
+      scalar_type x;
+      for (int d = 0; d < 4; ++d)
+        for (size_type i = 0; i < nb[d]; ++i) {
+          long tag; size_type nbph;
+          f >> tag;
+          for (int k = 0; k < ((d == 0 && fmt.v41) ? 3 : 6); ++k) f >> x;
+          f >> nbph;
+          std::vector<long> &phys = entities[std::make_pair(d, tag)];
+          phys.resize(nbph);
+          for (long &ph : phys) f >> ph;
+          if (d > 0) {
+            size_type nbb; long b;
+            f >> nbb;
+            for (size_type k = 0; k < nbb; ++k) f >> b;
+          }
+        }
+    }
+    bgeot::read_until(f, "$EndEntities");
+  }
+
+  /* Nodes of the $Nodes (or $NOD) section: tags and 3D coordinates. */
+  static void read_gmsh_nodes(std::istream &f, const gmsh_format &fmt,
+                              std::vector<size_type> &tags,
+                              std::vector<scalar_type> &coords) {
+    if (fmt.binary) {
+      gmsh_binary_stream bf(f, fmt.swap);
+      if (fmt.version == 2) {
+        size_type nb_node;
+        f >> nb_node; bf.skip_line_end();
+        tags.resize(nb_node); coords.resize(3 * nb_node);
+        for (size_type i = 0; i < nb_node; ++i) {
+          tags[i] = size_type(bf.get_int());
+          bf.read(&coords[3*i], 3);
+        }
+      } else {
+        bf.skip_line_end();
+        size_type nb_blocks = bf.get_size(), nb_node = bf.get_size();
+        if (fmt.v41) { bf.get_size(); bf.get_size(); }
+        tags.resize(nb_node); coords.resize(3 * nb_node);
+        size_type i0 = 0;
+        for (size_type b = 0; b < nb_blocks; ++b) {
+          long e1 = bf.get_int(), e2 = bf.get_int(), param = bf.get_int();
+          long dim = fmt.v41 ? e1 : e2;
+          size_type nb = bf.get_size(), nbparam = param ? size_type(dim) : 0;
+          GMM_ASSERT1(i0 + nb <= nb_node, "gmsh import: wrong node number");
+          if (fmt.v41) {
+            std::vector<uint64_t> t(nb);
+            if (nb) bf.read(&t[0], nb);
+            for (size_type i = 0; i < nb; ++i) tags[i0+i] = size_type(t[i]);
+            for (size_type i = 0; i < nb; ++i) {
+              bf.read(&coords[3*(i0+i)], 3);
+              bf.skip_doubles(nbparam);
+            }
+          } else {
+            for (size_type i = 0; i < nb; ++i) {
+              tags[i0+i] = size_type(bf.get_int());
+              bf.read(&coords[3*(i0+i)], 3);
+              bf.skip_doubles(nbparam);
+            }
+          }
+          i0 += nb;
+        }
+      }
+      bgeot::read_until(f, "$EndNodes");
+      return;
+    }
+
+    gmsh_ascii_lines lines;
+    lines.read(f, (fmt.version == 1) ? "$ENDNOD" : "$EndNodes");
+    const char *p = lines[0];
+    // line of the tag and line of the coordinates of each node
+    std::vector<size_type> tag_line, coord_line;
+    if (fmt.version < 4) {
+      size_type nb_node = size_type(parse_int(p));
+      tag_line.resize(nb_node); coord_line.resize(nb_node);
+      for (size_type i = 0; i < nb_node; ++i) tag_line[i]=coord_line[i]=i+1;
+    } else {
+      size_type nb_blocks = size_type(parse_int(p));
+      size_type nb_node = size_type(parse_int(p)), l = 1, i0 = 0;
+      tag_line.resize(nb_node); coord_line.resize(nb_node);
+      for (size_type b = 0; b < nb_blocks; ++b) {
+        p = lines[l++];
+        for (int k = 0; k < 3; ++k) parse_int(p);
+        size_type nb = size_type(parse_int(p));
+        GMM_ASSERT1(i0 + nb <= nb_node, "gmsh import: wrong node number");
+        for (size_type i = 0; i < nb; ++i) {
+          tag_line[i0+i] = l + i;
+          coord_line[i0+i] = fmt.v41 ? l + nb + i : l + i;
+        }
+        l += fmt.v41 ? 2*nb : nb; i0 += nb;
+      }
+    }
+    GMM_ASSERT1(tag_line.size() == 0 || coord_line.back() < lines.size(),
+                "gmsh import: unexpected end of the node section");
+
+    tags.resize(tag_line.size()); coords.resize(3 * tag_line.size());
+    open_mp_range_for(tags.size(), [&](size_type i) {
+      const char *q = lines[tag_line[i]];
+      tags[i] = size_type(parse_int(q));
+      if (coord_line[i] != tag_line[i]) q = lines[coord_line[i]];
+      for (size_type k = 0; k < 3; ++k) coords[3*i+k] = parse_scalar(q);
+    });
+  }
+
+  /* Elements of the $Elements (or $ELM) section with the gmsh tags of
+     their nodes. For version 4, the elements of an entity having several
+     physical tags are repeated for each of them, as in version 2 files. */
+  static void read_gmsh_elements(std::istream &f, const gmsh_format &fmt,
+                                 const gmsh_entities &entities,
+                                 std::vector<gmsh_cv_info> &cvlst) {
+    // For version 4, entity of each block and block of each element
+    std::vector<std::pair<int, long> > block_entity;
+    std::vector<size_type> elt_block;
+
+    if (fmt.binary) {
+      gmsh_binary_stream bf(f, fmt.swap);
+      if (fmt.version == 2) {
+        size_type nb_cv;
+        f >> nb_cv; bf.skip_line_end();
+        cvlst.resize(nb_cv);
+        std::vector<int32_t> data;
+        for (size_type i = 0; i < nb_cv; ) {
+          gmsh_cv_info ci;
+          ci.type = unsigned(bf.get_int());
+          size_type nb = size_type(bf.get_int());
+          size_type nbtags = size_type(bf.get_int());
+          GMM_ASSERT1(nbtags > 0, "Number of tags 0 is not managed.");
+          GMM_ASSERT1(i + nb <= nb_cv, "gmsh import: wrong element number");
+          ci.set_nb_nodes();
+          size_type nn = ci.nodes.size();
+          data.resize(1 + nbtags + nn);
+          for (size_type k = 0; k < nb; ++k, ++i) {
+            bf.read(&data[0], data.size());
+            cvlst[i] = ci;
+            cvlst[i].id = unsigned(data[0] - 1);
+            cvlst[i].region = unsigned(data[1]);
+            for (size_type j = 0; j < nn; ++j)
+              cvlst[i].nodes[j] = size_type(data[1+nbtags+j]);
+          }
+        }
+      } else {
+        bf.skip_line_end();
+        size_type nb_blocks = bf.get_size(), nb_cv = bf.get_size();
+        if (fmt.v41) { bf.get_size(); bf.get_size(); }
+        cvlst.resize(nb_cv); elt_block.resize(nb_cv);
+        size_type i = 0;
+        for (size_type b = 0; b < nb_blocks; ++b) {
+          long e1 = bf.get_int(), e2 = bf.get_int();
+          block_entity.push_back(fmt.v41 ? std::make_pair(int(e1), e2)
+                                 : std::make_pair(int(e2), e1));
+          gmsh_cv_info ci;
+          ci.type = unsigned(bf.get_int());
+          size_type nb = bf.get_size();
+          GMM_ASSERT1(i + nb <= nb_cv, "gmsh import: wrong element number");
+          ci.set_nb_nodes();
+          size_type nn = ci.nodes.size();
+          std::vector<uint64_t> data41(fmt.v41 ? 1 + nn : 0);
+          std::vector<int32_t> data40(fmt.v41 ? 0 : 1 + nn);
+          for (size_type k = 0; k < nb; ++k, ++i) {
+            cvlst[i] = ci; elt_block[i] = b;
+            if (fmt.v41) {
+              bf.read(&data41[0], 1 + nn);
+              cvlst[i].id = unsigned(data41[0] - 1);
+              for (size_type j = 0; j < nn; ++j)
+                cvlst[i].nodes[j] = size_type(data41[1+j]);
+            } else {
+              bf.read(&data40[0], 1 + nn);
+              cvlst[i].id = unsigned(data40[0] - 1);
+              for (size_type j = 0; j < nn; ++j)
+                cvlst[i].nodes[j] = size_type(data40[1+j]);
+            }
+          }
+        }
+      }
+      bgeot::read_until(f, "$EndElements");
+    } else {
+      gmsh_ascii_lines lines;
+      lines.read(f, (fmt.version == 1) ? "$ENDELM" : "$EndElements");
+      const char *p = lines[0];
+      std::vector<size_type> elt_line;
+      if (fmt.version < 4) {
+        size_type nb_cv = size_type(parse_int(p));
+        elt_line.resize(nb_cv);
+        for (size_type i = 0; i < nb_cv; ++i) elt_line[i] = i+1;
+      } else {
+        size_type nb_blocks = size_type(parse_int(p));
+        size_type nb_cv = size_type(parse_int(p)), l = 1, i = 0;
+        elt_line.resize(nb_cv); elt_block.resize(nb_cv);
+        cvlst.resize(nb_cv);
+        for (size_type b = 0; b < nb_blocks; ++b) {
+          p = lines[l++];
+          long e1 = parse_int(p), e2 = parse_int(p);
+          block_entity.push_back(fmt.v41 ? std::make_pair(int(e1), e2)
+                                 : std::make_pair(int(e2), e1));
+          unsigned type = unsigned(parse_int(p));
+          size_type nb = size_type(parse_int(p));
+          GMM_ASSERT1(i + nb <= nb_cv, "gmsh import: wrong element number");
+          for (size_type k = 0; k < nb; ++k, ++i) {
+            elt_line[i] = l++; elt_block[i] = b; cvlst[i].type = type;
+          }
+        }
+      }
+      GMM_ASSERT1(elt_line.size() == 0 || elt_line.back() < lines.size(),
+                  "gmsh import: unexpected end of the element section");
+
+      cvlst.resize(elt_line.size());
+      open_mp_range_for(cvlst.size(), [&](size_type i) {
+        gmsh_cv_info &ci = cvlst[i];
+        const char *q = lines[elt_line[i]];
+        ci.id = unsigned(parse_int(q) - 1); /* numbering starts at 1 */
+        if (fmt.version == 4)
+          ci.set_nb_nodes();
+        else if (fmt.version == 2) {
+          ci.type = unsigned(parse_int(q));
+          long nbtags = parse_int(q);
+          GMM_ASSERT1(nbtags > 0 && nbtags <= 3, "Number of tags " << nbtags
+                      << " is not managed.");
+          ci.region = unsigned(parse_int(q));
+          for (long k = 1; k < nbtags; ++k) parse_int(q);
+          ci.set_nb_nodes();
+        } else {
+          ci.type = unsigned(parse_int(q));
+          ci.region = unsigned(parse_int(q));
+          parse_int(q);
+          ci.nodes.resize(size_type(parse_int(q)));
+        }
+        for (size_type &j : ci.nodes) j = size_type(parse_int(q));
+      });
+    }
+
+    if (fmt.version == 4) {
+      size_type nb_cv = cvlst.size();
+      for (size_type i = 0; i < nb_cv; ++i) {
+        auto it = entities.find(block_entity[elt_block[i]]);
+        cvlst[i].region = 0;
+        if (it != entities.end() && it->second.size()) {
+          cvlst[i].region = unsigned(it->second[0]);
+          for (size_type k = 1; k < it->second.size(); ++k) {
+            gmsh_cv_info ci = cvlst[i];
+            ci.region = unsigned(it->second[k]);
+            cvlst.push_back(ci);
+          }
+        }
+      }
+    }
+  }
+
   /*
      Format version 1 [for gmsh version < 2.0].
      structure: $NOD list_of_nodes $ENDNOD $ELT list_of_elt $ENDELT
@@ -210,6 +907,13 @@ namespace getfem {
      structure: $Nodes list_of_nodes $EndNodes $Elements list_of_elt
      $EndElements
 
+     Format version 4 [for gmsh version >= 4.0]. Nodes and elements are
+     grouped by entity and the physical regions are the physical tags of
+     the entities listed in the $Entities section.
+
+     Versions 2 and 4 can be ASCII or binary files. ASCII sections are
+     parsed in parallel.
+
      Lower dimensions elements in the regions of lower_dim_convex_rg will
      be imported as independant convexes.
 
@@ -246,263 +950,100 @@ namespace getfem {
     }
 
     /* read the version */
-    int version;
+    gmsh_format fmt;
+    fmt.v41 = fmt.binary = fmt.swap = false;
     std::string header;
     f >> header;
-    if (bgeot::casecmp(header,"$MeshFormat")==0)
-      f >> version;
+    if (bgeot::casecmp(header,"$MeshFormat")==0) {
+      scalar_type version_number;
+      int file_type, data_size;
+      f >> version_number >> file_type >> data_size;
+      fmt.version = int(version_number);
+      fmt.v41 = (fmt.version == 4 && version_number > 4.05);
+      GMM_ASSERT1(fmt.version == 2 || fmt.version == 4,
+                  "gmsh format version " << version_number
+                  << " is not supported");
+      fmt.binary = (file_type == 1);
+      if (fmt.binary) {
+        GMM_ASSERT1(data_size == 8, "gmsh binary files with data-size "
+                    << data_size << " are not supported");
+        f.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        int32_t one;
+        f.read(reinterpret_cast<char *>(&one), 4);
+        fmt.swap = (one != 1);
+        if (fmt.swap) {
+          char *c = reinterpret_cast<char *>(&one);
+          std::reverse(c, c + 4);
+          GMM_ASSERT1(one == 1, "gmsh import: wrong binary file header");
+        }
+      }
+    }
     else if (bgeot::casecmp(header,"$NOD")==0)
-      version = 1;
+      fmt.version = 1;
     else
       GMM_ASSERT1(false, "can't read Gmsh format: " << header);
 
     /* read the region names */
     if (region_map != NULL) {
-      if (version == 2) {
+      if (fmt.version >= 2) {
         *region_map = read_region_names_from_gmsh_mesh_file(f);
       }
     }
+
+    /* read the physical tags of the entities */
+    gmsh_entities entities;
+    if (fmt.version == 4) read_gmsh_entities(f, fmt, entities);
+
     /* read the node list */
-    if (version == 2)
-      bgeot::read_until(f, "$Nodes"); /* Format version 2 */
-
-    size_type nb_node;
-    f >> nb_node;
-    //cerr << "reading nodes..[nb=" << nb_node << "]\n";
-    std::map<size_type, size_type> msh_node_2_getfem_node;
-    for (size_type node_cnt=0; node_cnt < nb_node; ++node_cnt) {
-      size_type node_id;
-      base_node n(3); n[0]=n[1]=n[2]=0.0;
-      f >> node_id >> n[0] >> n[1] >> n[2];
-      msh_node_2_getfem_node[node_id] = m.add_point(n, 0.0, remove_duplicated_nodes);
+    if (fmt.version >= 2)
+      GMM_ASSERT1(bgeot::read_until(f, "$Nodes"),
+                  "gmsh import: $Nodes not found");
+    std::vector<size_type> node_tags;
+    std::vector<scalar_type> node_coords;
+    read_gmsh_nodes(f, fmt, node_tags, node_coords);
+
+    std::vector<size_type> ipts(node_tags.size());
+    base_node n(3);
+    // Without identification of the duplicated nodes, the points are
+    // appended without maintaining the sorted index of the node table,
+    // which is rebuilt at once at the next search of a point.
+    if (!remove_duplicated_nodes) m.points().resort();
+    for (size_type i = 0; i < node_tags.size(); ++i) {
+      n[0] = node_coords[3*i]; n[1] = node_coords[3*i+1];
+      n[2] = node_coords[3*i+2];
+      ipts[i] = m.add_point(n, 0.0, remove_duplicated_nodes);
     }
-
-    if (version == 2)
-      bgeot::read_until(f, "$Endnodes"); /* Format version 2 */
-    else
-      bgeot::read_until(f, "$ENDNOD");
+    gmsh_node_remap msh_node_2_getfem_node;
+    msh_node_2_getfem_node.build(node_tags, ipts);
 
     /* read the convexes */
-    if (version == 2)
-      bgeot::read_until(f, "$Elements"); /* Format version 2 */
-    else
-      bgeot::read_until(f, "$ELM");
-
-    size_type nb_cv;
-    f >> nb_cv;
-    std::vector<gmsh_cv_info> cvlst; cvlst.reserve(nb_cv);
-    for (size_type cv=0; cv < nb_cv; ++cv) {
-      unsigned id, type, region;
-      unsigned dummy, cv_nb_nodes;
-
-      if (version == 2) { /* Format version 2 */
-        unsigned nbtags, mesh_part;
-        f >> id >> type >> nbtags;
-        if (nbtags == 0 || nbtags > 3)
-          GMM_ASSERT1(false, "Number of tags " << nbtags
-                      << " is not managed.");
-
-        f >> region;
-        if (nbtags > 1) f >> dummy;
-        if (nbtags > 2) f >> mesh_part;
-      }
-      else
-        f >> id >> type >> region >> dummy >> cv_nb_nodes;
-
-      id--; /* gmsh numbering starts at 1 */
-
-      cvlst.push_back(gmsh_cv_info());
-      gmsh_cv_info &ci = cvlst.back();
-      ci.id = id; ci.type = type; ci.region = region;
-
-
-      if (version == 2) { /* For version 2 */
-        ci.set_nb_nodes();
-        cv_nb_nodes = unsigned(ci.nodes.size());
+    bool found = (fmt.version >= 2) ? bgeot::read_until(f, "$Elements")
+                                    : bgeot::read_until(f, "$ELM");
+    GMM_ASSERT1(found, "gmsh import: element section not found");
+
+    std::vector<gmsh_cv_info> cvlst;
+    read_gmsh_elements(f, fmt, entities, cvlst);
+
+    open_mp_range_for(cvlst.size(), [&](size_type i) {
+      gmsh_cv_info &ci = cvlst[i];
+      for (size_type &j : ci.nodes) {
+        size_type ip = msh_node_2_getfem_node(j);
+        GMM_ASSERT1(ip != size_type(-1), "Invalid node ID " << j
+                    << " in gmsh element " << (ci.id + 1));
+        j = ip;
       }
-      else
-        ci.nodes.resize(cv_nb_nodes);
-
-      // cout << "cv_nb_nodes = " << cv_nb_nodes << endl;
-
-      for (size_type i=0; i < cv_nb_nodes; ++i) {
-        size_type j;
-        f >> j;
-        std::map<size_type, size_type>::iterator
-          it = msh_node_2_getfem_node.find(j);
-        GMM_ASSERT1(it != msh_node_2_getfem_node.end(),
-                    "Invalid node ID " << j << " in gmsh element "
-                    << (ci.id + 1));
-        ci.nodes[i] = it->second;
-      }
-      if(ci.type != 15) ci.set_pgt();
-      // Reordering nodes for certain elements (should be completed ?)
-      // http://www.geuz.org/gmsh/doc/texinfo/gmsh.html#Node-ordering
-      std::vector<size_type> tmp_nodes(ci.nodes);
-      switch(ci.type) {
-      case 3 : {
-        ci.nodes[2] = tmp_nodes[3];
-        ci.nodes[3] = tmp_nodes[2];
-      } break;
-      case 5 : { /* First order hexaedron */
-        //ci.nodes[0] = tmp_nodes[0];
-        //ci.nodes[1] = tmp_nodes[1];
-        ci.nodes[2] = tmp_nodes[3];
-        ci.nodes[3] = tmp_nodes[2];
-        //ci.nodes[4] = tmp_nodes[4];
-        //ci.nodes[5] = tmp_nodes[5];
-        ci.nodes[6] = tmp_nodes[7];
-        ci.nodes[7] = tmp_nodes[6];
-      } break;
-      case 7 : { /* first order pyramid */
-        //ci.nodes[0] = tmp_nodes[0];
-        ci.nodes[1] = tmp_nodes[2];
-        ci.nodes[2] = tmp_nodes[1];
-        // ci.nodes[3] = tmp_nodes[3];
-        // ci.nodes[4] = tmp_nodes[4];
-      } break;
-      case 8 : { /* Second order line */
-        //ci.nodes[0] = tmp_nodes[0];
-        ci.nodes[1] = tmp_nodes[2];
-        ci.nodes[2] = tmp_nodes[1];
-      } break;
-      case 9 : { /* Second order triangle */
-        //ci.nodes[0] = tmp_nodes[0];
-        ci.nodes[1] = tmp_nodes[3];
-        ci.nodes[2] = tmp_nodes[1];
-        ci.nodes[3] = tmp_nodes[5];
-        //ci.nodes[4] = tmp_nodes[4];
-        ci.nodes[5] = tmp_nodes[2];
-      } break;
-      case 10 : { /* Second order quadrangle */
-        //ci.nodes[0] = tmp_nodes[0];
-        ci.nodes[1] = tmp_nodes[4];
-        ci.nodes[2] = tmp_nodes[1];
-        ci.nodes[3] = tmp_nodes[7];
-        ci.nodes[4] = tmp_nodes[8];
-        //ci.nodes[5] = tmp_nodes[5];
-        ci.nodes[6] = tmp_nodes[3];
-        ci.nodes[7] = tmp_nodes[6];
-        ci.nodes[8] = tmp_nodes[2];
-      } break;
-      case 11: { /* Second order tetrahedron */
-        //ci.nodes[0] = tmp_nodes[0];
-        ci.nodes[1] = tmp_nodes[4];
-        ci.nodes[2] = tmp_nodes[1];
-        ci.nodes[3] = tmp_nodes[6];
-        ci.nodes[4] = tmp_nodes[5];
-        ci.nodes[5] = tmp_nodes[2];
-        ci.nodes[6] = tmp_nodes[7];
-        ci.nodes[7] = tmp_nodes[9];
-        //ci.nodes[8] = tmp_nodes[8];
-        ci.nodes[9] = tmp_nodes[3];
-      } break;
-      case 12: { /* Second order hexahedron */
-        //ci.nodes[0] = tmp_nodes[0];
-        ci.nodes[1] = tmp_nodes[8];
-        ci.nodes[2] = tmp_nodes[1];
-        ci.nodes[3] = tmp_nodes[9];
-        ci.nodes[4] = tmp_nodes[20];
-        ci.nodes[5] = tmp_nodes[11];
-        ci.nodes[6] = tmp_nodes[3];
-        ci.nodes[7] = tmp_nodes[13];
-        ci.nodes[8] = tmp_nodes[2];
-        ci.nodes[9] = tmp_nodes[10];
-        ci.nodes[10] = tmp_nodes[21];
-        ci.nodes[11] = tmp_nodes[12];
-        ci.nodes[12] = tmp_nodes[22];
-        ci.nodes[13] = tmp_nodes[26];
-        ci.nodes[14] = tmp_nodes[23];
-        //ci.nodes[15] = tmp_nodes[15];
-        ci.nodes[16] = tmp_nodes[24];
-        ci.nodes[17] = tmp_nodes[14];
-        ci.nodes[18] = tmp_nodes[4];
-        ci.nodes[19] = tmp_nodes[16];
-        ci.nodes[20] = tmp_nodes[5];
-        ci.nodes[21] = tmp_nodes[17];
-        ci.nodes[22] = tmp_nodes[25];
-        ci.nodes[23] = tmp_nodes[18];
-        ci.nodes[24] = tmp_nodes[7];
-        ci.nodes[25] = tmp_nodes[19];
-        ci.nodes[26] = tmp_nodes[6];
-      } break;
-      case 16 : { /* Incomplete second order quadrangle */
-        //ci.nodes[0] = tmp_nodes[0];
-        ci.nodes[1] = tmp_nodes[4];
-        ci.nodes[2] = tmp_nodes[1];
-        ci.nodes[3] = tmp_nodes[7];
-        ci.nodes[4] = tmp_nodes[5];
-        ci.nodes[5] = tmp_nodes[3];
-        ci.nodes[6] = tmp_nodes[6];
-        ci.nodes[7] = tmp_nodes[2];
-      } break;
-      case 17: { /* Incomplete second order hexahedron */
-        //ci.nodes[0] = tmp_nodes[0];
-        ci.nodes[1] = tmp_nodes[8];
-        ci.nodes[2] = tmp_nodes[1];
-        ci.nodes[3] = tmp_nodes[9];
-        ci.nodes[4] = tmp_nodes[11];
-        ci.nodes[5] = tmp_nodes[3];
-        ci.nodes[6] = tmp_nodes[13];
-        ci.nodes[7] = tmp_nodes[2];
-        ci.nodes[8] = tmp_nodes[10];
-        ci.nodes[9] = tmp_nodes[12];
-        ci.nodes[10] = tmp_nodes[15];
-        ci.nodes[11] = tmp_nodes[14];
-        ci.nodes[12] = tmp_nodes[4];
-        ci.nodes[13] = tmp_nodes[16];
-        ci.nodes[14] = tmp_nodes[5];
-        ci.nodes[15] = tmp_nodes[17];
-        ci.nodes[16] = tmp_nodes[18];
-        ci.nodes[17] = tmp_nodes[7];
-        ci.nodes[18] = tmp_nodes[19];
-        ci.nodes[19] = tmp_nodes[6];
-      } break;
-      case 26 : { /* Third order line */
-        //ci.nodes[0] = tmp_nodes[0];
-        ci.nodes[1] = tmp_nodes[2];
-        ci.nodes[2] = tmp_nodes[3];
-        ci.nodes[3] = tmp_nodes[1];
-      } break;
-      case 21 : { /* Third order triangle */
-        //ci.nodes[0] = tmp_nodes[0];
-        ci.nodes[1] = tmp_nodes[3];
-        ci.nodes[2] = tmp_nodes[4];
-        ci.nodes[3] = tmp_nodes[1];
-        ci.nodes[4] = tmp_nodes[8];
-        ci.nodes[5] = tmp_nodes[9];
-        ci.nodes[6] = tmp_nodes[5];
-        //ci.nodes[7] = tmp_nodes[7];
-        ci.nodes[8] = tmp_nodes[6];
-        ci.nodes[9] = tmp_nodes[2];
-      } break;
-      case 23: { /* Fourth order triangle */
-      //ci.nodes[0]  = tmp_nodes[0];
-        ci.nodes[1]  = tmp_nodes[3];
-        ci.nodes[2]  = tmp_nodes[4];
-        ci.nodes[3]  = tmp_nodes[5];
-        ci.nodes[4]  = tmp_nodes[1];
-        ci.nodes[5]  = tmp_nodes[11];
-        ci.nodes[6]  = tmp_nodes[12];
-        ci.nodes[7]  = tmp_nodes[13];
-        ci.nodes[8]  = tmp_nodes[6];
-        ci.nodes[9]  = tmp_nodes[10];
-        ci.nodes[10] = tmp_nodes[14];
-        ci.nodes[11] = tmp_nodes[7];
-        ci.nodes[12] = tmp_nodes[9];
-        ci.nodes[13] = tmp_nodes[8];
-        ci.nodes[14] = tmp_nodes[2];
-      } break;
-      case 27: { /* Fourth order line */
-      //ci.nodes[0]  = tmp_nodes[0];
-        ci.nodes[1]  = tmp_nodes[2];
-        ci.nodes[2]  = tmp_nodes[3];
-        ci.nodes[3]  = tmp_nodes[4];
-        ci.nodes[4]  = tmp_nodes[1];
-      } break;
+      ci.reorder_nodes();
+    });
+    std::map<unsigned, bgeot::pgeometric_trans> pgt_of_type;
+    for (gmsh_cv_info &ci : cvlst)
+      if (ci.type != 15) {
+        auto it = pgt_of_type.find(ci.type);
+        if (it == pgt_of_type.end())
+          { ci.set_pgt(); pgt_of_type[ci.type] = ci.pgt; }
+        else ci.pgt = it->second;
       }
-    }
-    nb_cv = cvlst.size();
+
+    size_type nb_cv = cvlst.size();
     if (cvlst.size()) {
       std::sort(cvlst.begin(), cvlst.end());
       if (cvlst.front().type == 15){
@@ -584,24 +1125,22 @@ namespace getfem {
   /* mesh file from GiD [http://gid.cimne.upc.es/]
 
   supports linear and quadratic elements (quadrilaterals, use 9(or 27)-noded elements)
+  The meshes are searched up to the end of the file.
   */
   static void import_gid_mesh_file(std::istream& f, mesh& m) {
-    gmm::stream_standard_locale sl(f);
+    mesh_file_tokenizer t(f);
     /* read the node list */
     size_type dim;
     enum { LIN,TRI,QUAD,TETR, PRISM, HEX,BADELTYPE } eltype=BADELTYPE;
     size_type nnode = 0;
-    std::map<size_type, size_type> msh_node_2_getfem_node;
+    std::vector<size_type> msh_node_2_getfem_node;
     std::vector<size_type> cv_nodes, getfem_cv_nodes;
     bool nodes_done = false;
-    do {
-      if (!f.eof()) f >> std::ws;
-      if (f.eof() || !bgeot::read_until(f, "MESH")) break;
+    while (t.find("MESH")) {
       std::string selemtype;
-      f >> bgeot::skip("DIMENSION") >> dim
-        >> bgeot::skip("ELEMTYPE") >> std::ws
-        >> selemtype
-        >> bgeot::skip("NNODE") >> nnode;
+      t.expect("DIMENSION"); dim = size_type(t.get_int());
+      t.expect("ELEMTYPE"); selemtype = t.get_word();
+      t.expect("NNODE"); nnode = size_type(t.get_int());
       if (bgeot::casecmp(selemtype, "linear")==0) { eltype = LIN;  }
       else if (bgeot::casecmp(selemtype, "triangle")==0) { eltype = TRI; }
       else if (bgeot::casecmp(selemtype, "quadrilateral")==0) { eltype = QUAD; }
@@ -609,28 +1148,22 @@ namespace getfem {
       else if (bgeot::casecmp(selemtype, "prisma")==0) { eltype = PRISM; }
       else if (bgeot::casecmp(selemtype, "hexahedra")==0) { eltype = HEX; }
       else GMM_ASSERT1(false, "unknown element type '"<< selemtype << "'");
-      GMM_ASSERT1(!f.eof(), "File ended before coordinates");
-      f >> bgeot::skip("COORDINATES");
-      if (!nodes_done) {
-        dal::dynamic_array<base_node> gid_nodes;
-        dal::bit_vector gid_nodes_used;
-        do {
-          //cerr << "reading coordinates " << std::streamoff(f.tellg()) << "\n";
-          std::string ls;
-          f >> std::ws;
-          std::getline(f,ls);
-          if (bgeot::casecmp(ls, "END COORDINATES", 15)==0) break;
-          std::stringstream s; s << ls;
-          size_type id;
-          s >> id;
-
-          gid_nodes[id].resize(dim); gid_nodes_used.add(id);
-          for (size_type i=0; i < dim; ++i) s >> gid_nodes[id][i];
-          //cerr << "ppoint " << id << ", " << n << endl;
-        } while (true);
-
-        GMM_ASSERT1(gid_nodes_used.card() != 0, "no nodes in the mesh!");
+      GMM_ASSERT1(t.skip_spaces(), "File ended before coordinates");
+      t.expect("COORDINATES");
+      dal::dynamic_array<base_node> gid_nodes;
+      dal::bit_vector gid_nodes_used;
+      while (!t.next_is("END")) {
+        size_type id = size_type(t.get_int());
+        gid_nodes[id].resize(dim); gid_nodes_used.add(id);
+        for (size_type i=0; i < dim; ++i) gid_nodes[id][i] = t.get_scalar();
+        t.skip_line();
+      }
+      t.expect("END"); t.expect("COORDINATES");
 
+      /* the following meshes may have an empty list of nodes */
+      if (gid_nodes_used.card() == 0)
+        GMM_ASSERT1(nodes_done, "no nodes in the mesh!");
+      if (gid_nodes_used.card() != 0) {
         /* suppression of unused dimensions */
         std::vector<bool> direction_useless(3,true);
         base_node first_pt = gid_nodes[gid_nodes_used.first()];
@@ -642,14 +1175,18 @@ namespace getfem {
         }
         size_type dim2=0;
         for (size_type j=0; j < dim; ++j) if (!direction_useless[j]) dim2++;
+        if (msh_node_2_getfem_node.size() <= size_type(gid_nodes_used.last()))
+          msh_node_2_getfem_node.resize(gid_nodes_used.last()+1,
+                                        size_type(-1));
         for (dal::bv_visitor ip(gid_nodes_used); !ip.finished(); ++ip) {
           base_node n(dim2);
           for (size_type j=0, cnt=0; j < dim; ++j) if (!direction_useless[j]) n[cnt++]=gid_nodes[ip][j];
           msh_node_2_getfem_node[ip] = m.add_point(n);
         }
+        nodes_done = true;
       }
 
-      bgeot::read_until(f, "ELEMENTS");
+      t.expect("ELEMENTS");
       bgeot::pgeometric_trans pgt = NULL;
       std::vector<size_type> order(nnode); // ordre de GiD cf http://gid.cimne.upc.es/support/gid_11.subst#SEC160
       for (size_type i=0; i < nnode; ++i) order[i]=i;
@@ -703,24 +1240,17 @@ namespace getfem {
       }
       GMM_ASSERT1(pgt != NULL, "unknown element type " << selemtype
                   << " with " << nnode << "nodes");
-      do {
-        std::string ls;
-        f >> std::ws;
-        std::getline(f,ls);
-        if (bgeot::casecmp(ls, "END ELEMENTS", 12)==0) break;
-        std::stringstream s; s << ls;
-        size_type cv_id;
-        s >> cv_id;
+      while (!t.next_is("END")) {
+        size_type cv_id = size_type(t.get_int());
         cv_nodes.resize(nnode);
         for (size_type i=0; i < nnode; ++i) {
-          size_type j;
-          s >> j;
-          std::map<size_type, size_type>::iterator
-            it = msh_node_2_getfem_node.find(j);
-          GMM_ASSERT1(it != msh_node_2_getfem_node.end(),
+          size_type j = size_type(t.get_int());
+          GMM_ASSERT1(j < msh_node_2_getfem_node.size()
+                      && msh_node_2_getfem_node[j] != size_type(-1),
                       "Invalid node ID " << j << " in GiD element " << cv_id);
-          cv_nodes[i] = it->second;
+          cv_nodes[i] = msh_node_2_getfem_node[j];
         }
+        t.skip_line(); // material number
         getfem_cv_nodes.resize(nnode);
         for (size_type i=0; i < nnode; ++i) {
           getfem_cv_nodes[i] = cv_nodes[order[i]];
@@ -730,8 +1260,9 @@ namespace getfem {
         // envisager la "simplification" quand on a une transfo non
         // lineaire mais que la destination est lineaire
         m.add_convex(pgt, getfem_cv_nodes.begin());
-      } while (true);
-    } while (!f.eof());
+      }
+      t.expect("END"); t.expect("ELEMENTS");
+    }
   }
 
   /* mesh file from ANSYS
@@ -1189,97 +1720,38 @@ namespace getfem {
   }
 
 
-  /* mesh file from noboite [http://www.distene.com/fr/corp/newsroom16.html] */
-  static void import_noboite_mesh_file(std::istream& f, mesh& m) {
-
-    using namespace std;
-    gmm::stream_standard_locale sl(f);
-
-    ofstream fichier_GiD("noboite_to_GiD.gid",    ios::out | ios::trunc );  //déclaration du flux et ouverture du fichier
-
-    fichier_GiD << "MESH    dimension 3 ElemType Tetrahedra  Nnode 4"<<endl;
-
-
-    int i,NE,NP,ligne_debut_NP;
-
-    /*NE: nombre d'elements (premier nombre du fichier .noboite)
-      NP: nombre de points (deuxieme nombre du fichier .noboite)
-      ligne_debut_NP: la ligne commence la liste des coordonnees des points dans le
-                      fichier .noboite*/
+  /* mesh file from noboite [http://www.distene.com/fr/corp/newsroom16.html]
 
-    f >> NE>>NP;
-    ligne_debut_NP=NE*4/6+3;
-
-    //passer 3 premiers lignes du fichier .noboite (la liste des elements commence a la
-    //quatrieme ligne)
-    string contenu;
-    for (i=1; i<=ligne_debut_NP; i++){
-      getline(f, contenu);
+  The three first lines are a header beginning with the number of elements
+  NE and the number of points NP. Then come the 4*NE node numbers of the
+  tetrahedra and the 3*NP coordinates of the points.
+  */
+  static void import_noboite_mesh_file(std::istream& f, mesh& m) {
+    mesh_file_tokenizer t(f);
+    size_type NE = size_type(t.get_int()), NP = size_type(t.get_int());
+    for (size_type i = 0; i < 3; ++i) t.skip_line();
+
+    std::vector<size_type> tetra(4*NE);
+    for (size_type i = 0; i < 4*NE; ++i) {
+      long j = t.get_int();
+      GMM_ASSERT1(j >= 1 && size_type(j) <= NP, "noboite import: invalid "
+                  "node number " << j << " in element " << i/4+1);
+      tetra[i] = size_type(j-1);
     }
 
-
-    /*-----------------------------------------------------------------------
-      Lire les coordonnees dans .noboite
-      -----------------------------------------------------------------------*/
-    fichier_GiD << "Coordinates" <<endl;
-
-    for (i=1; i<=NP; i++){
-      float coor_x,coor_y,coor_z;
-
-      fichier_GiD << i<<" ";
-
-      f>>coor_x >>coor_y >>coor_z;
-      fichier_GiD<<coor_x<<" " <<coor_y <<" "<<coor_z <<endl;
-
+    std::vector<size_type> ipts(NP);
+    base_node P(3);
+    for (size_type i = 0; i < NP; ++i) {
+      for (size_type k = 0; k < 3; ++k) P[k] = t.get_scalar();
+      ipts[i] = m.add_point(P);
     }
 
-    fichier_GiD << "end coordinates" <<endl<<endl;
-
-    /*-----------------------------------------------------------------------
-      Lire les elements dans .noboite et ecrire au . gid
-      ------------------------------------------------------------------------*/
-
-    //revenir au debut du fichier . noboite, puis passer les trois premiere lignes
-    f.seekg(0, ios::beg);
-    for (i=1; i<=3; i++){
-      getline(f, contenu);
+    bgeot::pgeometric_trans pgt = bgeot::simplex_geotrans(3,1);
+    size_type ind[4];
+    for (size_type i = 0; i < NE; ++i) {
+      for (size_type k = 0; k < 4; ++k) ind[k] = ipts[tetra[4*i+k]];
+      m.add_convex(pgt, &ind[0]);
     }
-
-
-    fichier_GiD << "Elements" <<endl;
-
-    for (i=1; i<=NE; i++){
-      float elem_1,elem_2,elem_3,elem_4;
-
-      fichier_GiD << i<<" ";
-      f>>elem_1>>elem_2>>elem_3>>elem_4;
-      fichier_GiD<<elem_1<<" " <<elem_2 <<" "<<elem_3<<" "<<elem_4<<" 1"<<endl;
-
-    }
-    fichier_GiD << "end elements" <<endl<<endl;
-
-    if(fichier_GiD)  // si l'ouverture a réussi
-      {
-        // instructions
-        fichier_GiD.close();  // on referme le fichier
-      }
-    else  // sinon
-      cerr << "Erreur à l'ouverture !" << endl;
-
-    if(f)  // si l'ouverture a réussi
-      {
-        // instructions
-        //f.close();  // on referme le fichier
-      }
-    else  // sinon
-      cerr << "Erreur à l'ouverture !" << endl;
-
-    // appeler sunroutine import_gid_mesh_file
-    //import_mesh(const std::string& "noboite_to_GiD.gid", mesh& msh)
-    ifstream fichier1_GiD("noboite_to_GiD.gid", ios::in);
-    import_gid_mesh_file(fichier1_GiD, m);
-
-    //      return 0;
   }
 
   /* mesh file from emc2 [http://pauillac.inria.fr/cdrom/prog/unix/emc2/eng.htm], am_fmt format
@@ -1287,17 +1759,17 @@ namespace getfem {
   (only triangular 2D meshes)
   */
   static void import_am_fmt_mesh_file(std::istream& f, mesh& m) {
-    gmm::stream_standard_locale sl(f);
+    mesh_file_tokenizer t(f);
     /* read the node list */
     std::vector<size_type> tri;
     size_type nbs,nbt;
     base_node P(2);
-    f >> nbs >> nbt; bgeot::read_until(f,"\n");
+    nbs = size_type(t.get_int()); nbt = size_type(t.get_int());
+    t.skip_line();
     tri.resize(nbt*3);
-    for (size_type i=0; i < nbt*3; ++i) f >> tri[i];
+    for (size_type i=0; i < nbt*3; ++i) tri[i] = size_type(t.get_int());
     for (size_type j=0; j < nbs; ++j) {
-      f >> P[0] >> P[1];
-      cerr.precision(16);
+      P[0] = t.get_scalar(); P[1] = t.get_scalar();
       P[0]=round_to_nth_significant_number(P[0],6); // force 9.999999E-1 to be converted to 1.0
       P[1]=round_to_nth_significant_number(P[1],6);
       size_type jj = m.add_point(P);
@@ -1312,35 +1784,35 @@ namespace getfem {
   triangular/quadrangular 2D meshes
   */
   static void import_emc2_mesh_file(std::istream& f, mesh& m) {
-    gmm::stream_standard_locale sl(f);
+    mesh_file_tokenizer t(f);
     /* read the node list */
-    std::vector<size_type> tri;
-    size_type nbs=0,nbt=0,nbq=0,dummy;
+    size_type nbs=0,nbt=0,nbq=0;
     base_node P(2);
-    bgeot::read_until(f,"Vertices");
-    f >> nbs;
+    GMM_ASSERT1(t.find("Vertices"), "emc2 import: no vertices found");
+    nbs = size_type(t.get_int());
     for (size_type j=0; j < nbs; ++j) {
-      f >> P[0] >> P[1] >> dummy;
+      P[0] = t.get_scalar(); P[1] = t.get_scalar(); t.get_int();
       size_type jj = m.add_point(P);
       GMM_ASSERT1(jj == j, "ouch");
     }
-    while (!f.eof()) {
+    while (t.skip_spaces()) {
       size_type ip[4];
-      std::string ls;
-      std::getline(f,ls);
-      if (ls.find("Triangles")+1) {
-        f >> nbt;
+      std::string w = t.get_word();
+      if (w.find("Triangles")+1) {
+        nbt = size_type(t.get_int());
         for (size_type i=0; i < nbt; ++i) {
-          f >> ip[0] >> ip[1] >> ip[2] >> dummy; ip[0]--; ip[1]--; ip[2]--;
+          for (size_type k=0; k < 3; ++k) ip[k] = size_type(t.get_int()-1);
+          t.get_int();
           m.add_triangle(ip[0],ip[1],ip[2]);
         }
-      } else if (ls.find("Quadrangles")+1) {
-        f >> nbq;
+      } else if (w.find("Quadrangles")+1) {
+        nbq = size_type(t.get_int());
         for (size_type i=0; i < nbq; ++i) {
-          f >> ip[0] >> ip[1] >> ip[2] >> ip[3] >> dummy; ip[0]--; ip[1]--; ip[2]--; ip[3]--;
+          for (size_type k=0; k < 4; ++k) ip[k] = size_type(t.get_int()-1);
+          t.get_int();
           m.add_parallelepiped(2, &ip[0]);
         }
-      } else if (ls.find("End")+1) break;
+      } else if (w.find("End")+1) break;
     }
   }
 
@@ -24,6 +24,7 @@
 #include "gmm/gmm_condition_number.h"
 #include "getfem/getfem_mesh.h"
 #include "getfem/getfem_integration.h"
+#include <atomic>
 
 #if GETFEM_HAVE_METIS_OLD_API
 extern "C" void METIS_PartGraphKway(int *, int *, int *, int *, int *, int *,
@@ -35,7 +36,7 @@ extern "C" void METIS_PartGraphKway(int *, int *, int *, int *, int *, int *,
 namespace getfem {
 
   gmm::uint64_type act_counter(void) {
-    static gmm::uint64_type c = gmm::uint64_type(1);
+    static std::atomic<gmm::uint64_type> c(1);
     return ++c;
   }
 
@@ -704,9 +705,9 @@ namespace getfem {
                                    const base_matrix& G,
                                    pintegration_method pi) {
     double area(0);
-    static bgeot::pgeometric_trans pgt_old = 0;
-    static bgeot::pgeotrans_precomp pgp = 0;
-    static pintegration_method pim_old = 0;
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(bgeot::pgeometric_trans, pgt_old, 0);
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(bgeot::pgeotrans_precomp, pgp, 0);
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(pintegration_method, pim_old, 0);
     papprox_integration pai = get_approx_im_or_fail(pi);
     if (pgt_old != pgt || pim_old != pi) {
       pgt_old = pgt;
@@ -729,8 +730,8 @@ namespace getfem {
   */
   scalar_type convex_quality_estimate(bgeot::pgeometric_trans pgt,
                                       const base_matrix& G) {
-    static bgeot::pgeometric_trans pgt_old = 0;
-    static bgeot::pgeotrans_precomp pgp = 0;
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(bgeot::pgeometric_trans, pgt_old, 0);
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(bgeot::pgeotrans_precomp, pgp, 0);
     if (pgt_old != pgt) {
       pgt_old=pgt;
       pgp=bgeot::geotrans_precomp(pgt, pgt->pgeometric_nodes(), 0);
@@ -755,8 +756,8 @@ namespace getfem {
 
   scalar_type convex_radius_estimate(bgeot::pgeometric_trans pgt,
                                      const base_matrix& G) {
-    static bgeot::pgeometric_trans pgt_old = 0;
-    static bgeot::pgeotrans_precomp pgp = 0;
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(bgeot::pgeometric_trans, pgt_old, 0);
+    DEFINE_STATIC_THREAD_LOCAL_INITIALIZED(bgeot::pgeotrans_precomp, pgp, 0);
     if (pgt_old != pgt) {
       pgt_old=pgt;
       pgp=bgeot::geotrans_precomp(pgt, pgt->pgeometric_nodes(), 0);
@@ -29,12 +29,30 @@ namespace getfem {
   { is_adapted = false; }
 
   void mesh_im_level_set::clear_build_methods() {
-    for (size_type i = 0; i < build_methods.size(); ++i)
-      del_stored_object(build_methods[i]);
+    for (cut_rule_map::iterator it = cut_rules.begin();
+	 it != cut_rules.end(); ++it)
+      del_stored_object(it->second.pim);
+    cut_rules.clear();
     build_methods.clear();
+    built_versions.clear();
     cut_im.clear();
   }
 
+  void mesh_im_level_set::clear_method_of_convex(size_type cv) {
+    std::map<size_type, cut_rule_map::iterator>::iterator
+      it = build_methods.find(cv);
+    if (it != build_methods.end()) {
+      if (--(it->second->second.nb_uses) == 0) {
+	del_stored_object(it->second->second.pim);
+	cut_rules.erase(it->second);
+      }
+      build_methods.erase(it);
+    }
+    if (cut_im.convex_index().is_in(cv))
+      cut_im.set_integration_method(cv, 0);
+    ignored_im.sup(cv);
+  }
+
   void mesh_im_level_set::clear(void) {
     mesh_im::clear();
     clear_build_methods();
@@ -58,12 +76,12 @@ namespace getfem {
 				       int integrate_where_, 
 				       pintegration_method reg,
 				       pintegration_method sing) {
-    mls = 0;
+    mls = 0; built_mls = 0;
     init_with_mls(me, integrate_where_, reg, sing);
   }
 
   mesh_im_level_set::mesh_im_level_set(void)
-  { mls = 0; is_adapted = false; }
+  { mls = 0; built_mls = 0; is_adapted = false; }
 
 
   pintegration_method 
@@ -221,7 +239,6 @@ namespace getfem {
   void mesh_im_level_set::build_method_of_convex(size_type cv) {
     const mesh &msh(mls->mesh_of_convex(cv));
     GMM_ASSERT3(msh.convex_index().card() != 0, "Internal error");
-    base_matrix G;
     base_node B;
 
     std::vector<pmesher_signed_distance> mesherls0(mls->nb_level_sets());
@@ -256,19 +273,19 @@ namespace getfem {
        && (n >= 2) && (n <= 3),
        "Base integration method for quasi polar integration not convenient");
 
-    auto new_approx = std::make_shared<approx_integration>(pgt->convex_ref());
-    new_approx->set_built_on_the_fly();
-    base_matrix KK(n,n), CS(n,n);
-    base_matrix pc(pgt2->nb_points(), n);
-    std::vector<size_type> ptsing;
+    GMM_ASSERT1(regular_simplex_pim->structure() == bgeot::simplex_structure(n), "Base integration method should be defined on a simplex of same dimension than the mesh");
 
-    // cout << "testing convex " << cv << ", " << msh.convex_index().card() << " subconvexes\n";
+    /* Integration method of each sub-element kept, and cut pattern
+       of the convex. */
+    std::vector<papprox_integration> pais(msh.nb_allocated_convex());
+    std::vector<size_type> ptsing;
+    cut_pattern pattern;
+    pattern.cvr = pgt->convex_ref(); pattern.pgt2 = pgt2;
+    pattern.cv = (integrate_where == INTEGRATE_BOUNDARY) ? cv : size_type(-1);
 
     for (dal::bv_visitor i(msh.convex_index()); !i.finished(); ++i) {
       papprox_integration pai = regular_simplex_pim->approx_method();
       
-      GMM_ASSERT1(regular_simplex_pim->structure() == bgeot::simplex_structure(n), "Base integration method should be defined on a simplex of same dimension than the mesh");
-      
       if ((integrate_where != INTEGRATE_ALL) &&
 	  !convexes_arein[i]) continue;
       
@@ -302,6 +319,50 @@ namespace getfem {
 	  pai = int_method_descriptor(sts.str())->approx_method();
 	}
       }
+      pais[i] = pai;
+
+      pattern.data.push_back(scalar_type(ptsing.size()));
+      for (size_type k = 0; k < ptsing.size(); ++k)
+	pattern.data.push_back(scalar_type(ptsing[k]));
+      for (size_type k = 0; k < msh.nb_points_of_convex(i); ++k)
+	for (dim_type l = 0; l < n; ++l)
+	  pattern.data.push_back
+	    (floor(msh.points_of_convex(i)[k][l] * 1E10 + 0.5));
+    }
+
+    cut_rule_map::iterator itr = cut_rules.find(pattern);
+    if (itr == cut_rules.end()) {
+      pintegration_method pim = build_method_of_cut(cv, mesherls0, mesherls1,
+						    pais);
+      if (!pim) return;
+      cut_rule r; r.pim = pim; r.nb_uses = 0;
+      itr = cut_rules.insert(std::make_pair(pattern, r)).first;
+    }
+    ++(itr->second.nb_uses);
+    build_methods[cv] = itr;
+    cut_im.set_integration_method(cv, itr->second.pim);
+  }
+
+  pintegration_method mesh_im_level_set::build_method_of_cut
+  (size_type cv, const std::vector<pmesher_signed_distance> &mesherls0,
+   const std::vector<pmesher_signed_distance> &mesherls1,
+   const std::vector<papprox_integration> &pais) {
+    const mesh &msh(mls->mesh_of_convex(cv));
+    base_matrix G;
+    base_node B;
+    bgeot::pgeometric_trans pgt = linked_mesh().trans_of_convex(cv);
+    bgeot::pgeometric_trans pgt2
+      = msh.trans_of_convex(msh.convex_index().first_true());
+    dim_type n = pgt->dim();
+
+    auto new_approx = std::make_shared<approx_integration>(pgt->convex_ref());
+    new_approx->set_built_on_the_fly();
+    base_matrix KK(n,n);
+    base_matrix pc(pgt2->nb_points(), n);
+
+    for (dal::bv_visitor i(msh.convex_index()); !i.finished(); ++i) {
+      papprox_integration pai = pais[i];
+      if (!pai) continue;
 
       base_matrix G2;
       vectors_to_base_matrix(G2, linked_mesh().points_of_convex(cv));
@@ -392,26 +453,46 @@ namespace getfem {
       }
     }
 
-    if (new_approx->nb_points()) {
-      new_approx->valid_method();
-      pintegration_method
-	pim = std::make_shared<integration_method>(new_approx);
-      dal::pstatic_stored_object_key
-	pk = std::make_shared<special_imls_key>(new_approx);
-      dal::add_stored_object(pk, pim, new_approx->ref_convex(),
-			     new_approx->pintegration_points());
-      build_methods.push_back(pim);
-      cut_im.set_integration_method(cv, pim);
-    }
+    if (!new_approx->nb_points()) return pintegration_method();
+    new_approx->valid_method();
+    pintegration_method
+      pim = std::make_shared<integration_method>(new_approx);
+    dal::pstatic_stored_object_key
+      pk = std::make_shared<special_imls_key>(new_approx);
+    dal::add_stored_object(pk, pim, new_approx->ref_convex(),
+			   new_approx->pintegration_points());
+    return pim;
   }
 
   void mesh_im_level_set::adapt(void) {
     GMM_ASSERT1(linked_mesh_ != 0, "mesh level set uninitialized");
     context_check();
-    clear_build_methods();
-    ignored_im.clear();
+    if (built_mls != mls || built_where != integrate_where
+	|| built_regular_pim != regular_simplex_pim
+	|| built_singular_pim != base_singular_pim
+	|| built_csg_description != ls_csg_description) {
+      clear_build_methods();
+      ignored_im.clear();
+      built_mls = mls; built_where = integrate_where;
+      built_regular_pim = regular_simplex_pim;
+      built_singular_pim = base_singular_pim;
+      built_csg_description = ls_csg_description;
+    }
+    for (std::map<size_type, cut_rule_map::iterator>::iterator
+	   it = build_methods.begin(); it != build_methods.end(); ) {
+      size_type cv = (it++)->first;
+      if (!linked_mesh().convex_index().is_in(cv)) clear_method_of_convex(cv);
+    }
+    ignored_im &= linked_mesh().convex_index();
+    built_versions.resize(linked_mesh().nb_allocated_convex());
+
     for (dal::bv_visitor cv(linked_mesh().convex_index()); 
 	 !cv.finished(); ++cv) {
+      // A version 0 means that cv is not known by the mesh_level_set.
+      gmm::uint64_type v = mls->convex_version_number(cv);
+      if (v != 0 && built_versions[cv] == v) continue;
+      built_versions[cv] = v;
+      clear_method_of_convex(cv);
       if (mls->is_convex_cut(cv)) build_method_of_convex(cv);
 
       if (!cut_im.convex_index().is_in(cv)) {
@@ -556,7 +637,6 @@ namespace getfem {
   (size_type cv, mesh &global_intersection, bgeot::rtree &rtree_seg) {
     const mesh &msh(mls->mesh_of_convex(cv));
     GMM_ASSERT3(msh.convex_index().card() != 0, "Internal error");
-    base_matrix G;
     base_node B;
 
     std::vector<pmesher_signed_distance> mesherls0(2);
@@ -19,6 +19,7 @@
 
 ===========================================================================*/
 
+#include <random>
 #include "getfem/getfem_mesh_level_set.h"
 
 
@@ -45,6 +46,16 @@ namespace getfem {
     os << "]";
     return os;
   }
+
+  // Random starting points of the projections and curvature estimates on
+  // an element. The elements are treated in parallel, so that the generator
+  // is seeded with the element number, the result depending neither on the
+  // number of threads nor on the global rand() state.
+  static void random_point(base_node &X, std::minstd_rand &gen) {
+    for (size_type i = 0; i < X.size(); ++i)
+      X[i] = scalar_type(gen() - gen.min()) * scalar_type(2)
+	/ scalar_type(gen.max() - gen.min()) - scalar_type(1);
+  }
   
 
 #ifdef DEBUG_LS
@@ -77,6 +88,7 @@ struct Chrono {
 
   void mesh_level_set::clear(void) {
     cut_cv.clear();
+    convex_states.clear(); adapted_level_sets.clear();
     is_adapted_ = false; touch();
   }
 
@@ -306,7 +318,11 @@ struct Chrono {
     double t0=gmm::uclock_sec();
     if (noisy) cout << "running delaunay with " << fixed_points.size()
 		    << " points.." << std::flush;
-    bgeot::qhull_delaunay(fixed_points, simplexes);
+    { // qhull is not reentrant
+      omp_guard scoped_lock;
+      GMM_NOPERATION(scoped_lock);
+      bgeot::qhull_delaunay(fixed_points, simplexes);
+    }
     if (noisy) cout << " -> " << gmm::mat_ncols(simplexes)
 		    << " simplexes [" << gmm::uclock_sec()-t0 << "sec]\n";
   }
@@ -332,20 +348,55 @@ struct Chrono {
 	}
 	else ++it1;
       }
-      zones1.insert(&(*(allzones.insert(z).first)));
+      zones1.insert(intern_zone(z));
     }
   }
 
+  /* The subzones and zones are shared by all the elements, they are stored
+     once in allsubzones and allzones and referred to by their address.
+     Since the elements are cut in parallel, the insertions are protected
+     by a lock. The stored strings and sets are never modified, so that
+     they can be read without it. */
+  const mesh_level_set::subzone *
+  mesh_level_set::intern_subzone(const subzone &s) const {
+    getfem::local_guard lock = zones_lock.get_lock();
+    return &(*(allsubzones.insert(s).first));
+  }
+
+  const mesh_level_set::zone *
+  mesh_level_set::intern_zone(const zone &z) const {
+    getfem::local_guard lock = zones_lock.get_lock();
+    return &(*(allzones.insert(z).first));
+  }
+
+  /* The incremental adapt only adds subzones and zones. The ones which are
+     no longer referred to by a convex are removed, so that the tables do
+     not grow over the successive updates of the level sets. */
+  void mesh_level_set::prune_zones(void) {
+    std::set<const subzone *> used_subzones;
+    std::set<const zone *> used_zones;
+    for (dal::bv_visitor cv(linked_mesh().convex_index());
+	 !cv.finished(); ++cv)
+      used_subzones.insert(zones_of_convexes[cv]);
+    for (const auto &cvi : cut_cv)
+      for (const zone *pz : cvi.second.zones) {
+	used_zones.insert(pz);
+	used_subzones.insert(pz->begin(), pz->end());
+      }
+    for (auto it = allzones.begin(); it != allzones.end(); )
+      if (used_zones.count(&(*it))) ++it; else allzones.erase(it++);
+    for (auto it = allsubzones.begin(); it != allsubzones.end(); )
+      if (used_subzones.count(&(*it))) ++it; else allsubzones.erase(it++);
+  }
+
   /* recursively replace '0' by '+' and '-', and the add the new zones */
-  static void add_sub_zones_no_zero(std::string &s, 
-				    mesh_level_set::zone &z, 
-				    std::set<std::string> &allsubzones) {
+  void mesh_level_set::add_sub_zones_no_zero(std::string &s, zone &z) const {
     size_t i = s.find('0');
     if (i != size_t(-1)) {
-      s[i] = '+'; add_sub_zones_no_zero(s, z, allsubzones);
-      s[i] = '-'; add_sub_zones_no_zero(s, z, allsubzones);
+      s[i] = '+'; add_sub_zones_no_zero(s, z);
+      s[i] = '-'; add_sub_zones_no_zero(s, z);
     } else {
-      z.insert(&(*(allsubzones.insert(s).first)));
+      z.insert(intern_subzone(s));
     }
   }
 
@@ -353,9 +404,9 @@ struct Chrono {
 				     const std::string &subz) const {
     // very sub-optimal
     zone z; std::string s(subz);
-    add_sub_zones_no_zero(s, z, allsubzones);
+    add_sub_zones_no_zero(s, z);
     zoneset zs;
-    zs.insert(&(*(allzones.insert(z).first)));
+    zs.insert(intern_zone(z));
     merge_zoneset(zones1, zs);
   }
 
@@ -365,7 +416,7 @@ struct Chrono {
   void mesh_level_set::find_zones_of_element(size_type cv,
 					     std::string &prezone,
 					     scalar_type radius) {
-    convex_info &cvi = cut_cv[cv];
+    convex_info &cvi = cut_cv.find(cv)->second;
     cvi.zones.clear();
     for (dal::bv_visitor i(cvi.pmsh->convex_index()); !i.finished();++i) {
       // If the sub element is too small, the zone is not taken into account
@@ -392,8 +443,9 @@ struct Chrono {
 				   const dal::bit_vector &secondary,
 				   scalar_type radius_cv) {
     
-    cut_cv[cv] = convex_info();
-    cut_cv[cv].pmsh = std::make_shared<mesh>();
+    // The entry of cv is created by adapt, cut_cv is not modified here.
+    convex_info &cvi = cut_cv.find(cv)->second;
+    cvi.pmsh = std::make_shared<mesh>();
     if (noisy) cout << "cutting element " << cv << endl;
     bgeot::pgeometric_trans pgt = linked_mesh().trans_of_convex(cv);
     pmesher_signed_distance ref_element = new_ref_element(pgt);
@@ -417,9 +469,10 @@ struct Chrono {
     ref_element->register_constraints(list_constraints);
     size_type nbeltconstraints = list_constraints.size();
     mesher_level_sets.reserve(nbtotls);
+    std::minstd_rand gen(std::minstd_rand::result_type(cv + 1));
     for (size_type ll = 0; ll < level_sets.size(); ++ll) {
       if (primary[ll]) {
-	base_node X(n); gmm::fill_random(X);
+	base_node X(n); random_point(X, gen);
 	K = std::max(K, (level_sets[ll])->degree());
 	mesher_level_sets.push_back(level_sets[ll]->mls_of_convex(cv, 0));
 	pmesher_signed_distance mls(mesher_level_sets.back());
@@ -525,9 +578,9 @@ struct Chrono {
       
       std::vector<base_node> fixed_points;
       std::vector<dal::bit_vector> fixed_points_constraints;
-      mesh &msh(*(cut_cv[cv].pmsh));
+      mesh &msh(*(cvi.pmsh));
 	
-      mesh_region &ls_border_faces(cut_cv[cv].ls_border_faces);
+      mesh_region &ls_border_faces(cvi.ls_border_faces);
       std::vector<base_node> cvpts;
 
       size_type nb_delaunay = 0;
@@ -829,12 +882,14 @@ struct Chrono {
 
   }
 
-  void mesh_level_set::update_crack_tip_convexes() {
-    crack_tip_convexes_.clear();
-     
-    for (std::map<size_type, convex_info>::const_iterator it = cut_cv.begin(); 
-	 it != cut_cv.end(); ++it) {
-      size_type cv = it->first;
+  // The crack tip status of the convexes cvs is recomputed.
+  void mesh_level_set::update_crack_tip_convexes
+  (const std::vector<size_type> &cvs) {
+    for (size_type i = 0; i < cvs.size(); ++i) {
+      size_type cv = cvs[i];
+      crack_tip_convexes_.sup(cv);
+      std::map<size_type, convex_info>::const_iterator it = cut_cv.find(cv);
+      if (it == cut_cv.end()) continue;
       mesh &msh = *(it->second.pmsh);      
       for (unsigned ils = 0; ils < nb_level_sets(); ++ils) {
 	if (get_level_set(ils)->has_secondary()) {
@@ -858,34 +913,230 @@ struct Chrono {
     }    
   }
 
+  /* Call f(i) for i = 0 .. nb-1 over the threads, serially in noisy mode
+     for readable traces. */
+  template <typename FUNC>
+  static void level_set_parallel_for(size_type nb, const FUNC &f) {
+    if (noisy) { for (size_type i = 0; i < nb; ++i) f(i); }
+    else open_mp_range_for(nb, f);
+  }
+
+  /* Bernstein polynomials of degree k at x on the reference simplex
+     (simplex = true) or parallelepiped of dimension n. They are
+     non-negative on the element and sum to one. */
+  static void bernstein_basis(bool simplex, dim_type n, short_type k,
+			      const base_node &x,
+			      std::vector<scalar_type> &B) {
+    std::vector<scalar_type> fact(k+1, scalar_type(1));
+    for (short_type i = 1; i <= k; ++i) fact[i] = fact[i-1] * scalar_type(i);
+    std::vector<short_type> alpha(n, 0);
+    B.resize(0);
+    scalar_type l0(1);
+    for (dim_type d = 0; d < n; ++d) l0 -= x[d];
+    for (;;) {
+      short_type s = 0;
+      for (dim_type d = 0; d < n; ++d) s = short_type(s + alpha[d]);
+      if (!simplex || s <= k) {
+	scalar_type b(1);
+	if (simplex) {
+	  b = fact[k] / fact[k-s] * pow(l0, int(k-s));
+	  for (dim_type d = 0; d < n; ++d)
+	    b *= pow(x[d], int(alpha[d])) / fact[alpha[d]];
+	}
+	else
+	  for (dim_type d = 0; d < n; ++d)
+	    b *= fact[k] / (fact[alpha[d]] * fact[k-alpha[d]])
+	      * pow(x[d], int(alpha[d])) * pow(1.0 - x[d], int(k-alpha[d]));
+	B.push_back(b);
+      }
+      dim_type d = 0;
+      for (; d < n && alpha[d] == k; ++d) alpha[d] = 0;
+      if (d == n) break;
+      ++(alpha[d]);
+    }
+  }
+
+  /* Upper bound of sum_i max(0, -phi_i(x)) for x in the reference element,
+     phi_i being the shape functions of a scalar Lagrange polynomial fem.
+     As sum_i phi_i = 1, a function interpolated on dof values v_i in
+     [vmin, vmax] is not lower than vmin - bound * (vmax - vmin) on the
+     element. The shape functions are expanded on the Bernstein basis,
+     phi_i = sum_j T(j,i) B_j, and max_j sum_i max(0, -T(j,i)) is a
+     guaranteed bound since the B_j are non-negative and sum to one.
+     Only the complete P_k fems on simplices and Q_k fems on
+     parallelepipeds are handled, the expansion being checked on a lattice.
+     Returns -1 for other fems, which are then tested geometrically. */
+  static scalar_type lagrange_undershoot_bound(pfem pf) {
+    const fem<base_poly> *ppf = dynamic_cast<const fem<base_poly> *>(pf.get());
+    if (!ppf || !pf->is_lagrange() || pf->target_dim() != 1)
+      return scalar_type(-1);
+    dim_type n = pf->dim();
+    bgeot::pconvex_structure cvs = pf->basic_structure(0);
+    bool simplex = (cvs == bgeot::simplex_structure(n));
+    if (n == 0 || (!simplex && cvs != bgeot::parallelepiped_structure(n)))
+      return scalar_type(-1);
+    size_type nb = pf->nb_base(0), dimk = 1;
+    short_type k = 0;
+    while (dimk < nb) { // dimension of P_k or Q_k
+      ++k;
+      if (simplex) dimk = (dimk * (k + n)) / k;
+      else { dimk = 1; for (dim_type d = 0; d < n; ++d) dimk *= k+1; }
+    }
+    if (dimk != nb || k == 0) return scalar_type(-1);
+
+    std::vector<scalar_type> B;
+    base_matrix A(nb, nb);
+    for (size_type l = 0; l < nb; ++l) {
+      bernstein_basis(simplex, n, k, pf->node_of_dof(0, l), B);
+      for (size_type j = 0; j < nb; ++j) A(l, j) = B[j];
+    }
+    if (gmm::lu_inverse(A, false) == scalar_type(0))
+      return scalar_type(-1);
+
+    short_type kc = short_type(std::max(k, pf->estimated_degree()) + 1);
+    const bgeot::basic_mesh *pm
+      = bgeot::refined_simplex_mesh_for_convex(pf->ref_convex(0), kc);
+    for (bgeot::node_tab::const_iterator it = pm->points().begin();
+	 it != pm->points().end(); ++it) {
+      bernstein_basis(simplex, n, k, *it, B);
+      for (size_type i = 0; i < nb; ++i) {
+	scalar_type s(0);
+	for (size_type j = 0; j < nb; ++j) s += A(j, i) * B[j];
+	if (gmm::abs(s - bgeot::to_scalar(ppf->base()[i].eval(it->begin())))
+	    > 1E-8)
+	  return scalar_type(-1);
+      }
+    }
+
+    scalar_type b(0);
+    for (size_type j = 0; j < nb; ++j) {
+      scalar_type s(0);
+      for (size_type i = 0; i < nb; ++i)
+	s += std::max(scalar_type(0), -A(j, i));
+      b = std::max(b, s);
+    }
+    return (b < 1E-10) ? scalar_type(0) : b;
+  }
+
+  void mesh_level_set::update_undershoot_bounds(void) {
+    undershoot_bounds.clear();
+    for (size_type k = 0; k < level_sets.size(); ++k) {
+      const mesh_fem &mf = level_sets[k]->get_mesh_fem();
+      mf.nb_basic_dof(); // enumerates the dofs before any parallel section
+      pfem pf_last = 0;
+      for (dal::bv_visitor cv(mf.convex_index()); !cv.finished(); ++cv) {
+	pfem pf = mf.fem_of_element(cv);
+	if (pf != pf_last && undershoot_bounds.find(pf)
+	    == undershoot_bounds.end())
+	  undershoot_bounds[pf] = lagrange_undershoot_bound(pf);
+	pf_last = pf;
+      }
+    }
+  }
+
+  void mesh_level_set::values_of_convex(size_type cv,
+					  std::vector<scalar_type> &v) const {
+    v.resize(0);
+    for (size_type j = 0; j < level_sets.size(); ++j) {
+      const mesh_fem &mf = level_sets[j]->get_mesh_fem();
+      const mesh_fem::ind_dof_ct &dofs = mf.ind_basic_dof_of_element(cv);
+      for (unsigned lsnum = 0;
+	   lsnum < (level_sets[j]->has_secondary() ? 2u : 1u); ++lsnum)
+	for (size_type k = 0; k < dofs.size(); ++k)
+	  v.push_back(level_sets[j]->values(lsnum)[dofs[k]]);
+      v.push_back(level_sets[j]->get_shift());
+    }
+  }
+
   void mesh_level_set::adapt(void) {
 
     // compute the elements touched by each level set
     // for each element touched, compute the sub mesh
     //   then compute the adapted integration method
     GMM_ASSERT1(linked_mesh_ != 0, "Uninitialized mesh_level_set");
-    cut_cv.clear();
-    allsubzones.clear();
-    zones_of_convexes.clear();
-    allzones.clear();
+    update_undershoot_bounds();
+
+    /* Everything is recomputed when the level sets or their mesh_fem
+       have changed. Otherwise, only the convexes on which the values of
+       the level sets have changed are adapted again, the zones are kept
+       since the retained convexes refer to them. */
+    bool all = (adapted_level_sets != level_sets);
+    for (size_type j = 0; j < level_sets.size() && !all; ++j)
+      all = (adapted_mf_versions[j]
+	     != level_sets[j]->get_mesh_fem().version_number());
+    if (all) {
+      cut_cv.clear();
+      allsubzones.clear();
+      zones_of_convexes.clear();
+      allzones.clear();
+      convex_states.clear();
+      crack_tip_convexes_.clear();
+      adapted_level_sets = level_sets;
+      adapted_mf_versions.resize(level_sets.size());
+      for (size_type j = 0; j < level_sets.size(); ++j)
+	adapted_mf_versions[j] = level_sets[j]->get_mesh_fem().version_number();
+    }
+    for (std::map<size_type, convex_info>::iterator it = cut_cv.begin();
+	 it != cut_cv.end(); )
+      if (linked_mesh().convex_index().is_in(it->first)) ++it;
+      else { crack_tip_convexes_.sup(it->first); cut_cv.erase(it++); }
+    convex_states.resize(linked_mesh().nb_allocated_convex());
 
     // noisy = true;
 
-    std::string z;
-    for (dal::bv_visitor cv(linked_mesh().convex_index()); 
-	 !cv.finished(); ++cv) {
-      scalar_type radius = linked_mesh().convex_radius_estimate(cv);
-      dal::bit_vector prim, sec;
-      find_crossing_level_set(cv, prim, sec, z, radius);
-      zones_of_convexes[cv] = &(*(allsubzones.insert(z).first));
-      if (noisy) cout << "element " << cv << " cut level sets : "
-		      << prim << " zone : " << z << endl;
-      if (prim.card()) {
-	cut_element(cv, prim, sec, radius);
-	find_zones_of_element(cv, z, radius);
+    /* First pass: the values of the level sets on each element are
+       compared to the ones of the last adapt, and the elements crossed by
+       the level sets are detected among the changed ones, most of them by
+       the bounds on the level-set values. The cut elements are then
+       meshed in parallel, each in its own sub-mesh. */
+    std::vector<size_type> all_cvs;
+    all_cvs.reserve(linked_mesh().convex_index().card());
+    for (dal::bv_visitor cv(linked_mesh().convex_index());
+	 !cv.finished(); ++cv)
+      all_cvs.push_back(cv);
+    std::vector<char> changed(all_cvs.size());
+    level_set_parallel_for(all_cvs.size(), [&](size_type i) {
+	convex_state &st = convex_states[all_cvs[i]];
+	std::vector<scalar_type> v;
+	values_of_convex(all_cvs[i], v);
+	gmm::uint64_type mv = linked_mesh().convex_version_number(all_cvs[i]);
+	changed[i] = (st.version == 0 || st.mesh_version != mv
+		      || st.values != v);
+	if (changed[i]) { st.values.swap(v); st.mesh_version = mv; }
+      });
+    std::vector<size_type> cvs;
+    for (size_type i = 0; i < all_cvs.size(); ++i)
+      if (changed[i]) {
+	cvs.push_back(all_cvs[i]);
+	convex_states[all_cvs[i]].version = act_counter();
       }
+
+    std::vector<std::string> z(cvs.size());
+    std::vector<dal::bit_vector> prim(cvs.size()), sec(cvs.size());
+    std::vector<scalar_type> radius(cvs.size());
+
+    level_set_parallel_for(cvs.size(), [&](size_type i) {
+	radius[i] = linked_mesh().convex_radius_estimate(cvs[i]);
+	find_crossing_level_set(cvs[i], prim[i], sec[i], z[i], radius[i]);
+      });
+
+    std::vector<size_type> cut;
+    for (size_type i = 0; i < cvs.size(); ++i) {
+      zones_of_convexes[cvs[i]] = intern_subzone(z[i]);
+      if (noisy) cout << "element " << cvs[i] << " cut level sets : "
+		      << prim[i] << " zone : " << z[i] << endl;
+      if (prim[i].card()) { cut_cv[cvs[i]] = convex_info(); cut.push_back(i); }
+      else cut_cv.erase(cvs[i]);
     }
+
+    level_set_parallel_for(cut.size(), [&](size_type j) {
+	size_type i = cut[j];
+	cut_element(cvs[i], prim[i], sec[i], radius[i]);
+	find_zones_of_element(cvs[i], z[i], radius[i]);
+      });
     if (noisy) {
+      cout << cvs.size() << " elements adapted, " << cut.size()
+	   << " of them cut" << endl;
       getfem::stored_mesh_slice sl;
       sl.build(global_mesh(), getfem::slicer_none(), 6);
       getfem::dx_export exp("totoglob.dx");
@@ -894,7 +1145,8 @@ struct Chrono {
       exp.write_mesh();
     }
 
-    update_crack_tip_convexes();
+    if (!all) prune_zones();
+    update_crack_tip_convexes(cvs);
     is_adapted_ = true;
   }
 
@@ -904,6 +1156,7 @@ struct Chrono {
   (std::vector<size_type> &icv, std::vector<dal::bit_vector> &ils) {
 
     GMM_ASSERT1(linked_mesh_ != 0, "Uninitialized mesh_level_set");
+    update_undershoot_bounds();
     std::string z;
     for (dal::bv_visitor cv(linked_mesh().convex_index()); 
 	 !cv.finished(); ++cv)
@@ -928,7 +1181,7 @@ struct Chrono {
 						    scalar_type radius) {
     scalar_type EPS = 1e-7 * radius;
     bgeot::pgeometric_trans pgt = linked_mesh().trans_of_convex(cv);
-    convex_info &cvi = cut_cv[cv];
+    convex_info &cvi = cut_cv.find(cv)->second;
     bgeot::pgeometric_trans pgt2 = cvi.pmsh->trans_of_convex(sub_cv);
 
     // cout << "cv " << cv << " radius = " << radius << endl;
@@ -964,10 +1217,12 @@ struct Chrono {
     const mesh_fem::ind_dof_ct &dofs = mf.ind_basic_dof_of_element(cv);
     pfem pf = mf.fem_of_element(cv);
     int p = -2;
-    scalar_type EPS = 1e-8 * radius;
+    scalar_type EPS = 1e-8 * radius, vmin(0), vmax(0);
 
     /* easy cases: 
      - different sign on the dof nodes => intersection for sure
+     - for a Lagrange level set, the bounds of its values on the element
+     have the same sign => no intersection
      - min value of the levelset greater than the radius of the convex
      => no intersection
     */ 
@@ -975,25 +1230,33 @@ struct Chrono {
 	 it != dofs.end(); ++it) {
       scalar_type v = ls->values(lsnum)[*it];
       int p2 = ( (v < -EPS) ? -1 : ((v > EPS) ? +1 : 0));
-      if (p == -2) p=p2;
+      if (p == -2) { p=p2; vmin = vmax = gmm::abs(v); }
       if (!p2 || p*p2 < 0) return 0;
+      vmin = std::min(vmin, gmm::abs(v)); vmax = std::max(vmax, gmm::abs(v));
     }
 
+    std::map<pfem, scalar_type>::const_iterator
+      itb = undershoot_bounds.find(pf);
+    if (itb != undershoot_bounds.end() && itb->second >= scalar_type(0)
+	&& ls->get_shift() == scalar_type(0)
+	&& vmin > itb->second * (vmax - vmin)) return p;
+
     pmesher_signed_distance mls1 = ls->mls_of_convex(cv, lsnum, false);
     base_node X(pf->dim()), G(pf->dim());
-    gmm::fill_random(X); X *= 1E-2;
+    std::minstd_rand gen(std::minstd_rand::result_type(cv + 1));
+    random_point(X, gen); X *= 1E-2;
     scalar_type d = mls1->grad(X, G);
     if (gmm::vect_norm2(G)*2.5 < gmm::abs(d)) return p;
 
     bgeot::pgeometric_trans pgt = linked_mesh().trans_of_convex(cv);
     pmesher_signed_distance ref_element = new_ref_element(pgt);
     
-    gmm::fill_random(X); X *= 1E-2;
+    random_point(X, gen); X *= 1E-2;
     mesher_intersection mi1(ref_element, mls1);
     if (!try_projection(mi1, X)) return p;
     if ((*ref_element)(X) > 1E-8) return p;
     
-    gmm::fill_random(X); X *= 1E-2;
+    random_point(X, gen); X *= 1E-2;
     pmesher_signed_distance mls2 = ls->mls_of_convex(cv, lsnum, true);
     mesher_intersection mi2(ref_element, mls2);
     if (!try_projection(mi2, X)) return p;
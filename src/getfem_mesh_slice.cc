@@ -183,6 +183,7 @@ namespace getfem {
     /* push the used nodes and simplexes in the final list */
     if (splx_in.card() == 0) return;
     merged_nodes_available = false;
+    interpolation_matrices.clear();
     std::vector<size_type> nused(cv_nodes.size(), size_type(-1));
     convex_slice *sc = 0;
     GMM_ASSERT1(cv < cv2pos.size(), "internal error");
@@ -276,13 +277,73 @@ namespace getfem {
                                 const slicer_action *c, 
                                 size_type nrefine) {
     clear();
-    mesh_slicer slicer(m);
-    slicer.push_back_action(*const_cast<slicer_action*>(a));
-    if (b) slicer.push_back_action(*const_cast<slicer_action*>(b));
-    if (c) slicer.push_back_action(*const_cast<slicer_action*>(c));
-    slicer_build_stored_mesh_slice sbuild(*this);
-    slicer.push_back_action(sbuild);
-    slicer.exec(nrefine);
+    slicer_action *actions[3] = { const_cast<slicer_action*>(a),
+                                  const_cast<slicer_action*>(b),
+                                  const_cast<slicer_action*>(c) };
+    bool parallel = (num_threads() > 1 && !me_is_multithreaded_now());
+    for (size_type i = 0; i < 3 && parallel; ++i)
+      if (actions[i]) parallel = actions[i]->prepare_parallel_exec();
+
+    if (!parallel) {
+      mesh_slicer slicer(m);
+      for (size_type i = 0; i < 3; ++i)
+        if (actions[i]) slicer.push_back_action(*actions[i]);
+      slicer_build_stored_mesh_slice sbuild(*this);
+      slicer.push_back_action(sbuild);
+      slicer.exec(nrefine);
+      return;
+    }
+
+    /* The convexes are sliced in parallel: each thread slices the
+       contiguous part of the region given by its partition into its own
+       stored_mesh_slice. The parts are then concatenated in the thread
+       order, which gives the same slice as the serial build. */
+    bgeot::pconvex_ref cvr = 0;
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+      if (m.trans_of_convex(cv)->convex_ref() != cvr) {
+        cvr = m.trans_of_convex(cv)->convex_ref();
+        bgeot::refined_simplex_mesh_for_convex(cvr, short_type(nrefine));
+      }
+    mesh_region region(m.convex_index());
+    std::vector<stored_mesh_slice> parts(num_threads());
+    gmm::standard_locale locale;
+    open_mp_is_running_properly check;
+    thread_exception exception;
+    #pragma omp parallel default(shared)
+    {
+      exception.run([&]
+      {
+        mesh_slicer slicer(m);
+        for (size_type i = 0; i < 3; ++i)
+          if (actions[i]) slicer.push_back_action(*actions[i]);
+        slicer_build_stored_mesh_slice sbuild(parts[this_thread()]);
+        slicer.push_back_action(sbuild);
+        slicer.exec(nrefine, region);
+      });
+    }
+    exception.rethrow();
+
+    for (size_type th = 0; th < parts.size(); ++th) {
+      stored_mesh_slice &part = parts[th];
+      if (!part.poriginal_mesh) continue;
+      if (!poriginal_mesh) {
+        poriginal_mesh = &m;
+        dim_ = m.dim();
+        cv2pos.resize(m.nb_allocated_convex());
+        gmm::fill(cv2pos, size_type(-1));
+      }
+      dim_ = std::max(dim_, part.dim_);
+      if (simplex_cnt.size() < part.simplex_cnt.size())
+        simplex_cnt.resize(part.simplex_cnt.size(), 0);
+      for (size_type i = 0; i < part.simplex_cnt.size(); ++i)
+        simplex_cnt[i] += part.simplex_cnt[i];
+      for (convex_slice &cs : part.cvlst) {
+        cs.global_points_count += points_cnt;
+        cv2pos[cs.cv_num] = cvlst.size();
+        cvlst.push_back(std::move(cs));
+      }
+      points_cnt += part.points_cnt;
+    }
   }
 
   void stored_mesh_slice::replay(slicer_action *a, slicer_action *b,
@@ -307,6 +368,7 @@ namespace getfem {
   void stored_mesh_slice::merge(const stored_mesh_slice& sl) {
     GMM_ASSERT1(dim()==sl.dim(), "inconsistent dimensions for slice merging");
     clear_merged_nodes();
+    interpolation_matrices.clear();
     cv2pos.resize(std::max(cv2pos.size(), sl.cv2pos.size()), size_type(-1));
     for (size_type i=0; i < sl.nb_convex(); ++i) 
       GMM_ASSERT1(cv2pos[sl.convex_num(i)] == size_type(-1) ||
@@ -346,6 +408,62 @@ namespace getfem {
     merged_nodes_available = false; 
   }
 
+  const stored_mesh_slice::interpolation_matrix_type &
+  stored_mesh_slice::interpolation_matrix(const mesh_fem &mf) const {
+    GMM_ASSERT1(!poriginal_mesh || &mf.linked_mesh() == poriginal_mesh,
+                "the mesh_fem and the slice should share the same mesh");
+    getfem::local_guard guard = interpolation_matrices.locks.get_lock();
+    interpolation_matrix_cache *pc = 0;
+    for (auto it = interpolation_matrices.begin();
+         it != interpolation_matrices.end(); ) {
+      if (!it->is_context_valid()) // the mesh_fem has been destroyed
+        it = interpolation_matrices.erase(it);
+      else { if (it->pmf == &mf) pc = &(*it); ++it; }
+    }
+    if (!pc) {
+      interpolation_matrices.emplace_back();
+      pc = &(interpolation_matrices.back());
+      pc->pmf = &mf;
+      pc->add_dependency(mf);
+    }
+    pc->context_check();
+    if (pc->up_to_date) return pc->M;
+
+    size_type qdim = mf.get_qdim();
+    interpolation_matrix_type &M = pc->M;
+    gmm::clear(M);
+    gmm::resize(M, nb_points()*qdim, mf.nb_basic_dof());
+    std::vector<base_node> refpts;
+    base_matrix G, Mcv;
+    for (size_type ic = 0; ic < nb_convex(); ++ic) {
+      size_type cv = convex_num(ic);
+      if (!mf.convex_index().is_in(cv)) continue;
+      refpts.resize(nodes(ic).size());
+      for (size_type j = 0; j < refpts.size(); ++j)
+        refpts[j] = nodes(ic)[j].pt_ref;
+      pfem pf = mf.fem_of_element(cv);
+      if (pf->need_G())
+        bgeot::vectors_to_base_matrix(G,
+                                      mf.linked_mesh().points_of_convex(cv));
+      fem_precomp_pool fppool;
+      pfem_precomp pfp = fppool(pf, store_point_tab(refpts));
+      const mesh_fem::ind_dof_ct &dof = mf.ind_basic_dof_of_element(cv);
+      gmm::resize(Mcv, qdim, dof.size());
+      fem_interpolation_context ctx(mf.linked_mesh().trans_of_convex(cv),
+                                    pfp, 0, G, cv, short_type(-1));
+      size_type row = global_index(ic, 0) * qdim;
+      for (size_type j = 0; j < refpts.size(); ++j, row += qdim) {
+        ctx.set_ii(j);
+        pf->interpolation(ctx, Mcv, dim_type(qdim));
+        for (size_type k = 0; k < qdim; ++k)
+          for (size_type l = 0; l < dof.size(); ++l)
+            if (Mcv(k, l) != scalar_type(0)) M(row+k, dof[l]) = Mcv(k, l);
+      }
+    }
+    pc->up_to_date = true;
+    return M;
+  }
+
   void stored_mesh_slice::merge_nodes() const {
     size_type count = 0;
     mesh mp;
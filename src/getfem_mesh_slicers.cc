@@ -112,6 +112,9 @@ namespace getfem {
 
   /* apply deformation from a mesh_fem to the nodes */
   void slicer_apply_deformation::exec(mesh_slicer& ms) {
+    deformation_cache &c = cache;
+    pfem &pf = c.pf;
+    std::vector<base_node> &ref_pts = c.ref_pts;
     base_vector coeff;
     base_matrix G;
     bool ref_pts_changed = false;
@@ -134,10 +137,10 @@ namespace getfem {
     if (ref_pts2.size() != ref_pts.size()) ref_pts_changed = true;
     if (ref_pts_changed) {
       ref_pts.swap(ref_pts2);
-      fprecomp.clear();
+      c.fprecomp.clear();
     }
     bgeot::pstored_point_tab pspt = store_point_tab(ref_pts);
-    pfem_precomp pfp = fprecomp(pf, pspt);
+    pfem_precomp pfp = c.fprecomp(pf, pspt);
     defdata->copy(ms.cv, coeff);
     
     base_vector val(ms.m.dim());
@@ -183,10 +186,10 @@ namespace getfem {
   */
   void slicer_volume::split_simplex(mesh_slicer& ms,
                                     slice_simplex s, size_type sstart, 
-                                    std::bitset<32> spin, std::bitset<32> spbin) {
+                                    std::bitset<32> spin, std::bitset<32> spbin,
+                                    int level) {
     scalar_type alpha = 0; size_type iA=0, iB = 0;
     bool intersection = false;
-    static int level = 0;
 
     level++;    
     /*
@@ -214,16 +217,16 @@ namespace getfem {
       n.faces = A.faces & B.faces;
       size_type nn = ms.nodes.size();
       ms.nodes.push_back(n); /* invalidate A and B.. */
-      pt_bin.add(nn); pt_in.add(nn);
+      pt_bin.thrd_cast().add(nn); pt_in.thrd_cast().add(nn);
       
       std::bitset<32> spin2(spin), spbin2(spbin); 
       std::swap(s.inodes[iA],nn);
       spin2.set(iA); spbin2.set(iA);
-      split_simplex(ms, s, sstart, spin2, spbin2);
+      split_simplex(ms, s, sstart, spin2, spbin2, level);
 
       std::swap(s.inodes[iA],nn); std::swap(s.inodes[iB],nn);
       spin2 = spin; spbin2 = spbin; spin2.set(iB); spbin2.set(iB);
-      split_simplex(ms, s, sstart, spin2, spbin2);
+      split_simplex(ms, s, sstart, spin2, spbin2, level);
 
     } else {
       /* end of recursion .. */
@@ -252,7 +255,6 @@ namespace getfem {
         }
       }
     }
-    level--;
   }
 
     /* nodes : list of nodes (new nodes may be added)
@@ -265,6 +267,7 @@ namespace getfem {
     //cerr << "\n----\nslicer_volume::slice : entree, splx_in=" << splx_in << endl;
     if (ms.splx_in.card() == 0) return;
     prepare(ms.cv,ms.nodes,ms.nodes_index);
+    const dal::bit_vector &pt_in_ = pt_in, &pt_bin_ = pt_bin;
     for (dal::bv_visitor_c cnt(ms.splx_in); !cnt.finished(); ++cnt) {
       slice_simplex& s = ms.simplexes[cnt];
       /*cerr << "\n--------slicer_volume::slice : slicing convex " << cnt << endl;
@@ -275,8 +278,8 @@ namespace getfem {
       size_type in_cnt = 0, in_bcnt = 0;
       std::bitset<32> spin, spbin;
       for (size_type i=0; i < s.dim()+1; ++i) {
-        if (pt_in.is_in(s.inodes[i])) { ++in_cnt; spin.set(i); }
-        if (pt_bin.is_in(s.inodes[i])) { ++in_bcnt; spbin.set(i); }
+        if (pt_in_.is_in(s.inodes[i])) { ++in_cnt; spin.set(i); }
+        if (pt_bin_.is_in(s.inodes[i])) { ++in_bcnt; spbin.set(i); }
       }
 
       if (in_cnt == 0) {
@@ -288,11 +291,11 @@ namespace getfem {
     }
 
     /* signalement des points qui se trouvent pile-poil sur la bordure */
-    if (pt_bin.card()) {
+    if (pt_bin_.card()) {
       GMM_ASSERT1(ms.fcnt != dim_type(-1), 
                   "too much {faces}/{slices faces} in the convex " << ms.cv 
                   << " (nbfaces=" << ms.fcnt << ")");
-      for (dal::bv_visitor cnt(pt_bin); !cnt.finished(); ++cnt) {
+      for (dal::bv_visitor cnt(pt_bin_); !cnt.finished(); ++cnt) {
         ms.nodes[cnt].faces.set(ms.fcnt);
       }
       ms.fcnt++;
@@ -373,9 +376,11 @@ namespace getfem {
   void slicer_isovalues::prepare(size_type cv,
                                  const mesh_slicer::cs_nodes_ct& nodes, 
                                  const dal::bit_vector& nodes_index) {
-    pt_in.clear(); pt_bin.clear();
+    dal::bit_vector &pt_in_ = pt_in, &pt_bin_ = pt_bin;
+    std::vector<scalar_type> &Uval_ = Uval;
+    pt_in_.clear(); pt_bin_.clear();
     std::vector<base_node> refpts(nodes.size());
-    Uval.resize(nodes.size());
+    Uval_.resize(nodes.size());
     base_vector coeff;
     base_matrix G;
     pfem pf = mfU->pmf->fem_of_element(cv);
@@ -395,11 +400,11 @@ namespace getfem {
       v[0] = 0;
       ctx.set_ii(i);
       pf->interpolation(ctx, coeff, v, mfU->pmf->get_qdim());
-      Uval[i] = v[0];
+      Uval_[i] = v[0];
       // optimisable -- les bit_vectors sont lents..
-      pt_bin[i] = (gmm::abs(Uval[i] - val) < EPS * val_scaling);
-      pt_in[i] = (Uval[i] - val < 0); if (orient>0) pt_in[i] = !pt_in[i]; 
-      pt_in[i] = pt_in[i] || pt_bin[i];
+      pt_bin_[i] = (gmm::abs(Uval_[i] - val) < EPS * val_scaling);
+      pt_in_[i] = (Uval_[i] - val < 0); if (orient>0) pt_in_[i] = !pt_in_[i]; 
+      pt_in_[i] = pt_in_[i] || pt_bin_[i];
       // cerr << "cv=" << cv << ", node["<< i << "]=" << nodes[i].pt
       //      << ", Uval[i]=" << Uval[i] << ", pt_in[i]=" << pt_in[i]
       //      << ", pt_bin[i]=" << pt_bin[i] << endl;
@@ -481,7 +486,7 @@ namespace getfem {
           M(i,j) = ms.nodes[s.inodes[i+1]].pt[j] - ms.nodes[s.inodes[0]].pt[j];
       scalar_type v = bgeot::lu_det(&(*(M.begin())), s.dim());
       for (size_type d=2; d <= s.dim(); ++d) v /= scalar_type(d);
-      a += v;
+      a.thrd_cast() += v;
     }
   }
 
@@ -23,16 +23,38 @@
 
 namespace getfem {
 
+  void eval_signed_distance(const mesher_signed_distance &dist,
+                            const std::vector<base_node> &P, base_vector &d) {
+    gmm::resize(d, P.size());
+    size_type nb = P.size(), nbt = (nb < 2*num_threads()) ? 1 : num_threads();
+    open_mp_range_for(nbt, [&](size_type t) {
+        size_type i0 = (nb * t) / nbt, i1 = (nb * (t+1)) / nbt;
+        std::vector<base_node> Pt(P.begin() + i0, P.begin() + i1);
+        base_vector dt;
+        dist.eval(Pt, dt);
+        gmm::copy(dt, gmm::sub_vector(d, gmm::sub_interval(i0, i1 - i0)));
+      });
+  }
+
+  /* The gradient and the hessian are computed once, the first thread
+     needing them does the job. The other threads see them complete once
+     they see the new value of initialized (release/acquire). */
   void mesher_level_set::init_grad(void) const {
+    omp_guard scoped_lock;
+    GMM_NOPERATION(scoped_lock);
+    if (initialized.load(std::memory_order_relaxed) >= 1) return;
     gradient.resize(base.dim());
     for (dim_type d=0; d < base.dim(); ++d) {
       gradient[d] = base; gradient[d].derivative(d);
     }
-    initialized = 1; 
+    initialized.store(1, std::memory_order_release);
   }
 
   void mesher_level_set::init_hess(void) const {
-    if (initialized < 1) init_grad();
+    omp_guard scoped_lock;
+    GMM_NOPERATION(scoped_lock);
+    if (initialized.load(std::memory_order_relaxed) >= 2) return;
+    if (initialized.load(std::memory_order_relaxed) < 1) init_grad();
     hessian.resize(base.dim()*base.dim());
     for (dim_type d=0; d < base.dim(); ++d) {
       for (dim_type e=0; e < base.dim(); ++e) {
@@ -40,12 +62,12 @@ namespace getfem {
         hessian[d*base.dim()+e].derivative(e);
       }
     }
-    initialized = 2;
+    initialized.store(2, std::memory_order_release);
   }
 
   scalar_type mesher_level_set::grad(const base_node &P,
                                      base_small_vector &G) const {
-    if (initialized < 1) init_grad();
+    if (initialized.load(std::memory_order_acquire) < 1) init_grad();
     gmm::resize(G, P.size());
     for (size_type i = 0; i < P.size(); ++i)
       G[i] = bgeot::to_scalar(gradient[i].eval(P.begin()));
@@ -53,7 +75,7 @@ namespace getfem {
   }
 
   void mesher_level_set::hess(const base_node &P, base_matrix &H) const {
-    if (initialized < 2) init_hess();
+    if (initialized.load(std::memory_order_acquire) < 2) init_hess();
     gmm::resize(H, P.size(), P.size()); 
     for (size_type i = 0; i < base.dim(); ++i)
       for (size_type j = 0; j < base.dim(); ++j) {
@@ -61,6 +83,243 @@ namespace getfem {
       }
   }
 
+  mesher_grid_distance::mesher_grid_distance
+  (const base_node &x0_, const base_small_vector &h_,
+   const std::vector<size_type> &nb_, const base_vector &values_)
+    : x0(x0_), h(h_), nb(nb_), values(values_) {
+    size_type N = x0.size(), nbv = 1;
+    GMM_ASSERT1(N >= 1 && N <= 3, "Grid distances are defined in dimension "
+                "1, 2 or 3 only");
+    GMM_ASSERT1(h.size() == N && nb.size() == N, "Dimensions mismatch");
+    for (size_type k = 0; k < N; ++k) {
+      GMM_ASSERT1(nb[k] >= 2 && h[k] > scalar_type(0), "Invalid grid");
+      nbv *= nb[k];
+    }
+    GMM_ASSERT1(values.size() == nbv, "Wrong number of values");
+  }
+
+  scalar_type mesher_grid_distance::interpolate(const base_node &P,
+                                                base_small_vector *G) const {
+    size_type N = x0.size(), i0[3], stride[3];
+    scalar_type t[3], out[3], out2(0), d(0);
+    bool clamped[3];
+
+    // Projection of P on the grid and local coordinates in the cell.
+    for (size_type k = 0; k < N; ++k) {
+      scalar_type xi = (P[k] - x0[k]) / h[k], xmax = scalar_type(nb[k]-1);
+      scalar_type c = std::max(scalar_type(0), std::min(xi, xmax));
+      clamped[k] = (c != xi);
+      out[k] = (xi - c) * h[k]; out2 += out[k] * out[k];
+      i0[k] = std::min(size_type(c), nb[k]-2);
+      t[k] = c - scalar_type(i0[k]);
+      stride[k] = (k == 0) ? 1 : stride[k-1] * nb[k-1];
+    }
+    if (G) { gmm::resize(*G, N); gmm::clear(*G); }
+
+    // Multilinear interpolation on the 2^N vertices of the cell.
+    for (size_type ic = 0; ic < (size_type(1) << N); ++ic) {
+      size_type ind = 0;
+      scalar_type w[3], wt(1);
+      for (size_type k = 0; k < N; ++k) {
+        bool up = (ic >> k) & 1;
+        ind += (i0[k] + (up ? 1 : 0)) * stride[k];
+        w[k] = up ? t[k] : scalar_type(1) - t[k];
+        wt *= w[k];
+      }
+      scalar_type v = values[ind];
+      d += wt * v;
+      if (G)
+        for (size_type k = 0; k < N; ++k) {
+          if (clamped[k]) continue;
+          scalar_type dw = ((ic >> k) & 1) ? scalar_type(1) : scalar_type(-1);
+          for (size_type l = 0; l < N; ++l) if (l != k) dw *= w[l];
+          (*G)[k] += dw * v / h[k];
+        }
+    }
+
+    if (out2 > scalar_type(0)) {
+      scalar_type e = gmm::sqrt(out2);
+      d += e;
+      if (G) for (size_type k = 0; k < N; ++k) (*G)[k] += out[k] / e;
+    }
+    return d;
+  }
+
+  mesher_triangulated_surface::mesher_triangulated_surface
+  (const std::vector<base_node> &pts_, const std::vector<size_type> &faces_)
+    : N(pts_.size() ? pts_[0].size() : 0), pts(pts_), faces(faces_),
+      hmean(0) {
+    GMM_ASSERT1(N == 2 || N == 3, "Triangulated surfaces are defined in "
+                "dimension 2 or 3 only");
+    GMM_ASSERT1(faces.size() && (faces.size() % N) == 0,
+                "Wrong size for the array of faces");
+    size_type nbf = faces.size() / N;
+    fnormals.resize(nbf);
+    vnormals.assign(pts.size(), base_small_vector(N));
+    base_node fmin(N), fmax(N);
+    bmin = bmax = pts[faces[0]];
+
+    for (size_type f = 0; f < nbf; ++f) {
+      const size_type *ind = &(faces[f*N]);
+      for (size_type i = 0; i < N; ++i)
+        GMM_ASSERT1(ind[i] < pts.size(), "Wrong vertex index in face " << f);
+      const base_node &a = pts[ind[0]], &b = pts[ind[1]];
+      base_small_vector n(N);
+      if (N == 2) {
+        n[0] = b[1] - a[1]; n[1] = a[0] - b[0];
+      } else {
+        const base_node &c = pts[ind[2]];
+        base_small_vector ab = b - a, ac = c - a;
+        n[0] = ab[1]*ac[2] - ab[2]*ac[1];
+        n[1] = ab[2]*ac[0] - ab[0]*ac[2];
+        n[2] = ab[0]*ac[1] - ab[1]*ac[0];
+      }
+      scalar_type nn = gmm::vect_norm2(n);
+      GMM_ASSERT1(nn > scalar_type(0), "Degenerated face " << f);
+      n /= nn;
+      fnormals[f] = n;
+
+      // Pseudo-normals, weighted by the angles in 3D
+      for (size_type i = 0; i < N; ++i) {
+        if (N == 2)
+          vnormals[ind[i]] += n;
+        else {
+          base_small_vector e1 = pts[ind[(i+1)%3]] - pts[ind[i]];
+          base_small_vector e2 = pts[ind[(i+2)%3]] - pts[ind[i]];
+          scalar_type cosa = gmm::vect_sp(e1, e2)
+            / (gmm::vect_norm2(e1) * gmm::vect_norm2(e2));
+          cosa = std::max(scalar_type(-1), std::min(scalar_type(1), cosa));
+          gmm::add(gmm::scaled(n, acos(cosa)), vnormals[ind[i]]);
+          std::pair<size_type, size_type>
+            e(std::min(ind[i], ind[(i+1)%3]), std::max(ind[i], ind[(i+1)%3]));
+          base_small_vector &en = enormals[e];
+          if (en.size() == 0) en = n; else en += n;
+        }
+      }
+
+      // Bounding box of the face
+      fmin = fmax = a;
+      for (size_type i = 1; i < N; ++i)
+        for (size_type k = 0; k < N; ++k) {
+          fmin[k] = std::min(fmin[k], pts[ind[i]][k]);
+          fmax[k] = std::max(fmax[k], pts[ind[i]][k]);
+        }
+      scalar_type hf(0);
+      for (size_type k = 0; k < N; ++k) {
+        bmin[k] = std::min(bmin[k], fmin[k]);
+        bmax[k] = std::max(bmax[k], fmax[k]);
+        hf = std::max(hf, fmax[k] - fmin[k]);
+      }
+      hmean += hf;
+      // The boxes are slightly enlarged, the rtree does not support flat
+      // boxes well (faces parallel to a coordinate plane).
+      for (size_type k = 0; k < N; ++k)
+        { fmin[k] -= hf * 1E-6; fmax[k] += hf * 1E-6; }
+      face_tree.add_box(fmin, fmax, f);
+    }
+    hmean /= scalar_type(nbf);
+    face_tree.build_tree(); // not to be built by concurrent searches.
+  }
+
+  // Nearest point Q of P on the triangle (a, b, c). Returns 0 if Q is
+  // inside the triangle, 1, 2, 3 if Q is the vertex a, b or c and 4, 5, 6
+  // if Q is on the edge ab, bc or ca.
+  static int closest_point_on_triangle(const base_node &P, const base_node &a,
+                                       const base_node &b, const base_node &c,
+                                       base_node &Q) {
+    base_small_vector ab = b - a, ac = c - a, ap = P - a;
+    scalar_type d1 = gmm::vect_sp(ab, ap), d2 = gmm::vect_sp(ac, ap);
+    if (d1 <= scalar_type(0) && d2 <= scalar_type(0)) { Q = a; return 1; }
+
+    base_small_vector bp = P - b;
+    scalar_type d3 = gmm::vect_sp(ab, bp), d4 = gmm::vect_sp(ac, bp);
+    if (d3 >= scalar_type(0) && d4 <= d3) { Q = b; return 2; }
+
+    scalar_type vc = d1*d4 - d3*d2;
+    if (vc <= scalar_type(0) && d1 >= scalar_type(0) && d3 <= scalar_type(0))
+      { gmm::add(a, gmm::scaled(ab, d1 / (d1 - d3)), Q); return 4; }
+
+    base_small_vector cp = P - c;
+    scalar_type d5 = gmm::vect_sp(ab, cp), d6 = gmm::vect_sp(ac, cp);
+    if (d6 >= scalar_type(0) && d5 <= d6) { Q = c; return 3; }
+
+    scalar_type vb = d5*d2 - d1*d6;
+    if (vb <= scalar_type(0) && d2 >= scalar_type(0) && d6 <= scalar_type(0))
+      { gmm::add(a, gmm::scaled(ac, d2 / (d2 - d6)), Q); return 6; }
+
+    scalar_type va = d3*d6 - d5*d4;
+    if (va <= scalar_type(0) && (d4 - d3) >= scalar_type(0)
+        && (d5 - d6) >= scalar_type(0)) {
+      gmm::add(b, gmm::scaled(c - b, (d4 - d3) / ((d4 - d3) + (d5 - d6))), Q);
+      return 5;
+    }
+
+    scalar_type denom = scalar_type(1) / (va + vb + vc);
+    gmm::add(a, gmm::scaled(ab, vb * denom), Q);
+    gmm::add(gmm::scaled(ac, vc * denom), Q);
+    return 0;
+  }
+
+  scalar_type mesher_triangulated_surface::distance
+  (const base_node &P, base_small_vector *G) const {
+    base_node pmin(N), pmax(N), Q(N), Qbest(N);
+    const base_small_vector *pn = 0;
+    bgeot::rtree::pbox_cont boxes;
+    scalar_type dbest(-1);
+
+    // The search box is enlarged until it contains the nearest face.
+    scalar_type r(0);
+    for (size_type k = 0; k < N; ++k) {
+      scalar_type e = std::max(bmin[k] - P[k], P[k] - bmax[k]);
+      if (e > scalar_type(0)) r += e * e;
+    }
+    r = gmm::sqrt(r) + hmean;
+    for (;;) {
+      for (size_type k = 0; k < N; ++k)
+        { pmin[k] = P[k] - r; pmax[k] = P[k] + r; }
+      face_tree.find_intersecting_boxes(pmin, pmax, boxes);
+      for (size_type i = 0; i < boxes.size(); ++i) {
+        size_type f = boxes[i]->id;
+        const size_type *ind = &(faces[f*N]);
+        int reg;
+        if (N == 2) {
+          const base_node &a = pts[ind[0]], &b = pts[ind[1]];
+          base_small_vector ab = b - a;
+          scalar_type t = gmm::vect_sp(P - a, ab) / gmm::vect_norm2_sqr(ab);
+          if (t <= scalar_type(0)) { Q = a; reg = 1; }
+          else if (t >= scalar_type(1)) { Q = b; reg = 2; }
+          else { gmm::add(a, gmm::scaled(ab, t), Q); reg = 0; }
+        } else
+          reg = closest_point_on_triangle(P, pts[ind[0]], pts[ind[1]],
+                                          pts[ind[2]], Q);
+        scalar_type d = gmm::vect_dist2(P, Q);
+        if (dbest < scalar_type(0) || d < dbest) {
+          dbest = d; Qbest = Q;
+          switch (reg) {
+          case 0: pn = &(fnormals[f]); break;
+          case 1: case 2: case 3: pn = &(vnormals[ind[reg-1]]); break;
+          default: {
+            size_type i1 = ind[reg-4], i2 = ind[(reg-3)%3];
+            pn = &(enormals.at(std::make_pair(std::min(i1, i2),
+                                              std::max(i1, i2))));
+          }
+          }
+        }
+      }
+      if (dbest >= scalar_type(0) && dbest <= r) break;
+      r *= scalar_type(2);
+    }
+
+    base_small_vector v = P - Qbest;
+    scalar_type s = (gmm::vect_sp(v, *pn) < scalar_type(0))
+      ? scalar_type(-1) : scalar_type(1);
+    if (G) {
+      if (dbest > hmean * 1E-12) *G = v * (s / dbest);
+      else { *G = *pn; *G /= gmm::vect_norm2(*G); }
+    }
+    return s * dbest;
+  }
+
 
   //
   // Exported functions
@@ -300,6 +559,78 @@ namespace getfem {
     }
   };
 
+  // Orientation of the triangle (a, b, c), positive if counterclockwise.
+  static scalar_type orientation(const std::vector<base_node> &pts,
+                                 size_type a, size_type b, size_type c) {
+    return (pts[b][0]-pts[a][0])*(pts[c][1]-pts[a][1])
+      - (pts[b][1]-pts[a][1])*(pts[c][0]-pts[a][0]);
+  }
+
+  // Positive if d is inside the circumcircle of the counterclockwise
+  // triangle (a, b, c).
+  static scalar_type in_circle(const std::vector<base_node> &pts,
+                               size_type a, size_type b, size_type c,
+                               size_type d) {
+    scalar_type ax = pts[a][0]-pts[d][0], ay = pts[a][1]-pts[d][1];
+    scalar_type bx = pts[b][0]-pts[d][0], by = pts[b][1]-pts[d][1];
+    scalar_type cx = pts[c][0]-pts[d][0], cy = pts[c][1]-pts[d][1];
+    return (ax*ax+ay*ay)*(bx*cy-cx*by) - (bx*bx+by*by)*(ax*cy-cx*ay)
+      + (cx*cx+cy*cy)*(ax*by-bx*ay);
+  }
+
+  bool delaunay_by_flips(const std::vector<base_node> &pts,
+                         gmm::dense_matrix<size_type> &t,
+                         std::vector<int> &orient, scalar_type h,
+                         size_type *nbflips) {
+    size_type nbt = gmm::mat_ncols(t);
+    if (nbflips) *nbflips = 0;
+    if (gmm::mat_nrows(t) != 3 || orient.size() != nbt) return false;
+    scalar_type eps = h*h*h*h*1E-12;
+    for (size_type i=0; i < nbt; ++i) {
+      scalar_type o = orientation(pts, t(0,i), t(1,i), t(2,i));
+      if (gmm::abs(o) < 1E-12*h*h || (o < 0) != (orient[i] < 0))
+        return false;
+      if (o < 0) { std::swap(t(1,i), t(2,i)); orient[i] = 1; }
+    }
+
+    typedef std::pair<size_type, size_type> edge;
+    for (size_type sweep = 0; ; ++sweep) {
+      if (sweep == 100) return false;
+      std::map<edge, std::vector<size_type> > edge_elts;
+      for (size_type i=0; i < nbt; ++i)
+        for (size_type k=0; k < 3; ++k) {
+          size_type a = t(k,i), b = t((k+1)%3,i);
+          edge_elts[edge(std::min(a,b), std::max(a,b))].push_back(i);
+        }
+      std::vector<char> flipped(nbt, 0);
+      size_type nb = 0;
+      for (const auto &e : edge_elts) {
+        if (e.second.size() > 2) return false;
+        if (e.second.size() != 2) continue;
+        size_type i1 = e.second[0], i2 = e.second[1];
+        if (flipped[i1] || flipped[i2]) continue;
+        size_type a = e.first.first, b = e.first.second, c(0), d(0);
+        for (size_type k=0; k < 3; ++k) {
+          if (t(k,i1) != a && t(k,i1) != b) c = t(k,i1);
+          if (t(k,i2) != a && t(k,i2) != b) d = t(k,i2);
+        }
+        if (orientation(pts, a, b, c) < 0) std::swap(a, b);
+        // the two elements have to lie on each side of their common edge
+        if (orientation(pts, a, b, d) >= 0) return false;
+        if (in_circle(pts, a, b, c, d) > eps
+            && orientation(pts, a, d, c) > 0
+            && orientation(pts, d, b, c) > 0) {
+          t(0,i1) = a; t(1,i1) = d; t(2,i1) = c;
+          t(0,i2) = d; t(1,i2) = b; t(2,i2) = c;
+          flipped[i1] = flipped[i2] = 1; ++nb;
+        }
+      }
+      if (nbflips) *nbflips += nb;
+      if (nb == 0) break;
+    }
+    return true;
+  }
+
   struct mesher {
     pmesher_signed_distance dist;
     const mesher_virtual_function& edge_len;
@@ -323,6 +654,15 @@ namespace getfem {
 
     std::vector<size_type> attracted_points;
     std::vector<base_node> attractor_points;
+    std::vector<size_type> renumbering; // of the points by cleanup_points
+
+    /* Complete triangulation of the last call to running_delaunay, before
+       the selection of the elements, with the orientation of its elements
+       and the points added on the hull (numbered from nb_pts_all). */
+    gmm::dense_matrix<size_type> t_all;
+    std::vector<int> t_all_orient;
+    std::vector<base_node> pts_hull;
+    size_type nb_pts_all;
 
     mesher(size_type K_,
            const pmesher_signed_distance &dist_, 
@@ -335,7 +675,7 @@ namespace getfem {
         boundary_threshold_flatness(btf), iter_max(itm), prefind(pref),
         noisy(noise) {
       if (noise == -1) noisy = gmm::traces_level::level() - 2;
-      K=K_; h0=h0_;
+      K=K_; h0=h0_; nb_pts_all = 0;
       ptol = 0.0025;
       ttol = .1;
       dist->bounding_box(bounding_box_min,bounding_box_max);
@@ -710,11 +1050,14 @@ namespace getfem {
       pts_attr[ip] = get_attr(pts_attr[ip]->fixed, new_cts);
     }
 
-    void project_and_update_constraints(size_type ip) {
-      const dal::bit_vector& cts = pts_attr[ip]->constraints;
-      dal::bit_vector new_cts;
-      multi_constraint_projection(pts[ip], cts);
+    // Projection of the point ip, new_cts receives its new constraints.
+    void project_point(size_type ip, dal::bit_vector &new_cts) {
+      multi_constraint_projection(pts[ip], pts_attr[ip]->constraints);
       (*dist)(pts[ip], new_cts);
+    }
+
+    void update_constraints(size_type ip, const dal::bit_vector &new_cts) {
+      const dal::bit_vector& cts = pts_attr[ip]->constraints;
       if (noisy > 1 && !new_cts.contains(cts)) {
         cout << "Point #" << ip << " has been downgraded from "
              << cts << " to " << new_cts << endl;
@@ -729,8 +1072,14 @@ namespace getfem {
       }
       
     }
+
+    void project_and_update_constraints(size_type ip) {
+      dal::bit_vector new_cts;
+      project_point(ip, new_cts);
+      update_constraints(ip, new_cts);
+    }
     
-    template <class VECT> void move_carefully(size_type ip, const VECT &VV) {
+    template <class VECT> void move_point(size_type ip, const VECT &VV) {
       base_node V(N); gmm::copy(VV, V);
 //       if (pts_attr[ip]->constraints.card() != 0) {
 //         base_small_vector grad;
@@ -743,7 +1092,6 @@ namespace getfem {
         gmm::add(V, pts[ip]);
       else
         gmm::add(gmm::scaled(V, h0 / (scalar_type(4) * norm)), pts[ip]);
-      project_and_update_constraints(ip);
     }
 
      template <class VECT> void move_carefully(const VECT &V) {
@@ -755,9 +1103,15 @@ namespace getfem {
        if (norm_max > h0/scalar_type(3.7))
                 lambda = h0 / (scalar_type(3.7) * norm_max);
        
-       for (size_type i = 0; i < npt; ++i)
-                move_carefully(i, gmm::scaled(gmm::sub_vector
-                                       (V, gmm::sub_interval(i*N, N)),lambda));
+       // The points are moved and projected in parallel, the attributes
+       // are shared and updated afterwards.
+       std::vector<dal::bit_vector> new_cts(npt);
+       open_mp_range_for(npt, [&](size_type i) {
+           move_point(i, gmm::scaled(gmm::sub_vector
+                                     (V, gmm::sub_interval(i*N, N)),lambda));
+           project_point(i, new_cts[i]);
+         });
+       for (size_type i = 0; i < npt; ++i) update_constraints(i, new_cts[i]);
      }
 
     void distribute_points_regularly(const std::vector<base_node>
@@ -925,9 +1279,11 @@ namespace getfem {
       pts_prev.resize(keep_pts.card());
       size_type cnt = 0;
       std::vector<const pt_attribute*> pts_attr2(keep_pts.card());
+      renumbering.assign(pts.size(), size_type(-1));
       for (dal::bv_visitor i(keep_pts); !i.finished(); ++i, ++cnt) {
         pts_prev[cnt].swap(pts[idx[i]]);
         pts_attr2[cnt] = pts_attr[idx[i]];
+        renumbering[idx[i]] = cnt;
       }
       pts_attr.swap(pts_attr2);
       pts.resize(pts_prev.size()); 
@@ -938,29 +1294,36 @@ namespace getfem {
     base_node worst_q_P;
 
     void select_elements(int version) {
-      size_type nbpt = pts.size();
+      size_type nbpt = pts.size(), nbt = gmm::mat_ncols(t);
 
-      worst_q = 1.;
-      base_node weights(N+1);
-      for (size_type i=0; i < gmm::mat_ncols(t); )  {
+      /* The elements to be kept are determined in parallel, the signed
+         distance being evaluated at once at the barycenters. */
+      std::vector<size_type> inner;
+      for (size_type i=0; i < nbt; ++i) {
         bool ext_simplex = false;
-        // bool boundary_simplex = true;
-        bool on_boundary_simplex = false;
-        bool is_bridge_simplex = false;
-        scalar_type q(0), dG(0);
-        base_node G;
-        
         for (size_type k=0; k <= N; ++k)
           if (t(k, i) >= nbpt) ext_simplex = true;
-
-        if (!ext_simplex) {
-          G = pts[t(0,i)];
-          for (size_type k=1; k <= N; ++k) G += pts[t(k,i)];
-          gmm::scale(G, scalar_type(1)/scalar_type(N+1));
-          dG = (*dist)(G);
-          gmm::clear(weights);
-          
-          q = quality_of_element(i);
+        if (!ext_simplex) inner.push_back(i);
+      }
+      std::vector<base_node> G(inner.size());
+      open_mp_range_for(inner.size(), [&](size_type j) {
+          size_type i = inner[j];
+          G[j] = pts[t(0,i)];
+          for (size_type k=1; k <= N; ++k) G[j] += pts[t(k,i)];
+          gmm::scale(G[j], scalar_type(1)/scalar_type(N+1));
+        });
+      base_vector dG;
+      eval_signed_distance(*dist, G, dG);
+
+      std::vector<char> keep(nbt, 0);
+      std::vector<scalar_type> q(nbt, scalar_type(0));
+      open_mp_range_for(inner.size(), [&](size_type j) {
+          size_type i = inner[j];
+          // bool boundary_simplex = true;
+          bool on_boundary_simplex = false;
+          bool is_bridge_simplex = false;
+
+          q[i] = quality_of_element(i);
           
           for (size_type k=0; k <= N; ++k) {
             if (!(pts_attr[t(k,i)]->constraints.card() == 0))
@@ -980,14 +1343,24 @@ namespace getfem {
                     && (*dist)(0.5*(pts[t(k,i)] + pts[t(l,i)])) > 0.)
                   is_bridge_simplex = true;
               }
-        }
-        if (ext_simplex || dG > 0 || is_bridge_simplex || q < 1e-14) {
+          keep[i] = !(dG[j] > 0 || is_bridge_simplex || q[i] < 1e-14);
+        });
+
+      worst_q = 1.;
+      std::vector<size_type> num(nbt, size_type(-1)); // index in inner
+      for (size_type j=0; j < inner.size(); ++j) num[inner[j]] = j;
+      std::vector<size_type> orig(nbt); // element before the deletions
+      for (size_type i=0; i < nbt; ++i) orig[i] = i;
+      for (size_type i=0; i < gmm::mat_ncols(t); )  {
+        size_type io = orig[i];
+        if (!keep[io]) {
           delete_element(i);
+          orig[i] = orig.back(); orig.pop_back();
         } else {
           ++i;
-          if (q < worst_q) {
-            worst_q = q;
-            worst_q_P = G*(scalar_type(1)/scalar_type(N+1));
+          if (q[io] < worst_q) {
+            worst_q = q[io];
+            worst_q_P = G[num[io]]*(scalar_type(1)/scalar_type(N+1));
           }
         }
       }
@@ -1166,32 +1539,69 @@ namespace getfem {
     }
 
 
+    void build_edges_mesh(void) {
+      edges_mesh.clear();
+      for (size_type i=0; i < gmm::mat_ncols(t); ++i)
+        for (size_type j=0; j < N+1; ++j)
+          for (size_type k=j+1; k < N+1; ++k)
+            edges_mesh.add_segment(t(j,i), t(k,i));
+    }
+
     void running_delaunay(bool mct) {
       if (noisy > 0)
         cout << "NEW DELAUNAY, running on " << pts.size() << " points\n";
       size_type nbpt = pts.size();
       add_point_hull();
       bgeot::qhull_delaunay(pts, t);
+      gmm::resize(t_all, 0, 0); t_all_orient.resize(0);
+      if (N == 2 && !mct) {
+        t_all = t; nb_pts_all = nbpt;
+        pts_hull.assign(pts.begin()+nbpt, pts.end());
+        t_all_orient.resize(gmm::mat_ncols(t));
+        for (size_type i=0; i < gmm::mat_ncols(t); ++i)
+          t_all_orient[i]
+            = (orientation(pts, t(0,i), t(1,i), t(2,i)) < 0) ? -1 : 1;
+      }
       pts.resize(nbpt);
       if (noisy > 1) cout << "number of elements before selection = "
                           << gmm::mat_ncols(t) << "\n";
       if (mct) {
         select_elements(0);
-        edges_mesh.clear();
-        for (size_type i=0; i < gmm::mat_ncols(t); ++i)
-          for (size_type j=0; j < N+1; ++j)
-            for (size_type k=j+1; k < N+1; ++k)
-              edges_mesh.add_segment(t(j,i), t(k,i));
+        build_edges_mesh();
         special_constraints_management();
       }
       select_elements(1);
       if (noisy > 0) cout << "number of elements after selection = "
                           << gmm::mat_ncols(t) << "\n";
-      edges_mesh.clear();
-      for (size_type i=0; i < gmm::mat_ncols(t); ++i)
-        for (size_type j=0; j < N+1; ++j)
-          for (size_type k=j+1; k < N+1; ++k)
-            edges_mesh.add_segment(t(j,i), t(k,i));
+      build_edges_mesh();
+    }
+
+    /* Incremental update of the triangulation of the last call to
+       running_delaunay when the points have only moved (none added or
+       removed): the complete triangulation, including the points on the
+       hull, is renumbered as the points and the Delaunay property is
+       restored by edge flips. Done in 2D only. Returns false if an element
+       has been inverted by the motion of the points, a new Delaunay
+       triangulation being then needed. */
+    bool delaunay_by_flips(void) {
+      size_type nbt = gmm::mat_ncols(t_all), nbflips = 0;
+      if (N != 2 || nbt == 0 || pts.size() != nb_pts_all
+          || renumbering.size() != nb_pts_all) return false;
+      std::vector<base_node> P(pts);
+      P.insert(P.end(), pts_hull.begin(), pts_hull.end());
+      for (size_type i=0; i < nbt; ++i)
+        for (size_type k=0; k <= N; ++k)
+          if (t_all(k,i) < nb_pts_all) t_all(k,i) = renumbering[t_all(k,i)];
+      if (!getfem::delaunay_by_flips(P, t_all, t_all_orient, h0, &nbflips)) {
+        gmm::resize(t_all, 0, 0); t_all_orient.resize(0);
+        return false;
+      }
+      if (noisy > 0)
+        cout << "DELAUNAY UPDATED by " << nbflips << " flips\n";
+      t = t_all;
+      select_elements(1);
+      build_edges_mesh();
+      return true;
     }
 
     void standard_move_strategy(base_vector &X) {
@@ -1237,6 +1647,7 @@ namespace getfem {
         if (count==0 || pts_prev.size() != pts.size()
             || (pts_dist_max(pts, pts_prev) > ttol*h0 && count_id >= 5)) {
           size_type nbpt = pts.size();
+          bool moved = (count != 0 && pts_prev.size() == nbpt);
           cleanup_points(); /* and copy pts to pts_prev */
           if (noisy == 1) cout << "Iter " << count << " ";
           bool mct = false;
@@ -1244,7 +1655,8 @@ namespace getfem {
             mct = true;
             count_ct = 0;
           }
-          running_delaunay(mct);
+          if (!moved || mct || nbpt != pts.size() || !delaunay_by_flips())
+            running_delaunay(mct);
           pt_changed = nbpt != pts.size();
           count_id = 0;
         }
@@ -21,6 +21,7 @@
 
 #include "getfem/getfem_model_solvers.h"
 #include "gmm/gmm_inoutput.h"
+#include "gmm/gmm_condition_number.h"
 #include <iomanip>
 
 namespace getfem {
@@ -193,6 +194,221 @@ namespace getfem {
   }
 
 
+  /* ***************************************************************** */
+  /*     Explicit central difference scheme.                           */
+  /* ***************************************************************** */
+
+  explicit_central_difference::explicit_central_difference
+  (model &md_, const std::string &varname_, const mesh_im &mim,
+   const std::string &dataexpr_rho, size_type region)
+    : md(md_), varname(varname_), acceleration_computed(false) {
+    GMM_ASSERT1(!(md.is_complex()), "The explicit central difference "
+                "scheme is only available for real models");
+    const gmm::sub_interval &I = md.interval_of_variable(varname);
+    size_type nbdof = md.nb_dof();
+    GMM_ASSERT1(I.first() == 0 && I.size() == nbdof, "Variable " << varname
+                << " should be the only unknown of the model for the "
+                "explicit central difference scheme");
+
+    // Row-sum lumping of the mass matrix
+    ga_workspace workspace(md);
+    std::string prod = (md.qdim_of_variable(varname) == 1) ? "*" : ".";
+    workspace.add_expression("("+dataexpr_rho+")*Test_"+varname+prod
+                             +"Test2_"+varname, mim, region);
+    model_real_sparse_matrix MM(nbdof, nbdof);
+    workspace.set_assembled_matrix(MM);
+    workspace.assembly(2);
+    gmm::resize(M, nbdof);
+    for (size_type j = 0; j < nbdof; ++j)
+      for (const auto &e : MM.col(j)) M[e.c] += e.e;
+    for (size_type i = 0; i < nbdof; ++i)
+      GMM_ASSERT1(M[i] > scalar_type(0), "Non positive lumped mass for the "
+                  "dof " << i << ". The row-sum lumping needs a fem whose "
+                  "mass matrix has positive row sums (P1, Q1, ...)");
+    gmm::resize(V, nbdof);
+    gmm::resize(A, nbdof);
+  }
+
+  void explicit_central_difference::compute_acceleration() {
+    md.assembly(model::BUILD_COMPLETE_RHS);
+    const model_real_plain_vector &F = md.real_rhs();
+    for (size_type i = 0; i < A.size(); ++i) A[i] = F[i] / M[i];
+  }
+
+  void explicit_central_difference::next_step() {
+    scalar_type dt = md.get_time_step();
+    if (!acceleration_computed) {
+      compute_acceleration();
+      acceleration_computed = true;
+    }
+    gmm::add(gmm::scaled(A, dt/scalar_type(2)), V);
+    gmm::add(gmm::scaled(V, dt), md.set_real_variable(varname));
+    md.set_time(md.get_time() + dt);
+    compute_acceleration();
+    gmm::add(gmm::scaled(A, dt/scalar_type(2)), V);
+  }
+
+  scalar_type explicit_stable_time_step(const mesh_fem &mf, scalar_type c,
+                                        const mesh_region &rg) {
+    const mesh &m = mf.linked_mesh();
+    scalar_type dt(0);
+    bgeot::pgeometric_trans pgt_old = 0;
+    bgeot::pgeotrans_precomp pgp = 0;
+    base_matrix G;
+    for (mr_visitor i(rg, m); !i.finished(); ++i) {
+      size_type cv = i.cv();
+      if (!(mf.convex_index().is_in(cv))) continue;
+      bgeot::pgeometric_trans pgt = m.trans_of_convex(cv);
+      if (pgt != pgt_old) {
+        pgt_old = pgt;
+        pgp = bgeot::geotrans_precomp(pgt, pgt->pgeometric_nodes(), 0);
+      }
+      bgeot::vectors_to_base_matrix(G, m.points_of_convex(cv));
+      dim_type P = pgt->structure()->dim();
+
+      // Smallest singular value of the jacobian times the smallest height
+      // of the reference element.
+      base_matrix K(P, G.nrows());
+      scalar_type h(-1);
+      size_type n = (pgt->is_linear()) ? 1 : pgt->nb_points();
+      for (size_type ip = 0; ip < n; ++ip) {
+        gmm::mult(gmm::transposed(pgp->grad(ip)), gmm::transposed(G), K);
+        scalar_type emax, emin; gmm::condition_number(K, emax, emin);
+        if (h < scalar_type(0) || emin < h) h = emin;
+      }
+      if (bgeot::basic_structure(pgt->structure())
+          != bgeot::parallelepiped_structure(P))
+        h /= gmm::sqrt(scalar_type(P));
+
+      short_type k = std::max(short_type(1),
+                              mf.fem_of_element(cv)->estimated_degree());
+      scalar_type dte = h / (c * scalar_type(k));
+      if (dt == scalar_type(0) || dte < dt) dt = dte;
+    }
+    return dt;
+  }
+
+
+  /* ***************************************************************** */
+  /*     Adaptive time stepping.                                       */
+  /* ***************************************************************** */
+
+  adaptive_time_stepping::adaptive_time_stepping
+  (model &md_, const std::string &varname_, scalar_type rtol_,
+   scalar_type atol_)
+    : md(md_), varname(varname_), rtol(rtol_), atol(atol_),
+      dt_min(0), dt_max(std::numeric_limits<scalar_type>::max()),
+      safety(0.9), fac_min(0.2), fac_max(5.), newton_target(8),
+      dt_prev(0), has_history(false), nb_accepted(0), nb_rejected(0),
+      nb_failures(0), nb_iter(0), dt_min_used(0), dt_max_used(0) {
+    GMM_ASSERT1(!(md.is_complex()), "Sorry, only for real models");
+    GMM_ASSERT1(md.is_true_data(varname) == false,
+                varname << " should be a variable of the model");
+    GMM_ASSERT1(rtol > scalar_type(0) || atol > scalar_type(0),
+                "Invalid tolerances");
+  }
+
+  scalar_type adaptive_time_stepping::error_estimate
+  (const model_real_plain_vector &U, const model_real_plain_vector &Up) const {
+    gmm::sub_interval I = md.interval_of_variable(varname);
+    scalar_type err(0);
+    for (size_type i = I.first(); i < I.last(); ++i)
+      err += gmm::sqr((U[i] - Up[i]) / (atol + rtol * gmm::abs(U[i])));
+    return I.size() ? gmm::sqrt(err / scalar_type(I.size())) : err;
+  }
+
+  scalar_type adaptive_time_stepping::next_step
+  (gmm::iteration &iter, rmodel_plsolver_type lsolver,
+   abstract_newton_line_search &ls) {
+    GMM_ASSERT1(md.is_time_integration(),
+                "No time integration scheme in the model");
+    if (md.is_init_step()) { // Initial time derivatives
+      gmm::iteration iter1 = iter;
+      iter1.init();
+      standard_solve(md, iter1, lsolver, ls);
+    }
+
+    size_type nbdof = md.nb_dof();
+    gmm::resize(U1, nbdof);
+    md.from_variables(U1);
+    if (has_history && gmm::vect_size(U0) != nbdof) has_history = false;
+    model_real_plain_vector U(nbdof), Up(nbdof);
+    scalar_type t = md.get_time();
+
+    for (;;) {
+      scalar_type dt = std::min(dt_max, std::max(dt_min,
+                                                 md.get_time_step()));
+      md.set_time_step(dt);
+
+      // Predictor, also used as initial guess.
+      if (has_history) {
+        scalar_type r = dt / dt_prev;
+        gmm::add(gmm::scaled(U1, scalar_type(1) + r),
+                 gmm::scaled(U0, -r), Up);
+      } else
+        gmm::copy(U1, Up);
+      md.to_variables(Up);
+
+      iter.init();
+      standard_solve(md, iter, lsolver, ls);
+      nb_iter += iter.get_iteration();
+      bool converged = iter.converged();
+      md.from_variables(U);
+
+      scalar_type err(0), fac(fac_min);
+      if (converged) {
+        err = error_estimate(U, Up);
+        scalar_type q = has_history ? scalar_type(1) : scalar_type(0);
+        fac = (err > scalar_type(0))
+          ? safety * pow(err, -scalar_type(1) / (q + scalar_type(1))) : fac_max;
+        fac = std::min(fac_max, std::max(fac_min, fac));
+        if (!(md.is_linear()) && iter.get_iteration() > newton_target)
+          fac = std::min(fac, scalar_type(newton_target)
+                         / scalar_type(iter.get_iteration()));
+      }
+
+      if (iter.get_noisy())
+        cout << "t = " << t << " dt = " << dt << " error estimate = " << err
+             << (converged && err <= scalar_type(1) ? " accepted" : " rejected")
+             << endl;
+
+      if (converged && err <= scalar_type(1)) {
+        std::swap(U0, U1);
+        dt_prev = dt; has_history = true;
+        md.shift_variables_for_time_integration();
+        md.set_time_step(std::min(dt_max, std::max(dt_min, dt * fac)));
+        if (nb_accepted == 0 || dt < dt_min_used) dt_min_used = dt;
+        if (nb_accepted == 0 || dt > dt_max_used) dt_max_used = dt;
+        ++nb_accepted;
+        return dt;
+      }
+
+      // Rejected step: restore the state and the time of the model.
+      ++nb_rejected;
+      if (!converged) ++nb_failures;
+      GMM_ASSERT1(dt > dt_min && t + dt > t,
+                  "Adaptive time stepping: step rejected at t = " << t
+                  << " with the minimal time step " << dt);
+      md.to_variables(U1);
+      md.set_time(t);
+      md.set_time_step(dt * std::min(fac, safety));
+    }
+  }
+
+  scalar_type adaptive_time_stepping::next_step(gmm::iteration &iter) {
+    newton_search_with_step_control ls;
+    return next_step(iter, rdefault_linear_solver(md), ls);
+  }
+
+  void adaptive_time_stepping::print_statistics(std::ostream &ost) const {
+    ost << "Adaptive time stepping: " << nb_accepted << " accepted steps, "
+        << nb_rejected << " rejected steps (" << nb_failures
+        << " solver failures), " << nb_iter << " solver iterations, "
+        << "time step in [" << dt_min_used << ", " << dt_max_used << "]"
+        << endl;
+  }
+
+
 
 }  /* end of namespace getfem.                                             */
 
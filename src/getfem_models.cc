@@ -87,6 +87,13 @@ namespace getfem {
     }
   };
 
+  // Zero the stored values of a tangent matrix, keeping its sparsity pattern.
+  template <typename T>
+  static void clear_values(gmm::col_matrix<gmm::rsvector<T>> &M) {
+    for (size_type j = 0; j < gmm::mat_ncols(M); ++j)
+      for (auto &e : M.col(j)) e.e = T(0);
+  }
+
   model::model(bool comp_version) {
     init(); complex_version = comp_version;
     is_linear_ = is_symmetric_ = is_coercive_ = true;
@@ -357,6 +364,7 @@ namespace getfem {
         v.second.set_size();
       }
 
+    tangent_pattern_valid = false;
     if (complex_version) {
       gmm::resize(cTM, tot_size, tot_size);
       gmm::resize(crhs, tot_size);
@@ -2175,11 +2183,27 @@ namespace getfem {
   }
 
   // Call the brick to compute the terms
+  template <typename MATLIST>
+  static bool same_matrices(const MATLIST &ml1, const MATLIST &ml2) {
+    if (ml1.size() != ml2.size()) return false;
+    for (size_type i = 0; i < ml1.size(); ++i) {
+      if (gmm::mat_nrows(ml1[i]) != gmm::mat_nrows(ml2[i])
+          || gmm::mat_ncols(ml1[i]) != gmm::mat_ncols(ml2[i])) return false;
+      for (size_type j = 0; j < gmm::mat_ncols(ml1[i]); ++j) {
+        const auto &c1 = ml1[i].col(j), &c2 = ml2[i].col(j);
+        if (c1.nb_stored() != c2.nb_stored()) return false;
+        for (auto it1 = c1.begin(), it2 = c2.begin(); it1 != c1.end();
+             ++it1, ++it2)
+          if (it1->c != it2->c || it1->e != it2->e) return false;
+      }
+    }
+    return true;
+  }
+
   void model::update_brick(size_type ib, build_version version) const {
     const brick_description &brick = bricks[ib];
     bool cplx = is_complex() && brick.pbr->is_complex();
     bool tobecomputed = brick.terms_to_be_computed
-      || brick.pbr->is_to_be_computed_each_time()
       || !(brick.pbr->is_linear());
 
     // check variable list to test if a mesh_fem as changed.
@@ -2190,6 +2214,12 @@ namespace getfem {
       }
     }
 
+    // A linear brick computed each time or on a change of its data may
+    // leave its matrices unchanged. For a linear model, they are compared
+    // to the previous ones in order to keep the tangent matrix.
+    bool matrices_changed = tobecomputed || !is_linear();
+    if (brick.pbr->is_to_be_computed_each_time()) tobecomputed = true;
+
     // check data list to test if a vector value of a data has changed.
     for (size_type i = 0; i < brick.dlist.size() && !tobecomputed; ++i) {
       var_description &vd = variables[brick.dlist[i]];
@@ -2201,6 +2231,12 @@ namespace getfem {
 
     if (tobecomputed) {
       brick.external_load = scalar_type(0);
+      real_matlist rmatlist_old;
+      complex_matlist cmatlist_old;
+      if (!matrices_changed) {
+        if (cplx) cmatlist_old = brick.cmatlist;
+        else rmatlist_old = brick.rmatlist;
+      }
 
       if (!(brick.pdispatch))
         { brick_call(ib, version, 0); }
@@ -2215,6 +2251,10 @@ namespace getfem {
              version);
       }
       brick.v_num = act_counter();
+      if (!matrices_changed)
+        matrices_changed = cplx ? !same_matrices(cmatlist_old, brick.cmatlist)
+                                : !same_matrices(rmatlist_old, brick.rmatlist);
+      if (matrices_changed) brick.matrix_v_num = brick.v_num;
     }
 
     if (brick.pbr->is_linear()) brick.terms_to_be_computed = false;
@@ -2391,34 +2431,77 @@ namespace getfem {
 #endif
 
     context_check(); if (act_size_to_be_done) actualize_sizes();
+    clear_dof_constraints();
+    generic_expressions.clear();
+    update_affine_dependent_variables();
+
+    // Update of the terms of the bricks. A brick is disabled if all its
+    // variables are disabled.
+    dal::bit_vector assembled_bricks;
+    for (dal::bv_visitor ib(active_bricks); !ib.finished(); ++ib) {
+      const brick_description &brick = bricks[ib];
+      for (size_type j = 0; j < brick.vlist.size(); ++j)
+        if (!(is_disabled_variable(brick.vlist[j])))
+          { assembled_bricks.add(ib); break; }
+      if (assembled_bricks.is_in(ib)) update_brick(ib, version);
+    }
+
+    // The pattern of the previous tangent matrix is reused when the sizes
+    // and the active bricks are unchanged: the values are updated in place
+    // and only the new entries are inserted.
+    bool keep_pattern = (version & BUILD_MATRIX) && tangent_pattern_valid
+      && tangent_pattern_bricks == active_bricks;
+
+    // For a linear model, the previous tangent matrix is kept as it is when
+    // no matrix of a brick and no factor of a variable has changed. Only
+    // the right hand side is then assembled.
+    bool linear_tangent = (version & BUILD_MATRIX) && is_linear()
+      && generic_expressions.empty()
+      && (is_complex() ? complex_dof_constraints.empty()
+                       : real_dof_constraints.empty());
+    std::vector<scalar_type> tangent_coeffs;
+    if (linear_tangent) {
+      for (const auto &v : variables) tangent_coeffs.push_back(v.second.alpha);
+      for (dal::bv_visitor ib(assembled_bricks); !ib.finished(); ++ib)
+        if (bricks[ib].pdispatch)
+          tangent_coeffs.push_back(bricks[ib].matrix_coeff);
+    }
+    if (keep_pattern && linear_tangent && tangent_matrix_reusable
+        && tangent_coeffs == tangent_matrix_coeffs) {
+      bool unchanged = true;
+      for (dal::bv_visitor ib(assembled_bricks); !ib.finished(); ++ib)
+        if (bricks[ib].matrix_v_num > tangent_matrix_v_num) unchanged = false;
+      if (unchanged) {
+        version = build_version(version & ~BUILD_MATRIX);
+        keep_pattern = false;
+      }
+    }
+
     if (is_complex()) {
-      if (version & BUILD_MATRIX) gmm::clear(cTM);
+      if (keep_pattern) clear_values(cTM);
+      else if (version & BUILD_MATRIX) gmm::clear(cTM);
       if (version & BUILD_RHS) gmm::clear(crhs);
     }
     else {
-      if (version & BUILD_MATRIX) gmm::clear(rTM);
+      if (keep_pattern) clear_values(rTM);
+      else if (version & BUILD_MATRIX) gmm::clear(rTM);
       if (version & BUILD_RHS) gmm::clear(rrhs);
     }
-    clear_dof_constraints();
-    generic_expressions.clear();
-    update_affine_dependent_variables();
+    if (version & BUILD_MATRIX) {
+      tangent_pattern_valid = true;
+      tangent_pattern_bricks = active_bricks;
+      tangent_matrix_reusable = false;
+      tangent_matrix_v_num = act_counter();
+      tangent_matrix_coeffs = tangent_coeffs;
+      ++nb_tangent_matrix_builds_;
+    }
 
     if (version & BUILD_RHS) approx_external_load_ = scalar_type(0);
 
-    for (dal::bv_visitor ib(active_bricks); !ib.finished(); ++ib) {
+    for (dal::bv_visitor ib(assembled_bricks); !ib.finished(); ++ib) {
 
       brick_description &brick = bricks[ib];
 
-      // Disables the brick if all its variables are disabled.
-      bool auto_disabled_brick = true;
-      for (size_type j = 0; j < brick.vlist.size(); ++j) {
-        if (!(is_disabled_variable(brick.vlist[j])))
-          auto_disabled_brick = false;
-      }
-      if (auto_disabled_brick) continue;
-
-      update_brick(ib, version);
-
       bool cplx = is_complex() && brick.pbr->is_complex();
 
       scalar_type coeff0 = scalar_type(1);
@@ -2861,6 +2944,7 @@ namespace getfem {
     if (version & BUILD_RHS) {
       approx_external_load_ = MPI_SUM_SCALAR(approx_external_load_);
     }
+    if (version & BUILD_MATRIX) tangent_matrix_reusable = linear_tangent;
 
 
     #if GETFEM_PARA_LEVEL > 1
@@ -3099,6 +3183,7 @@ model_complex_plain_vector &
     bricks.resize(0);
     rTM = model_real_sparse_matrix();
     cTM = model_complex_sparse_matrix();
+    tangent_pattern_valid = false;
     rrhs = model_real_plain_vector();
     crhs = model_complex_plain_vector();
   }
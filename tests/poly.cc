@@ -130,6 +130,37 @@ int main(void)
 	//cout << "Horner: " << PP.horner_print(mi,dim,0) << "\n";
       }
     }
+    // packed evaluation of polynomials of different degrees
+    for (bgeot::short_type dim=1; dim <= 3; ++dim) {
+      std::vector<bgeot::polynomial<bgeot::scalar_type> > PS;
+      for (bgeot::short_type dg=0; dg <= 8; ++dg) {
+	PS.push_back(bgeot::polynomial<bgeot::scalar_type>(dim, dg));
+	for (unsigned i=0; i < PS.back().size(); ++i)
+	  PS.back()[i] = bgeot::scalar_type(rand())
+	    / bgeot::scalar_type(RAND_MAX);
+      }
+      bgeot::packed_polynomials pp;
+      assert(bgeot::pack_functions(PS, pp));
+      assert(pp.nb_polynomials() == PS.size());
+      std::vector<bgeot::scalar_type> X(dim);
+      for (unsigned i=0; i < dim; ++i) X[i] =
+	bgeot::scalar_type(rand()) / bgeot::scalar_type(RAND_MAX) - 0.5;
+      std::vector<bgeot::scalar_type> V(PS.size());
+      pp.eval(X.begin(), V.begin());
+      for (unsigned j=0; j < PS.size(); ++j) {
+	bgeot::scalar_type a = PS[j].eval(X.begin());
+	cout << "[d=" << dim << ", dg=" << PS[j].degree() << "] packed "
+	     << V[j] << " == " << a << "?\n";
+	assert(gmm::abs(a-V[j]) < 1e-13);
+      }
+      // the polynomials of higher precision are not packed
+      std::vector<bgeot::base_poly> PL(1, bgeot::one_poly(dim));
+      bgeot::packed_polynomials pl;
+      assert(bgeot::pack_functions(PL, pl)
+	     == (std::is_same<bgeot::opt_long_scalar_type,
+		 bgeot::scalar_type>::value));
+    }
+
     cout << "\n--------------------------------------------------------\n";
     dump_poly_eval();
     cout << "\n--------------------------------------------------------\n";
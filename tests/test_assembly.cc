@@ -24,6 +24,7 @@
 #include "getfem/getfem_regular_meshes.h"
 #include "getfem/getfem_partial_mesh_fem.h"
 #include "getfem/getfem_mat_elem.h"
+#include "getfem/getfem_model_solvers.h"
 #include "gmm/gmm.h"
 #ifdef GETFEM_HAVE_SYS_TIMES
 # include <sys/times.h>
@@ -887,6 +888,334 @@ static void test_new_assembly(int N, int NX, int pK) {
 
 
 
+/* Mesh mixing quadrilaterals and triangles, with a P1 or Q1 element on
+   each, on which the elements of a region are visited by groups of same
+   transformation, integration method and fem. */
+static void test_mixed_mesh_assembly(int NX) {
+  getfem::mesh m;
+  bgeot::pgeometric_trans pgt_q = bgeot::parallelepiped_geotrans(2, 1);
+  scalar_type h = scalar_type(1) / scalar_type(NX);
+  for (int i = 0; i < NX; ++i)
+    for (int j = 0; j < NX; ++j) {
+      base_node A(i*h, j*h), B((i+1)*h, j*h), C(i*h, (j+1)*h);
+      base_node D((i+1)*h, (j+1)*h);
+      if ((i+j) % 2) {
+        std::vector<base_node> pts = {A, B, C, D};
+        m.add_convex_by_points(pgt_q, pts.begin());
+      } else {
+        m.add_triangle_by_points(A, B, D);
+        m.add_triangle_by_points(A, D, C);
+      }
+    }
+  m.region(1) = getfem::outer_faces_of_mesh(m);
+
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(m.convex_index(), 1);
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(m.convex_index(), 4);
+
+  std::vector<scalar_type> U(mf.nb_dof());
+  gmm::fill_random(U);
+  getfem::ga_workspace workspace;
+  gmm::sub_interval Iu(0, mf.nb_dof());
+  workspace.add_fem_variable("u", mf, Iu, U);
+
+  workspace.add_expression("1", mim);
+  workspace.assembly(0);
+  scalar_type area = workspace.assembled_potential();
+  GMM_ASSERT1(gmm::abs(area - scalar_type(1)) < 1E-10,
+              "Wrong area of a mixed mesh: " << area);
+
+  workspace.clear_expressions();
+  workspace.add_expression("Grad_u.Grad_u", mim);
+  workspace.assembly(0);
+  scalar_type err = gmm::abs(workspace.assembled_potential()
+                    - getfem::old_asm_H1_semi_norm_sqr(mim, mf, U,
+                                           getfem::mesh_region::all_convexes(),
+                                           scalar_type()));
+  GMM_ASSERT1(err < 1E-10, "Error in assembly on a mixed mesh : " << err);
+
+  workspace.clear_expressions();
+  workspace.add_expression("u*u", mim, 1);
+  workspace.assembly(0);
+  err = gmm::abs(workspace.assembled_potential()
+                 - getfem::old_asm_L2_norm_sqr(mim, mf, U, m.region(1),
+                                               scalar_type()));
+  GMM_ASSERT1(err < 1E-10, "Error in boundary assembly on a mixed mesh : "
+              << err);
+
+  // The schedules of the elements are kept between the assemblies and
+  // should follow the modifications of the region and of the methods.
+  workspace.clear_expressions();
+  workspace.add_expression("1", mim, 1);
+  workspace.assembly(0);
+  scalar_type length = workspace.assembled_potential();
+  GMM_ASSERT1(gmm::abs(length - scalar_type(4)) < 1E-10,
+              "Wrong boundary length of a mixed mesh: " << length);
+  getfem::mesh_region bottom;
+  for (getfem::mr_visitor v(m.region(1)); !v.finished(); ++v) {
+    getfem::mesh::ref_mesh_face_pt_ct pts
+      = m.points_of_face_of_convex(v.cv(), v.f());
+    base_node G = gmm::mean_value(pts.begin(), pts.end());
+    if (G[1] < 1E-10) bottom.add(v.cv(), v.f());
+  }
+  m.region(1) = bottom;
+  workspace.assembly(0);
+  length = workspace.assembled_potential();
+  GMM_ASSERT1(gmm::abs(length - scalar_type(1)) < 1E-10,
+              "The modification of a region is ignored: " << length);
+
+  // More regions than the schedules kept by a thread.
+  for (size_type i = 0; i < 70; ++i) {
+    m.region(100+i) = bottom;
+    workspace.clear_expressions();
+    workspace.add_expression("1", mim, 100+i);
+    workspace.assembly(0);
+  }
+  for (size_type i = 0; i < 70; i += 23) {
+    workspace.clear_expressions();
+    workspace.add_expression("1", mim, 100+i);
+    workspace.assembly(0);
+    length = workspace.assembled_potential();
+    GMM_ASSERT1(gmm::abs(length - scalar_type(1)) < 1E-10,
+                "Wrong length after the removal of schedules: " << length);
+  }
+
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    if (m.structure_of_convex(cv)->nb_points() == 4)
+      mim.set_integration_method(cv, 0);
+  workspace.clear_expressions();
+  workspace.add_expression("1", mim);
+  workspace.assembly(0);
+  area = workspace.assembled_potential();
+  GMM_ASSERT1(gmm::abs(area - scalar_type(1)/scalar_type(2)) < 1E-10,
+              "The modification of the integration method is ignored: "
+              << area);
+  cout << "Assembly on a mixed mesh ok" << endl;
+}
+
+static void build_pattern_test_model(getfem::model &md,
+                                     const getfem::mesh_fem &mf,
+                                     const getfem::mesh_im &mim) {
+  md.add_fem_variable("u", mf);
+  getfem::add_nonlinear_term(md, mim, "(1+sqr(u))*Grad_u.Grad_Test_u");
+  getfem::add_linear_term(md, mim, "u*Test_u", 1);
+}
+
+static void test_model_tangent_pattern(int NX) {
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(2, NX),
+                            bgeot::simplex_geotrans(2, 1));
+  m.region(1) = getfem::outer_faces_of_mesh(m);
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(m.convex_index(), 2);
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(m.convex_index(), 4);
+
+  std::vector<scalar_type> U1(mf.nb_dof()), U2(mf.nb_dof());
+  gmm::fill_random(U1); gmm::fill_random(U2);
+
+  // md is assembled repeatedly and reuses the pattern of its tangent matrix,
+  // md_ref is a fresh model for each comparison.
+  getfem::model md;
+  build_pattern_test_model(md, mf, mim);
+  gmm::copy(U1, md.set_real_variable("u"));
+  md.assembly(getfem::model::BUILD_ALL);
+  gmm::copy(U2, md.set_real_variable("u"));
+  md.assembly(getfem::model::BUILD_ALL);
+
+  for (int step = 0; step < 2; ++step) {
+    getfem::model md_ref;
+    build_pattern_test_model(md_ref, mf, mim);
+    if (step == 1) { md.disable_brick(1); md_ref.disable_brick(1); }
+    gmm::copy(U2, md_ref.set_real_variable("u"));
+    md_ref.assembly(getfem::model::BUILD_ALL);
+    if (step == 1) md.assembly(getfem::model::BUILD_ALL);
+
+    getfem::model_real_sparse_matrix K(md.nb_dof(), md.nb_dof());
+    gmm::copy(md.real_tangent_matrix(), K);
+    gmm::add(gmm::scaled(md_ref.real_tangent_matrix(), scalar_type(-1)), K);
+    scalar_type err = gmm::mat_maxnorm(K);
+    GMM_ASSERT1(err < 1E-10, "Wrong tangent matrix after a reassembly of "
+                "the model : " << err);
+    GMM_ASSERT1(gmm::nnz(md.real_tangent_matrix())
+                == gmm::nnz(md_ref.real_tangent_matrix()),
+                "Unexpected pattern of the tangent matrix");
+  }
+  cout << "Reassembly of the model tangent matrix ok" << endl;
+}
+
+static void build_transient_test_model(getfem::model &md,
+                                       const getfem::mesh_fem &mf,
+                                       const getfem::mesh_im &mim) {
+  md.add_fem_variable("u", mf, 2);
+  md.add_initialized_scalar_data("c", scalar_type(1));
+  md.add_fem_data("F", mf);
+  md.add_fem_data("D", mf);
+  getfem::add_linear_term(md, mim, "c*Grad_u.Grad_Test_u - F*Test_u");
+  getfem::add_Dirichlet_condition_with_multipliers(md, mim, "u", mf, 1, "D");
+  getfem::add_theta_method_for_first_order(md, "u", scalar_type(0.5));
+  getfem::add_mass_brick(md, mim, "Dot_u");
+  md.set_time(scalar_type(0));
+  md.set_time_step(scalar_type(0.1));
+  md.perform_init_time_derivative(scalar_type(0.01));
+}
+
+static void test_linear_model_reassembly(int NX) {
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(2, NX),
+                            bgeot::simplex_geotrans(2, 1));
+  m.region(1) = getfem::outer_faces_of_mesh(m);
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(m.convex_index(), 2);
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(m.convex_index(), 4);
+
+  // md keeps its tangent matrix from one step to the next one when it is
+  // unchanged, all the bricks of md_ref are recomputed at each step.
+  getfem::model md, md_ref;
+  build_transient_test_model(md, mf, mim);
+  build_transient_test_model(md_ref, mf, mim);
+
+  std::vector<scalar_type> V(mf.nb_dof());
+  for (int step = 0; step < 7; ++step) {
+    for (getfem::model *pmd : {&md, &md_ref}) {
+      gmm::fill(V, scalar_type(step));
+      gmm::copy(V, pmd->set_real_variable("F"));
+      gmm::fill(V, scalar_type(1) / scalar_type(step+1));
+      gmm::copy(V, pmd->set_real_variable("D"));
+      if (step == 4) pmd->set_real_variable("c")[0] = scalar_type(2);
+      if (step == 5) pmd->set_time_step(scalar_type(0.05));
+    }
+    for (dal::bv_visitor ib(md_ref.get_active_bricks()); !ib.finished(); ++ib)
+      md_ref.touch_brick(ib);
+
+    size_type nb_builds = md.nb_tangent_matrix_builds();
+    size_type nb_builds_ref = md_ref.nb_tangent_matrix_builds();
+    gmm::iteration iter(1E-12, 0, 40000);
+    getfem::standard_solve(md, iter);
+    iter.init();
+    getfem::standard_solve(md_ref, iter);
+    nb_builds = md.nb_tangent_matrix_builds() - nb_builds;
+    nb_builds_ref = md_ref.nb_tangent_matrix_builds() - nb_builds_ref;
+    GMM_ASSERT1(nb_builds_ref > 0, "No assembly of the reference model");
+    // The first step computes the initial time derivative with a different
+    // time step. After that, only the changes of c (step 4) and of the time
+    // step (step 5) modify the tangent matrix.
+    if (step == 2 || step == 3 || step == 6) {
+      GMM_ASSERT1(nb_builds == 0, "The unchanged tangent matrix is "
+                  "assembled again at step " << step);
+    } else {
+      GMM_ASSERT1(nb_builds > 0, "The tangent matrix is not assembled "
+                  "at step " << step);
+    }
+
+    getfem::model_real_sparse_matrix K(md.nb_dof(), md.nb_dof());
+    gmm::copy(md.real_tangent_matrix(), K);
+    gmm::add(gmm::scaled(md_ref.real_tangent_matrix(), scalar_type(-1)), K);
+    scalar_type err = gmm::mat_maxnorm(K);
+    GMM_ASSERT1(err < 1E-10, "Wrong tangent matrix at step " << step
+                << " of a linear transient model : " << err);
+    gmm::add(gmm::scaled(md_ref.real_variable("u"), scalar_type(-1)),
+             md.real_variable("u"), V);
+    err = gmm::vect_norminf(V);
+    GMM_ASSERT1(err < 1E-8, "Wrong solution at step " << step
+                << " of a linear transient model : " << err);
+    md.shift_variables_for_time_integration();
+    md_ref.shift_variables_for_time_integration();
+  }
+  cout << "Reassembly of a linear transient model ok" << endl;
+}
+
+static void test_explicit_central_difference(int NX) {
+  // Free vibration of a string with free ends, u = cos(pi x) cos(pi t).
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(1, NX),
+                            bgeot::simplex_geotrans(1, 1));
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(m.convex_index(), 1);
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(m.convex_index(), 2);
+
+  getfem::model md;
+  md.add_fem_variable("u", mf);
+  getfem::add_linear_term(md, mim, "Grad_u.Grad_Test_u");
+  std::vector<scalar_type> &U = md.set_real_variable("u");
+  for (size_type i = 0; i < mf.nb_dof(); ++i)
+    U[i] = cos(M_PI * mf.point_of_basic_dof(i)[0]);
+
+  scalar_type dt = getfem::explicit_stable_time_step(mf, scalar_type(1));
+  GMM_ASSERT1(gmm::abs(dt * scalar_type(NX) - scalar_type(1)) < 1E-10,
+              "Wrong stable time step estimate : " << dt);
+  size_type nbsteps = 4 * NX;
+  md.set_time(scalar_type(0));
+  md.set_time_step(scalar_type(1) / scalar_type(nbsteps));
+  getfem::explicit_central_difference ecd(md, "u", mim);
+  for (size_type k = 0; k < nbsteps; ++k) ecd.next_step();
+
+  scalar_type t = md.get_time(), err(0);
+  for (size_type i = 0; i < mf.nb_dof(); ++i) {
+    scalar_type x = mf.point_of_basic_dof(i)[0];
+    err = std::max(err, gmm::abs(md.real_variable("u")[i]
+                                 - cos(M_PI * x) * cos(M_PI * t)));
+  }
+  GMM_ASSERT1(gmm::abs(t - scalar_type(1)) < 1E-10 && err < 1E-2,
+              "Wrong solution of the explicit central difference scheme : "
+              << err);
+  cout << "Explicit central difference scheme ok" << endl;
+}
+
+static void test_adaptive_time_stepping(int NX) {
+  // Heat equation on ]0,1[ with homogeneous Dirichlet conditions,
+  // u = sin(pi x) exp(-pi^2 t): the solution decays and the time step
+  // should grow.
+  getfem::mesh m;
+  getfem::regular_unit_mesh(m, std::vector<size_type>(1, NX),
+                            bgeot::simplex_geotrans(1, 1));
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(m.convex_index(), 2);
+  getfem::mesh_im mim(m);
+  mim.set_integration_method(m.convex_index(), 4);
+  getfem::mesh_region border;
+  getfem::outer_faces_of_mesh(m, border);
+  m.region(1) = border;
+
+  getfem::model md;
+  md.add_fem_variable("u", mf);
+  getfem::add_Laplacian_brick(md, mim, "u");
+  getfem::add_Dirichlet_condition_with_multipliers(md, mim, "u", mf, 1);
+  getfem::add_theta_method_for_first_order(md, "u", scalar_type(1));
+  getfem::add_mass_brick(md, mim, "Dot_u");
+  std::vector<scalar_type> U(mf.nb_dof());
+  for (size_type i = 0; i < mf.nb_dof(); ++i)
+    U[i] = sin(M_PI * mf.point_of_basic_dof(i)[0]);
+  gmm::copy(U, md.set_real_variable("u"));
+  gmm::copy(U, md.set_real_variable("Previous_u"));
+
+  scalar_type T(0.5), dt0(0.1);
+  md.set_time(scalar_type(0));
+  md.set_time_step(dt0); // Too large, the first step has to be rejected
+  getfem::adaptive_time_stepping ats(md, "u", 1E-3, 1E-5);
+  gmm::iteration iter(1E-9, 0, 100);
+  while (md.get_time() < T - 1E-12) {
+    md.set_time_step(std::min(md.get_time_step(), T - md.get_time()));
+    ats.next_step(iter);
+  }
+  scalar_type err(0);
+  for (size_type i = 0; i < mf.nb_dof(); ++i) {
+    scalar_type x = mf.point_of_basic_dof(i)[0];
+    err = std::max(err, gmm::abs(md.real_variable("u")[i]
+                                 - sin(M_PI * x) * exp(-M_PI * M_PI * T)));
+  }
+  GMM_ASSERT1(err < 2E-3, "Wrong solution of the adaptive time stepping : "
+              << err);
+  GMM_ASSERT1(ats.nb_rejected_steps() > 0 && ats.min_accepted_time_step()
+              < dt0 && ats.max_accepted_time_step()
+              > scalar_type(10) * ats.min_accepted_time_step(),
+              "Wrong behaviour of the adaptive time stepping");
+  cout << "Adaptive time stepping ok" << endl;
+}
+
 int main(int argc, char *argv[]) {
 
   GMM_SET_EXCEPTION_DEBUG; // Exceptions make a memory fault, to debug.
@@ -894,6 +1223,11 @@ int main(int argc, char *argv[]) {
   
   test_new_assembly(2, 25, 2);
   test_new_assembly(3, 7, 2);
+  test_mixed_mesh_assembly(6);
+  test_model_tangent_pattern(5);
+  test_linear_model_reassembly(5);
+  test_explicit_central_difference(40);
+  test_adaptive_time_stepping(20);
 
 
   // testbug();
@@ -0,0 +1,333 @@
+/*===========================================================================
+
+ Copyright (C) 2017-2017 Yves Renard.
+
+ This file is a part of GetFEM++
+
+ GetFEM++  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/**@file test_contact.cc
+   @brief Tests of the detection of contact pairs in large sliding.
+*/
+
+#include "getfem/getfem_contact_and_friction_common.h"
+#include "getfem/getfem_contact_and_friction_nodal.h"
+#include "getfem/getfem_regular_meshes.h"
+#include "getfem/getfem_mesher.h"
+
+using std::endl; using std::cout; using std::cerr;
+using bgeot::size_type;
+using bgeot::scalar_type;
+using bgeot::base_node;
+using bgeot::base_small_vector;
+
+typedef getfem::model_real_plain_vector plain_vector;
+typedef getfem::multi_contact_frame::contact_pair contact_pair;
+
+// Two stacked rectangles [0,w]x[0,0.5] and [0,1]x[0.52,1.02], the upper one
+// being moved down by its displacement so that the two bodies overlap.
+// Region 1 is the top face of the lower block and the bottom face of the
+// upper one, region 2 the whole boundary of the upper block.
+struct two_blocks {
+  getfem::mesh m1, m2;
+  getfem::mesh_fem mf1, mf2;
+  getfem::mesh_im mim1, mim2;
+  plain_vector U1, U2;
+
+  static void build(getfem::mesh &m, scalar_type y0, size_type NX,
+                    scalar_type w) {
+    std::vector<size_type> nsubdiv = {size_type(w*scalar_type(NX)), NX/2};
+    getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(2, 1));
+    base_small_vector tr(2); tr[1] = y0;
+    bgeot::base_matrix M(2, 2); M(0,0) = w; M(1,1) = 0.5;
+    m.transformation(M);
+    m.translation(tr);
+  }
+
+  static void boundary(getfem::mesh &m, size_type rg, scalar_type y) {
+    getfem::mesh_region border;
+    getfem::outer_faces_of_mesh(m, border);
+    for (getfem::mr_visitor i(border); !i.finished(); ++i) {
+      base_small_vector n = m.normal_of_face_of_convex(i.cv(), i.f());
+      base_node c = gmm::mean_value(m.points_of_face_of_convex(i.cv(), i.f()));
+      if (gmm::abs(n[0]) < 1E-8 && gmm::abs(c[1] - y) < 1E-8)
+        m.region(rg).add(i.cv(), i.f());
+    }
+  }
+
+  two_blocks(size_type NX, scalar_type penetration, scalar_type w = 1.)
+    : mf1(m1), mf2(m2), mim1(m1), mim2(m2) {
+    build(m1, 0., NX, w); build(m2, 0.52, NX, 1.);
+    boundary(m1, 1, 0.5); boundary(m2, 1, 0.52);
+    getfem::outer_faces_of_mesh(m2, m2.region(2));
+    mf1.set_qdim(2); mf1.set_classical_finite_element(1);
+    mf2.set_qdim(2); mf2.set_classical_finite_element(1);
+    mim1.set_integration_method(2); mim2.set_integration_method(2);
+    gmm::resize(U1, mf1.nb_dof()); gmm::resize(U2, mf2.nb_dof());
+    for (size_type i = 0; i < mf2.nb_dof(); i += 2) {
+      scalar_type x = mf2.point_of_basic_dof(i)[0];
+      U2[i] = 0.001 * x; U2[i+1] = -0.02 - penetration * x * (1. - x);
+    }
+  }
+
+  void add_boundaries(getfem::multi_contact_frame &mcf, size_type rg2 = 1) {
+    mcf.add_slave_boundary(mim1, &mf1, &U1, 1);
+    mcf.add_master_boundary(mim2, &mf2, &U2, rg2);
+  }
+};
+
+static bool same_pairs(const getfem::multi_contact_frame &mcf1,
+                       const getfem::multi_contact_frame &mcf2,
+                       scalar_type eps = 1E-10) {
+  const std::vector<contact_pair> &cp1 = mcf1.ct_pairs();
+  const std::vector<contact_pair> &cp2 = mcf2.ct_pairs();
+  if (cp1.size() != cp2.size()) return false;
+  for (size_type i = 0; i < cp1.size(); ++i) {
+    const contact_pair &p1 = cp1[i], &p2 = cp2[i];
+    if (p1.slave_ind_element != p2.slave_ind_element
+        || p1.slave_ind_face != p2.slave_ind_face
+        || p1.slave_ind_pt != p2.slave_ind_pt
+        || p1.master_ind_element != p2.master_ind_element
+        || p1.master_ind_face != p2.master_ind_face
+        || p1.irigid_obstacle != p2.irigid_obstacle
+        || gmm::abs(p1.signed_dist - p2.signed_dist) > eps
+        || gmm::vect_dist2(p1.master_point, p2.master_point) > eps)
+      return false;
+  }
+  return true;
+}
+
+// The contact pairs found with all the threads should be the same, in the
+// same order, as the ones found with a single thread.
+static void test_parallel_detection(bool delaunay, bool raytrace) {
+  two_blocks tb(40, 0.05);
+  getfem::multi_contact_frame mcf(2, 0.1, delaunay, false, 0.3, raytrace);
+  tb.add_boundaries(mcf);
+  mcf.compute_contact_pairs();
+  GMM_ASSERT1(mcf.nb_contact_pairs() > 0, "No contact pair found");
+
+  size_type nbth = getfem::num_threads();
+  getfem::set_num_threads(1);
+  getfem::multi_contact_frame mcf1(2, 0.1, delaunay, false, 0.3, raytrace);
+  tb.add_boundaries(mcf1);
+  mcf1.compute_contact_pairs();
+  getfem::set_num_threads(int(nbth));
+
+  GMM_ASSERT1(same_pairs(mcf, mcf1), "The contact pairs depend on the "
+              "number of threads: " << mcf.nb_contact_pairs() << " / "
+              << mcf1.nb_contact_pairs());
+}
+
+#ifdef GETFEM_HAVE_LIBQHULL_QHULL_A_H
+// For the delaunay option, the bucket grid should give the same contact
+// pairs as the Delaunay triangulation of qhull.
+static void test_grid_and_qhull(bool raytrace) {
+  two_blocks tb(40, 0.05);
+  getfem::multi_contact_frame mcf(2, 0.1, 1, false, 0.3, raytrace);
+  tb.add_boundaries(mcf);
+  mcf.compute_contact_pairs();
+  GMM_ASSERT1(mcf.nb_contact_pairs() > 0, "No contact pair found");
+
+  getfem::multi_contact_frame mcf1(2, 0.1, 2, false, 0.3, raytrace);
+  tb.add_boundaries(mcf1);
+  mcf1.compute_contact_pairs();
+  GMM_ASSERT1(same_pairs(mcf, mcf1), "Different contact pairs with qhull "
+              "and with the bucket grid: " << mcf.nb_contact_pairs() << " / "
+              << mcf1.nb_contact_pairs());
+}
+#endif
+
+// The bucket grid kept from a detection to the next one should give the
+// same contact pairs as a new one, whether the master points stay in the
+// grid bounds or not.
+static void test_grid_reuse(void) {
+  two_blocks tb(40, 0.05);
+  getfem::multi_contact_frame mcf(2, 0.1, 2, false);
+  tb.add_boundaries(mcf);
+
+  auto check_with_new_grid = [&]() {
+    mcf.compute_contact_pairs();
+    getfem::multi_contact_frame mcf0(2, 0.1, 2, false);
+    tb.add_boundaries(mcf0);
+    mcf0.compute_contact_pairs();
+    GMM_ASSERT1(mcf.nb_contact_pairs() > 0, "No contact pair found");
+    GMM_ASSERT1(same_pairs(mcf, mcf0), "Wrong pairs with a kept bucket "
+                "grid: " << mcf.nb_contact_pairs() << " / "
+                << mcf0.nb_contact_pairs());
+  };
+
+  check_with_new_grid();
+  for (size_type i = 0; i < tb.mf2.nb_dof(); i += 2) // In the grid bounds
+    { tb.U2[i] += 0.03; tb.U2[i+1] -= 0.01; }
+  check_with_new_grid();
+  for (size_type i = 0; i < tb.mf2.nb_dof(); i += 2) // Out of the bounds
+    tb.U2[i] += 0.5;
+  check_with_new_grid();
+}
+
+// Contact pairs found with a search margin compared to the ones of a full
+// search. The lower block is wider so that its points on the right of the
+// upper block can only be in contact with the right side of it, whose
+// normal is orthogonal to the normal of the slave surface before a shear
+// of the upper block.
+static void test_search_margin(void) {
+  two_blocks tb(40, 0., 1.5);
+  getfem::multi_contact_frame mcf(2, 0.1, false, false);
+  mcf.set_search_margin(0.05);
+  tb.add_boundaries(mcf, 2);
+
+  auto check_with_full_search = [&](size_type nbs) {
+    mcf.compute_contact_pairs();
+    getfem::multi_contact_frame mcf0(2, 0.1, false, false);
+    tb.add_boundaries(mcf0, 2);
+    mcf0.compute_contact_pairs();
+    GMM_ASSERT1(mcf.nb_full_searches() == nbs, "Wrong number of full "
+                "searches: " << mcf.nb_full_searches());
+    // The projections may be done from other candidate faces and are
+    // only compared up to the accuracy of their Newton algorithm.
+    GMM_ASSERT1(same_pairs(mcf, mcf0, 1E-8), "Wrong pairs with a search "
+                "margin: " << mcf.nb_contact_pairs() << " / "
+                << mcf0.nb_contact_pairs());
+  };
+
+  check_with_full_search(1);
+  size_type nbcp = mcf.nb_contact_pairs();
+
+  // Small displacement: the stored potential pairs are kept.
+  for (size_type i = 0; i < tb.mf2.nb_dof(); i += 2)
+    tb.U2[i+1] -= 0.01;
+  check_with_full_search(1);
+
+  // Shear of the upper block within the margin. Its right side now faces
+  // the slave surface, which gives new pairs.
+  for (size_type i = 0; i < tb.mf2.nb_dof(); i += 2)
+    tb.U2[i] -= 0.06 * (1.02 - tb.mf2.point_of_basic_dof(i)[1]);
+  check_with_full_search(1);
+  GMM_ASSERT1(mcf.nb_contact_pairs() > nbcp, "No pair on the tilted face");
+
+  // Displacement beyond the margin: new full search.
+  for (size_type i = 0; i < tb.mf2.nb_dof(); i += 2)
+    tb.U2[i] += 0.1;
+  check_with_full_search(2);
+}
+
+// Contact of the top face of the lower block with a rigid ball described
+// by an analytic signed distance. The pairs are compared to the exact
+// projections and to the ones of the same obstacle given by an expression.
+static void test_analytic_obstacle(bool raytrace) {
+  two_blocks tb(40, 0.);
+  base_node c(0.5, 0.79); scalar_type R(0.3);
+  getfem::multi_contact_frame mcf(2, 0.1, false, false, 0.3, raytrace);
+  mcf.add_slave_boundary(tb.mim1, &tb.mf1, &tb.U1, 1);
+  mcf.add_obstacle(getfem::new_mesher_ball(c, R));
+  mcf.compute_contact_pairs();
+  GMM_ASSERT1(mcf.nb_contact_pairs() > 0, "No contact with the obstacle");
+
+  for (const contact_pair &cp : mcf.ct_pairs()) {
+    const base_node &x = cp.slave_point, &y = cp.master_point;
+    GMM_ASSERT1(cp.irigid_obstacle == 0, "Wrong obstacle");
+    GMM_ASSERT1(gmm::abs(gmm::vect_dist2(y, c) - R) < 1E-8,
+                "The master point " << y << " is not on the obstacle");
+    if (raytrace) {
+      GMM_ASSERT1(gmm::abs(y[0] - x[0]) < 1E-8, "Wrong raytrace " << y);
+    } else {
+      GMM_ASSERT1(gmm::abs(cp.signed_dist - (gmm::vect_dist2(x, c) - R))
+                  < 1E-8, "Wrong signed distance " << cp.signed_dist);
+    }
+  }
+
+  getfem::multi_contact_frame mcf2(2, 0.1, false, false, 0.3, raytrace);
+  mcf2.add_slave_boundary(tb.mim1, &tb.mf1, &tb.U1, 1);
+  mcf2.add_obstacle("sqrt(sqr(x-0.5)+sqr(y-0.79))-0.3");
+  mcf2.compute_contact_pairs();
+  GMM_ASSERT1(mcf2.nb_contact_pairs() == mcf.nb_contact_pairs(),
+              "Different pairs for an expression obstacle");
+  for (size_type i = 0; i < mcf.nb_contact_pairs(); ++i)
+    GMM_ASSERT1(gmm::abs(mcf.ct_pairs()[i].signed_dist
+                         - mcf2.ct_pairs()[i].signed_dist) < 1E-6
+                && mcf.ct_pairs()[i].slave_ind_pt
+                == mcf2.ct_pairs()[i].slave_ind_pt,
+                "Different pairs for an expression obstacle");
+}
+
+// The tangent matrix and the right hand side of the nodal contact with
+// friction brick computed with all the threads should be the same as the
+// ones computed with a single thread.
+static void test_parallel_nodal_contact(int aug_version) {
+  two_blocks tb(20, 0.05);
+  getfem::model md;
+  md.add_fem_variable("u1", tb.mf1);
+  md.add_fem_variable("u2", tb.mf2);
+  gmm::copy(tb.U2, md.set_real_variable("u2"));
+  md.add_initialized_scalar_data("r", scalar_type(1));
+  md.add_initialized_scalar_data("f", scalar_type(0.3));
+  std::string multname_n, multname_t;
+  getfem::add_nodal_contact_between_nonmatching_meshes_brick
+    (md, tb.mim1, tb.mim2, "u1", "u2", multname_n, multname_t, "r", "f",
+     1, 1, true, false, aug_version);
+  plain_vector &lambda_n = md.set_real_variable(multname_n);
+  plain_vector &lambda_t = md.set_real_variable(multname_t);
+  for (size_type i = 0; i < lambda_n.size(); ++i)
+    lambda_n[i] = -0.01 * scalar_type(i % 3);
+  for (size_type i = 0; i < lambda_t.size(); ++i)
+    lambda_t[i] = 0.001 * (scalar_type(i % 5) - 2.);
+
+  md.assembly(getfem::model::BUILD_ALL);
+  getfem::model_real_sparse_matrix K(gmm::mat_nrows(md.real_tangent_matrix()),
+                                     gmm::mat_ncols(md.real_tangent_matrix()));
+  gmm::copy(md.real_tangent_matrix(), K);
+  plain_vector F(md.real_rhs());
+  GMM_ASSERT1(gmm::mat_maxnorm(K) > 0., "Empty tangent matrix");
+
+  size_type nbth = getfem::num_threads();
+  getfem::set_num_threads(1);
+  md.assembly(getfem::model::BUILD_ALL);
+  getfem::set_num_threads(int(nbth));
+
+  gmm::add(gmm::scaled(md.real_tangent_matrix(), scalar_type(-1)), K);
+  gmm::add(gmm::scaled(md.real_rhs(), scalar_type(-1)), F);
+  GMM_ASSERT1(gmm::mat_maxnorm(K) < 1E-12 && gmm::vect_norminf(F) < 1E-12,
+              "The nodal contact terms depend on the number of threads: "
+              << gmm::mat_maxnorm(K) << " " << gmm::vect_norminf(F));
+}
+
+int main(void) {
+
+  GMM_SET_EXCEPTION_DEBUG; // Exceptions make a memory fault, to debug.
+  FE_ENABLE_EXCEPT;        // Enable floating point exception for Nan.
+
+  test_parallel_detection(false, false);
+  test_parallel_detection(false, true);
+  test_parallel_detection(true, false);
+  cout << "Parallel contact detection ok" << endl;
+#ifdef GETFEM_HAVE_LIBQHULL_QHULL_A_H
+  test_grid_and_qhull(false);
+  test_grid_and_qhull(true);
+  cout << "Bucket grid and qhull contact detection ok" << endl;
+#endif
+  test_grid_reuse();
+  cout << "Contact detection with a kept bucket grid ok" << endl;
+  test_search_margin();
+  cout << "Contact detection with a search margin ok" << endl;
+  test_analytic_obstacle(false);
+  test_analytic_obstacle(true);
+  cout << "Contact with an analytic obstacle ok" << endl;
+  for (int aug_version = 1; aug_version <= 4; ++aug_version)
+    test_parallel_nodal_contact(aug_version);
+  cout << "Parallel nodal contact terms ok" << endl;
+
+  return 0;
+}
@@ -23,6 +23,7 @@
 #include "getfem/bgeot_comma_init.h"
 #include "getfem/getfem_export.h"
 #include "getfem/bgeot_node_tab.h"
+#include "getfem/getfem_import.h"
 using std::endl; using std::cout; using std::cerr;
 using std::ends; using std::cin;
 using getfem::size_type;
@@ -630,6 +631,258 @@ void test_incomplete_Q2(void) {
 
 
 
+void test_vtu_export() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(2, 10);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::parallelepiped_geotrans(2,1));
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(m.convex_index(), 1);
+  std::vector<double> U(mf.nb_dof());
+  for (size_type i = 0; i < mf.nb_dof(); ++i)
+    U[i] = mf.point_of_basic_dof(i)[0];
+
+  for (int compressed = 0; compressed < 2; ++compressed) {
+    std::string name = compressed ? "test_mesh_z.vtu" : "test_mesh.vtu";
+    {
+      getfem::vtu_export exp(name, compressed != 0);
+      exp.exporting(mf);
+      exp.write_point_data(mf, U, "x");
+    }
+    std::ifstream f(name.c_str(), std::ios::binary);
+    std::string s((std::istreambuf_iterator<char>(f)),
+                  std::istreambuf_iterator<char>());
+    GMM_ASSERT1(s.find("NumberOfPoints=\"121\" NumberOfCells=\"100\"")
+                != std::string::npos, "wrong vtu header");
+    size_type pos = s.find("<AppendedData encoding=\"raw\">\n_");
+    GMM_ASSERT1(pos != std::string::npos, "no appended data");
+    if (!compressed) { // the field x is the first array
+      const char *p = s.c_str() + pos + 31;
+      uint64_t nb; memcpy(&nb, p, sizeof(nb));
+      GMM_ASSERT1(nb == 121*sizeof(float), "wrong size of array");
+      std::vector<float> x(121); memcpy(&x[0], p + sizeof(nb), nb);
+      double sum = 0.;
+      for (size_type i = 0; i < 121; ++i) sum += x[i];
+      GMM_ASSERT1(gmm::abs(sum - 60.5) < 1E-4, "wrong values in vtu file");
+    }
+  }
+
+  /* two pieces gathered in a pvtu file, in a pvd time series */
+  getfem::pvd_export pvd("test_mesh.pvd");
+  std::vector<std::string> pieces;
+  for (size_type k = 0; k < 2; ++k) {
+    getfem::mesh_fem mfk(m);
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+      if ((m.points_of_convex(cv)[0][0] < 0.5) == (k == 0))
+        mfk.set_finite_element(cv, mf.fem_of_element(cv));
+    std::stringstream piece; piece << "test_mesh_" << k << ".vtu";
+    pieces.push_back(piece.str());
+    getfem::vtu_export exp(piece.str());
+    exp.exporting(mfk);
+    exp.write_point_data(mf, U, "x");
+    exp.close();
+    if (k == 1) exp.write_pvtu("test_mesh.pvtu", pieces);
+  }
+  pvd.add_dataset(0., "test_mesh.pvtu");
+  GMM_ASSERT1(pvd.nb_datasets() == 1, "wrong pvd collection");
+}
+
+void test_xdmf_export() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(2, 10);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::parallelepiped_geotrans(2,1));
+  getfem::mesh_fem mf(m);
+  mf.set_classical_finite_element(m.convex_index(), 1);
+  std::vector<double> U(mf.nb_dof()), V(2*mf.nb_dof());
+  {
+    getfem::xdmf_export exp("test_mesh_series");
+    exp.exporting(mf);
+    for (size_type k = 0; k < 3; ++k) {
+      exp.new_time_step(0.1*double(k));
+      for (size_type i = 0; i < mf.nb_dof(); ++i)
+        U[i] = V[2*i+1] = double(k)*mf.point_of_basic_dof(i)[0];
+      exp.write_point_data(mf, U, "u");
+      exp.write_sliced_point_data(V, "v", 2);
+    }
+    exp.flush();
+    GMM_ASSERT1(exp.nb_time_steps() == 3, "wrong number of time steps");
+  }
+  /* the mesh is written once: 121 points, 100 quadrangles (5 integers
+     each), and for each time step a scalar and a vector field. */
+  std::ifstream f("test_mesh_series.bin", std::ios::binary | std::ios::ate);
+  size_type size = size_type(f.tellg());
+  GMM_ASSERT1(size == (121*3 + 100*5 + 3*(121 + 121*3)) * 4,
+              "wrong size of the xdmf binary file: " << size);
+  std::ifstream fx("test_mesh_series.xmf");
+  std::string sx((std::istreambuf_iterator<char>(fx)),
+                 std::istreambuf_iterator<char>());
+  size_type nt = 0;
+  for (size_type i = sx.find("<Time "); i != std::string::npos;
+       i = sx.find("<Time ", i+1)) ++nt;
+  GMM_ASSERT1(nt == 3, "wrong xdmf description");
+}
+
+/* The unit square cut into two triangles, with its bottom edge in the
+   physical region 1 and its surface in the physical region 2, written in
+   the gmsh formats 2.2 and 4.1, ASCII and binary. The binary files have
+   CRLF line endings. */
+template <typename T> void put_binary(std::ostream &o, T v)
+{ o.write(reinterpret_cast<const char *>(&v), sizeof(T)); }
+
+static const double square_nodes[4][3]
+  = { {0., 0., 0.}, {1., 0., 0.}, {1., 1., 0.}, {0., 1., 0.} };
+
+std::string gmsh_square(int version, bool binary) {
+  std::stringstream s;
+  const char *nl = binary ? "\r\n" : "\n";
+  s << "$MeshFormat" << nl << ((version == 2) ? "2.2 " : "4.1 ")
+    << (binary ? 1 : 0) << " 8" << nl;
+  if (binary) { put_binary(s, int32_t(1)); s << nl; }
+  s << "$EndMeshFormat" << nl;
+  if (version == 2) {
+    s << "$Nodes" << nl << 4 << nl;
+    for (int i = 0; i < 4; ++i)
+      if (binary) {
+        put_binary(s, int32_t(i+1));
+        for (int k = 0; k < 3; ++k) put_binary(s, square_nodes[i][k]);
+      } else
+        s << i+1 << " " << square_nodes[i][0] << " " << square_nodes[i][1]
+          << " " << square_nodes[i][2] << nl;
+    if (binary) s << nl;
+    s << "$EndNodes" << nl << "$Elements" << nl << 3 << nl;
+    if (binary) {
+      int32_t line[] = {1, 1, 2, 1, 1, 1, 1, 2};
+      int32_t tri[] = {2, 2, 2, 2, 2, 1, 1, 2, 3, 3, 2, 1, 1, 3, 4};
+      for (int32_t i : line) put_binary(s, i);
+      for (int32_t i : tri) put_binary(s, i);
+      s << nl;
+    } else
+      s << "1 1 2 1 1 1 2" << nl << "2 2 2 2 1 1 2 3" << nl
+        << "3 2 2 2 1 1 3 4" << nl;
+    s << "$EndElements" << nl;
+    return s.str();
+  }
+
+  s << "$Entities" << nl;
+  if (binary) {
+    uint64_t nb[] = {0, 1, 1, 0};
+    for (uint64_t i : nb) put_binary(s, i);
+    put_binary(s, int32_t(1));
+    for (double x : {0., 0., 0., 1., 0., 0.}) put_binary(s, x);
+    put_binary(s, uint64_t(1)); put_binary(s, int32_t(1));
+    put_binary(s, uint64_t(0));
+    put_binary(s, int32_t(1));
+    for (double x : {0., 0., 0., 1., 1., 0.}) put_binary(s, x);
+    put_binary(s, uint64_t(1)); put_binary(s, int32_t(2));
+    put_binary(s, uint64_t(0));
+    s << nl;
+  } else
+    s << "0 1 1 0" << nl << "1 0 0 0 1 0 0 1 1 0" << nl
+      << "1 0 0 0 1 1 0 1 2 0" << nl;
+  s << "$EndEntities" << nl << "$Nodes" << nl;
+  // nodes 1, 2 on the curve 1, nodes 3, 4 on the surface 1
+  if (binary) {
+    for (uint64_t i : {2, 4, 1, 4}) put_binary(s, uint64_t(i));
+    for (int b = 0; b < 2; ++b) {
+      put_binary(s, int32_t(1+b)); put_binary(s, int32_t(1));
+      put_binary(s, int32_t(0)); put_binary(s, uint64_t(2));
+      put_binary(s, uint64_t(2*b+1)); put_binary(s, uint64_t(2*b+2));
+      for (int i = 2*b; i < 2*b+2; ++i)
+        for (int k = 0; k < 3; ++k) put_binary(s, square_nodes[i][k]);
+    }
+    s << nl;
+  } else {
+    s << "2 4 1 4" << nl;
+    for (int b = 0; b < 2; ++b) {
+      s << 1+b << " 1 0 2" << nl << 2*b+1 << nl << 2*b+2 << nl;
+      for (int i = 2*b; i < 2*b+2; ++i)
+        s << square_nodes[i][0] << " " << square_nodes[i][1] << " "
+          << square_nodes[i][2] << nl;
+    }
+  }
+  s << "$EndNodes" << nl << "$Elements" << nl;
+  if (binary) {
+    for (uint64_t i : {2, 3, 1, 3}) put_binary(s, uint64_t(i));
+    uint64_t line[] = {1, 1, 2}, tri[] = {2, 1, 2, 3, 3, 1, 3, 4};
+    put_binary(s, int32_t(1)); put_binary(s, int32_t(1));
+    put_binary(s, int32_t(1)); put_binary(s, uint64_t(1));
+    for (uint64_t i : line) put_binary(s, i);
+    put_binary(s, int32_t(2)); put_binary(s, int32_t(1));
+    put_binary(s, int32_t(2)); put_binary(s, uint64_t(2));
+    for (uint64_t i : tri) put_binary(s, i);
+    s << nl;
+  } else
+    s << "2 3 1 3" << nl << "1 1 1 1" << nl << "1 1 2" << nl
+      << "2 1 2 2" << nl << "2 1 2 3" << nl << "3 1 3 4" << nl;
+  s << "$EndElements" << nl;
+  return s.str();
+}
+
+void test_gmsh_import() {
+  for (int version : {2, 4})
+    for (int binary = 0; binary < 2; ++binary) {
+      std::stringstream f(gmsh_square(version, binary != 0));
+      getfem::mesh m;
+      getfem::import_mesh(f, "gmsh", m);
+      GMM_ASSERT1(m.dim() == 2 && m.nb_points() == 4
+                  && m.convex_index().card() == 2, "gmsh import: version "
+                  << version << (binary ? " binary" : " ASCII")
+                  << ": wrong mesh");
+      for (size_type i = 0; i < 4; ++i)
+        for (size_type k = 0; k < 2; ++k)
+          GMM_ASSERT1(m.points()[i][k] == square_nodes[i][k],
+                      "gmsh import: wrong node " << m.points()[i]);
+      size_type sum = 0;
+      for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+        for (size_type ip : m.ind_points_of_convex(cv)) sum += ip;
+      GMM_ASSERT1(sum == 8, "gmsh import: wrong element nodes");
+      size_type nbf = 0;
+      for (getfem::mr_visitor i(m.region(1)); !i.finished(); ++i, ++nbf) {
+        GMM_ASSERT1(i.is_face(), "gmsh import: wrong region 1");
+        for (size_type ip : m.ind_points_of_face_of_convex(i.cv(), i.f()))
+          GMM_ASSERT1(ip < 2, "gmsh import: wrong face in region 1");
+      }
+      GMM_ASSERT1(nbf == 1 && m.region(2).index().card() == 2,
+                  "gmsh import: version " << version
+                  << (binary ? " binary" : " ASCII") << ": wrong regions");
+    }
+}
+
+/* Small meshes in the other text formats, followed by some other data
+   which should remain in the stream after the import (except for GiD files
+   which are read up to their end). */
+void test_text_import() {
+  const char *files[][2] = {
+    { "am_fmt", "4 2\n1 2 3 1 3 4\n0 0 1 0 1 1 0 1\nnext" },
+    { "emc2_mesh", "MeshVersionFormatted 0\nDimension 2\nVertices\n4\n"
+      "0 0 0\n1 0 0\n1 1 0\n0 1 0\nTriangles\n2\n1 2 3 0\n1 3 4 0\n"
+      "End\nnext" },
+    { "noboite", "1 4 0 0 0 0\n0 0 0\n0 0 0\n1 2 3 4\n"
+      "0 0 0 1 0 0 0 1 0 0 0 1\nnext" },
+    { "gid", "MESH dimension 2 ElemType Triangle Nnode 3\nCoordinates\n"
+      "1 0 0\n2 1 0\n3 1 1\n4 0 1\nend coordinates\nElements\n"
+      "1 1 2 3 1\n2 1 3 4 1\nend elements\n" } };
+
+  for (const auto &file : files) {
+    std::stringstream f(file[1]);
+    getfem::mesh m;
+    getfem::import_mesh(f, file[0], m);
+    bool tetra = (std::string(file[0]) == "noboite");
+    GMM_ASSERT1(m.nb_points() == 4 && m.dim() == (tetra ? 3 : 2)
+                && m.convex_index().card() == (tetra ? 1 : 2),
+                file[0] << " import: wrong mesh");
+    getfem::scalar_type area = 0.;
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+      area += m.convex_area_estimate(cv);
+    GMM_ASSERT1(gmm::abs(area - (tetra ? 1./6. : 1.)) < 1E-10,
+                file[0] << " import: wrong mesh area " << area);
+    std::string next;
+    f >> next;
+    GMM_ASSERT1(next == (std::string(file[0]) == "gid" ? "" : "next"),
+                file[0] << " import: wrong position in the stream \""
+                << next << "\"");
+  }
+}
+
 int main(void) {
 
   test_mesh_building(2, 100); 
@@ -657,6 +910,11 @@ int main(void) {
   test_refinable(3, 3);
 
   test_incomplete_Q2();
+
+  test_vtu_export();
+  test_xdmf_export();
+  test_gmsh_import();
+  test_text_import();
   
   return 0;
 }
@@ -25,6 +25,156 @@ using std::endl; using std::cout; using std::cerr;
 using std::ends; using std::cin;
 using getfem::base_node;
 using getfem::scalar_type;
+using getfem::size_type;
+
+// Checks the grid and triangulated surface distances on the unit cube and
+// on the unit disk.
+static void check_sampled_distances() {
+  std::vector<base_node> pts;
+  for (unsigned i = 0; i < 8; ++i)
+    pts.push_back(base_node(i&1, (i>>1)&1, (i>>2)&1));
+  static const size_type f[] = { 0,2,1, 1,2,3, 4,5,6, 5,7,6, 0,1,4, 1,5,4,
+                                 2,6,3, 3,6,7, 0,4,2, 2,4,6, 1,3,5, 3,7,5 };
+  std::vector<size_type> faces(f, f + 36);
+  getfem::pmesher_signed_distance
+    T = getfem::new_mesher_triangulated_surface(pts, faces);
+  getfem::base_small_vector G;
+  for (unsigned i = 0; i < 1000; ++i) {
+    base_node P(3);
+    gmm::fill_random(P); P *= 1.5; P += base_node(.5, .5, .5);
+    scalar_type din(-1), dout(0);
+    for (unsigned k = 0; k < 3; ++k) {
+      din = std::max(din, std::max(-P[k], P[k]-1.));
+      scalar_type e = std::max(scalar_type(0), std::max(-P[k], P[k]-1.));
+      dout += e*e;
+    }
+    scalar_type d = (din < 0.) ? din : sqrt(dout);
+    assert(gmm::abs((*T)(P) - d) < 1E-10);
+    assert(gmm::abs(T->grad(P, G) - d) < 1E-10);
+    assert(gmm::abs(gmm::vect_norm2(G) - 1.) < 1E-8);
+  }
+
+  size_type n = 41;
+  std::vector<size_type> nb(2, n);
+  getfem::base_small_vector h(2./scalar_type(n-1), 2./scalar_type(n-1));
+  getfem::base_vector values(n*n);
+  for (size_type j = 0; j < n; ++j)
+    for (size_type i = 0; i < n; ++i)
+      values[j*n+i] = gmm::vect_norm2(base_node(-1.+h[0]*i, -1.+h[1]*j)) - 1.;
+  getfem::pmesher_signed_distance
+    D = getfem::new_mesher_grid_distance(base_node(-1., -1.), h, nb, values),
+    B = getfem::new_mesher_ball(base_node(0., 0.), 1.);
+  for (unsigned i = 0; i < 1000; ++i) {
+    base_node P(2);
+    gmm::fill_random(P); P *= 0.9;
+    if (gmm::vect_norm2(P) < 0.2) continue;
+    assert(gmm::abs((*D)(P) - (*B)(P)) < 5E-3);
+    D->grad(P, G);
+    assert(gmm::vect_dist2(G, P / gmm::vect_norm2(P)) < 0.1);
+  }
+  base_node P(3., 0.); // outside the grid
+  assert(gmm::abs((*D)(P) - 2.) < 1E-10);
+
+  getfem::base_vector dv;
+  std::vector<base_node> Ps(10, base_node(0.5, 0.5));
+  D->eval(Ps, dv);
+  assert(dv.size() == 10 && gmm::abs(dv[3] - (*D)(Ps[3])) < 1E-14);
+
+  // Evaluation shared between the threads on a set of points.
+  getfem::pmesher_signed_distance
+    U = getfem::new_mesher_union(B, getfem::new_mesher_ball(base_node(1., 0.),
+                                                            .5));
+  Ps.resize(0);
+  for (unsigned i = 0; i < 1000; ++i) {
+    base_node Q(2); gmm::fill_random(Q); Q *= 2.; Ps.push_back(Q);
+  }
+  getfem::eval_signed_distance(*U, Ps, dv);
+  for (unsigned i = 0; i < 1000; ++i)
+    assert(gmm::abs(dv[i] - (*U)(Ps[i])) < 1E-14);
+}
+
+// Moves the points of a triangulated grid by a shear, which makes half of
+// its edges non Delaunay without inverting any triangle, and checks the
+// triangulation repaired by edge flips. Inverting a triangle has to be
+// detected.
+static scalar_type circle_test(const std::vector<base_node> &P, size_type a,
+                               size_type b, size_type c, size_type d) {
+  scalar_type ax = P[a][0]-P[d][0], ay = P[a][1]-P[d][1];
+  scalar_type bx = P[b][0]-P[d][0], by = P[b][1]-P[d][1];
+  scalar_type cx = P[c][0]-P[d][0], cy = P[c][1]-P[d][1];
+  return (ax*ax+ay*ay)*(bx*cy-cx*by) - (bx*bx+by*by)*(ax*cy-cx*ay)
+    + (cx*cx+cy*cy)*(ax*by-bx*ay);
+}
+
+static scalar_type triangle_area(const std::vector<base_node> &P,
+                                 size_type a, size_type b, size_type c) {
+  return ((P[b][0]-P[a][0])*(P[c][1]-P[a][1])
+          - (P[b][1]-P[a][1])*(P[c][0]-P[a][0])) / 2.;
+}
+
+static void grid_triangulation(size_type n, std::vector<base_node> &P,
+                               gmm::dense_matrix<size_type> &t,
+                               std::vector<int> &orient) {
+  scalar_type h = 1. / scalar_type(n-1);
+  P.resize(0);
+  for (size_type j = 0; j < n; ++j)
+    for (size_type i = 0; i < n; ++i) {
+      base_node e(2); gmm::fill_random(e);
+      if (i == 0 || j == 0 || i == n-1 || j == n-1) e *= 0.;
+      P.push_back(base_node(h*i, h*j) + e * (0.05*h));
+    }
+  gmm::resize(t, 3, 2*(n-1)*(n-1)); orient.resize(0);
+  size_type k = 0;
+  for (size_type j = 0; j+1 < n; ++j)
+    for (size_type i = 0; i+1 < n; ++i) {
+      size_type a = j*n+i, b = a+1, c = a+n+1, d = a+n;
+      // half of the triangles are given clockwise
+      t(0,k) = a; t(1,k) = b; t(2,k) = c; orient.push_back(1); ++k;
+      t(0,k) = a; t(1,k) = d; t(2,k) = c; orient.push_back(-1); ++k;
+    }
+}
+
+static void check_delaunay_by_flips() {
+  size_type n = 11, nbflips;
+  scalar_type h = 1. / scalar_type(n-1);
+  std::vector<base_node> P;
+  gmm::dense_matrix<size_type> t;
+  std::vector<int> orient;
+  grid_triangulation(n, P, t, orient);
+  for (size_type i = 0; i < P.size(); ++i) P[i][0] += 0.8 * P[i][1];
+  assert(getfem::delaunay_by_flips(P, t, orient, h, &nbflips));
+  assert(nbflips > 0);
+
+  size_type nbt = gmm::mat_ncols(t);
+  assert(nbt == 2*(n-1)*(n-1) && orient.size() == nbt);
+  scalar_type area(0);
+  typedef std::pair<size_type, size_type> edge;
+  std::map<edge, std::vector<size_type> > edge_elts;
+  for (size_type i = 0; i < nbt; ++i) {
+    assert(orient[i] == 1);
+    scalar_type a = triangle_area(P, t(0,i), t(1,i), t(2,i));
+    assert(a > 0.);
+    area += a;
+    for (size_type k = 0; k < 3; ++k) {
+      size_type a0 = t(k,i), b0 = t((k+1)%3,i);
+      edge_elts[edge(std::min(a0,b0), std::max(a0,b0))].push_back(i);
+    }
+  }
+  assert(gmm::abs(area - 1.) < 1E-10);
+  for (const auto &e : edge_elts) {
+    assert(e.second.size() <= 2);
+    if (e.second.size() < 2) continue;
+    size_type i1 = e.second[0], i2 = e.second[1], d(0);
+    for (size_type k = 0; k < 3; ++k)
+      if (t(k,i2) != e.first.first && t(k,i2) != e.first.second) d = t(k,i2);
+    assert(circle_test(P, t(0,i1), t(1,i1), t(2,i1), d) < 1E-10*h*h*h*h);
+  }
+
+  // A point moved beyond its neighbour inverts some triangles.
+  grid_triangulation(n, P, t, orient);
+  P[5*n+5][0] += 1.5*h;
+  assert(!getfem::delaunay_by_flips(P, t, orient, h));
+}
 
 int main(int argc, char **argv) {
 
@@ -46,6 +196,9 @@ int main(int argc, char **argv) {
     assert(K>0); assert(h>0.); 
     std::vector<getfem::base_node> fixed;
 
+    check_sampled_distances();
+    check_delaunay_by_flips();
+
     getfem::pmesher_signed_distance
       D0  = getfem::new_mesher_ball(base_node(0.,0.),1.),
       B1  = getfem::new_mesher_ball(base_node(1.5,0.),2.),     
@@ -20,6 +20,7 @@
 ===========================================================================*/
 #include "getfem/getfem_mesh_im_level_set.h"
 #include "getfem/getfem_mesh_im_level_set.h"
+#include "getfem/getfem_regular_meshes.h"
 using std::endl; using std::cout; using std::cerr;
 using std::ends; using std::cin;
 
@@ -170,6 +171,186 @@ void test_3d() {
     GMM_ASSERT1(false, "Cutting integration method has failed");
 }
 
+/* The elements cut by mesh_level_set::adapt have to contain the ones on
+   which the level set takes both signs, the other ones being in the
+   zone of the sign of the level set. */
+void test_cut_detection() {
+  for (bgeot::short_type K = 1; K <= 2; ++K) {
+    getfem::mesh m;
+    std::vector<size_type> nsubdiv(2, 8);
+    getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(2,1));
+    getfem::level_set ls(m, K);
+    const getfem::mesh_fem &lsmf = ls.get_mesh_fem();
+    for (unsigned i=0; i < lsmf.nb_dof(); ++i)
+      ls.values()[i] = gmm::vect_dist2_sqr(lsmf.point_of_basic_dof(i),
+					   base_node(0.47, 0.52)) - 0.09;
+    getfem::mesh_level_set mls(m);
+    mls.add_level_set(ls);
+    mls.adapt();
+
+    size_type nbcut = 0;
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+      getfem::pmesher_signed_distance d = ls.mls_of_convex(cv, 0);
+      const bgeot::basic_mesh *pm = bgeot::refined_simplex_mesh_for_convex
+	(m.trans_of_convex(cv)->convex_ref(), 8);
+      bool neg = false, pos = false;
+      for (bgeot::node_tab::const_iterator it = pm->points().begin();
+	   it != pm->points().end(); ++it) {
+	scalar_type v = (*d)(*it);
+	if (v < 0) neg = true; else if (v > 0) pos = true;
+      }
+      if (mls.is_convex_cut(cv)) ++nbcut;
+      else {
+	GMM_ASSERT1(!(neg && pos), "element " << cv << " should be cut");
+	GMM_ASSERT1(mls.primary_zone_of_convex(cv) == (neg ? "-" : "+"),
+		    "wrong zone for element " << cv);
+      }
+    }
+    cout << nbcut << " elements cut by the level set of degree " << K << endl;
+    GMM_ASSERT1(nbcut > 0, "No cut element");
+
+    // The cut elements and their sub-meshes do not depend on the number
+    // of threads.
+    size_type nbth = getfem::num_threads();
+    getfem::set_num_threads(1);
+    getfem::mesh_level_set mls1(m);
+    mls1.add_level_set(ls);
+    mls1.adapt();
+    getfem::set_num_threads(int(nbth));
+    for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+      GMM_ASSERT1(mls.is_convex_cut(cv) == mls1.is_convex_cut(cv),
+		  "element " << cv << " cut with some numbers of threads only");
+      if (mls.is_convex_cut(cv))
+	GMM_ASSERT1(mls.mesh_of_convex(cv).nb_points()
+		    == mls1.mesh_of_convex(cv).nb_points(), "the cut of "
+		    "element " << cv << " depends on the number of threads");
+    }
+  }
+}
+
+static scalar_type area_of(const getfem::mesh_im &mim) {
+  const getfem::mesh &m = mim.linked_mesh();
+  scalar_type area(0);
+  base_matrix G;
+  for (dal::bv_visitor i(m.convex_index()); !i.finished(); ++i) {
+    getfem::pintegration_method pim = mim.int_method_of_element(i);
+    if (pim->type() == getfem::IM_NONE) continue;
+    getfem::papprox_integration pai = pim->approx_method();
+    bgeot::vectors_to_base_matrix(G, m.points_of_convex(i));
+    bgeot::geotrans_interpolation_context c(m.trans_of_convex(i),
+					    pai->point(0), G);
+    for (size_type j = 0; j < pai->nb_points_on_convex(); ++j) {
+      c.set_xref(pai->point(j));
+      area += pai->coeff(j) * c.J();
+    }
+  }
+  return area;
+}
+
+/* A local change of the level set re-adapts only the elements on which
+   it has changed, and gives the same cut and the same integration
+   methods as a full adaptation. */
+void test_incremental_adapt() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(2, 10);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(2,1));
+  getfem::pintegration_method pim
+    = getfem::int_method_descriptor("IM_TRIANGLE(4)");
+  getfem::level_set ls(m, 2);
+  const getfem::mesh_fem &lsmf = ls.get_mesh_fem();
+  for (unsigned i=0; i < lsmf.nb_dof(); ++i)
+    ls.values()[i] = gmm::vect_dist2_sqr(lsmf.point_of_basic_dof(i),
+					 base_node(0.5, 0.5)) - 0.1;
+  getfem::mesh_level_set mls(m);
+  mls.add_level_set(ls);
+  getfem::mesh_im_level_set
+    mim(mls, getfem::mesh_im_level_set::INTEGRATE_INSIDE, pim);
+  mim.set_integration_method(m.convex_index(), pim);
+  mls.adapt(); mim.adapt();
+  std::vector<gmm::uint64_type> versions(m.nb_allocated_convex());
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    versions[cv] = mls.convex_version_number(cv);
+
+  for (unsigned i=0; i < lsmf.nb_dof(); ++i)
+    if (lsmf.point_of_basic_dof(i)[0] > 0.75) ls.values()[i] -= 0.02;
+  mls.adapt(); mim.adapt();
+
+  getfem::mesh_level_set mls2(m);
+  mls2.add_level_set(ls);
+  getfem::mesh_im_level_set
+    mim2(mls2, getfem::mesh_im_level_set::INTEGRATE_INSIDE, pim);
+  mim2.set_integration_method(m.convex_index(), pim);
+  mls2.adapt(); mim2.adapt();
+
+  size_type nbchanged = 0;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv) {
+    if (mls.convex_version_number(cv) != versions[cv]) ++nbchanged;
+    GMM_ASSERT1(mls.is_convex_cut(cv) == mls2.is_convex_cut(cv),
+		"wrong cut status for element " << cv);
+    GMM_ASSERT1(mls.primary_zone_of_convex(cv)
+		== mls2.primary_zone_of_convex(cv),
+		"wrong zone for element " << cv);
+  }
+  scalar_type area = area_of(mim), area2 = area_of(mim2);
+  cout << nbchanged << " elements adapted again over "
+       << m.convex_index().card() << ", area " << area
+       << " instead of " << area2 << endl;
+  GMM_ASSERT1(nbchanged > 0 && nbchanged < m.convex_index().card() / 2,
+	      "The change of the level set is local");
+  // The cuts are computed with random perturbations.
+  GMM_ASSERT1(gmm::abs(area - area2) < 1E-6, "Incremental adapt failed");
+
+  // The zones no longer used are removed: going back and forth between
+  // two level sets does not increase the memory used.
+  size_type size0 = 0;
+  for (size_type k = 0; k < 6; ++k) {
+    for (unsigned i=0; i < lsmf.nb_dof(); ++i)
+      if (lsmf.point_of_basic_dof(i)[0] > 0.75)
+	ls.values()[i] += (k % 2) ? -0.02 : 0.02;
+    mls.adapt();
+    if (k == 1) size0 = mls.memsize();
+    if (k > 1 && k % 2)
+      GMM_ASSERT1(mls.memsize() == size0, "The zones are not removed");
+  }
+}
+
+/* On a structured mesh cut by a straight line, the cut elements have
+   only a few different cut patterns and share their integration
+   methods. */
+void test_shared_cut_methods() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(2, 10);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::simplex_geotrans(2,1));
+  getfem::pintegration_method pim
+    = getfem::int_method_descriptor("IM_TRIANGLE(4)");
+  getfem::level_set ls(m, 1);
+  const getfem::mesh_fem &lsmf = ls.get_mesh_fem();
+  for (unsigned i=0; i < lsmf.nb_dof(); ++i)
+    ls.values()[i] = lsmf.point_of_basic_dof(i)[0] - 0.35;
+  getfem::mesh_level_set mls(m);
+  mls.add_level_set(ls);
+  getfem::mesh_im_level_set
+    mim(mls, getfem::mesh_im_level_set::INTEGRATE_INSIDE, pim);
+  mim.set_integration_method(m.convex_index(), pim);
+  mls.adapt(); mim.adapt();
+
+  size_type nbcut = 0;
+  for (dal::bv_visitor cv(m.convex_index()); !cv.finished(); ++cv)
+    if (mls.is_convex_cut(cv)) ++nbcut;
+  scalar_type area = area_of(mim);
+  cout << nbcut << " cut elements, " << mim.nb_distinct_cut_methods()
+       << " distinct integration methods, area " << area << endl;
+  GMM_ASSERT1(nbcut > 0 && mim.nb_distinct_cut_methods() <= nbcut / 4,
+	      "The integration methods are not shared");
+  GMM_ASSERT1(gmm::abs(area - 0.35) < 1E-8, "Wrong area : " << area);
+
+  for (unsigned i=0; i < lsmf.nb_dof(); ++i)
+    ls.values()[i] += 0.1;
+  mls.adapt(); mim.adapt();
+  area = area_of(mim);
+  GMM_ASSERT1(gmm::abs(area - 0.25) < 1E-8, "Wrong area : " << area);
+}
+
 int main(/* int argc, char **argv */) {
 
   GMM_SET_EXCEPTION_DEBUG; // Exceptions make a memory fault, to debug.
@@ -178,6 +359,9 @@ int main(/* int argc, char **argv */) {
   try {
     // getfem::getfem_mesh_level_set_noisy();
     test_2d();
+    test_cut_detection();
+    test_incremental_adapt();
+    test_shared_cut_methods();
   }
   GMM_STANDARD_CATCH_ERROR;
   return 0;
@@ -141,6 +141,17 @@ static void verify(const std::vector<base_node>& rmin, const std::vector<base_no
 
     tree.find_boxes_at_point(max,pbset);
     brute_force_check(rmin,rmax,pbset,has_point_p(max));
+
+    rtree::pbox_cont pbcont;
+    tree.find_boxes_at_point(min,pbcont);
+    std::vector<size_type> pbset2;
+    for (size_type j=0; j < pbcont.size(); ++j) {
+      assert(j == 0 || pbcont[j-1] < pbcont[j]); // sorted, no duplicates
+      pbset2.push_back(pbcont[j]->id);
+    }
+    tree.find_boxes_at_point(min,pbset);
+    assert(pbset2.size() == pbset.size());
+    brute_force_check(rmin,rmax,pbset2,has_point_p(min));
   }
   for (size_type i=0; i < rmin.size(); ++i) {
     base_node min2(rmin[i]); for (size_type k=0; k < N; ++k) { min2[k] -= extent[k]*gmm::random()*0.1; }
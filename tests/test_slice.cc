@@ -21,6 +21,7 @@
 #include "getfem/bgeot_comma_init.h"
 #include "getfem/bgeot_comma_init.h"
 #include "getfem/getfem_mesh_slice.h"
+#include "getfem/getfem_regular_meshes.h"
 using std::endl; using std::cout; using std::cerr;
 using std::ends; using std::cin;
 
@@ -64,6 +65,122 @@ namespace getfem {
 #endif
 }
 
+static void check_same_slices(const getfem::stored_mesh_slice &sl1,
+                              const getfem::stored_mesh_slice &sl2) {
+  GMM_ASSERT1(sl1.nb_convex() == sl2.nb_convex() &&
+              sl1.nb_points() == sl2.nb_points() &&
+              sl1.nb_simplexes(3) == sl2.nb_simplexes(3) &&
+              sl1.dim() == sl2.dim(), "different slices");
+  for (size_type ic = 0; ic < sl1.nb_convex(); ++ic) {
+    GMM_ASSERT1(sl1.convex_num(ic) == sl2.convex_num(ic) &&
+                sl1.convex_pos(sl1.convex_num(ic)) == ic &&
+                sl1.global_index(ic, 0) == sl2.global_index(ic, 0) &&
+                sl1.nodes(ic).size() == sl2.nodes(ic).size() &&
+                sl1.simplexes(ic) == sl2.simplexes(ic), "different slices");
+    for (size_type i = 0; i < sl1.nodes(ic).size(); ++i)
+      GMM_ASSERT1(gmm::vect_dist2(sl1.nodes(ic)[i].pt,
+                                  sl2.nodes(ic)[i].pt) == 0,
+                  "different slices");
+  }
+}
+
+/* the slice built by stored_mesh_slice::build (in parallel when several
+   threads are available) has to be the same as the one built with a
+   single thread and as the one built convex by convex. */
+static void test_parallel_build() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(3, 6);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::parallelepiped_geotrans(3,1));
+  getfem::base_node x0{.5,.5,.5};
+
+  getfem::slicer_sphere s1(x0, .4, getfem::slicer_volume::VOLIN);
+  getfem::slicer_compute_area a1;
+  getfem::stored_mesh_slice sl1;
+  sl1.build(m, s1, a1, 2);
+
+  getfem::slicer_sphere s2(x0, .4, getfem::slicer_volume::VOLIN);
+  getfem::slicer_compute_area a2;
+  getfem::stored_mesh_slice sl2;
+  getfem::mesh_slicer ms(m);
+  ms.push_back_action(s2); ms.push_back_action(a2);
+  getfem::slicer_build_stored_mesh_slice slb(sl2);
+  ms.push_back_action(slb);
+  ms.exec(2);
+
+  size_type nbth = getfem::num_threads();
+  getfem::set_num_threads(1);
+  getfem::slicer_sphere s3(x0, .4, getfem::slicer_volume::VOLIN);
+  getfem::slicer_compute_area a3;
+  getfem::stored_mesh_slice sl3;
+  sl3.build(m, s3, a3, 2);
+  // the per thread areas of a3 are sized for a single thread
+  getfem::scalar_type area3 = a3.area();
+  getfem::set_num_threads(int(nbth));
+
+  check_same_slices(sl1, sl2);
+  check_same_slices(sl1, sl3);
+  GMM_ASSERT1(gmm::abs(a1.area() - a2.area()) < 1e-12 &&
+              gmm::abs(a1.area() - area3) < 1e-12, "different volumes");
+  cout << "parallel build of " << sl1.nb_simplexes(3)
+       << " tetrahedrons with " << nbth << " threads" << endl;
+}
+
+/* interpolation on a slice with the cached interpolation matrix, which
+   has to follow the modifications of the mesh_fem. */
+static void test_interpolation() {
+  getfem::mesh m;
+  std::vector<size_type> nsubdiv(2, 5);
+  getfem::regular_unit_mesh(m, nsubdiv, bgeot::parallelepiped_geotrans(2,1));
+  getfem::stored_mesh_slice sl;
+  sl.build(m, getfem::slicer_half_space(getfem::base_node{.3,.3},
+                                        getfem::base_node{1,1},
+                                        getfem::slicer_volume::VOLIN), 3);
+  getfem::mesh_fem mf(m, 2);
+  for (size_type k = 1; k <= 2; ++k) {
+    mf.set_classical_finite_element(getfem::dim_type(k));
+    std::vector<double> U(mf.nb_dof()), V(sl.nb_points()*2);
+    for (size_type t = 0; t < 3; ++t) { // same matrix for several fields
+      for (size_type i = 0; i < mf.nb_dof(); i += 2) {
+        getfem::base_node P = mf.point_of_basic_dof(i);
+        U[i] = double(t) + P[0]*P[0]; U[i+1] = P[0] - 2*P[1];
+      }
+      sl.interpolate(mf, U, V);
+      for (size_type ic = 0; ic < sl.nb_convex(); ++ic)
+        for (size_type i = 0; i < sl.nodes(ic).size(); ++i) {
+          const getfem::base_node &P = sl.nodes(ic)[i].pt;
+          size_type j = sl.global_index(ic, i);
+          GMM_ASSERT1(gmm::abs(V[2*j+1] - (P[0] - 2*P[1])) < 1e-10 &&
+                      (k == 1 || gmm::abs(V[2*j] - (double(t) + P[0]*P[0]))
+                       < 1e-10), "wrong interpolation");
+        }
+    }
+    GMM_ASSERT1(gmm::mat_ncols(sl.interpolation_matrix(mf)) == mf.nb_dof(),
+                "the interpolation matrix has not been updated");
+  }
+
+  /* concurrent interpolations, the matrices of the two mesh_fems being
+     computed by the first threads using them. */
+  getfem::mesh_fem mf1(m), mf2(m);
+  mf1.set_classical_finite_element(1); mf2.set_classical_finite_element(2);
+  mf1.nb_dof(); mf2.nb_dof();
+  std::vector<int> ok(8, 0);
+  getfem::open_mp_for(0, 8, [&](int i) {
+    const getfem::mesh_fem &mfi = (i % 2) ? mf2 : mf1;
+    std::vector<double> U(mfi.nb_dof()), V(sl.nb_points());
+    for (size_type j = 0; j < mfi.nb_dof(); ++j)
+      U[j] = double(i) + mfi.point_of_basic_dof(j)[0];
+    sl.interpolate(mfi, U, V);
+    ok[i] = 1;
+    for (size_type ic = 0; ic < sl.nb_convex(); ++ic)
+      for (size_type j = 0; j < sl.nodes(ic).size(); ++j)
+        if (gmm::abs(V[sl.global_index(ic, j)] - double(i)
+                     - sl.nodes(ic)[j].pt[0]) > 1e-10) ok[i] = 0;
+  });
+  for (size_type i = 0; i < 8; ++i)
+    GMM_ASSERT1(ok[i], "wrong concurrent interpolation");
+  cout << "interpolation on " << sl.nb_points() << " slice nodes ok\n";
+}
+
 int 
 main() {
 
@@ -113,5 +230,8 @@ main() {
   cout << sl << endl;
 
   cout << "memory 1: " << sl.memsize() << " bytes\n";
+
+  test_parallel_build();
+  test_interpolation();
   return 0;
 }
@@ -0,0 +1,172 @@
+/*===========================================================================
+
+ Copyright (C) 2017-2017 Yves Renard.
+
+ This file is a part of GetFEM++
+
+ GetFEM++  is  free software;  you  can  redistribute  it  and/or modify it
+ under  the  terms  of the  GNU  Lesser General Public License as published
+ by  the  Free Software Foundation;  either version 3 of the License,  or
+ (at your option) any later version along with the GCC Runtime Library
+ Exception either version 3.1 or (at your option) any later version.
+ This program  is  distributed  in  the  hope  that it will be useful,  but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ or  FITNESS  FOR  A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ License and GCC Runtime Library Exception for more details.
+ You  should  have received a copy of the GNU Lesser General Public License
+ along  with  this program;  if not, write to the Free Software Foundation,
+ Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+
+===========================================================================*/
+
+/* Tests of the cache of the stored objects found by
+   dal::search_stored_object in each thread. */
+
+#include "getfem/dal_static_stored_objects.h"
+#include "getfem/dal_singleton.h"
+
+using std::endl; using std::cout; using std::cerr;
+
+DAL_SIMPLE_KEY(test_object_key, int);
+DAL_SIMPLE_KEY(other_test_object_key, int);
+
+struct test_object : virtual public dal::static_stored_object {
+  int i;
+  test_object(int ii) : i(ii) {}
+};
+
+static dal::pstatic_stored_object_key key(int i)
+{ return std::make_shared<test_object_key>(i); }
+
+static int search(int i) {
+  dal::pstatic_stored_object o = dal::search_stored_object(key(i));
+  if (!o) return -1;
+  return std::dynamic_pointer_cast<const test_object>(o)->i;
+}
+
+static void check_counts(size_t &h0, size_t &m0, size_t dh, size_t dm) {
+  size_t h, m;
+  dal::stored_object_cache_statistics(h, m);
+  GMM_ASSERT1(h == h0 + dh && m == m0 + dm, "cache statistics: " << h-h0
+              << " hits and " << m-m0 << " misses instead of " << dh
+              << " and " << dm);
+  h0 = h; m0 = m;
+}
+
+static void test_cache() {
+  size_t h, m;
+  dal::stored_object_cache_statistics(h, m);
+
+  std::vector<dal::pstatic_stored_object> objs;
+  for (int i = 0; i < 64; ++i) {
+    objs.push_back(std::make_shared<test_object>(i));
+    dal::add_stored_object(key(i), objs.back());
+  }
+
+  // The first search is answered by the table, the next ones by the cache.
+  GMM_ASSERT1(search(3) == 3, "wrong object");
+  check_counts(h, m, 0, 1);
+  GMM_ASSERT1(search(3) == 3 && search(3) == 3, "wrong object");
+  check_counts(h, m, 2, 0);
+
+  // A key of another type with the same value is not found in the cache.
+  GMM_ASSERT1(!dal::search_stored_object
+              (std::make_shared<other_test_object_key>(3)), "wrong object");
+  check_counts(h, m, 0, 1);
+  // Neither is a key missing in the table, which is not added to the cache.
+  GMM_ASSERT1(search(1000) == -1 && search(1000) == -1, "wrong object");
+  check_counts(h, m, 0, 2);
+  GMM_ASSERT1(search(3) == 3, "wrong object");
+  check_counts(h, m, 1, 0);
+
+  // The cache keeps all the objects found, whatever the type of their key.
+  GMM_ASSERT1(search(4) == 4 && search(3) == 3, "wrong object");
+  check_counts(h, m, 1, 1);
+  dal::pstatic_stored_object o3(std::make_shared<test_object>(1003));
+  dal::add_stored_object(std::make_shared<other_test_object_key>(3), o3);
+  GMM_ASSERT1(dal::search_stored_object
+              (std::make_shared<other_test_object_key>(3)) == o3,
+              "wrong object");
+  check_counts(h, m, 0, 1);
+  for (int k = 0; k < 3; ++k) {
+    GMM_ASSERT1(search(4) == 4 && search(3) == 3 && dal::search_stored_object
+                (std::make_shared<other_test_object_key>(3)) == o3,
+                "wrong object");
+    check_counts(h, m, 3, 0);
+  }
+  for (int i = 0; i < 64; ++i) search(i);
+  check_counts(h, m, 2, 62);
+  for (int i = 0; i < 64; ++i) search(i);
+  check_counts(h, m, 64, 0);
+  dal::del_stored_object(o3);
+
+  // A deletion invalidates the cache, a deleted object is not found.
+  GMM_ASSERT1(search(5) == 5 && search(5) == 5, "wrong object");
+  check_counts(h, m, 1, 1);
+  dal::del_stored_object(objs[5]);
+  GMM_ASSERT1(search(5) == -1, "deleted object found");
+  check_counts(h, m, 0, 1);
+  GMM_ASSERT1(search(3) == 3, "wrong object");
+  check_counts(h, m, 0, 1);
+  GMM_ASSERT1(search(3) == 3, "wrong object");
+  check_counts(h, m, 1, 0);
+
+  // An object stored again with the same key replaces the deleted one.
+  objs[5] = std::make_shared<test_object>(105);
+  dal::add_stored_object(key(5), objs[5]);
+  GMM_ASSERT1(search(5) == 105 && search(5) == 105, "wrong object");
+  check_counts(h, m, 1, 1);
+
+  for (int i = 0; i < 64; ++i) dal::del_stored_object(objs[i], true);
+  GMM_ASSERT1(search(3) == -1, "deleted object found");
+}
+
+/* Compares the time of the searches in the table only, which is what a
+   search did before the cache, of the first searches of the objects, which
+   miss the cache, and of the searches answered by the cache. */
+static void time_searches(int n) {
+  std::vector<dal::pstatic_stored_object> objs;
+  std::vector<dal::pstatic_stored_object_key> keys;
+  for (int i = 0; i < 65; ++i) {
+    objs.push_back(std::make_shared<test_object>(i));
+    keys.push_back(key(i));
+    dal::add_stored_object(keys.back(), objs.back());
+  }
+  const dal::stored_object_tab &tab
+    = dal::singleton<dal::stored_object_tab>::instance();
+  size_t nb = 0;
+  double t = gmm::uclock_sec();
+  for (int j = 0; j < n; ++j)
+    for (int i = 0; i < 64; ++i)
+      if (tab.search_stored_object(keys[i])) ++nb;
+  double t_table = gmm::uclock_sec() - t;
+  t = gmm::uclock_sec();
+  for (int j = 0; j < n; ++j) {
+    // each deletion empties the cache
+    dal::del_stored_object(objs[64], true);
+    dal::add_stored_object(keys[64], objs[64]);
+    for (int i = 0; i < 64; ++i)
+      if (dal::search_stored_object(keys[i])) ++nb;
+  }
+  double t_miss = gmm::uclock_sec() - t;
+  t = gmm::uclock_sec();
+  for (int j = 0; j < n; ++j)
+    for (int i = 0; i < 64; ++i)
+      if (dal::search_stored_object(keys[i])) ++nb;
+  double t_hit = gmm::uclock_sec() - t;
+  GMM_ASSERT1(nb == size_t(3*64*n), "objects not found");
+  cout << "Searches of " << 64*n << " objects, table only : " << t_table
+       << "s, cache misses : " << t_miss << "s, cache hits : " << t_hit
+       << "s" << endl;
+  for (int i = 0; i < 65; ++i) dal::del_stored_object(objs[i], true);
+}
+
+int main(int argc, char *argv[]) {
+  try {
+    test_cache();
+    time_searches((argc > 1) ? atoi(argv[1]) : 10000);
+  }
+  GMM_STANDARD_CATCH_ERROR;
+
+  return 0;
+}